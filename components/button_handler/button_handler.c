@@ -1,8 +1,14 @@
 /**
  * Button Handler Component
- * 
+ *
  * Manages button inputs with debouncing and event callbacks.
- * 
+ *
+ * Edges are caught by a GPIO interrupt that timestamps them and wakes the
+ * button task. Debounce, long press and double-click windows run on
+ * one-shot esp_timers per button, so a button waiting for its second
+ * click never delays the others and the task only runs when something
+ * happened.
+ *
  * @author ninharp
  * @date 2025
  */
@@ -10,115 +16,248 @@
 #include "button_handler.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "esp_attr.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "metrics.h"
 
 static const char *TAG = "BUTTON";
 
 #define BUTTON_TASK_STACK_SIZE 4096  // Increased from 2048 to prevent stack overflow
 #define BUTTON_TASK_PRIORITY 5
+#define BUTTON_QUEUE_LEN (MAX_BUTTONS * 4)
 #define DOUBLE_CLICK_TIME_MS 300
 
+/**
+ * Button task input (from the ISR and the timers)
+ */
+typedef enum {
+    BUTTON_MSG_EDGE,            // First edge after a stable period
+    BUTTON_MSG_DEBOUNCE,        // Debounce time over, sample the pin
+    BUTTON_MSG_LONG_PRESS,      // Held for long_press_time_ms
+    BUTTON_MSG_CLICK_TIMEOUT    // No second click within DOUBLE_CLICK_TIME_MS
+} button_msg_type_t;
+
+typedef struct {
+    uint8_t id;
+    uint8_t type;               // button_msg_type_t
+} button_msg_t;
+
 typedef struct {
     button_config_t config;
     uint8_t id;
-    bool current_state;
-    bool last_state;
-    uint64_t press_time;
-    uint64_t release_time;
+    bool current_state;             // Debounced state
+    volatile bool debouncing;       // Set by the ISR, further edges are ignored until sampled
+    volatile int64_t edge_us;       // ISR timestamp of the first edge
+    int64_t event_us;               // Edge time of the last press/release
     bool long_press_triggered;
     uint8_t click_count;
+    esp_timer_handle_t debounce_timer;
+    esp_timer_handle_t long_press_timer;
+    esp_timer_handle_t click_timer;
 } button_state_t;
 
 static button_state_t buttons[MAX_BUTTONS];
 static uint8_t num_buttons_active = 0;
 static button_callback_t event_callback = NULL;
 static TaskHandle_t button_task_handle = NULL;
+static QueueHandle_t button_queue = NULL;
+static bool isr_service_installed = false;
 static bool is_initialized = false;
 
+static metric_t *m_latency_us = NULL;
+
+/**
+ * GPIO interrupt - timestamp the edge and wake the task
+ */
+static void IRAM_ATTR button_isr_handler(void *arg)
+{
+    button_state_t *btn = (button_state_t *)arg;
+    if (btn->debouncing) {
+        return;     // Bounce of an edge that is already being debounced
+    }
+    btn->debouncing = true;
+    btn->edge_us = esp_timer_get_time();
+
+    button_msg_t msg = { .id = btn->id, .type = BUTTON_MSG_EDGE };
+    BaseType_t woken = pdFALSE;
+    if (xQueueSendFromISR(button_queue, &msg, &woken) != pdTRUE) {
+        btn->debouncing = false;
+    }
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+/**
+ * Timer callbacks - hand the timeout to the button task
+ */
+static void post_msg(button_state_t *btn, button_msg_type_t type)
+{
+    button_msg_t msg = { .id = btn->id, .type = type };
+    if (xQueueSend(button_queue, &msg, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Button %d: event queue full", btn->id);
+    }
+}
+
+static void debounce_timer_callback(void *arg)
+{
+    post_msg((button_state_t *)arg, BUTTON_MSG_DEBOUNCE);
+}
+
+static void long_press_timer_callback(void *arg)
+{
+    post_msg((button_state_t *)arg, BUTTON_MSG_LONG_PRESS);
+}
+
+static void click_timer_callback(void *arg)
+{
+    post_msg((button_state_t *)arg, BUTTON_MSG_CLICK_TIMEOUT);
+}
+
+/**
+ * Read the pin as pressed/released
+ */
+static bool read_pressed(const button_state_t *btn)
+{
+    int level = gpio_get_level(btn->config.pin);
+    return btn->config.active_low ? (level == 0) : (level == 1);
+}
+
+static void emit(button_state_t *btn, button_event_t event)
+{
+    if (event_callback) {
+        event_callback(btn->id, event);
+    }
+}
+
+/**
+ * Debounced press or release
+ */
+static void handle_transition(button_state_t *btn, bool pressed)
+{
+    int64_t now = esp_timer_get_time();
+    btn->current_state = pressed;
+    btn->event_us = btn->edge_us;
+    metrics_max(m_latency_us, (int32_t)(now - btn->event_us));
+
+    if (pressed) {
+        // Long press counts from the edge, not from the end of the debounce
+        int64_t held_us = now - btn->event_us;
+        int64_t remaining_us = (int64_t)btn->config.long_press_time_ms * 1000 - held_us;
+        btn->long_press_triggered = false;
+        esp_timer_start_once(btn->long_press_timer, remaining_us > 0 ? remaining_us : 1);
+        emit(btn, BUTTON_EVENT_PRESSED);
+        return;
+    }
+
+    esp_timer_stop(btn->long_press_timer);
+    emit(btn, BUTTON_EVENT_RELEASED);
+    if (btn->long_press_triggered) {
+        return;
+    }
+
+    btn->click_count++;
+    if (btn->click_count >= 2) {
+        esp_timer_stop(btn->click_timer);
+        btn->click_count = 0;
+        emit(btn, BUTTON_EVENT_DOUBLE_CLICK);
+    } else {
+        // Click is reported once no second click follows
+        esp_timer_start_once(btn->click_timer, DOUBLE_CLICK_TIME_MS * 1000);
+    }
+}
+
 /**
- * Button polling task
+ * Button task - runs the per-button state machines
  */
 static void button_task(void *arg)
 {
+    button_msg_t msg;
+
     while (1) {
-        uint64_t now = esp_timer_get_time() / 1000; // Convert to milliseconds
+        if (xQueueReceive(button_queue, &msg, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        button_state_t *btn = &buttons[msg.id];
 
-        for (uint8_t i = 0; i < num_buttons_active; i++) {
-            if (buttons[i].config.pin == -1) {
-                continue;
+        switch (msg.type) {
+            case BUTTON_MSG_EDGE: {
+                uint32_t debounce_ms = btn->config.debounce_time_ms ? btn->config.debounce_time_ms : 1;
+                esp_timer_start_once(btn->debounce_timer, debounce_ms * 1000);
+                break;
             }
 
-            // Read current button state
-            int level = gpio_get_level(buttons[i].config.pin);
-            bool pressed = buttons[i].config.active_low ? (level == 0) : (level == 1);
-
-            // Detect state change with debouncing
-            if (pressed != buttons[i].last_state) {
-                vTaskDelay(pdMS_TO_TICKS(buttons[i].config.debounce_time_ms));
-                level = gpio_get_level(buttons[i].config.pin);
-                pressed = buttons[i].config.active_low ? (level == 0) : (level == 1);
-
-                if (pressed != buttons[i].last_state) {
-                    buttons[i].current_state = pressed;
-                    buttons[i].last_state = pressed;
-
-                    if (pressed) {
-                        // Button pressed
-                        buttons[i].press_time = now;
-                        buttons[i].long_press_triggered = false;
-                        if (event_callback) {
-                            event_callback(buttons[i].id, BUTTON_EVENT_PRESSED);
-                        }
-                    } else {
-                        // Button released
-                        buttons[i].release_time = now;
-                        uint32_t press_duration = now - buttons[i].press_time;
-
-                        if (event_callback) {
-                            event_callback(buttons[i].id, BUTTON_EVENT_RELEASED);
-
-                            if (!buttons[i].long_press_triggered) {
-                                if (press_duration < buttons[i].config.long_press_time_ms) {
-                                    // Click event
-                                    buttons[i].click_count++;
-                                    
-                                    // Wait to see if double click
-                                    vTaskDelay(pdMS_TO_TICKS(DOUBLE_CLICK_TIME_MS));
-                                    
-                                    if (buttons[i].click_count == 1) {
-                                        event_callback(buttons[i].id, BUTTON_EVENT_CLICK);
-                                    } else if (buttons[i].click_count >= 2) {
-                                        event_callback(buttons[i].id, BUTTON_EVENT_DOUBLE_CLICK);
-                                    }
-                                    buttons[i].click_count = 0;
-                                }
-                            }
-                        }
-                    }
+            case BUTTON_MSG_DEBOUNCE: {
+                // Re-arm first so an edge right after sampling is not lost
+                btn->debouncing = false;
+                bool pressed = read_pressed(btn);
+                if (pressed != btn->current_state) {
+                    handle_transition(btn, pressed);
                 }
+                break;
             }
 
-            // Check for long press
-            if (buttons[i].current_state && !buttons[i].long_press_triggered) {
-                uint32_t press_duration = now - buttons[i].press_time;
-                if (press_duration >= buttons[i].config.long_press_time_ms) {
-                    buttons[i].long_press_triggered = true;
-                    if (event_callback) {
-                        event_callback(buttons[i].id, BUTTON_EVENT_LONG_PRESS);
-                    }
+            case BUTTON_MSG_LONG_PRESS:
+                if (btn->current_state && !btn->long_press_triggered) {
+                    btn->long_press_triggered = true;
+                    btn->click_count = 0;
+                    esp_timer_stop(btn->click_timer);
+                    emit(btn, BUTTON_EVENT_LONG_PRESS);
                 }
-            }
+                break;
 
-            // Reset double-click counter if timeout
-            if (buttons[i].click_count > 0 && 
-                (now - buttons[i].release_time) > DOUBLE_CLICK_TIME_MS) {
-                buttons[i].click_count = 0;
-            }
+            case BUTTON_MSG_CLICK_TIMEOUT:
+                if (btn->click_count == 1) {
+                    emit(btn, BUTTON_EVENT_CLICK);
+                }
+                btn->click_count = 0;
+                break;
+
+            default:
+                break;
         }
+    }
+}
 
-        vTaskDelay(pdMS_TO_TICKS(10)); // Poll every 10ms
+/**
+ * Create the timers of a button
+ */
+static esp_err_t create_button_timers(button_state_t *btn)
+{
+    esp_timer_create_args_t args = {
+        .arg = btn,
+        .name = "btn_debounce",
+        .callback = &debounce_timer_callback
+    };
+    esp_err_t ret = esp_timer_create(&args, &btn->debounce_timer);
+
+    if (ret == ESP_OK) {
+        args.name = "btn_long";
+        args.callback = &long_press_timer_callback;
+        ret = esp_timer_create(&args, &btn->long_press_timer);
+    }
+    if (ret == ESP_OK) {
+        args.name = "btn_click";
+        args.callback = &click_timer_callback;
+        ret = esp_timer_create(&args, &btn->click_timer);
+    }
+    return ret;
+}
+
+/**
+ * Delete the timers of a button
+ */
+static void delete_button_timers(button_state_t *btn)
+{
+    esp_timer_handle_t *timers[] = { &btn->debounce_timer, &btn->long_press_timer, &btn->click_timer };
+    for (size_t t = 0; t < sizeof(timers) / sizeof(timers[0]); t++) {
+        if (*timers[t]) {
+            esp_timer_stop(*timers[t]);
+            esp_timer_delete(*timers[t]);
+            *timers[t] = NULL;
+        }
     }
 }
 
@@ -140,6 +279,26 @@ esp_err_t button_handler_init(const button_config_t *button_configs, uint8_t num
 
     ESP_LOGI(TAG, "Initializing button handler with %d buttons...", num_buttons);
 
+    button_queue = xQueueCreate(BUTTON_QUEUE_LEN, sizeof(button_msg_t));
+    if (!button_queue) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Other modules may have installed the shared ISR service already
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "Failed to install GPIO ISR service: %s", esp_err_to_name(ret));
+        vQueueDelete(button_queue);
+        button_queue = NULL;
+        return ret;
+    }
+    isr_service_installed = (ret == ESP_OK);
+
+    if (!m_latency_us) {
+        m_latency_us = metrics_register_gauge("laser_button_latency_max_us",
+                                              "Longest time from button edge to event", NULL);
+    }
+
     num_buttons_active = num_buttons;
     event_callback = callback;
 
@@ -151,31 +310,44 @@ esp_err_t button_handler_init(const button_config_t *button_configs, uint8_t num
             continue;
         }
 
-        buttons[i].config = button_configs[i];
-        buttons[i].id = i;
-        buttons[i].current_state = false;
-        buttons[i].last_state = false;
-        buttons[i].press_time = 0;
-        buttons[i].release_time = 0;
-        buttons[i].long_press_triggered = false;
-        buttons[i].click_count = 0;
+        button_state_t *btn = &buttons[i];
+        btn->config = button_configs[i];
+        btn->id = i;
+        btn->debouncing = false;
+        btn->edge_us = 0;
+        btn->event_us = 0;
+        btn->long_press_triggered = false;
+        btn->click_count = 0;
+
+        ret = create_button_timers(btn);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Button %d: timer create failed: %s", i, esp_err_to_name(ret));
+            button_handler_deinit();
+            return ret;
+        }
 
         // Configure GPIO
         gpio_config_t io_conf = {
-            .intr_type = GPIO_INTR_DISABLE,
+            .intr_type = GPIO_INTR_ANYEDGE,
             .mode = GPIO_MODE_INPUT,
             .pin_bit_mask = (1ULL << button_configs[i].pin),
             .pull_down_en = GPIO_PULLDOWN_DISABLE,
             .pull_up_en = button_configs[i].pull_up ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE
         };
         gpio_config(&io_conf);
+        btn->current_state = read_pressed(btn);
+        gpio_isr_handler_add(btn->config.pin, button_isr_handler, btn);
 
         ESP_LOGI(TAG, "Button %d configured on GPIO %d", i, button_configs[i].pin);
     }
 
-    // Create button polling task
-    xTaskCreate(button_task, "button_task", BUTTON_TASK_STACK_SIZE, NULL,
-                BUTTON_TASK_PRIORITY, &button_task_handle);
+    // Create button task (sleeps until an edge or timer wakes it)
+    if (xTaskCreate(button_task, "button_task", BUTTON_TASK_STACK_SIZE, NULL,
+                    BUTTON_TASK_PRIORITY, &button_task_handle) != pdPASS) {
+        is_initialized = true;
+        button_handler_deinit();
+        return ESP_ERR_NO_MEM;
+    }
 
     is_initialized = true;
     ESP_LOGI(TAG, "Button handler initialized");
@@ -187,17 +359,35 @@ esp_err_t button_handler_init(const button_config_t *button_configs, uint8_t num
  */
 esp_err_t button_handler_deinit(void)
 {
-    if (!is_initialized) {
+    if (!is_initialized && !button_queue) {
         return ESP_OK;
     }
 
     ESP_LOGI(TAG, "Deinitializing button handler...");
 
+    for (uint8_t i = 0; i < num_buttons_active; i++) {
+        if (buttons[i].config.pin != -1) {
+            gpio_isr_handler_remove(buttons[i].config.pin);
+            gpio_set_intr_type(buttons[i].config.pin, GPIO_INTR_DISABLE);
+        }
+        delete_button_timers(&buttons[i]);
+    }
+
     if (button_task_handle) {
         vTaskDelete(button_task_handle);
         button_task_handle = NULL;
     }
 
+    if (button_queue) {
+        vQueueDelete(button_queue);
+        button_queue = NULL;
+    }
+
+    if (isr_service_installed) {
+        gpio_uninstall_isr_service();
+        isr_service_installed = false;
+    }
+
     num_buttons_active = 0;
     event_callback = NULL;
     is_initialized = false;
@@ -221,3 +411,20 @@ esp_err_t button_get_state(uint8_t button_id, bool *pressed)
     *pressed = buttons[button_id].current_state;
     return ESP_OK;
 }
+
+/**
+ * Get the edge time of the last press or release
+ */
+esp_err_t button_get_event_time(uint8_t button_id, int64_t *time_us)
+{
+    if (!is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (button_id >= num_buttons_active || !time_us) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *time_us = buttons[button_id].event_us;
+    return ESP_OK;
+}
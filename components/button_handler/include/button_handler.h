@@ -78,6 +78,18 @@ esp_err_t button_handler_deinit(void);
  */
 esp_err_t button_get_state(uint8_t button_id, bool *pressed);
 
+/**
+ * Get the time of the last press or release
+ * 
+ * Taken in the GPIO interrupt at the first edge, before debouncing, so
+ * it can be read from the callback to timestamp the event precisely.
+ * 
+ * @param button_id Button identifier (0-3)
+ * @param time_us Pointer to store the esp_timer time of the edge
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t button_get_event_time(uint8_t button_id, int64_t *time_us);
+
 #ifdef __cplusplus
 }
 #endif
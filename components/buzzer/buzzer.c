@@ -3,6 +3,11 @@
  * 
  * PWM-based buzzer/speaker control for audio feedback.
  * 
+ * Patterns are note tables in flash, played by an esp_timer callback that
+ * changes the LEDC frequency at each note boundary, so callers never
+ * wait for a melody. A pattern of higher priority preempts the playing
+ * one, others wait in a small queue ordered by priority.
+ * 
  * @author ninharp
  * @date 2025
  */
@@ -10,6 +15,7 @@
 #include "buzzer.h"
 #include "driver/ledc.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
@@ -21,10 +27,185 @@ static const char *TAG = "BUZZER";
 #define BUZZER_LEDC_DUTY_RES       LEDC_TIMER_10_BIT
 #define BUZZER_MAX_DUTY            ((1 << BUZZER_LEDC_DUTY_RES) - 1)
 
+#define BUZZER_QUEUE_LEN           4
+#define BUZZER_TONE_PRIORITY       UINT8_MAX   // buzzer_play_tone() preempts any pattern
+
+/**
+ * Note of a pattern (frequency 0 = rest)
+ */
+typedef struct {
+    uint16_t freq_hz;
+    uint16_t duration_ms;
+} buzzer_note_t;
+
+/**
+ * Pattern table entry
+ */
+typedef struct {
+    const buzzer_note_t *notes;
+    uint8_t count;
+    uint8_t priority;           // Higher preempts lower
+} buzzer_seq_t;
+
+static const buzzer_note_t notes_beep[] = {
+    {BUZZER_NOTE_A4, 100},
+};
+static const buzzer_note_t notes_double_beep[] = {
+    {BUZZER_NOTE_A4, 100}, {0, 100}, {BUZZER_NOTE_A4, 100},
+};
+static const buzzer_note_t notes_success[] = {
+    {BUZZER_NOTE_C4, 150}, {BUZZER_NOTE_E4, 150}, {BUZZER_NOTE_G4, 200},
+};
+static const buzzer_note_t notes_error[] = {
+    {BUZZER_NOTE_C4, 300}, {0, 50}, {BUZZER_NOTE_C4, 300},
+};
+static const buzzer_note_t notes_countdown[] = {
+    {BUZZER_NOTE_C4, 100},
+};
+static const buzzer_note_t notes_game_start[] = {
+    {BUZZER_NOTE_E4, 100}, {BUZZER_NOTE_G4, 100}, {BUZZER_NOTE_C5, 200},
+};
+static const buzzer_note_t notes_game_end[] = {
+    {BUZZER_NOTE_C5, 150}, {BUZZER_NOTE_A4, 150}, {BUZZER_NOTE_F4, 200},
+};
+
+#define SEQ(notes, prio) { notes, sizeof(notes) / sizeof(notes[0]), prio }
+
+static const buzzer_seq_t patterns[] = {
+    [BUZZER_PATTERN_BEEP]        = SEQ(notes_beep, 0),
+    [BUZZER_PATTERN_DOUBLE_BEEP] = SEQ(notes_double_beep, 0),
+    [BUZZER_PATTERN_SUCCESS]     = SEQ(notes_success, 1),
+    [BUZZER_PATTERN_ERROR]       = SEQ(notes_error, 2),
+    [BUZZER_PATTERN_COUNTDOWN]   = SEQ(notes_countdown, 2),
+    [BUZZER_PATTERN_GAME_START]  = SEQ(notes_game_start, 3),
+    [BUZZER_PATTERN_GAME_END]    = SEQ(notes_game_end, 3),
+};
+
 static gpio_num_t buzzer_pin = -1;
 static bool is_initialized = false;
 static uint8_t current_volume = 50; // 0-100%
 
+// Sequencer state, shared between callers and the timer callback (seq_lock)
+static portMUX_TYPE seq_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t seq_timer = NULL;
+static const buzzer_seq_t *seq_current = NULL;  // Playing pattern, NULL when idle
+static uint8_t seq_note = 0;                    // Next note of seq_current
+static const buzzer_seq_t *seq_queue[BUZZER_QUEUE_LEN];    // Highest priority first
+static uint8_t seq_queued = 0;
+static buzzer_note_t tone_note;                 // Single note of buzzer_play_tone()
+static buzzer_seq_t tone_seq = { &tone_note, 1, BUZZER_TONE_PRIORITY };
+
+/**
+ * Output a frequency (0 = silence)
+ */
+static esp_err_t set_output(uint32_t frequency)
+{
+    if (frequency == 0) {
+        ledc_set_duty(BUZZER_LEDC_MODE, BUZZER_LEDC_CHANNEL, 0);
+        return ledc_update_duty(BUZZER_LEDC_MODE, BUZZER_LEDC_CHANNEL);
+    }
+
+    esp_err_t ret = ledc_set_freq(BUZZER_LEDC_MODE, BUZZER_LEDC_TIMER, frequency);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set frequency: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // Set duty cycle based on volume (50% duty for square wave)
+    uint32_t duty = (BUZZER_MAX_DUTY * current_volume * 50) / (100 * 100);
+    ledc_set_duty(BUZZER_LEDC_MODE, BUZZER_LEDC_CHANNEL, duty);
+    return ledc_update_duty(BUZZER_LEDC_MODE, BUZZER_LEDC_CHANNEL);
+}
+
+/**
+ * Sequencer step (esp_timer task) - plays the next note
+ * 
+ * Moves on to the next queued pattern at the end of one and arms the
+ * timer for the duration of the note.
+ */
+static void seq_timer_callback(void *arg)
+{
+    buzzer_note_t note = {0, 0};
+
+    taskENTER_CRITICAL(&seq_lock);
+    if (seq_current && seq_note >= seq_current->count) {
+        seq_current = NULL;
+    }
+    if (!seq_current && seq_queued > 0) {
+        seq_current = seq_queue[0];
+        seq_note = 0;
+        seq_queued--;
+        for (int i = 0; i < seq_queued; i++) {
+            seq_queue[i] = seq_queue[i + 1];
+        }
+    }
+    if (seq_current) {
+        note = seq_current->notes[seq_note++];
+    }
+    taskEXIT_CRITICAL(&seq_lock);
+
+    set_output(note.freq_hz);
+    if (note.duration_ms > 0) {
+        esp_timer_start_once(seq_timer, (uint64_t)note.duration_ms * 1000);
+    }
+}
+
+/**
+ * Run the sequencer step now (preemption or start from idle)
+ */
+static void seq_kick(void)
+{
+    // The callback may re-arm the timer between stop and start, then try again
+    for (int i = 0; i < 2; i++) {
+        esp_timer_stop(seq_timer);
+        if (esp_timer_start_once(seq_timer, 0) == ESP_OK) {
+            break;
+        }
+    }
+}
+
+/**
+ * Start a pattern now or queue it behind the playing one
+ * 
+ * @return ESP_ERR_NO_MEM if the queue is full of patterns of equal or higher priority
+ */
+static esp_err_t seq_submit(const buzzer_seq_t *seq)
+{
+    bool kick = false;
+    esp_err_t ret = ESP_OK;
+
+    taskENTER_CRITICAL(&seq_lock);
+    if (!seq_current || seq->priority > seq_current->priority) {
+        // Preempt, the interrupted pattern is dropped
+        seq_current = seq;
+        seq_note = 0;
+        kick = true;
+    } else {
+        // Insert behind patterns of the same or higher priority, the lowest falls out when full
+        int pos = 0;
+        while (pos < seq_queued && seq_queue[pos]->priority >= seq->priority) {
+            pos++;
+        }
+        if (pos >= BUZZER_QUEUE_LEN) {
+            ret = ESP_ERR_NO_MEM;
+        } else {
+            if (seq_queued < BUZZER_QUEUE_LEN) {
+                seq_queued++;
+            }
+            for (int i = seq_queued - 1; i > pos; i--) {
+                seq_queue[i] = seq_queue[i - 1];
+            }
+            seq_queue[pos] = seq;
+        }
+    }
+    taskEXIT_CRITICAL(&seq_lock);
+
+    if (kick) {
+        seq_kick();
+    }
+    return ret;
+}
+
 /**
  * Initialize buzzer
  */
@@ -74,6 +255,16 @@ esp_err_t buzzer_init(gpio_num_t pin)
         return ret;
     }
 
+    const esp_timer_create_args_t seq_timer_args = {
+        .callback = &seq_timer_callback,
+        .name = "buzzer_seq"
+    };
+    ret = esp_timer_create(&seq_timer_args, &seq_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create sequencer timer: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
     is_initialized = true;
     ESP_LOGI(TAG, "Buzzer initialized");
     return ESP_OK;
@@ -92,6 +283,8 @@ esp_err_t buzzer_deinit(void)
     buzzer_stop();
     
     ledc_stop(BUZZER_LEDC_MODE, BUZZER_LEDC_CHANNEL, 0);
+    esp_timer_delete(seq_timer);
+    seq_timer = NULL;
     
     is_initialized = false;
     buzzer_pin = -1;
@@ -113,25 +306,21 @@ esp_err_t buzzer_play_tone(uint32_t frequency, uint32_t duration_ms)
 
     ESP_LOGD(TAG, "Playing tone: %lu Hz for %lu ms", frequency, duration_ms);
 
-    // Set frequency
-    esp_err_t ret = ledc_set_freq(BUZZER_LEDC_MODE, BUZZER_LEDC_TIMER, frequency);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set frequency: %s", esp_err_to_name(ret));
-        return ret;
+    if (duration_ms == 0) {
+        // Continuous, until buzzer_stop() or the next pattern
+        buzzer_stop();
+        return set_output(frequency);
     }
 
-    // Set duty cycle based on volume (50% duty for square wave)
-    uint32_t duty = (BUZZER_MAX_DUTY * current_volume * 50) / (100 * 100);
-    ledc_set_duty(BUZZER_LEDC_MODE, BUZZER_LEDC_CHANNEL, duty);
-    ledc_update_duty(BUZZER_LEDC_MODE, BUZZER_LEDC_CHANNEL);
-
-    // If duration specified, stop after duration
-    if (duration_ms > 0) {
-        vTaskDelay(pdMS_TO_TICKS(duration_ms));
-        buzzer_stop();
+    taskENTER_CRITICAL(&seq_lock);
+    tone_note.freq_hz = frequency > UINT16_MAX ? UINT16_MAX : frequency;
+    tone_note.duration_ms = duration_ms > UINT16_MAX ? UINT16_MAX : duration_ms;
+    if (seq_current == &tone_seq) {
+        seq_current = NULL;     // Restart with the new note
     }
+    taskEXIT_CRITICAL(&seq_lock);
 
-    return ESP_OK;
+    return seq_submit(&tone_seq);
 }
 
 /**
@@ -143,50 +332,23 @@ esp_err_t buzzer_play_pattern(buzzer_pattern_t pattern)
         return ESP_ERR_INVALID_STATE;
     }
 
-    switch (pattern) {
-        case BUZZER_PATTERN_BEEP:
-            buzzer_play_tone(BUZZER_NOTE_A4, 100);
-            break;
-
-        case BUZZER_PATTERN_DOUBLE_BEEP:
-            buzzer_play_tone(BUZZER_NOTE_A4, 100);
-            vTaskDelay(pdMS_TO_TICKS(100));
-            buzzer_play_tone(BUZZER_NOTE_A4, 100);
-            break;
-
-        case BUZZER_PATTERN_SUCCESS:
-            buzzer_play_tone(BUZZER_NOTE_C4, 150);
-            buzzer_play_tone(BUZZER_NOTE_E4, 150);
-            buzzer_play_tone(BUZZER_NOTE_G4, 200);
-            break;
-
-        case BUZZER_PATTERN_ERROR:
-            buzzer_play_tone(BUZZER_NOTE_C4, 300);
-            vTaskDelay(pdMS_TO_TICKS(50));
-            buzzer_play_tone(BUZZER_NOTE_C4, 300);
-            break;
-
-        case BUZZER_PATTERN_COUNTDOWN:
-            buzzer_play_tone(BUZZER_NOTE_C4, 100);
-            break;
-
-        case BUZZER_PATTERN_GAME_START:
-            buzzer_play_tone(BUZZER_NOTE_E4, 100);
-            buzzer_play_tone(BUZZER_NOTE_G4, 100);
-            buzzer_play_tone(BUZZER_NOTE_C5, 200);
-            break;
-
-        case BUZZER_PATTERN_GAME_END:
-            buzzer_play_tone(BUZZER_NOTE_C5, 150);
-            buzzer_play_tone(BUZZER_NOTE_A4, 150);
-            buzzer_play_tone(BUZZER_NOTE_F4, 200);
-            break;
-
-        default:
-            return ESP_ERR_INVALID_ARG;
+    if ((unsigned)pattern >= sizeof(patterns) / sizeof(patterns[0])) {
+        return ESP_ERR_INVALID_ARG;
     }
 
-    return ESP_OK;
+    ESP_LOGD(TAG, "Playing pattern %d", pattern);
+    return seq_submit(&patterns[pattern]);
+}
+
+/**
+ * Check if a pattern or tone is playing or queued
+ */
+bool buzzer_is_busy(void)
+{
+    taskENTER_CRITICAL(&seq_lock);
+    bool busy = seq_current != NULL || seq_queued > 0;
+    taskEXIT_CRITICAL(&seq_lock);
+    return busy;
 }
 
 /**
@@ -198,10 +360,13 @@ esp_err_t buzzer_stop(void)
         return ESP_ERR_INVALID_STATE;
     }
 
-    ledc_set_duty(BUZZER_LEDC_MODE, BUZZER_LEDC_CHANNEL, 0);
-    ledc_update_duty(BUZZER_LEDC_MODE, BUZZER_LEDC_CHANNEL);
+    taskENTER_CRITICAL(&seq_lock);
+    seq_current = NULL;
+    seq_queued = 0;
+    taskEXIT_CRITICAL(&seq_lock);
+    esp_timer_stop(seq_timer);
 
-    return ESP_OK;
+    return set_output(0);
 }
 
 /**
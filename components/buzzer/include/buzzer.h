@@ -2,6 +2,8 @@
  * Buzzer Component - Header
  * 
  * PWM-based buzzer/speaker control for audio feedback.
+ * Tones and patterns play in the background (esp_timer driven), none of
+ * the functions wait for the sound to finish.
  * 
  * @author ninharp
  * @date 2025
@@ -62,6 +64,8 @@ esp_err_t buzzer_deinit(void);
 /**
  * Play tone at specific frequency
  * 
+ * Returns immediately; a tone with duration preempts any pattern.
+ * 
  * @param frequency Frequency in Hz (0 to stop)
  * @param duration_ms Duration in milliseconds (0 for continuous)
  * @return ESP_OK on success, error code otherwise
@@ -71,11 +75,23 @@ esp_err_t buzzer_play_tone(uint32_t frequency, uint32_t duration_ms);
 /**
  * Play predefined pattern
  * 
+ * Returns immediately. A pattern of higher priority (game start/end >
+ * error/countdown > success > beeps) interrupts the playing one, others
+ * are queued and played in priority order.
+ * 
  * @param pattern Pattern to play
- * @return ESP_OK on success, error code otherwise
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the queue is full,
+ *         error code otherwise
  */
 esp_err_t buzzer_play_pattern(buzzer_pattern_t pattern);
 
+/**
+ * Check if a pattern or tone is playing or queued
+ * 
+ * @return true while the buzzer is busy
+ */
+bool buzzer_is_busy(void);
+
 /**
  * Stop buzzer
  * 
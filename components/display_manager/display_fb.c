@@ -0,0 +1,432 @@
+/**
+ * Display Framebuffer - Implementation
+ *
+ * Back, front and shadow buffers with per-page dirty spans, shared by all
+ * panel drivers. Buffers are sized for the largest panel; rows are
+ * `width` bytes long, so a 128x32 panel only uses the first 4 rows.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#include "display_fb.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "metrics.h"
+#include <string.h>
+
+static const char *TAG = "DISPLAY_FB";
+
+#define FB_SIZE (DISPLAY_MAX_WIDTH * DISPLAY_MAX_PAGES)
+#define WAIT_IDLE_TIMEOUT_MS 100
+
+static const display_driver_t *driver = NULL;
+static uint8_t width = 0;
+static uint8_t pages = 0;
+
+static uint8_t framebuffer[FB_SIZE];    // Back buffer, drawn by producers
+static uint8_t front[FB_SIZE];          // Last completed frame, read by flush
+static uint8_t shadow[FB_SIZE];         // Last content handed to the driver
+
+// Dirty column span per page [min, max]; empty when min > max
+static uint8_t dirty_min[DISPLAY_MAX_PAGES];    // Back buffer changes since last present
+static uint8_t dirty_max[DISPLAY_MAX_PAGES];
+static uint8_t front_min[DISPLAY_MAX_PAGES];    // Front buffer changes since last flush
+static uint8_t front_max[DISPLAY_MAX_PAGES];
+static SemaphoreHandle_t front_mutex = NULL;
+static bool force_full_update = true;   // Panel RAM content is unknown after init
+
+// Bus statistics
+static display_stats_t stats = {0};
+static uint32_t window_bytes = 0;
+static int64_t window_start_us = 0;
+static metric_t *m_bus_bytes = NULL;
+static metric_t *m_bytes_per_sec = NULL;
+
+/**
+ * Mark a column span of a page as dirty
+ */
+static inline void mark_dirty(uint8_t page, uint8_t x0, uint8_t x1)
+{
+    if (x0 < dirty_min[page]) dirty_min[page] = x0;
+    if (x1 > dirty_max[page]) dirty_max[page] = x1;
+}
+
+/**
+ * Reset all dirty spans to empty
+ */
+static void clear_dirty(uint8_t *span_min, uint8_t *span_max)
+{
+    memset(span_min, 0xFF, DISPLAY_MAX_PAGES);
+    memset(span_max, 0x00, DISPLAY_MAX_PAGES);
+}
+
+/**
+ * Account bytes put on the display bus
+ */
+void display_fb_count_bus_bytes(size_t len)
+{
+    stats.total_bytes += len;
+    window_bytes += len;
+    metrics_add(m_bus_bytes, (int32_t)len);
+}
+
+/**
+ * Roll the bytes-per-second window
+ */
+static void update_rate_window(void)
+{
+    int64_t now = esp_timer_get_time();
+    if (now - window_start_us >= 1000000) {
+        stats.bytes_per_sec = (uint32_t)((uint64_t)window_bytes * 1000000 / (now - window_start_us));
+        metrics_set(m_bytes_per_sec, (int32_t)stats.bytes_per_sec);
+        window_bytes = 0;
+        window_start_us = now;
+    }
+}
+
+/**
+ * Initialize the panel and the framebuffer
+ */
+esp_err_t display_fb_init(const display_driver_t *drv, const display_config_t *config)
+{
+    if (!drv || !config || drv->width > DISPLAY_MAX_WIDTH || drv->pages > DISPLAY_MAX_PAGES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!front_mutex) {
+        front_mutex = xSemaphoreCreateMutex();
+        if (!front_mutex) {
+            ESP_LOGE(TAG, "Failed to create front buffer mutex");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    if (!m_bus_bytes) {
+        m_bus_bytes = metrics_register_counter("laser_display_i2c_bytes_total", "Bytes sent to the display over I2C", NULL);
+        m_bytes_per_sec = metrics_register_gauge("laser_display_i2c_bytes_per_sec", "Display I2C bytes sent in the last second", NULL);
+    }
+
+    esp_err_t ret = drv->init(config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    driver = drv;
+    width = drv->width;
+    pages = drv->pages;
+
+    memset(framebuffer, 0, sizeof(framebuffer));
+    memset(front, 0, sizeof(front));
+    clear_dirty(dirty_min, dirty_max);
+    clear_dirty(front_min, front_max);
+    force_full_update = true;
+    window_start_us = esp_timer_get_time();
+
+    ESP_LOGI(TAG, "Display %s ready (%dx%d)", drv->name, width, pages * 8);
+    return ESP_OK;
+}
+
+/**
+ * Visible width in columns
+ */
+uint8_t display_fb_width(void)
+{
+    return width;
+}
+
+/**
+ * Visible height in pages
+ */
+uint8_t display_fb_pages(void)
+{
+    return pages;
+}
+
+/**
+ * Clear the framebuffer
+ */
+esp_err_t display_fb_clear(void)
+{
+    if (!driver) {
+        return ESP_FAIL;
+    }
+
+    memset(framebuffer, 0, sizeof(framebuffer));
+    for (int p = 0; p < pages; p++) {
+        mark_dirty(p, 0, width - 1);
+    }
+    return ESP_OK;
+}
+
+/**
+ * Publish the back buffer as the next frame to flush
+ */
+esp_err_t display_fb_present(void)
+{
+    if (!driver) {
+        return ESP_FAIL;
+    }
+
+    // Only the dirty spans differ between back and front buffer
+    xSemaphoreTake(front_mutex, portMAX_DELAY);
+    for (uint8_t page = 0; page < pages; page++) {
+        uint8_t x0 = dirty_min[page];
+        uint8_t x1 = dirty_max[page];
+        if (x0 > x1) {
+            continue;
+        }
+        memcpy(&front[page * width + x0], &framebuffer[page * width + x0], x1 - x0 + 1);
+        if (x0 < front_min[page]) front_min[page] = x0;
+        if (x1 > front_max[page]) front_max[page] = x1;
+    }
+    xSemaphoreGive(front_mutex);
+
+    clear_dirty(dirty_min, dirty_max);
+    return ESP_OK;
+}
+
+/**
+ * Wait until queued display transfers are on the panel
+ */
+esp_err_t display_fb_wait_idle(uint32_t timeout_ms)
+{
+    if (!driver || !driver->wait_idle) {
+        return ESP_OK;
+    }
+
+    esp_err_t ret = driver->wait_idle(timeout_ms);
+    if (ret != ESP_OK) {
+        // Shadow was updated optimistically when the frame was queued
+        force_full_update = true;
+    }
+    return ret;
+}
+
+/**
+ * Send changed regions of the front buffer to the panel
+ *
+ * Dirty spans are trimmed against the shadow copy of the panel RAM and
+ * copied into the shadow while holding the front buffer, so presenting
+ * the next frame only waits for a memcpy, never for the bus. The driver
+ * then stages and sends the trimmed spans from the shadow.
+ */
+esp_err_t display_fb_flush(void)
+{
+    if (!driver) {
+        return ESP_FAIL;
+    }
+
+    // The driver's staging buffer may still be in use by the previous flush
+    esp_err_t ret = display_fb_wait_idle(WAIT_IDLE_TIMEOUT_MS);
+    if (ret != ESP_OK) {
+        ESP_LOGD(TAG, "Previous flush failed (%s), resending full frame", esp_err_to_name(ret));
+    }
+
+    uint8_t span_x0[DISPLAY_MAX_PAGES];
+    uint8_t span_x1[DISPLAY_MAX_PAGES];
+    uint8_t changed_pages = 0;
+
+    xSemaphoreTake(front_mutex, portMAX_DELAY);
+
+    for (uint8_t page = 0; page < pages; page++) {
+        uint8_t x0 = force_full_update ? 0 : front_min[page];
+        uint8_t x1 = force_full_update ? width - 1 : front_max[page];
+        const uint8_t *fb = &front[page * width];
+        uint8_t *sh = &shadow[page * width];
+
+        if (x0 <= x1 && !force_full_update) {
+            // Trim the span to columns that differ from what the panel shows
+            while (x0 <= x1 && fb[x0] == sh[x0]) x0++;
+            while (x1 > x0 && fb[x1] == sh[x1]) x1--;
+        }
+
+        span_x0[page] = x0;
+        span_x1[page] = x1;
+        if (x0 > x1) {
+            continue;  // Nothing changed on this page
+        }
+
+        memcpy(&sh[x0], &fb[x0], x1 - x0 + 1);
+        changed_pages++;
+    }
+
+    // Everything needed is in the shadow, producers may present the next frame
+    clear_dirty(front_min, front_max);
+    force_full_update = false;
+    xSemaphoreGive(front_mutex);
+
+    if (changed_pages == 0) {
+        stats.frames_skipped++;
+        update_rate_window();
+        return ESP_OK;
+    }
+
+    ret = driver->flush(shadow, span_x0, span_x1);
+    if (ret == ESP_OK) {
+        stats.frames_sent++;
+        stats.pages_sent += changed_pages;
+    } else {
+        // Trimmed spans are gone from the dirty tracking, resend everything
+        force_full_update = true;
+    }
+
+    update_rate_window();
+    return ret;
+}
+
+/**
+ * Present the back buffer and send it to the panel
+ */
+esp_err_t display_fb_update(void)
+{
+    esp_err_t ret = display_fb_present();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return display_fb_flush();
+}
+
+/**
+ * Get display bus statistics
+ */
+esp_err_t display_fb_get_stats(display_stats_t *out)
+{
+    if (!out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out = stats;
+    return ESP_OK;
+}
+
+/**
+ * Draw a glyph from a font atlas
+ */
+uint8_t display_fb_draw_glyph(uint8_t x, uint8_t page, const font_atlas_t *font, char c, bool overlay)
+{
+    if (!driver || !font || x >= width || page >= pages) return 0;
+
+    const font_glyph_t *glyph = font_get_glyph(font, c);
+    if (!glyph) return 0;
+
+    // Clip glyph and trailing spacing at the right edge
+    uint8_t room = width - x;
+    uint8_t cols = (glyph->width < room) ? glyph->width : room;
+    uint8_t gap = (font->spacing < room - cols) ? font->spacing : room - cols;
+
+    const uint8_t *src = &font->bitmap[glyph->offset];
+    for (uint8_t p = 0; p < font->pages && page + p < pages; p++, src += glyph->width) {
+        uint8_t *dst = &framebuffer[(page + p) * width + x];
+        if (overlay) {
+            for (uint8_t i = 0; i < cols; i++) {
+                dst[i] |= src[i];
+            }
+        } else {
+            memcpy(dst, src, cols);
+            memset(dst + cols, 0, gap);
+        }
+        if (cols + gap > 0) {
+            mark_dirty(page + p, x, x + cols + gap - 1);
+        }
+    }
+
+    return glyph->width + font->spacing;
+}
+
+/**
+ * Draw a string with a font atlas
+ */
+uint8_t display_fb_draw_text(uint8_t x, uint8_t page, const font_atlas_t *font, const char *str, bool overlay)
+{
+    if (!driver || !font || !str) return x;
+
+    uint16_t pos = x;
+    while (*str && pos < width) {
+        pos += display_fb_draw_glyph(pos, page, font, *str, overlay);
+        str++;
+    }
+    return (pos < width) ? pos : width;
+}
+
+/**
+ * Draw a string with the 5x7 font
+ */
+void display_fb_draw_string(uint8_t x, uint8_t page, const char *str)
+{
+    display_fb_draw_text(x, page, &font_5x7, str, false);
+}
+
+/**
+ * Draw a horizontal line
+ */
+void display_fb_draw_hline(uint8_t page, uint8_t pattern)
+{
+    if (!driver || page >= pages) return;
+
+    memset(&framebuffer[page * width], pattern, width);
+    mark_dirty(page, 0, width - 1);
+}
+
+/**
+ * Fill a column span of a page with a byte pattern
+ */
+void display_fb_fill_area(uint8_t x0, uint8_t x1, uint8_t page, uint8_t pattern)
+{
+    if (!driver || page >= pages || x0 >= width) return;
+    if (x1 >= width) x1 = width - 1;
+    if (x0 > x1) return;
+
+    memset(&framebuffer[page * width + x0], pattern, x1 - x0 + 1);
+    mark_dirty(page, x0, x1);
+}
+
+/**
+ * Set panel contrast
+ */
+esp_err_t display_fb_set_contrast(uint8_t contrast)
+{
+    if (!driver) {
+        return ESP_FAIL;
+    }
+    return driver->set_contrast(contrast);
+}
+
+/**
+ * Turn panel on/off
+ */
+esp_err_t display_fb_set_power(bool on)
+{
+    if (!driver) {
+        return ESP_FAIL;
+    }
+    return driver->set_power(on);
+}
+
+/**
+ * Get direct access to framebuffer
+ */
+uint8_t* display_fb_get_framebuffer(void)
+{
+    if (!driver) {
+        return NULL;
+    }
+
+    // Caller may write anywhere; the shadow compare in display_fb_flush keeps this cheap
+    for (int p = 0; p < pages; p++) {
+        mark_dirty(p, 0, width - 1);
+    }
+    return framebuffer;
+}
+
+/**
+ * Mark a framebuffer region as modified
+ */
+void display_fb_mark_dirty(uint8_t x0, uint8_t x1, uint8_t page)
+{
+    if (page >= pages || x0 >= width) return;
+    if (x1 >= width) x1 = width - 1;
+    if (x0 > x1) return;
+    mark_dirty(page, x0, x1);
+}
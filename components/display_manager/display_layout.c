@@ -0,0 +1,244 @@
+/**
+ * Display Layout - Implementation
+ *
+ * Retained-mode rendering of widget tables. Only the layout pointer on
+ * screen is tracked; widgets carry their own changed flag, so a frame
+ * with no changed widget costs a loop over the table and nothing else.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#include "display_layout.h"
+#include "display_manager.h"
+#include "display_fb.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef CONFIG_ENABLE_DISPLAY
+
+static const char *TAG = "DISPLAY_LAYOUT";
+
+// Progress bar columns (bits 2..5 of a page)
+#define PROGRESS_EDGE    0x3C
+#define PROGRESS_FILLED  0x3C
+#define PROGRESS_EMPTY   0x24
+
+static display_layout_t *active_layout = NULL;
+
+/**
+ * Width of the area owned by a widget
+ */
+static uint8_t widget_width(const display_widget_t *widget)
+{
+    uint8_t display_width = display_fb_width();
+    if (widget->x >= display_width) {
+        return 0;
+    }
+    if (widget->width == 0 || widget->x + widget->width > display_width) {
+        return display_width - widget->x;
+    }
+    return widget->width;
+}
+
+/**
+ * Bind a new value to a widget
+ */
+void display_widget_set_value(display_widget_t *widget, int32_t value)
+{
+    if (!widget) {
+        return;
+    }
+
+    int32_t old_value = widget->value;
+    widget->value = value;
+
+    if (widget->type == DISPLAY_WIDGET_CLOCK) {
+        // Compare at display resolution, the clock is bound in milliseconds
+        int32_t unit = (widget->flags & DISPLAY_WIDGET_CENTIS) ? 10 : 1000;
+        if (old_value / unit == value / unit) {
+            return;
+        }
+    } else if (widget->type == DISPLAY_WIDGET_PROGRESS && widget->max > 0) {
+        // Compare at bar resolution (filled columns)
+        int32_t inner = widget_width(widget) - 2;
+        if ((int64_t)old_value * inner / widget->max == (int64_t)value * inner / widget->max) {
+            return;
+        }
+    } else if (old_value == value) {
+        return;
+    }
+
+    widget->changed = true;
+}
+
+/**
+ * Bind a new text to a widget
+ */
+void display_widget_set_text(display_widget_t *widget, const char *text)
+{
+    if (!widget || widget->text == text) {
+        return;
+    }
+
+    widget->text = text;
+    widget->changed = true;
+}
+
+/**
+ * Draw a progress bar
+ */
+static void draw_progress(const display_widget_t *widget, uint8_t width)
+{
+    if (width < 3) {
+        return;
+    }
+
+    int32_t value = widget->value;
+    if (value < 0) value = 0;
+    if (value > widget->max) value = widget->max;
+
+    uint8_t inner = width - 2;
+    uint8_t filled = (widget->max > 0) ? (uint8_t)((int64_t)value * inner / widget->max) : 0;
+    uint8_t x0 = widget->x;
+    uint8_t x1 = widget->x + width - 1;
+
+    display_fb_fill_area(x0, x0, widget->page, PROGRESS_EDGE);
+    if (filled > 0) {
+        display_fb_fill_area(x0 + 1, x0 + filled, widget->page, PROGRESS_FILLED);
+    }
+    if (filled < inner) {
+        display_fb_fill_area(x0 + 1 + filled, x1 - 1, widget->page, PROGRESS_EMPTY);
+    }
+    display_fb_fill_area(x1, x1, widget->page, PROGRESS_EDGE);
+}
+
+/**
+ * Draw one widget, optionally clearing its area first
+ */
+static void draw_widget(const display_widget_t *widget, bool clear_area)
+{
+    uint8_t width = widget_width(widget);
+    if (width == 0) {
+        return;
+    }
+
+    const font_atlas_t *font = widget->font ? widget->font : &font_5x7;
+
+    if (clear_area) {
+        for (uint8_t p = 0; p < font->pages; p++) {
+            display_fb_fill_area(widget->x, widget->x + width - 1, widget->page + p, 0x00);
+        }
+    }
+
+    char buf[32];
+    const char *prefix = widget->text ? widget->text : "";
+
+    switch (widget->type) {
+        case DISPLAY_WIDGET_LABEL:
+            strlcpy(buf, prefix, sizeof(buf));
+            break;
+
+        case DISPLAY_WIDGET_COUNTER:
+            snprintf(buf, sizeof(buf), "%s%ld", prefix, (long)widget->value);
+            break;
+
+        case DISPLAY_WIDGET_CLOCK: {
+            uint32_t ms = (widget->value > 0) ? (uint32_t)widget->value : 0;
+            uint32_t minutes = ms / 60000;
+            uint32_t seconds = (ms % 60000) / 1000;
+            if (widget->flags & DISPLAY_WIDGET_CENTIS) {
+                snprintf(buf, sizeof(buf), "%s%02lu:%02lu.%02lu", prefix, minutes, seconds, (ms % 1000) / 10);
+            } else {
+                snprintf(buf, sizeof(buf), "%s%02lu:%02lu", prefix, minutes, seconds);
+            }
+            break;
+        }
+
+        case DISPLAY_WIDGET_PROGRESS:
+            draw_progress(widget, width);
+            return;
+
+        default:
+            return;
+    }
+
+    uint8_t x = widget->x;
+    if (widget->flags & DISPLAY_WIDGET_CENTER) {
+        uint16_t text_width = font_text_width(font, buf);
+        if (text_width < width) {
+            x += (width - text_width) / 2;
+        }
+    }
+    display_fb_draw_text(x, widget->page, font, buf, false);
+}
+
+/**
+ * Render a layout
+ */
+esp_err_t display_layout_render(display_layout_t *layout)
+{
+    if (!layout || !layout->widgets) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bool full = (layout != active_layout);
+    bool drawn = full;
+
+    if (full) {
+        // display_clear() invalidates, so set the active layout afterwards
+        esp_err_t ret = display_clear();
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        active_layout = layout;
+        ESP_LOGD(TAG, "Full render (%d widgets)", layout->count);
+    }
+
+    for (uint8_t i = 0; i < layout->count; i++) {
+        display_widget_t *widget = &layout->widgets[i];
+        if (full || widget->changed) {
+            draw_widget(widget, !full);
+            widget->changed = false;
+            drawn = true;
+        }
+    }
+
+    return drawn ? display_update() : ESP_OK;
+}
+
+/**
+ * Forget the layout on screen
+ */
+void display_layout_invalidate(void)
+{
+    active_layout = NULL;
+}
+
+#else // CONFIG_ENABLE_DISPLAY not defined - provide stub implementations
+
+void display_widget_set_value(display_widget_t *widget, int32_t value)
+{
+    if (widget) {
+        widget->value = value;
+    }
+}
+
+void display_widget_set_text(display_widget_t *widget, const char *text)
+{
+    if (widget) {
+        widget->text = text;
+    }
+}
+
+esp_err_t display_layout_render(display_layout_t *layout)
+{
+    return ESP_OK;
+}
+
+void display_layout_invalidate(void)
+{
+}
+
+#endif // CONFIG_ENABLE_DISPLAY
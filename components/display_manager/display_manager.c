@@ -1,15 +1,20 @@
 /**
  * Display Manager Component - Implementation
  * 
- * Abstract display manager that delegates to specific display drivers
- * (SSD1306, SH1106, etc.) based on menuconfig selection.
+ * Abstract display manager that draws through the shared framebuffer
+ * (display_fb) into the panel driver selected in menuconfig.
  * 
  * @author ninharp
  * @date 2025
  */
 
 #include "display_manager.h"
+#include "display_layout.h"
+#include "display_fb.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "metrics.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -17,24 +22,84 @@ static const char *TAG = "DISPLAY_MGR";
 
 #ifdef CONFIG_ENABLE_DISPLAY
 
-// Include driver based on configuration
-#ifdef CONFIG_OLED_SSD1306
-#include "ssd1306.h"
-#define DISPLAY_WIDTH SSD1306_WIDTH
-#define DISPLAY_HEIGHT SSD1306_HEIGHT
-#define DISPLAY_PAGES SSD1306_PAGES
+// Select driver based on configuration. CONFIG_DISPLAY_VIRTUAL_PANEL (host
+// builds only) replaces the panel by a PBM dump of the same geometry.
+#if defined(CONFIG_OLED_SSD1306)
+#define DISPLAY_PANEL_DRIVER   display_driver_ssd1306_128x32
+#define DISPLAY_VIRTUAL_DRIVER display_driver_virtual_128x32
+#elif defined(CONFIG_OLED_SSD1306_128X64)
+#define DISPLAY_PANEL_DRIVER   display_driver_ssd1306_128x64
+#define DISPLAY_VIRTUAL_DRIVER display_driver_virtual_128x64
 #elif defined(CONFIG_OLED_SH1106)
-#include "sh1106.h"
-#define DISPLAY_WIDTH SH1106_WIDTH
-#define DISPLAY_HEIGHT SH1106_HEIGHT
-#define DISPLAY_PAGES SH1106_PAGES
+#define DISPLAY_PANEL_DRIVER   display_driver_sh1106_128x64
+#define DISPLAY_VIRTUAL_DRIVER display_driver_virtual_128x64
 #else
-#error "CONFIG_ENABLE_DISPLAY is set but no display driver selected (CONFIG_OLED_SSD1306 or CONFIG_OLED_SH1106)"
+#error "CONFIG_ENABLE_DISPLAY is set but no display driver selected (CONFIG_OLED_SSD1306, CONFIG_OLED_SSD1306_128X64 or CONFIG_OLED_SH1106)"
 #endif
 
+#ifdef CONFIG_DISPLAY_VIRTUAL_PANEL
+#define DISPLAY_DRIVER DISPLAY_VIRTUAL_DRIVER
+#ifndef CONFIG_DISPLAY_VIRTUAL_PATH
+#define CONFIG_DISPLAY_VIRTUAL_PATH NULL
+#endif
+#else
+#define DISPLAY_DRIVER DISPLAY_PANEL_DRIVER
+#endif
+
+#define DISPLAY_FLUSH_TASK_STACK    3072
+#define DISPLAY_FLUSH_TASK_PRIORITY 2       // Below game, sound and network tasks
+
 static bool initialized = false;
 static display_screen_t current_screen = SCREEN_IDLE;
 
+static TaskHandle_t flush_task_handle = NULL;
+static metric_t *m_frames_rendered = NULL;
+
+// Game status screen
+enum { STATUS_TITLE, STATUS_TIME, STATUS_BREAKS };
+static display_widget_t status_widgets[] = {
+    [STATUS_TITLE]  = { .type = DISPLAY_WIDGET_LABEL, .x = 0, .page = 0, .flags = DISPLAY_WIDGET_CENTER, .text = "GAME ACTIVE" },
+    [STATUS_TIME]   = { .type = DISPLAY_WIDGET_CLOCK, .x = 0, .page = 1, .flags = DISPLAY_WIDGET_CENTER | DISPLAY_WIDGET_CENTIS,
+                        .font = &font_clock_16 },
+    [STATUS_BREAKS] = { .type = DISPLAY_WIDGET_COUNTER, .x = 0, .page = 3, .flags = DISPLAY_WIDGET_CENTER, .text = "Breaks: " },
+};
+static display_layout_t status_layout = DISPLAY_LAYOUT(status_widgets);
+
+// Countdown screen
+enum { COUNTDOWN_DIGIT };
+static display_widget_t countdown_widgets[] = {
+    [COUNTDOWN_DIGIT] = { .type = DISPLAY_WIDGET_COUNTER, .x = 41, .page = 1, .width = 36,
+                          .flags = DISPLAY_WIDGET_CENTER, .font = &font_clock_24 },
+};
+static display_layout_t countdown_layout = DISPLAY_LAYOUT(countdown_widgets);
+
+// Game results screen
+enum { RESULTS_TITLE, RESULTS_TIME, RESULTS_BREAKS };
+static display_widget_t results_widgets[] = {
+    [RESULTS_TITLE]  = { .type = DISPLAY_WIDGET_LABEL, .x = 0, .page = 0, .flags = DISPLAY_WIDGET_CENTER, .text = "GAME COMPLETE!" },
+    [RESULTS_TIME]   = { .type = DISPLAY_WIDGET_CLOCK, .x = 25, .page = 1, .flags = DISPLAY_WIDGET_CENTIS },
+    [RESULTS_BREAKS] = { .type = DISPLAY_WIDGET_COUNTER, .x = 30, .page = 2, .text = "Breaks: " },
+};
+static display_layout_t results_layout = DISPLAY_LAYOUT(results_widgets);
+
+/**
+ * Display flush task - sends presented frames to the panel
+ * 
+ * Runs at low priority so the I2C transfer never delays the task that
+ * draws the frame. Several presents before a flush collapse into one.
+ */
+static void display_flush_task(void *pvParameters)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        
+        esp_err_t ret = display_fb_flush();
+        if (ret != ESP_OK) {
+            ESP_LOGD(TAG, "Display flush failed: %s", esp_err_to_name(ret));
+        }
+    }
+}
+
 /**
  * Initialize display manager
  */
@@ -42,16 +107,32 @@ esp_err_t display_manager_init(gpio_num_t sda_pin, gpio_num_t scl_pin, uint32_t
 {
     ESP_LOGI(TAG, "Initializing display manager...");
     
-    esp_err_t ret;
-    
-#ifdef CONFIG_OLED_SSD1306
-    ret = ssd1306_init(sda_pin, scl_pin, freq_hz);
-#elif defined(CONFIG_OLED_SH1106)
-    ret = sh1106_init(sda_pin, scl_pin, freq_hz);
+    const display_config_t config = {
+        .sda_pin = sda_pin,
+        .scl_pin = scl_pin,
+        .freq_hz = freq_hz,
+#ifdef CONFIG_DISPLAY_VIRTUAL_PANEL
+        .path = CONFIG_DISPLAY_VIRTUAL_PATH,
 #endif
+    };
+    esp_err_t ret = display_fb_init(&DISPLAY_DRIVER, &config);
     
     if (ret == ESP_OK) {
         initialized = true;
+        
+        if (!flush_task_handle) {
+            if (xTaskCreate(display_flush_task, "display_flush", DISPLAY_FLUSH_TASK_STACK, NULL,
+                            DISPLAY_FLUSH_TASK_PRIORITY, &flush_task_handle) == pdPASS) {
+                metrics_register_task(flush_task_handle, "display_flush");
+            } else {
+                ESP_LOGW(TAG, "Failed to create flush task, updating synchronously");
+                flush_task_handle = NULL;
+            }
+            
+            m_frames_rendered = metrics_register_counter("laser_display_frames_total",
+                                                         "Frames drawn and presented", NULL);
+        }
+        
         ESP_LOGI(TAG, "Display manager initialized successfully");
     } else {
         ESP_LOGE(TAG, "Display manager initialization failed");
@@ -69,17 +150,14 @@ esp_err_t display_clear(void)
         return ESP_FAIL;
     }
     
-#ifdef CONFIG_OLED_SSD1306
-    return ssd1306_clear();
-#elif defined(CONFIG_OLED_SH1106)
-    return sh1106_clear();
-#endif
+    // Free-form drawing replaces whatever layout was on screen
+    display_layout_invalidate();
     
-    return ESP_FAIL;
+    return display_fb_clear();
 }
 
 /**
- * Update display (send framebuffer to display)
+ * Update display (publish framebuffer, flush task sends it)
  */
 esp_err_t display_update(void)
 {
@@ -87,13 +165,14 @@ esp_err_t display_update(void)
         return ESP_FAIL;
     }
     
-#ifdef CONFIG_OLED_SSD1306
-    return ssd1306_update();
-#elif defined(CONFIG_OLED_SH1106)
-    return sh1106_update();
-#endif
+    metrics_inc(m_frames_rendered);
     
-    return ESP_FAIL;
+    esp_err_t ret = display_fb_present();
+    if (ret != ESP_OK || !flush_task_handle) {
+        return (ret == ESP_OK) ? display_fb_flush() : ret;
+    }
+    xTaskNotifyGive(flush_task_handle);
+    return ESP_OK;
 }
 
 /**
@@ -129,34 +208,14 @@ esp_err_t display_game_status(uint32_t elapsed_time, uint16_t beam_breaks)
     uint32_t seconds = (elapsed_time % 60000) / 1000;
     uint32_t millis = (elapsed_time % 1000) / 10;
     
-    display_clear();
+    // Title depends on the current screen state (caller sets PAUSED for penalty/pause)
+    display_widget_set_text(&status_widgets[STATUS_TITLE],
+                            (current_screen == SCREEN_GAME_PAUSED) ? "*** PAUSED ***" : "GAME ACTIVE");
+    display_widget_set_value(&status_widgets[STATUS_TIME], elapsed_time);
+    display_widget_set_value(&status_widgets[STATUS_BREAKS], beam_breaks);
     
-#ifdef CONFIG_OLED_SSD1306
-    // Line 0: Title - show different text based on current screen state
-    if (current_screen == SCREEN_GAME_PAUSED) {
-        ssd1306_draw_string(25, 0, "*** PAUSED ***");
-    } else if (current_screen == SCREEN_GAME_RUNNING) {
-        // Check if we should show PENALTY (caller will set screen appropriately)
-        ssd1306_draw_string(30, 0, "GAME ACTIVE");
-    } else {
-        // Default for any other state
-        ssd1306_draw_string(30, 0, "GAME ACTIVE");
-    }
-    
-    // Line 2-3: Time (large)
-    char time_str[16];
-    snprintf(time_str, sizeof(time_str), "%02lu:%02lu.%02lu", minutes, seconds, millis);
-    ssd1306_draw_string(10, 3, time_str);
-    
-    // Line 5: Beam breaks
-    char breaks_str[20];
-    snprintf(breaks_str, sizeof(breaks_str), "Breaks: %d", beam_breaks);
-    ssd1306_draw_string(5, 6, breaks_str);
-#elif defined(CONFIG_OLED_SH1106)
-    // SH1106 implementation (TODO when driver is available)
-#endif
-    
-    display_update();
+    // Only changed widgets are redrawn
+    display_layout_render(&status_layout);
     
     ESP_LOGD(TAG, "Game Status - Time: %02lu:%02lu.%02lu, Breaks: %d",
              minutes, seconds, millis, beam_breaks);
@@ -173,22 +232,9 @@ esp_err_t display_countdown(uint8_t seconds)
         return ESP_FAIL;
     }
     
-    display_clear();
-    
-#ifdef CONFIG_OLED_SSD1306
-    // Draw "Starting in..." text
-    // ssd1306_draw_string(20, 0, "Starting in...");
-    
-    // Draw large countdown number (centered)
-    char num[2] = {seconds + '0', 0};
-    if (seconds < 10) {
-        ssd1306_draw_large_digit(50, 1, num[0]);
-    }
-#elif defined(CONFIG_OLED_SH1106)
-    // SH1106 implementation (TODO)
-#endif
-    
-    display_update();
+    // Large digit centered in the top 32 rows
+    display_widget_set_value(&countdown_widgets[COUNTDOWN_DIGIT], seconds);
+    display_layout_render(&countdown_layout);
     
     ESP_LOGD(TAG, "Countdown: %d", seconds);
     
@@ -204,15 +250,11 @@ esp_err_t display_text(const char *message, uint8_t line)
         return ESP_FAIL;
     }
     
-    if (line >= DISPLAY_PAGES) {
+    if (line >= display_fb_pages()) {
         return ESP_ERR_INVALID_ARG;
     }
     
-#ifdef CONFIG_OLED_SSD1306
-    ssd1306_draw_string(0, line, message);
-#elif defined(CONFIG_OLED_SH1106)
-    // SH1106 implementation (TODO)
-#endif
+    display_fb_draw_string(0, line, message);
     
     ESP_LOGD(TAG, "Display text (line %d): %s", line, message);
     
@@ -232,31 +274,15 @@ esp_err_t display_game_results(uint32_t final_time, uint16_t beam_breaks, comple
     uint32_t seconds = (final_time % 60000) / 1000;
     uint32_t millis = (final_time % 1000) / 10;
     
-    display_clear();
-    
-#ifdef CONFIG_OLED_SSD1306
-    // Line 0: Title - show different message based on completion status
-    if (completion == COMPLETION_SOLVED) {
-        ssd1306_draw_string(20, 0, "GAME COMPLETE!");
-    } else {
-        // ABORTED_TIME or ABORTED_MANUAL
-        ssd1306_draw_string(15, 0, "GAME CANCELED!");
-    }
-    
-    // Line 1: Time
-    char time_str[20];
-    snprintf(time_str, sizeof(time_str), "%02lu:%02lu.%02lu", minutes, seconds, millis);
-    ssd1306_draw_string(25, 1, time_str);
-    
-    // Line 2: Breaks
-    char breaks_str[20];
-    snprintf(breaks_str, sizeof(breaks_str), "Breaks: %d", beam_breaks);
-    ssd1306_draw_string(30, 2, breaks_str);
-#elif defined(CONFIG_OLED_SH1106)
-    // SH1106 implementation (TODO)
-#endif
+    // Title shows how the game ended (ABORTED_TIME or ABORTED_MANUAL -> canceled)
+    display_widget_set_text(&results_widgets[RESULTS_TITLE],
+                            (completion == COMPLETION_SOLVED) ? "GAME COMPLETE!" : "GAME CANCELED!");
+    display_widget_set_value(&results_widgets[RESULTS_TIME], final_time);
+    display_widget_set_value(&results_widgets[RESULTS_BREAKS], beam_breaks);
     
-    display_update();
+    // Results are shown once, always draw the full screen
+    display_layout_invalidate();
+    display_layout_render(&results_layout);
     
     const char* completion_str = (completion == COMPLETION_SOLVED) ? "COMPLETE" : 
                                  (completion == COMPLETION_ABORTED_TIME) ? "CANCELED (TIME LIMIT)" :
@@ -280,11 +306,7 @@ esp_err_t display_set_contrast(uint8_t contrast)
         return ESP_FAIL;
     }
     
-#ifdef CONFIG_OLED_SSD1306
-    ssd1306_set_contrast(contrast);
-#elif defined(CONFIG_OLED_SH1106)
-    // SH1106 implementation (TODO)
-#endif
+    display_fb_set_contrast(contrast);
     
     ESP_LOGI(TAG, "Contrast set to %d", contrast);
     
@@ -300,11 +322,7 @@ esp_err_t display_power(bool on)
         return ESP_FAIL;
     }
     
-#ifdef CONFIG_OLED_SSD1306
-    ssd1306_display_power(on);
-#elif defined(CONFIG_OLED_SH1106)
-    // SH1106 implementation (TODO)
-#endif
+    display_fb_set_power(on);
     
     ESP_LOGI(TAG, "Display power: %s", on ? "ON" : "OFF");
     
@@ -0,0 +1,132 @@
+/**
+ * Virtual Display Panel - Implementation
+ *
+ * Panel driver without hardware: every flush writes the complete frame
+ * as a binary PBM image (lit pixels are black). Used on the host to check
+ * screen layouts, see tools/display_preview.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#include "display_driver.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "DISPLAY_VIRT";
+
+#define VIRTUAL_WIDTH 128
+#define VIRTUAL_DEFAULT_PATH "display_%03u.pbm"
+
+static const char *path_format = VIRTUAL_DEFAULT_PATH;
+static uint8_t panel_pages = 0;
+static unsigned frame_count = 0;
+static bool power_on = true;
+static uint8_t panel[VIRTUAL_WIDTH * DISPLAY_MAX_PAGES];   // Emulated panel RAM
+
+/**
+ * Write the panel RAM as PBM (P4) image
+ */
+static esp_err_t write_pbm(void)
+{
+    char path[256];
+    snprintf(path, sizeof(path), path_format, frame_count);
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        ESP_LOGE(TAG, "Cannot open %s", path);
+        return ESP_FAIL;
+    }
+
+    fprintf(f, "P4\n# frame %u\n%d %d\n", frame_count, VIRTUAL_WIDTH, panel_pages * 8);
+    for (int y = 0; y < panel_pages * 8; y++) {
+        const uint8_t *row = &panel[(y / 8) * VIRTUAL_WIDTH];
+        uint8_t mask = 1 << (y % 8);
+        uint8_t line[VIRTUAL_WIDTH / 8] = {0};
+        for (int x = 0; power_on && x < VIRTUAL_WIDTH; x++) {
+            if (row[x] & mask) {
+                line[x / 8] |= 0x80 >> (x % 8);
+            }
+        }
+        fwrite(line, 1, sizeof(line), f);
+    }
+
+    fclose(f);
+    ESP_LOGD(TAG, "Frame %u written to %s", frame_count, path);
+    frame_count++;
+    return ESP_OK;
+}
+
+/**
+ * Initialize the virtual panel with the given number of pages
+ */
+static esp_err_t virtual_init(const display_config_t *config, uint8_t pages)
+{
+    path_format = (config->path && config->path[0]) ? config->path : VIRTUAL_DEFAULT_PATH;
+    panel_pages = pages;
+    frame_count = 0;
+    power_on = true;
+    memset(panel, 0, sizeof(panel));
+
+    ESP_LOGI(TAG, "Virtual panel 128x%d, frames go to %s", pages * 8, path_format);
+    return ESP_OK;
+}
+
+static esp_err_t virtual_init_128x32(const display_config_t *config)
+{
+    return virtual_init(config, 4);
+}
+
+static esp_err_t virtual_init_128x64(const display_config_t *config)
+{
+    return virtual_init(config, 8);
+}
+
+/**
+ * Apply the changed spans and dump the frame
+ */
+static esp_err_t virtual_flush(const uint8_t *frame, const uint8_t *span_x0, const uint8_t *span_x1)
+{
+    for (uint8_t page = 0; page < panel_pages; page++) {
+        if (span_x0[page] <= span_x1[page]) {
+            memcpy(&panel[page * VIRTUAL_WIDTH + span_x0[page]], &frame[page * VIRTUAL_WIDTH + span_x0[page]],
+                   span_x1[page] - span_x0[page] + 1);
+        }
+    }
+    return write_pbm();
+}
+
+static esp_err_t virtual_set_contrast(uint8_t contrast)
+{
+    ESP_LOGD(TAG, "Contrast %d", contrast);
+    return ESP_OK;
+}
+
+static esp_err_t virtual_set_power(bool on)
+{
+    power_on = on;
+    return write_pbm();
+}
+
+const display_driver_t display_driver_virtual_128x32 = {
+    .name = "virtual 128x32",
+    .width = VIRTUAL_WIDTH,
+    .pages = 4,
+    .init = virtual_init_128x32,
+    .flush = virtual_flush,
+    .set_contrast = virtual_set_contrast,
+    .set_power = virtual_set_power,
+    .wait_idle = NULL,
+};
+
+const display_driver_t display_driver_virtual_128x64 = {
+    .name = "virtual 128x64",
+    .width = VIRTUAL_WIDTH,
+    .pages = 8,
+    .init = virtual_init_128x64,
+    .flush = virtual_flush,
+    .set_contrast = virtual_set_contrast,
+    .set_power = virtual_set_power,
+    .wait_idle = NULL,
+};
@@ -0,0 +1,216 @@
+/**
+ * Font Atlas - font_5x7_prop
+ * 
+ * Generated by tools/font_atlas.py from font5x7.bdf, do not edit.
+ * 8 px (1 pages), characters 32-126, 423 bytes.
+ * 
+ * @author ninharp
+ * @date 2026
+ */
+
+#include "fonts.h"
+
+static const uint8_t font_5x7_prop_bitmap[] = {
+    0x00, 0x00,  // ' '
+    0x5F,  // '!'
+    0x07, 0x00, 0x07,  // '"'
+    0x14, 0x7F, 0x14, 0x7F, 0x14,  // '#'
+    0x24, 0x2A, 0x7F, 0x2A, 0x12,  // '$'
+    0x23, 0x13, 0x08, 0x64, 0x62,  // '%'
+    0x36, 0x49, 0x55, 0x22, 0x50,  // '&'
+    0x05, 0x03,  // '''
+    0x1C, 0x22, 0x41,  // '('
+    0x41, 0x22, 0x1C,  // ')'
+    0x14, 0x08, 0x3E, 0x08, 0x14,  // '*'
+    0x08, 0x08, 0x3E, 0x08, 0x08,  // '+'
+    0x50, 0x30,  // ','
+    0x08, 0x08, 0x08, 0x08, 0x08,  // '-'
+    0x60, 0x60,  // '.'
+    0x20, 0x10, 0x08, 0x04, 0x02,  // '/'
+    0x3E, 0x51, 0x49, 0x45, 0x3E,  // '0'
+    0x00, 0x42, 0x7F, 0x40, 0x00,  // '1'
+    0x42, 0x61, 0x51, 0x49, 0x46,  // '2'
+    0x21, 0x41, 0x45, 0x4B, 0x31,  // '3'
+    0x18, 0x14, 0x12, 0x7F, 0x10,  // '4'
+    0x27, 0x45, 0x45, 0x45, 0x39,  // '5'
+    0x3C, 0x4A, 0x49, 0x49, 0x30,  // '6'
+    0x01, 0x71, 0x09, 0x05, 0x03,  // '7'
+    0x36, 0x49, 0x49, 0x49, 0x36,  // '8'
+    0x06, 0x49, 0x49, 0x29, 0x1E,  // '9'
+    0x36, 0x36,  // ':'
+    0x56, 0x36,  // ';'
+    0x08, 0x14, 0x22, 0x41,  // '<'
+    0x14, 0x14, 0x14, 0x14, 0x14,  // '='
+    0x41, 0x22, 0x14, 0x08,  // '>'
+    0x02, 0x01, 0x51, 0x09, 0x06,  // '?'
+    0x32, 0x49, 0x79, 0x41, 0x3E,  // '@'
+    0x7E, 0x11, 0x11, 0x11, 0x7E,  // 'A'
+    0x7F, 0x49, 0x49, 0x49, 0x36,  // 'B'
+    0x3E, 0x41, 0x41, 0x41, 0x22,  // 'C'
+    0x7F, 0x41, 0x41, 0x22, 0x1C,  // 'D'
+    0x7F, 0x49, 0x49, 0x49, 0x41,  // 'E'
+    0x7F, 0x09, 0x09, 0x09, 0x01,  // 'F'
+    0x3E, 0x41, 0x49, 0x49, 0x7A,  // 'G'
+    0x7F, 0x08, 0x08, 0x08, 0x7F,  // 'H'
+    0x41, 0x7F, 0x41,  // 'I'
+    0x20, 0x40, 0x41, 0x3F, 0x01,  // 'J'
+    0x7F, 0x08, 0x14, 0x22, 0x41,  // 'K'
+    0x7F, 0x40, 0x40, 0x40, 0x40,  // 'L'
+    0x7F, 0x02, 0x0C, 0x02, 0x7F,  // 'M'
+    0x7F, 0x04, 0x08, 0x10, 0x7F,  // 'N'
+    0x3E, 0x41, 0x41, 0x41, 0x3E,  // 'O'
+    0x7F, 0x09, 0x09, 0x09, 0x06,  // 'P'
+    0x3E, 0x41, 0x51, 0x21, 0x5E,  // 'Q'
+    0x7F, 0x09, 0x19, 0x29, 0x46,  // 'R'
+    0x46, 0x49, 0x49, 0x49, 0x31,  // 'S'
+    0x01, 0x01, 0x7F, 0x01, 0x01,  // 'T'
+    0x3F, 0x40, 0x40, 0x40, 0x3F,  // 'U'
+    0x1F, 0x20, 0x40, 0x20, 0x1F,  // 'V'
+    0x3F, 0x40, 0x38, 0x40, 0x3F,  // 'W'
+    0x63, 0x14, 0x08, 0x14, 0x63,  // 'X'
+    0x07, 0x08, 0x70, 0x08, 0x07,  // 'Y'
+    0x61, 0x51, 0x49, 0x45, 0x43,  // 'Z'
+    0x7F, 0x41, 0x41,  // '['
+    0x02, 0x04, 0x08, 0x10, 0x20,  // backslash
+    0x41, 0x41, 0x7F,  // ']'
+    0x04, 0x02, 0x01, 0x02, 0x04,  // '^'
+    0x40, 0x40, 0x40, 0x40, 0x40,  // '_'
+    0x01, 0x02, 0x04,  // '`'
+    0x20, 0x54, 0x54, 0x54, 0x78,  // 'a'
+    0x7F, 0x48, 0x44, 0x44, 0x38,  // 'b'
+    0x38, 0x44, 0x44, 0x44, 0x20,  // 'c'
+    0x38, 0x44, 0x44, 0x48, 0x7F,  // 'd'
+    0x38, 0x54, 0x54, 0x54, 0x18,  // 'e'
+    0x08, 0x7E, 0x09, 0x01, 0x02,  // 'f'
+    0x0C, 0x52, 0x52, 0x52, 0x3E,  // 'g'
+    0x7F, 0x08, 0x04, 0x04, 0x78,  // 'h'
+    0x44, 0x7D, 0x40,  // 'i'
+    0x20, 0x40, 0x44, 0x3D,  // 'j'
+    0x7F, 0x10, 0x28, 0x44,  // 'k'
+    0x41, 0x7F, 0x40,  // 'l'
+    0x7C, 0x04, 0x18, 0x04, 0x78,  // 'm'
+    0x7C, 0x08, 0x04, 0x04, 0x78,  // 'n'
+    0x38, 0x44, 0x44, 0x44, 0x38,  // 'o'
+    0x7C, 0x14, 0x14, 0x14, 0x08,  // 'p'
+    0x08, 0x14, 0x14, 0x18, 0x7C,  // 'q'
+    0x7C, 0x08, 0x04, 0x04, 0x08,  // 'r'
+    0x48, 0x54, 0x54, 0x54, 0x20,  // 's'
+    0x04, 0x3F, 0x44, 0x40, 0x20,  // 't'
+    0x3C, 0x40, 0x40, 0x20, 0x7C,  // 'u'
+    0x1C, 0x20, 0x40, 0x20, 0x1C,  // 'v'
+    0x3C, 0x40, 0x30, 0x40, 0x3C,  // 'w'
+    0x44, 0x28, 0x10, 0x28, 0x44,  // 'x'
+    0x0C, 0x50, 0x50, 0x50, 0x3C,  // 'y'
+    0x44, 0x64, 0x54, 0x4C, 0x44,  // 'z'
+    0x08, 0x36, 0x41,  // '{'
+    0x7F,  // '|'
+    0x41, 0x36, 0x08,  // '}'
+    0x08, 0x04, 0x08, 0x10, 0x08,  // '~'
+};
+
+static const font_glyph_t font_5x7_prop_glyphs[] = {
+    {     0,  2 },  // ' '
+    {     2,  1 },  // '!'
+    {     3,  3 },  // '"'
+    {     6,  5 },  // '#'
+    {    11,  5 },  // '$'
+    {    16,  5 },  // '%'
+    {    21,  5 },  // '&'
+    {    26,  2 },  // '''
+    {    28,  3 },  // '('
+    {    31,  3 },  // ')'
+    {    34,  5 },  // '*'
+    {    39,  5 },  // '+'
+    {    44,  2 },  // ','
+    {    46,  5 },  // '-'
+    {    51,  2 },  // '.'
+    {    53,  5 },  // '/'
+    {    58,  5 },  // '0'
+    {    63,  5 },  // '1'
+    {    68,  5 },  // '2'
+    {    73,  5 },  // '3'
+    {    78,  5 },  // '4'
+    {    83,  5 },  // '5'
+    {    88,  5 },  // '6'
+    {    93,  5 },  // '7'
+    {    98,  5 },  // '8'
+    {   103,  5 },  // '9'
+    {   108,  2 },  // ':'
+    {   110,  2 },  // ';'
+    {   112,  4 },  // '<'
+    {   116,  5 },  // '='
+    {   121,  4 },  // '>'
+    {   125,  5 },  // '?'
+    {   130,  5 },  // '@'
+    {   135,  5 },  // 'A'
+    {   140,  5 },  // 'B'
+    {   145,  5 },  // 'C'
+    {   150,  5 },  // 'D'
+    {   155,  5 },  // 'E'
+    {   160,  5 },  // 'F'
+    {   165,  5 },  // 'G'
+    {   170,  5 },  // 'H'
+    {   175,  3 },  // 'I'
+    {   178,  5 },  // 'J'
+    {   183,  5 },  // 'K'
+    {   188,  5 },  // 'L'
+    {   193,  5 },  // 'M'
+    {   198,  5 },  // 'N'
+    {   203,  5 },  // 'O'
+    {   208,  5 },  // 'P'
+    {   213,  5 },  // 'Q'
+    {   218,  5 },  // 'R'
+    {   223,  5 },  // 'S'
+    {   228,  5 },  // 'T'
+    {   233,  5 },  // 'U'
+    {   238,  5 },  // 'V'
+    {   243,  5 },  // 'W'
+    {   248,  5 },  // 'X'
+    {   253,  5 },  // 'Y'
+    {   258,  5 },  // 'Z'
+    {   263,  3 },  // '['
+    {   266,  5 },  // backslash
+    {   271,  3 },  // ']'
+    {   274,  5 },  // '^'
+    {   279,  5 },  // '_'
+    {   284,  3 },  // '`'
+    {   287,  5 },  // 'a'
+    {   292,  5 },  // 'b'
+    {   297,  5 },  // 'c'
+    {   302,  5 },  // 'd'
+    {   307,  5 },  // 'e'
+    {   312,  5 },  // 'f'
+    {   317,  5 },  // 'g'
+    {   322,  5 },  // 'h'
+    {   327,  3 },  // 'i'
+    {   330,  4 },  // 'j'
+    {   334,  4 },  // 'k'
+    {   338,  3 },  // 'l'
+    {   341,  5 },  // 'm'
+    {   346,  5 },  // 'n'
+    {   351,  5 },  // 'o'
+    {   356,  5 },  // 'p'
+    {   361,  5 },  // 'q'
+    {   366,  5 },  // 'r'
+    {   371,  5 },  // 's'
+    {   376,  5 },  // 't'
+    {   381,  5 },  // 'u'
+    {   386,  5 },  // 'v'
+    {   391,  5 },  // 'w'
+    {   396,  5 },  // 'x'
+    {   401,  5 },  // 'y'
+    {   406,  5 },  // 'z'
+    {   411,  3 },  // '{'
+    {   414,  1 },  // '|'
+    {   415,  3 },  // '}'
+    {   418,  5 },  // '~'
+};
+
+const font_atlas_t font_5x7_prop = {
+    .pages = 1,
+    .spacing = 1,
+    .first = 32,
+    .last = 126,
+    .glyphs = font_5x7_prop_glyphs,
+    .bitmap = font_5x7_prop_bitmap,
+};
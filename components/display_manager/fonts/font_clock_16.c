@@ -0,0 +1,66 @@
+/**
+ * Font Atlas - font_clock_16
+ * 
+ * Generated by tools/font_atlas.py from font5x7.bdf, do not edit.
+ * 16 px (2 pages), characters 32-58, 226 bytes.
+ * 
+ * @author ninharp
+ * @date 2026
+ */
+
+#include "fonts.h"
+
+static const uint8_t font_clock_16_bitmap[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ' '
+    0x00, 0x00, 0x00, 0x00, 0x3C, 0x3C, 0x3C, 0x3C,  // '.'
+    0xFC, 0xFC, 0x03, 0x03, 0xC3, 0xC3, 0x33, 0x33, 0xFC, 0xFC, 0x0F, 0x0F, 0x33, 0x33, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F,  // '0'
+    0x00, 0x00, 0x0C, 0x0C, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x3F, 0x3F, 0x30, 0x30, 0x00, 0x00,  // '1'
+    0x0C, 0x0C, 0x03, 0x03, 0x03, 0x03, 0xC3, 0xC3, 0x3C, 0x3C, 0x30, 0x30, 0x3C, 0x3C, 0x33, 0x33, 0x30, 0x30, 0x30, 0x30,  // '2'
+    0x03, 0x03, 0x03, 0x03, 0x33, 0x33, 0xCF, 0xCF, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F,  // '3'
+    0xC0, 0xC0, 0x30, 0x30, 0x0C, 0x0C, 0xFF, 0xFF, 0x00, 0x00, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x3F, 0x3F, 0x03, 0x03,  // '4'
+    0x3F, 0x3F, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0xC3, 0xC3, 0x0C, 0x0C, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F,  // '5'
+    0xF0, 0xF0, 0xCC, 0xCC, 0xC3, 0xC3, 0xC3, 0xC3, 0x00, 0x00, 0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F,  // '6'
+    0x03, 0x03, 0x03, 0x03, 0xC3, 0xC3, 0x33, 0x33, 0x0F, 0x0F, 0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '7'
+    0x3C, 0x3C, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x3C, 0x3C, 0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F,  // '8'
+    0x3C, 0x3C, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFC, 0xFC, 0x00, 0x00, 0x30, 0x30, 0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03,  // '9'
+    0x3C, 0x3C, 0x3C, 0x3C, 0x0F, 0x0F, 0x0F, 0x0F,  // ':'
+};
+
+static const font_glyph_t font_clock_16_glyphs[] = {
+    {     0,  5 },  // ' '
+    {    10,  0 },  // '!'
+    {    10,  0 },  // '"'
+    {    10,  0 },  // '#'
+    {    10,  0 },  // '$'
+    {    10,  0 },  // '%'
+    {    10,  0 },  // '&'
+    {    10,  0 },  // '''
+    {    10,  0 },  // '('
+    {    10,  0 },  // ')'
+    {    10,  0 },  // '*'
+    {    10,  0 },  // '+'
+    {    10,  0 },  // ','
+    {    10,  0 },  // '-'
+    {    10,  4 },  // '.'
+    {    18,  0 },  // '/'
+    {    18, 10 },  // '0'
+    {    38, 10 },  // '1'
+    {    58, 10 },  // '2'
+    {    78, 10 },  // '3'
+    {    98, 10 },  // '4'
+    {   118, 10 },  // '5'
+    {   138, 10 },  // '6'
+    {   158, 10 },  // '7'
+    {   178, 10 },  // '8'
+    {   198, 10 },  // '9'
+    {   218,  4 },  // ':'
+};
+
+const font_atlas_t font_clock_16 = {
+    .pages = 2,
+    .spacing = 2,
+    .first = 32,
+    .last = 58,
+    .glyphs = font_clock_16_glyphs,
+    .bitmap = font_clock_16_bitmap,
+};
@@ -0,0 +1,90 @@
+/**
+ * Display Driver Interface - Header
+ *
+ * Panel drivers only initialize the controller and transfer changed
+ * regions. Framebuffer, dirty tracking, fonts and widgets live in
+ * display_fb and are shared by all panels.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#ifndef DISPLAY_DRIVER_H
+#define DISPLAY_DRIVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DISPLAY_MAX_WIDTH 128
+#define DISPLAY_MAX_PAGES 8     // 64 px
+
+/**
+ * Display configuration passed to the driver
+ */
+typedef struct {
+    gpio_num_t sda_pin;         // I2C SDA (panel drivers)
+    gpio_num_t scl_pin;         // I2C SCL (panel drivers)
+    uint32_t freq_hz;           // I2C frequency (panel drivers)
+    const char *path;           // Output file, may contain %u for a frame counter (virtual panel)
+} display_config_t;
+
+/**
+ * Display driver (vtable)
+ */
+typedef struct {
+    const char *name;
+    uint8_t width;              // Visible columns
+    uint8_t pages;              // Visible pages (height / 8)
+
+    /**
+     * Initialize bus and controller
+     */
+    esp_err_t (*init)(const display_config_t *config);
+
+    /**
+     * Send changed regions of a frame
+     *
+     * frame holds width * pages bytes (page-major). span_x0/span_x1 give
+     * the changed columns per page; a page is unchanged if x0 > x1. The
+     * frame may change once flush returns, drivers copy what they queue.
+     */
+    esp_err_t (*flush)(const uint8_t *frame, const uint8_t *span_x0, const uint8_t *span_x1);
+
+    esp_err_t (*set_contrast)(uint8_t contrast);
+    esp_err_t (*set_power)(bool on);
+
+    /**
+     * Wait for queued transfers (NULL if flush is synchronous)
+     *
+     * Returns an error if a queued transfer failed; the next flush then
+     * resends the full frame.
+     */
+    esp_err_t (*wait_idle)(uint32_t timeout_ms);
+} display_driver_t;
+
+// Available drivers
+extern const display_driver_t display_driver_ssd1306_128x32;
+extern const display_driver_t display_driver_ssd1306_128x64;
+extern const display_driver_t display_driver_sh1106_128x64;
+extern const display_driver_t display_driver_virtual_128x32;
+extern const display_driver_t display_driver_virtual_128x64;
+
+/**
+ * Account bytes put on the display bus (for drivers)
+ *
+ * @param len Bytes incl. address and control bytes
+ */
+void display_fb_count_bus_bytes(size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISPLAY_DRIVER_H
@@ -0,0 +1,198 @@
+/**
+ * Display Framebuffer - Header
+ *
+ * Panel independent framebuffer with dirty tracking and font drawing.
+ * Producers draw into the back buffer and publish it with
+ * display_fb_present(); the flush task sends the changed regions through
+ * the selected display_driver_t.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#ifndef DISPLAY_FB_H
+#define DISPLAY_FB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "display_driver.h"
+#include "fonts.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Display bus statistics
+ */
+typedef struct {
+    uint32_t total_bytes;       // Bytes put on the bus since init (incl. address/control bytes)
+    uint32_t bytes_per_sec;     // Bus bytes over the last full second
+    uint32_t frames_sent;       // Updates that transmitted at least one region
+    uint32_t frames_skipped;    // Updates with nothing to send
+    uint32_t pages_sent;        // Pages with changed columns transmitted
+} display_stats_t;
+
+/**
+ * Initialize the panel and the framebuffer
+ *
+ * @param driver Panel driver
+ * @param config Bus pins/frequency or output path, passed to the driver
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t display_fb_init(const display_driver_t *driver, const display_config_t *config);
+
+/**
+ * Visible width in columns (0 before init)
+ */
+uint8_t display_fb_width(void);
+
+/**
+ * Visible height in pages of 8 px (0 before init)
+ */
+uint8_t display_fb_pages(void);
+
+/**
+ * Clear the framebuffer
+ *
+ * @return ESP_OK on success
+ */
+esp_err_t display_fb_clear(void);
+
+/**
+ * Publish the framebuffer (back buffer) as the next frame to display
+ *
+ * Copies the changed spans into the front buffer. Cheap and never waits
+ * for the bus, so drawing can continue right after it returns.
+ *
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t display_fb_present(void);
+
+/**
+ * Send changed regions of the front buffer to the panel
+ *
+ * Only columns that differ from the last transmitted frame are sent.
+ * Must only be called from one task (the display flush task).
+ *
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t display_fb_flush(void);
+
+/**
+ * Present the framebuffer and send it to the panel (synchronous)
+ *
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t display_fb_update(void);
+
+/**
+ * Wait until queued display transfers have completed
+ *
+ * Only blocks with drivers that queue transfers (CONFIG_DISPLAY_ASYNC_FLUSH).
+ *
+ * @param timeout_ms Maximum time to wait
+ * @return ESP_OK when idle, ESP_ERR_TIMEOUT or ESP_FAIL if a transfer failed
+ *         (the next flush then resends the full frame)
+ */
+esp_err_t display_fb_wait_idle(uint32_t timeout_ms);
+
+/**
+ * Get display bus statistics
+ *
+ * @param out Pointer to store statistics
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if out is NULL
+ */
+esp_err_t display_fb_get_stats(display_stats_t *out);
+
+/**
+ * Mark a framebuffer region as modified (after writing via display_fb_get_framebuffer)
+ *
+ * @param x0 First column
+ * @param x1 Last column (inclusive)
+ * @param page Page number
+ */
+void display_fb_mark_dirty(uint8_t x0, uint8_t x1, uint8_t page);
+
+/**
+ * Draw a glyph from a font atlas
+ *
+ * @param x X position
+ * @param page Starting page (glyph covers font->pages pages)
+ * @param font Font atlas
+ * @param c Character
+ * @param overlay true to OR onto existing pixels, false to replace (incl. spacing)
+ * @return Advance in columns (0 if the character is not in the font)
+ */
+uint8_t display_fb_draw_glyph(uint8_t x, uint8_t page, const font_atlas_t *font, char c, bool overlay);
+
+/**
+ * Draw a string with a font atlas
+ *
+ * @param x X position
+ * @param page Starting page
+ * @param font Font atlas
+ * @param str String to draw
+ * @param overlay true to OR onto existing pixels, false to replace
+ * @return Column after the last drawn glyph
+ */
+uint8_t display_fb_draw_text(uint8_t x, uint8_t page, const font_atlas_t *font, const char *str, bool overlay);
+
+/**
+ * Draw a string with the 5x7 font
+ *
+ * @param x X position
+ * @param page Page number
+ * @param str String to draw
+ */
+void display_fb_draw_string(uint8_t x, uint8_t page, const char *str);
+
+/**
+ * Draw a horizontal line
+ *
+ * @param page Page number
+ * @param pattern Line pattern (0xFF for solid line)
+ */
+void display_fb_draw_hline(uint8_t page, uint8_t pattern);
+
+/**
+ * Fill a column span of a page with a byte pattern
+ *
+ * @param x0 First column
+ * @param x1 Last column (inclusive)
+ * @param page Page number
+ * @param pattern Byte written to each column (0x00 to clear)
+ */
+void display_fb_fill_area(uint8_t x0, uint8_t x1, uint8_t page, uint8_t pattern);
+
+/**
+ * Set panel contrast
+ *
+ * @param contrast Contrast value (0-255)
+ * @return ESP_OK on success
+ */
+esp_err_t display_fb_set_contrast(uint8_t contrast);
+
+/**
+ * Turn panel on/off
+ *
+ * @param on true to turn on, false to turn off
+ * @return ESP_OK on success
+ */
+esp_err_t display_fb_set_power(bool on);
+
+/**
+ * Get direct access to the framebuffer (for advanced operations)
+ *
+ * Rows are display_fb_width() bytes long, one row per page.
+ *
+ * @return Pointer to framebuffer
+ */
+uint8_t* display_fb_get_framebuffer(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISPLAY_FB_H
@@ -0,0 +1,110 @@
+/**
+ * Display Layout - Header
+ *
+ * Retained-mode widget layouts for the display. A screen is a static
+ * table of widgets (labels, counters, clocks, progress bars). Switching
+ * to a layout draws it completely once; afterwards only widgets whose
+ * bound value changed are cleared and redrawn.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#ifndef DISPLAY_LAYOUT_H
+#define DISPLAY_LAYOUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "fonts.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Widget types
+ */
+typedef enum {
+    DISPLAY_WIDGET_LABEL = 0,   // Text (static, or switched with display_widget_set_text)
+    DISPLAY_WIDGET_COUNTER,     // Prefix text followed by an integer value
+    DISPLAY_WIDGET_CLOCK,       // Prefix text followed by a time in ms as MM:SS
+    DISPLAY_WIDGET_PROGRESS     // Horizontal bar showing value / max
+} display_widget_type_t;
+
+// Widget flags
+#define DISPLAY_WIDGET_CENTER   0x01    // Center content within the widget width
+#define DISPLAY_WIDGET_CENTIS   0x02    // Clock shows hundredths (MM:SS.cc)
+
+/**
+ * Widget definition and retained state
+ */
+typedef struct {
+    display_widget_type_t type;
+    uint8_t x;                  // Left column
+    uint8_t page;               // Top page
+    uint8_t width;              // Area cleared on redraw (0 = up to the right edge)
+    uint8_t flags;              // DISPLAY_WIDGET_* flags
+    const font_atlas_t *font;   // Font (NULL = font_5x7), widget is font->pages tall
+    const char *text;           // Label text or value prefix (may be NULL)
+    int32_t max;                // Full scale of a progress bar
+    int32_t value;              // Bound value
+    bool changed;               // Needs redraw on next render
+} display_widget_t;
+
+/**
+ * Layout (screen) made of widgets
+ */
+typedef struct {
+    display_widget_t *widgets;
+    uint8_t count;
+} display_layout_t;
+
+/**
+ * Define a layout from a static widget array
+ */
+#define DISPLAY_LAYOUT(widget_array) \
+    { .widgets = (widget_array), .count = sizeof(widget_array) / sizeof((widget_array)[0]) }
+
+/**
+ * Bind a new value to a widget
+ *
+ * Marks the widget for redraw only if the visible value changes (clocks
+ * compare at their display resolution).
+ *
+ * @param widget Widget to update
+ * @param value New value (milliseconds for clocks)
+ */
+void display_widget_set_value(display_widget_t *widget, int32_t value);
+
+/**
+ * Bind a new text to a widget
+ *
+ * @param widget Widget to update
+ * @param text New text (must stay valid, compared by pointer)
+ */
+void display_widget_set_text(display_widget_t *widget, const char *text);
+
+/**
+ * Render a layout
+ *
+ * Draws the whole layout if it is not the one on screen, otherwise only
+ * the changed widgets. Publishes the frame only if something was drawn.
+ *
+ * @param layout Layout to render
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t display_layout_render(display_layout_t *layout);
+
+/**
+ * Forget the layout on screen (next render draws everything)
+ *
+ * Called by display_clear() so free-form drawing and layouts can be mixed.
+ */
+void display_layout_invalidate(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISPLAY_LAYOUT_H
@@ -12,6 +12,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
 #include "driver/gpio.h"
 #include "game_logic.h"  // For completion_status_t
@@ -52,7 +53,10 @@ esp_err_t display_manager_init(gpio_num_t sda_pin, gpio_num_t scl_pin, uint32_t
 esp_err_t display_clear(void);
 
 /**
- * Update display (refresh screen)
+ * Update display (publish frame)
+ * 
+ * Hands the drawn frame to the low-priority flush task and returns
+ * without waiting for the I2C transfer.
  * 
  * @return ESP_OK on success, error code otherwise
  */
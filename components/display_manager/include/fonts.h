@@ -0,0 +1,81 @@
+/**
+ * Display Fonts - Header
+ *
+ * Precomputed font atlases for the page-organized OLED framebuffer.
+ * Each glyph is stored as `pages` rows of `width` column bytes (bit 0 is
+ * the top pixel of a page), so drawing is one memcpy per page row.
+ * Atlases are generated with tools/font_atlas.py from BDF/TTF fonts.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#ifndef FONTS_H
+#define FONTS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Glyph entry of a font atlas
+ */
+typedef struct {
+    uint16_t offset;            // Offset of the first column byte in the bitmap
+    uint8_t width;              // Width in columns (0 = not in the font)
+} font_glyph_t;
+
+/**
+ * Font atlas
+ */
+typedef struct {
+    uint8_t pages;              // Glyph height in pages (8 px each)
+    uint8_t spacing;            // Blank columns after each glyph
+    uint8_t first;              // First character in the atlas
+    uint8_t last;               // Last character in the atlas
+    const font_glyph_t *glyphs; // Glyph table (last - first + 1 entries)
+    const uint8_t *bitmap;      // Column bytes, per glyph page row 0 first
+} font_atlas_t;
+
+// Available fonts
+extern const font_atlas_t font_5x7;         // 8 px fixed width, ASCII 32-126
+extern const font_atlas_t font_5x7_prop;    // 8 px proportional, tabular digits
+extern const font_atlas_t font_clock_16;    // 16 px clock digits, ':' '.' ' '
+extern const font_atlas_t font_clock_24;    // 24 px clock digits, ':' '.' ' '
+
+/**
+ * Look up a glyph (NULL if the character is not in the font)
+ */
+static inline const font_glyph_t *font_get_glyph(const font_atlas_t *font, char c)
+{
+    uint8_t code = (uint8_t)c;
+    if (code < font->first || code > font->last) {
+        return NULL;
+    }
+    const font_glyph_t *glyph = &font->glyphs[code - font->first];
+    return glyph->width ? glyph : NULL;
+}
+
+/**
+ * Width of a string in columns, including spacing between glyphs
+ */
+static inline uint16_t font_text_width(const font_atlas_t *font, const char *str)
+{
+    uint16_t width = 0;
+    for (; *str; str++) {
+        const font_glyph_t *glyph = font_get_glyph(font, *str);
+        if (glyph) {
+            width += glyph->width + font->spacing;
+        }
+    }
+    return width ? width - font->spacing : 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FONTS_H
@@ -0,0 +1,76 @@
+/**
+ * OLED I2C Transport - Header
+ *
+ * I2C master bus handling shared by the SSD1306 and SH1106 drivers:
+ * display detection, command streams and (optionally queued) transfers.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#ifndef OLED_I2C_H
+#define OLED_I2C_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "display_driver.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OLED_I2C_TIMEOUT_MS 100
+
+// Control byte sent after the I2C address (same for SSD1306 and SH1106)
+#define OLED_CTRL_CMD_STREAM  0x00  // Co=0, D/C=0: all following bytes are commands
+#define OLED_CTRL_CMD_SINGLE  0x80  // Co=1, D/C=0: one command byte, then another control byte
+#define OLED_CTRL_DATA_STREAM 0x40  // Co=0, D/C=1: all following bytes are display RAM data
+
+/**
+ * Create the I2C bus and attach the display (0x3C or 0x3D)
+ *
+ * @param config Bus pins and frequency
+ * @param queue_depth Transfers one flush may queue (with CONFIG_DISPLAY_ASYNC_FLUSH)
+ * @return ESP_OK on success, ESP_FAIL if no display answers
+ */
+esp_err_t oled_i2c_init(const display_config_t *config, size_t queue_depth);
+
+/**
+ * Detach the display and delete the bus (after a failed init sequence)
+ */
+void oled_i2c_deinit(void);
+
+/**
+ * Send one complete I2C transaction (queued when async flush is enabled)
+ *
+ * With async flush the buffer must stay valid until oled_i2c_wait_idle().
+ *
+ * @param buf Control byte followed by payload
+ * @param len Length of buf
+ * @return ESP_OK on success
+ */
+esp_err_t oled_i2c_transmit(const uint8_t *buf, size_t len);
+
+/**
+ * Write a sequence of commands as one command stream (waits for completion)
+ *
+ * @param cmds Command bytes (max 32)
+ * @param len Number of command bytes
+ * @return ESP_OK on success
+ */
+esp_err_t oled_i2c_write_commands(const uint8_t *cmds, size_t len);
+
+/**
+ * Wait until all queued transfers are on the panel
+ *
+ * @param timeout_ms Maximum time to wait
+ * @return ESP_OK when idle, ESP_ERR_TIMEOUT or ESP_FAIL if a transfer failed
+ */
+esp_err_t oled_i2c_wait_idle(uint32_t timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OLED_I2C_H
@@ -0,0 +1,254 @@
+/**
+ * OLED I2C Transport - Implementation
+ *
+ * I2C master bus handling shared by the SSD1306 and SH1106 drivers.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#include "oled_i2c.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/i2c_master.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include <string.h>
+#include <stdatomic.h>
+
+static const char *TAG = "OLED_I2C";
+
+#define I2C_MASTER_NUM I2C_NUM_0
+#define OLED_I2C_ADDRESS 0x3C
+
+// I2C master bus and display device
+static i2c_master_bus_handle_t bus_handle = NULL;
+static i2c_master_dev_handle_t dev_handle = NULL;
+
+#ifdef CONFIG_DISPLAY_ASYNC_FLUSH
+static atomic_bool transfer_failed = false;   // Set from the I2C ISR on NACK/timeout
+
+/**
+ * I2C transfer done callback (ISR context) - only records failures
+ */
+static bool IRAM_ATTR on_trans_done(i2c_master_dev_handle_t dev, const i2c_master_event_data_t *evt, void *arg)
+{
+    if (evt->event != I2C_EVENT_DONE) {
+        atomic_store(&transfer_failed, true);
+    }
+    return false;
+}
+#endif
+
+/**
+ * Test if I2C communication works at all
+ */
+static void i2c_test_pins(gpio_num_t sda_pin, gpio_num_t scl_pin)
+{
+    ESP_LOGI(TAG, "Testing I2C configuration:");
+    ESP_LOGI(TAG, "  SDA Pin: GPIO%d", sda_pin);
+    ESP_LOGI(TAG, "  SCL Pin: GPIO%d", scl_pin);
+    ESP_LOGI(TAG, "  Pull-ups: Enabled (internal)");
+    ESP_LOGI(TAG, "");
+    ESP_LOGI(TAG, "If scan fails, try:");
+    ESP_LOGI(TAG, "  1. Swap SDA/SCL pins");
+    ESP_LOGI(TAG, "  2. Add external 4.7k pull-up resistors");
+    ESP_LOGI(TAG, "  3. Check display power (3.3V)");
+    ESP_LOGI(TAG, "  4. Try lower I2C speed (10kHz)");
+}
+
+/**
+ * Create the I2C bus and attach the display
+ */
+esp_err_t oled_i2c_init(const display_config_t *config, size_t queue_depth)
+{
+    gpio_num_t sda_pin = config->sda_pin;
+    gpio_num_t scl_pin = config->scl_pin;
+
+    // Configure I2C master bus
+    i2c_master_bus_config_t bus_config = {
+        .i2c_port = I2C_MASTER_NUM,
+        .sda_io_num = sda_pin,
+        .scl_io_num = scl_pin,
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .glitch_ignore_cnt = 7,
+#ifdef CONFIG_DISPLAY_ASYNC_FLUSH
+        .trans_queue_depth = queue_depth,
+#endif
+        .flags.enable_internal_pullup = true,
+    };
+    (void)queue_depth;
+
+    esp_err_t err = i2c_new_master_bus(&bus_config, &bus_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "I2C master bus creation failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    ESP_LOGI(TAG, "I2C master bus created, scanning for display...");
+
+    // Wait for display to power up
+    vTaskDelay(pdMS_TO_TICKS(200));
+
+    // Show I2C configuration for debugging
+    i2c_test_pins(sda_pin, scl_pin);
+
+    // Try common OLED display addresses (0x3C and 0x3D)
+    uint8_t display_addr = 0;
+    ESP_LOGI(TAG, "Trying display address 0x3C...");
+    if (i2c_master_probe(bus_handle, 0x3C, OLED_I2C_TIMEOUT_MS) == ESP_OK) {
+        display_addr = 0x3C;
+        ESP_LOGI(TAG, "✓ Display found at address 0x3C");
+    } else {
+        ESP_LOGI(TAG, "Trying display address 0x3D...");
+        if (i2c_master_probe(bus_handle, 0x3D, OLED_I2C_TIMEOUT_MS) == ESP_OK) {
+            display_addr = 0x3D;
+            ESP_LOGI(TAG, "✓ Display found at address 0x3D");
+        } else {
+            ESP_LOGE(TAG, "✗ Display NOT found at 0x3C or 0x3D");
+
+            // Full I2C bus scan with detailed output
+            ESP_LOGI(TAG, "");
+            ESP_LOGI(TAG, "=== Full I2C Bus Scan ===");
+            bool found_any = false;
+            for (uint8_t addr = 0x01; addr < 0x7F; addr++) {
+                esp_err_t ret = i2c_master_probe(bus_handle, addr, OLED_I2C_TIMEOUT_MS);
+                if (ret == ESP_OK) {
+                    ESP_LOGI(TAG, "  ✓ Device found at 0x%02X", addr);
+                    found_any = true;
+                } else if (addr % 16 == 0) {
+                    // Progress indicator
+                    ESP_LOGD(TAG, "  Scanning 0x%02X...", addr);
+                }
+            }
+            ESP_LOGI(TAG, "=========================");
+            ESP_LOGI(TAG, "");
+
+            if (!found_any) {
+                ESP_LOGE(TAG, "❌ NO I2C devices found on bus!");
+                ESP_LOGE(TAG, "");
+                ESP_LOGE(TAG, "Possible issues:");
+                ESP_LOGE(TAG, "  1. SDA/SCL pins swapped (try: SDA=18, SCL=19)");
+                ESP_LOGE(TAG, "  2. Missing pull-up resistors (add 4.7kΩ)");
+                ESP_LOGE(TAG, "  3. Display not powered (check 3.3V)");
+                ESP_LOGE(TAG, "  4. Loose wiring/bad connections");
+            } else {
+                ESP_LOGW(TAG, "Found I2C device(s) but not at expected OLED addresses");
+            }
+
+            // Don't fail - allow system to continue without display
+            ESP_LOGW(TAG, "Continuing without display...");
+            i2c_del_master_bus(bus_handle);
+            bus_handle = NULL;
+            return ESP_FAIL;
+        }
+    }
+
+    if (display_addr != OLED_I2C_ADDRESS) {
+        ESP_LOGI(TAG, "Using detected address 0x%02X instead of default 0x%02X",
+                 display_addr, OLED_I2C_ADDRESS);
+    }
+
+    // Attach the display as I2C device
+    i2c_device_config_t dev_config = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = display_addr,
+        .scl_speed_hz = config->freq_hz,
+    };
+    err = i2c_master_bus_add_device(bus_handle, &dev_config, &dev_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add display device: %s", esp_err_to_name(err));
+        i2c_del_master_bus(bus_handle);
+        bus_handle = NULL;
+        return err;
+    }
+
+#ifdef CONFIG_DISPLAY_ASYNC_FLUSH
+    i2c_master_event_callbacks_t callbacks = {
+        .on_trans_done = on_trans_done,
+    };
+    err = i2c_master_register_event_callbacks(dev_handle, &callbacks, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to register I2C callbacks: %s", esp_err_to_name(err));
+    }
+#endif
+
+    return ESP_OK;
+}
+
+/**
+ * Detach the display and delete the bus
+ */
+void oled_i2c_deinit(void)
+{
+    if (dev_handle) {
+        i2c_master_bus_rm_device(dev_handle);
+        dev_handle = NULL;
+    }
+    if (bus_handle) {
+        i2c_del_master_bus(bus_handle);
+        bus_handle = NULL;
+    }
+}
+
+/**
+ * Send one complete I2C transaction
+ */
+esp_err_t oled_i2c_transmit(const uint8_t *buf, size_t len)
+{
+    esp_err_t ret = i2c_master_transmit(dev_handle, buf, len, OLED_I2C_TIMEOUT_MS);
+    if (ret == ESP_OK) {
+        display_fb_count_bus_bytes(len + 1);  // + address byte
+    }
+    return ret;
+}
+
+/**
+ * Wait until all queued transfers are on the panel
+ */
+esp_err_t oled_i2c_wait_idle(uint32_t timeout_ms)
+{
+#ifdef CONFIG_DISPLAY_ASYNC_FLUSH
+    if (!bus_handle) {
+        return ESP_OK;
+    }
+
+    esp_err_t ret = i2c_master_bus_wait_all_done(bus_handle, timeout_ms);
+    if (atomic_exchange(&transfer_failed, false) && ret == ESP_OK) {
+        ret = ESP_FAIL;
+    }
+    return ret;
+#else
+    (void)timeout_ms;
+    return ESP_OK;
+#endif
+}
+
+/**
+ * Write a sequence of commands as one command stream
+ */
+esp_err_t oled_i2c_write_commands(const uint8_t *cmds, size_t len)
+{
+    uint8_t buf[1 + 32];
+    if (len > sizeof(buf) - 1) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    buf[0] = OLED_CTRL_CMD_STREAM;
+    memcpy(&buf[1], cmds, len);
+
+    esp_err_t prev_ret = oled_i2c_wait_idle(OLED_I2C_TIMEOUT_MS);
+    esp_err_t ret = oled_i2c_transmit(buf, len + 1);
+    // buf lives on the stack, so an async transfer must finish before returning
+    esp_err_t wait_ret = oled_i2c_wait_idle(OLED_I2C_TIMEOUT_MS);
+#ifdef CONFIG_DISPLAY_ASYNC_FLUSH
+    if (prev_ret != ESP_OK) {
+        // A queued frame failed, keep it reported for the next flush
+        atomic_store(&transfer_failed, true);
+    }
+#else
+    (void)prev_ret;
+#endif
+
+    return (ret != ESP_OK) ? ret : wait_ret;
+}
@@ -0,0 +1,158 @@
+/**
+ * SH1106 OLED Display Driver - Implementation
+ *
+ * Panel driver for SH1106 128x64 OLED displays via I2C. The SH1106 has
+ * 132 columns of RAM (the 128 visible ones start at column 2) and only
+ * supports page addressing, so every changed page is its own transaction.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#include "display_driver.h"
+#include "oled_i2c.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "SH1106";
+
+#define SH1106_WIDTH 128
+#define SH1106_PAGES 8
+#define SH1106_COLUMN_OFFSET 2      // Visible area within the 132 column RAM
+
+// Page/column address (3 command bytes, each behind OLED_CTRL_CMD_SINGLE) + OLED_CTRL_DATA_STREAM
+#define PAGE_HDR_LEN 7
+#define TX_BUF_LEN (SH1106_PAGES * (PAGE_HDR_LEN + SH1106_WIDTH))
+
+// SH1106 Commands
+#define SH1106_CMD_SET_LOW_COLUMN 0x00
+#define SH1106_CMD_SET_HIGH_COLUMN 0x10
+#define SH1106_CMD_SET_START_LINE 0x40
+#define SH1106_CMD_SET_CONTRAST 0x81
+#define SH1106_CMD_SEG_REMAP_NORMAL 0xA0
+#define SH1106_CMD_SEG_REMAP_FLIP 0xA1
+#define SH1106_CMD_DISPLAY_ALL_ON_RESUME 0xA4
+#define SH1106_CMD_NORMAL_DISPLAY 0xA6
+#define SH1106_CMD_SET_MULTIPLEX 0xA8
+#define SH1106_CMD_DCDC_MODE 0xAD
+#define SH1106_CMD_DISPLAY_OFF 0xAE
+#define SH1106_CMD_DISPLAY_ON 0xAF
+#define SH1106_CMD_SET_PAGE 0xB0
+#define SH1106_CMD_COM_SCAN_INC 0xC0
+#define SH1106_CMD_COM_SCAN_DEC 0xC8
+#define SH1106_CMD_SET_DISPLAY_OFFSET 0xD3
+#define SH1106_CMD_SET_DISPLAY_CLK_DIV 0xD5
+#define SH1106_CMD_SET_PRECHARGE 0xD9
+#define SH1106_CMD_SET_COM_PINS 0xDA
+#define SH1106_CMD_SET_VCOMH_DESELECT 0xDB
+
+// Staging buffer, one segment per page (see ssd1306.c)
+static uint8_t tx_buf[TX_BUF_LEN];
+
+/**
+ * Initialize SH1106 display
+ */
+static esp_err_t sh1106_init(const display_config_t *config)
+{
+    ESP_LOGI(TAG, "Initializing SH1106 128x64 (SDA:%d, SCL:%d, Freq:%lu Hz)...",
+             config->sda_pin, config->scl_pin, config->freq_hz);
+
+    esp_err_t err = oled_i2c_init(config, SH1106_PAGES);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    const uint8_t init_cmds[] = {
+        SH1106_CMD_DISPLAY_OFF,
+        SH1106_CMD_SET_DISPLAY_CLK_DIV, 0x80,
+        SH1106_CMD_SET_MULTIPLEX, 0x3F,             // 64 lines
+        SH1106_CMD_SET_DISPLAY_OFFSET, 0x00,
+        SH1106_CMD_SET_START_LINE | 0x00,
+        SH1106_CMD_DCDC_MODE, 0x8B,                 // Built-in DC-DC on
+#ifdef CONFIG_DISPLAY_ROTATION_180
+        SH1106_CMD_SEG_REMAP_NORMAL,
+        SH1106_CMD_COM_SCAN_INC,
+#else
+        SH1106_CMD_SEG_REMAP_FLIP,
+        SH1106_CMD_COM_SCAN_DEC,
+#endif
+        SH1106_CMD_SET_COM_PINS, 0x12,
+        SH1106_CMD_SET_CONTRAST, 0xCF,
+        SH1106_CMD_SET_PRECHARGE, 0x22,
+        SH1106_CMD_SET_VCOMH_DESELECT, 0x35,
+        SH1106_CMD_DISPLAY_ALL_ON_RESUME,
+        SH1106_CMD_NORMAL_DISPLAY,
+        SH1106_CMD_DISPLAY_ON,
+    };
+    err = oled_i2c_write_commands(init_cmds, sizeof(init_cmds));
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Init sequence failed: %s", esp_err_to_name(err));
+        oled_i2c_deinit();
+        return err;
+    }
+
+    ESP_LOGI(TAG, "SH1106 initialized successfully (128x64, 8 pages)");
+    return ESP_OK;
+}
+
+/**
+ * Send changed regions of a frame to the display (one transaction per page)
+ */
+static esp_err_t sh1106_flush(const uint8_t *frame, const uint8_t *span_x0, const uint8_t *span_x1)
+{
+    esp_err_t ret = ESP_OK;
+    size_t pos = 0;
+
+    for (uint8_t page = 0; page < SH1106_PAGES && ret == ESP_OK; page++) {
+        uint8_t x0 = span_x0[page];
+        uint8_t x1 = span_x1[page];
+        if (x0 > x1) {
+            continue;
+        }
+
+        uint8_t col = x0 + SH1106_COLUMN_OFFSET;
+        size_t width = x1 - x0 + 1;
+        uint8_t *seg = &tx_buf[pos];
+        seg[0] = OLED_CTRL_CMD_SINGLE;
+        seg[1] = SH1106_CMD_SET_PAGE | page;
+        seg[2] = OLED_CTRL_CMD_SINGLE;
+        seg[3] = SH1106_CMD_SET_LOW_COLUMN | (col & 0x0F);
+        seg[4] = OLED_CTRL_CMD_SINGLE;
+        seg[5] = SH1106_CMD_SET_HIGH_COLUMN | (col >> 4);
+        seg[6] = OLED_CTRL_DATA_STREAM;
+        memcpy(&seg[PAGE_HDR_LEN], &frame[page * SH1106_WIDTH + x0], width);
+
+        ret = oled_i2c_transmit(seg, PAGE_HDR_LEN + width);
+        pos += PAGE_HDR_LEN + width;
+    }
+    return ret;
+}
+
+/**
+ * Set display contrast
+ */
+static esp_err_t sh1106_set_contrast(uint8_t contrast)
+{
+    const uint8_t cmds[] = {SH1106_CMD_SET_CONTRAST, contrast};
+    return oled_i2c_write_commands(cmds, sizeof(cmds));
+}
+
+/**
+ * Turn display on/off
+ */
+static esp_err_t sh1106_set_power(bool on)
+{
+    const uint8_t cmd = on ? SH1106_CMD_DISPLAY_ON : SH1106_CMD_DISPLAY_OFF;
+    return oled_i2c_write_commands(&cmd, 1);
+}
+
+const display_driver_t display_driver_sh1106_128x64 = {
+    .name = "SH1106 128x64",
+    .width = SH1106_WIDTH,
+    .pages = SH1106_PAGES,
+    .init = sh1106_init,
+    .flush = sh1106_flush,
+    .set_contrast = sh1106_set_contrast,
+    .set_power = sh1106_set_power,
+    .wait_idle = oled_i2c_wait_idle,
+};
@@ -16,6 +16,9 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "nvs.h"
+#include "metrics.h"
 #include <string.h>
 
 static const char *TAG = "ESPNOW_MGR";
@@ -29,6 +32,127 @@ static espnow_recv_callback_t recv_callback = NULL;
 // Message queue (reserved for future use)
 static QueueHandle_t espnow_queue __attribute__((unused)) = NULL;
 
+// Per-peer traffic metrics (registered peers, broadcast and one "other" entry)
+#define PEER_METRICS_MAX (CONFIG_MAX_ESPNOW_PEERS + 2)
+
+typedef struct {
+    uint8_t mac[6];
+    atomic_bool ready;      // Metrics registered, entry may be used
+    metric_t *tx;           // Frames handed to the WiFi driver
+    metric_t *tx_failed;    // Send errors and unacknowledged frames
+    metric_t *rx;           // Valid frames received
+    metric_t *rx_dropped;   // Frames rejected (size or checksum)
+} peer_metrics_t;
+
+static peer_metrics_t peer_metrics[PEER_METRICS_MAX];
+static peer_metrics_t other_metrics;        // Unregistered senders and peers beyond the table
+static atomic_int peer_metrics_count = 0;   // Claimed entries
+static portMUX_TYPE peer_metrics_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Pairing beacon (main unit) and beacon scan (units)
+#define NVS_NAMESPACE "espnow"
+#define NVS_KEY_CHANNEL "channel"
+#define MAX_WIFI_CHANNEL 13
+
+static esp_timer_handle_t beacon_timer = NULL;
+static esp_timer_handle_t scan_timer = NULL;
+static portMUX_TYPE scan_lock = portMUX_INITIALIZER_UNLOCKED;
+static espnow_beacon_found_cb_t scan_found_cb = NULL;
+static bool scan_active = false;
+static bool scan_found = false;             // Beacon received, lock on in the timer callback
+static uint8_t scan_found_mac[6];
+static uint8_t scan_found_channel = 0;
+static uint8_t scan_order[MAX_WIFI_CHANNEL];
+static uint8_t scan_index = 0;
+static uint32_t scan_dwell_ms = 0;
+static int64_t scan_start_time = 0;
+static uint8_t cached_channel = 0;          // Last channel saved in NVS, 0 = none
+static metric_t *scan_time_metric = NULL;
+
+// Channel migration (main unit: ACK tracking, units: scheduled switch)
+#define MIGRATION_RETRY_MS      100         // Repeat the announcement to silent peers
+#define MIGRATION_MIN_LEAD_MS   20          // Don't announce a switch closer than this
+#define MIGRATION_VERIFY_MS     400         // Time for peers to answer on the new channel
+
+typedef struct {
+    uint8_t mac[6];
+    bool acked;
+} migration_peer_t;
+
+static migration_peer_t migration_peers[CONFIG_MAX_ESPNOW_PEERS];
+static size_t migration_peer_count = 0;
+static uint8_t migration_channel = 0;       // Channel being acknowledged, 0 = none
+static bool migration_busy = false;         // A migration is running
+static SemaphoreHandle_t migration_ack_sem = NULL;  // Given on every ACK
+static portMUX_TYPE migration_lock = portMUX_INITIALIZER_UNLOCKED;
+static metric_t *migration_metric = NULL;
+static metric_t *migration_stranded_metric = NULL;
+
+static esp_timer_handle_t switch_timer = NULL;
+static uint8_t switch_channel = 0;
+
+/**
+ * Register the four traffic metrics of an entry
+ */
+static void peer_metrics_register(peer_metrics_t *entry, const char *labels)
+{
+    entry->tx = metrics_register_counter("laser_espnow_tx_total", "ESP-NOW frames sent", labels);
+    entry->tx_failed = metrics_register_counter("laser_espnow_tx_failed_total", "ESP-NOW frames that failed to send", labels);
+    entry->rx = metrics_register_counter("laser_espnow_rx_total", "Valid ESP-NOW frames received", labels);
+    entry->rx_dropped = metrics_register_counter("laser_espnow_rx_dropped_total", "ESP-NOW frames dropped (bad size or checksum)", labels);
+    atomic_store_explicit(&entry->ready, true, memory_order_release);
+}
+
+/**
+ * Create the metrics entry for a peer (task context, on espnow_add_peer)
+ * Entries are never freed; a peer that is added again reuses its entry.
+ */
+static void peer_metrics_add(const uint8_t *mac)
+{
+    peer_metrics_t *entry = NULL;
+
+    taskENTER_CRITICAL(&peer_metrics_lock);
+    int count = atomic_load_explicit(&peer_metrics_count, memory_order_relaxed);
+    bool known = false;
+    for (int i = 0; i < count; i++) {
+        if (memcmp(peer_metrics[i].mac, mac, 6) == 0) {
+            known = true;
+            break;
+        }
+    }
+    if (!known && count < PEER_METRICS_MAX) {
+        entry = &peer_metrics[count];
+        memcpy(entry->mac, mac, 6);
+        atomic_store_explicit(&peer_metrics_count, count + 1, memory_order_release);
+    }
+    taskEXIT_CRITICAL(&peer_metrics_lock);
+
+    if (entry) {
+        char labels[METRICS_LABELS_LEN];
+        snprintf(labels, sizeof(labels), "peer=\"%02X:%02X:%02X:%02X:%02X:%02X\"",
+                 mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+        peer_metrics_register(entry, labels);
+    } else if (!known) {
+        ESP_LOGW(TAG, "Peer metrics table full, counting peer as \"other\"");
+    }
+}
+
+/**
+ * Find the metrics entry for a peer (lock-free, safe in WiFi callbacks)
+ * Unknown MACs share the "other" entry.
+ */
+static peer_metrics_t *peer_metrics_get(const uint8_t *mac)
+{
+    int count = atomic_load_explicit(&peer_metrics_count, memory_order_acquire);
+    for (int i = 0; i < count; i++) {
+        if (atomic_load_explicit(&peer_metrics[i].ready, memory_order_acquire) &&
+            memcmp(peer_metrics[i].mac, mac, 6) == 0) {
+            return &peer_metrics[i];
+        }
+    }
+    return &other_metrics;
+}
+
 /**
  * ESP-NOW send callback
  * Note: IDF 5.5+ uses wifi_tx_info_t instead of mac_addr
@@ -39,6 +163,56 @@ static void espnow_send_cb(const wifi_tx_info_t *tx_info, esp_now_send_status_t
         ESP_LOGD(TAG, "Message sent successfully");
     } else {
         ESP_LOGW(TAG, "Message send failed");
+        peer_metrics_t *pm = tx_info ? peer_metrics_get(tx_info->des_addr) : &other_metrics;
+        metrics_inc(pm->tx_failed);
+    }
+}
+
+/**
+ * Record a received pairing beacon (WiFi task)
+ * Channel switching stays in the scan timer callback, so only the
+ * timer is re-armed here.
+ */
+static void scan_handle_beacon(const uint8_t *src_mac, const espnow_message_t *msg)
+{
+    bool lock_on = false;
+    
+    portENTER_CRITICAL(&scan_lock);
+    if (scan_active && !scan_found) {
+        scan_found = true;
+        memcpy(scan_found_mac, src_mac, 6);
+        scan_found_channel = msg->data[0];
+        lock_on = true;
+    }
+    portEXIT_CRITICAL(&scan_lock);
+    
+    if (lock_on) {
+        esp_timer_stop(scan_timer);
+        esp_timer_start_once(scan_timer, 0);
+    }
+}
+
+/**
+ * Mark a peer as acknowledged for the running migration (WiFi task)
+ */
+static void migration_handle_ack(const uint8_t *src_mac, const espnow_message_t *msg)
+{
+    bool acked = false;
+    
+    portENTER_CRITICAL(&migration_lock);
+    if (migration_channel && msg->data[0] == migration_channel) {
+        for (size_t i = 0; i < migration_peer_count; i++) {
+            if (!migration_peers[i].acked && memcmp(migration_peers[i].mac, src_mac, 6) == 0) {
+                migration_peers[i].acked = true;
+                acked = true;
+                break;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&migration_lock);
+    
+    if (acked) {
+        xSemaphoreGive(migration_ack_sem);
     }
 }
 
@@ -49,6 +223,7 @@ static void espnow_recv_cb(const esp_now_recv_info_t *esp_now_info, const uint8_
 {
     if (data_len != sizeof(espnow_message_t)) {
         ESP_LOGW(TAG, "Invalid message size: %d", data_len);
+        metrics_inc(other_metrics.rx_dropped);
         return;
     }
     
@@ -58,12 +233,25 @@ static void espnow_recv_cb(const esp_now_recv_info_t *esp_now_info, const uint8_
     uint16_t calc_checksum = esp_crc16_le(0, data, sizeof(espnow_message_t) - 2);
     if (calc_checksum != msg->checksum) {
         ESP_LOGW(TAG, "Checksum mismatch");
+        metrics_inc(peer_metrics_get(esp_now_info->src_addr)->rx_dropped);
         return;
     }
     
+    metrics_inc(peer_metrics_get(esp_now_info->src_addr)->rx);
+    
     ESP_LOGD(TAG, "Received message type 0x%02X from module %d", 
              msg->msg_type, msg->module_id);
     
+    // Beacons only matter to a running scan, don't pass them on
+    if (msg->msg_type == MSG_PAIRING_BEACON) {
+        scan_handle_beacon(esp_now_info->src_addr, msg);
+        return;
+    }
+    
+    if (msg->msg_type == MSG_CHANNEL_ACK) {
+        migration_handle_ack(esp_now_info->src_addr, msg);
+    }
+    
     // Call user callback if registered
     if (recv_callback) {
         recv_callback(esp_now_info->src_addr, msg);
@@ -80,6 +268,11 @@ esp_err_t espnow_manager_init(uint8_t channel, espnow_recv_callback_t callback)
     // Store callback
     recv_callback = callback;
     
+    if (!atomic_load(&other_metrics.ready)) {
+        peer_metrics_register(&other_metrics, "peer=\"other\"");
+        peer_metrics_add(broadcast_mac);
+    }
+    
     // WiFi should already be initialized by wifi_ap_manager
     // Get the current WiFi channel instead of trying to set it
     uint8_t current_channel = 0;
@@ -158,10 +351,13 @@ esp_err_t espnow_send_message(const uint8_t *dest_mac, espnow_msg_type_t msg_typ
     const uint8_t *target_mac = dest_mac ? dest_mac : broadcast_mac;
     esp_err_t err = esp_now_send(target_mac, (uint8_t *)&msg, sizeof(espnow_message_t));
     
+    peer_metrics_t *pm = peer_metrics_get(target_mac);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to send message: %s", esp_err_to_name(err));
+        metrics_inc(pm->tx_failed);
         return err;
     }
+    metrics_inc(pm->tx);
     
     ESP_LOGD(TAG, "Sent message type 0x%02X", msg_type);
     
@@ -214,6 +410,8 @@ esp_err_t espnow_add_peer(const uint8_t *mac_addr, uint8_t module_id, uint8_t mo
         return err;
     }
     
+    peer_metrics_add(mac_addr);
+    
     ESP_LOGI(TAG, "Added peer: Module ID %d, Role %d", module_id, module_role);
     
     return ESP_OK;
@@ -352,27 +550,24 @@ esp_err_t espnow_change_channel(uint8_t new_channel)
     
     ESP_LOGI(TAG, "Changing WiFi/ESP-NOW channel to %d", new_channel);
     
-    // Remove old broadcast peer
-    esp_err_t ret = esp_now_del_peer(broadcast_mac);
-    if (ret != ESP_OK && ret != ESP_ERR_ESPNOW_NOT_FOUND) {
-        ESP_LOGW(TAG, "Failed to remove broadcast peer: %s", esp_err_to_name(ret));
-    }
-    
     // Change WiFi channel
-    ret = esp_wifi_set_channel(new_channel, WIFI_SECOND_CHAN_NONE);
+    esp_err_t ret = esp_wifi_set_channel(new_channel, WIFI_SECOND_CHAN_NONE);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to change WiFi channel: %s", esp_err_to_name(ret));
         return ret;
     }
     
-    // Add broadcast peer on new channel
+    // Move the broadcast peer in place (re-add it if it is missing)
     esp_now_peer_info_t peer_info = {0};
     memcpy(peer_info.peer_addr, broadcast_mac, 6);
     peer_info.channel = new_channel;
     peer_info.ifidx = WIFI_IF_STA;
     peer_info.encrypt = false;
     
-    ret = esp_now_add_peer(&peer_info);
+    ret = esp_now_mod_peer(&peer_info);
+    if (ret == ESP_ERR_ESPNOW_NOT_FOUND) {
+        ret = esp_now_add_peer(&peer_info);
+    }
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to add broadcast peer on channel %d: %s", 
                  new_channel, esp_err_to_name(ret));
@@ -384,33 +579,439 @@ esp_err_t espnow_change_channel(uint8_t new_channel)
 }
 
 /**
- * Broadcast channel change to all peers and wait for acknowledgement
+ * Announce a channel change to every peer that has not acknowledged yet
  */
-esp_err_t espnow_broadcast_channel_change(uint8_t new_channel, uint32_t timeout_ms)
+static size_t migration_announce(uint8_t new_channel, uint32_t delay_ms)
 {
-    if (new_channel < 1 || new_channel > 13) {
+    uint8_t data[3] = {new_channel, delay_ms & 0xFF, (delay_ms >> 8) & 0xFF};
+    size_t pending = 0;
+    
+    for (size_t i = 0; i < migration_peer_count; i++) {
+        portENTER_CRITICAL(&migration_lock);
+        bool acked = migration_peers[i].acked;
+        portEXIT_CRITICAL(&migration_lock);
+        if (!acked) {
+            espnow_send_message(migration_peers[i].mac, MSG_CHANNEL_CHANGE, data, sizeof(data));
+            pending++;
+        }
+    }
+    return pending;
+}
+
+/**
+ * Wait until all peers acknowledged or the time is up
+ */
+static size_t migration_wait_acks(int64_t until_us)
+{
+    for (;;) {
+        size_t pending = 0;
+        portENTER_CRITICAL(&migration_lock);
+        for (size_t i = 0; i < migration_peer_count; i++) {
+            pending += migration_peers[i].acked ? 0 : 1;
+        }
+        portEXIT_CRITICAL(&migration_lock);
+        
+        int64_t left_ms = (until_us - esp_timer_get_time()) / 1000;
+        if (pending == 0 || left_ms <= 0) {
+            return pending;
+        }
+        xSemaphoreTake(migration_ack_sem, pdMS_TO_TICKS(left_ms));
+    }
+}
+
+/**
+ * Move all peers to a new channel (main unit)
+ */
+esp_err_t espnow_broadcast_channel_change(uint8_t new_channel, uint32_t switch_delay_ms)
+{
+    if (new_channel < 1 || new_channel > 13 || switch_delay_ms > UINT16_MAX) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    ESP_LOGI(TAG, "Broadcasting channel change to %d (timeout: %lu ms)", new_channel, timeout_ms);
+    if (!migration_ack_sem) {
+        migration_ack_sem = xSemaphoreCreateBinary();
+        if (!migration_ack_sem) {
+            return ESP_ERR_NO_MEM;
+        }
+        migration_metric = metrics_register_counter("laser_espnow_channel_migrations_total",
+                                                    "Coordinated ESP-NOW channel changes", NULL);
+        migration_stranded_metric = metrics_register_gauge("laser_espnow_migration_stranded",
+                                                           "Peers not reachable after the last channel change", NULL);
+    }
     
-    // Prepare channel change message
-    uint8_t data[1] = {new_channel};
+    portENTER_CRITICAL(&migration_lock);
+    bool busy = migration_busy;
+    migration_busy = true;
+    portEXIT_CRITICAL(&migration_lock);
+    if (busy) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // Drop a give left over from a late ACK of the previous migration
+    xSemaphoreTake(migration_ack_sem, 0);
+    
+    // Registry: every unicast peer known to ESP-NOW
+    esp_now_peer_info_t peer;
+    size_t count = 0;
+    for (esp_err_t ret = esp_now_fetch_peer(true, &peer);
+         ret == ESP_OK && count < CONFIG_MAX_ESPNOW_PEERS;
+         ret = esp_now_fetch_peer(false, &peer)) {
+        if (memcmp(peer.peer_addr, broadcast_mac, 6) != 0) {
+            memcpy(migration_peers[count].mac, peer.peer_addr, 6);
+            migration_peers[count].acked = false;
+            count++;
+        }
+    }
+    
+    portENTER_CRITICAL(&migration_lock);
+    migration_peer_count = count;
+    migration_channel = new_channel;
+    portEXIT_CRITICAL(&migration_lock);
+    metrics_inc(migration_metric);
+    
+    ESP_LOGI(TAG, "Moving %d peers to channel %d in %lu ms", (int)count, new_channel, switch_delay_ms);
+    
+    // Phase 1: announce the switch time, repeat to peers that stay silent
+    int64_t switch_at = esp_timer_get_time() + (int64_t)switch_delay_ms * 1000;
+    size_t pending = count;
+    while (pending > 0) {
+        int64_t left_ms = (switch_at - esp_timer_get_time()) / 1000;
+        if (left_ms < MIGRATION_MIN_LEAD_MS) {
+            break;
+        }
+        migration_announce(new_channel, (uint32_t)left_ms);
+        int64_t retry_at = esp_timer_get_time() + MIGRATION_RETRY_MS * 1000;
+        pending = migration_wait_acks(retry_at < switch_at ? retry_at : switch_at);
+    }
+    if (pending > 0) {
+        ESP_LOGW(TAG, "%d peers did not acknowledge the channel change", (int)pending);
+    }
+    
+    // Switch together with the peers
+    int64_t wait_us = switch_at - esp_timer_get_time();
+    if (wait_us > 0) {
+        vTaskDelay(pdMS_TO_TICKS(wait_us / 1000));
+    }
+    esp_err_t ret = espnow_change_channel(new_channel);
+    if (ret == ESP_OK) {
+        espnow_update_all_peers_channel(new_channel);
+    }
+    
+    // Phase 2: every peer has to answer on the new channel
+    portENTER_CRITICAL(&migration_lock);
+    for (size_t i = 0; i < migration_peer_count; i++) {
+        migration_peers[i].acked = false;
+    }
+    portEXIT_CRITICAL(&migration_lock);
+    
+    int64_t verify_until = esp_timer_get_time() + MIGRATION_VERIFY_MS * 1000;
+    pending = count;
+    while (pending > 0 && esp_timer_get_time() < verify_until) {
+        migration_announce(new_channel, 0);
+        int64_t retry_at = esp_timer_get_time() + MIGRATION_RETRY_MS * 1000;
+        pending = migration_wait_acks(retry_at < verify_until ? retry_at : verify_until);
+    }
+    
+    portENTER_CRITICAL(&migration_lock);
+    migration_channel = 0;
+    migration_busy = false;
+    portEXIT_CRITICAL(&migration_lock);
+    metrics_set(migration_stranded_metric, (int32_t)pending);
+    
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    for (size_t i = 0; i < migration_peer_count && pending > 0; i++) {
+        if (!migration_peers[i].acked) {
+            const uint8_t *m = migration_peers[i].mac;
+            ESP_LOGW(TAG, "Peer %02X:%02X:%02X:%02X:%02X:%02X not reachable on channel %d",
+                     m[0], m[1], m[2], m[3], m[4], m[5], new_channel);
+        }
+    }
+    ESP_LOGI(TAG, "Channel change to %d complete, %d of %d peers verified",
+             new_channel, (int)(count - pending), (int)count);
+    return pending ? ESP_ERR_TIMEOUT : ESP_OK;
+}
+
+/**
+ * Switch timer callback (units)
+ */
+static void switch_timer_callback(void *arg)
+{
+    uint8_t channel = switch_channel;
+    if (espnow_change_channel(channel) == ESP_OK) {
+        espnow_update_all_peers_channel(channel);
+        espnow_save_channel();
+    }
+}
+
+/**
+ * Handle a MSG_CHANNEL_CHANGE from the main unit (units)
+ */
+esp_err_t espnow_handle_channel_change(const uint8_t *sender_mac, const espnow_message_t *message)
+{
+    uint8_t new_channel = message->data[0];
+    uint32_t delay_ms = message->data[1] | (message->data[2] << 8);
+    if (new_channel < 1 || new_channel > 13) {
+        return ESP_ERR_INVALID_ARG;
+    }
     
-    // Send broadcast 3 times for reliability
-    for (int i = 0; i < 3; i++) {
-        esp_err_t ret = espnow_broadcast_message(MSG_CHANNEL_CHANGE, data, sizeof(data));
+    if (!switch_timer) {
+        const esp_timer_create_args_t switch_timer_args = {
+            .callback = &switch_timer_callback,
+            .name = "espnow_switch"
+        };
+        esp_err_t ret = esp_timer_create(&switch_timer_args, &switch_timer);
         if (ret != ESP_OK) {
-            ESP_LOGW(TAG, "Failed to broadcast channel change (attempt %d)", i + 1);
+            return ret;
         }
-        vTaskDelay(pdMS_TO_TICKS(100)); // Wait 100ms between broadcasts
     }
     
-    // Give peers time to process and switch
-    ESP_LOGI(TAG, "Waiting %lu ms for peers to acknowledge channel change...", timeout_ms);
-    vTaskDelay(pdMS_TO_TICKS(timeout_ms));
+    // The main unit decides the channel now
+    espnow_scan_stop();
     
-    ESP_LOGI(TAG, "Channel change broadcast complete");
+    uint8_t current_channel = 0;
+    wifi_second_chan_t second;
+    esp_wifi_get_channel(&current_channel, &second);
+    
+    esp_timer_stop(switch_timer);
+    if (new_channel != current_channel) {
+        switch_channel = new_channel;
+        if (delay_ms == 0) {
+            // Immediate switch, ACK goes out on the new channel
+            switch_timer_callback(NULL);
+        } else {
+            ESP_LOGI(TAG, "Switching to channel %d in %lu ms", new_channel, delay_ms);
+            esp_timer_start_once(switch_timer, (uint64_t)delay_ms * 1000);
+        }
+    }
+    
+    // Unicast if the main unit is a peer, broadcast otherwise
+    uint8_t ack = new_channel;
+    if (espnow_send_message(sender_mac, MSG_CHANNEL_ACK, &ack, sizeof(ack)) != ESP_OK) {
+        espnow_broadcast_message(MSG_CHANNEL_ACK, &ack, sizeof(ack));
+    }
     return ESP_OK;
 }
 
+/**
+ * Beacon timer callback (main unit)
+ */
+static void beacon_timer_callback(void *arg)
+{
+    uint8_t channel = 0;
+    wifi_second_chan_t second;
+    if (esp_wifi_get_channel(&channel, &second) != ESP_OK) {
+        return;
+    }
+    espnow_broadcast_message(MSG_PAIRING_BEACON, &channel, sizeof(channel));
+}
+
+/**
+ * Start broadcasting pairing beacons (main unit)
+ */
+esp_err_t espnow_beacon_start(uint32_t interval_ms)
+{
+    if (!beacon_timer) {
+        const esp_timer_create_args_t beacon_timer_args = {
+            .callback = &beacon_timer_callback,
+            .name = "espnow_beacon"
+        };
+        esp_err_t ret = esp_timer_create(&beacon_timer_args, &beacon_timer);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    
+    esp_timer_stop(beacon_timer);
+    ESP_LOGI(TAG, "Pairing beacon every %lu ms", interval_ms);
+    return esp_timer_start_periodic(beacon_timer, (uint64_t)interval_ms * 1000);
+}
+
+/**
+ * Stop broadcasting pairing beacons
+ */
+void espnow_beacon_stop(void)
+{
+    if (beacon_timer) {
+        esp_timer_stop(beacon_timer);
+    }
+}
+
+/**
+ * Read the cached channel from NVS
+ */
+static uint8_t load_cached_channel(void)
+{
+    nvs_handle_t handle;
+    uint8_t channel = 0;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK) {
+        nvs_get_u8(handle, NVS_KEY_CHANNEL, &channel);
+        nvs_close(handle);
+    }
+    return (channel >= 1 && channel <= MAX_WIFI_CHANNEL) ? channel : 0;
+}
+
+/**
+ * Scan timer callback (units)
+ * Hops to the next channel after each dwell, or locks onto the channel
+ * announced by a received beacon.
+ */
+static void scan_timer_callback(void *arg)
+{
+    uint8_t mac[6];
+    uint8_t channel;
+    bool found, active;
+    
+    portENTER_CRITICAL(&scan_lock);
+    found = scan_found;
+    active = scan_active;
+    memcpy(mac, scan_found_mac, 6);
+    channel = scan_found_channel;
+    if (found) {
+        scan_active = false;
+        scan_found = false;
+    }
+    portEXIT_CRITICAL(&scan_lock);
+    
+    if (found) {
+        // The beacon may have leaked over from an adjacent channel
+        if (channel < 1 || channel > MAX_WIFI_CHANNEL) {
+            channel = scan_order[scan_index];
+        }
+        espnow_change_channel(channel);
+        
+        int64_t elapsed_ms = (esp_timer_get_time() - scan_start_time) / 1000;
+        metrics_set(scan_time_metric, (int32_t)elapsed_ms);
+        ESP_LOGI(TAG, "Main unit found on channel %d after %lld ms", channel, elapsed_ms);
+        
+        if (scan_found_cb) {
+            scan_found_cb(mac, channel);
+        }
+        return;
+    }
+    
+    if (!active) {
+        return;
+    }
+    
+    // No beacon on this channel, dwell on the next one (WiFi channel only,
+    // the broadcast peer is moved once the main unit is found)
+    scan_index = (scan_index + 1) % MAX_WIFI_CHANNEL;
+    if (scan_index == 0) {
+        ESP_LOGI(TAG, "No beacon on any channel, scanning again");
+    }
+    esp_wifi_set_channel(scan_order[scan_index], WIFI_SECOND_CHAN_NONE);
+    ESP_LOGD(TAG, "Listening for beacon on channel %d", scan_order[scan_index]);
+    esp_timer_start_once(scan_timer, (uint64_t)scan_dwell_ms * 1000);
+}
+
+/**
+ * Scan for the main unit's pairing beacon (units)
+ */
+esp_err_t espnow_scan_start(uint32_t dwell_ms, espnow_beacon_found_cb_t found_cb)
+{
+    if (!scan_timer) {
+        const esp_timer_create_args_t scan_timer_args = {
+            .callback = &scan_timer_callback,
+            .name = "espnow_scan"
+        };
+        esp_err_t ret = esp_timer_create(&scan_timer_args, &scan_timer);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        scan_time_metric = metrics_register_gauge("laser_espnow_pairing_scan_ms",
+                                                  "Time the last beacon scan took to find the main unit", NULL);
+        cached_channel = load_cached_channel();
+    }
+    
+    esp_timer_stop(scan_timer);
+    
+    // Last known channel first, then the rest in ascending order
+    uint8_t first = cached_channel ? cached_channel : CONFIG_ESPNOW_CHANNEL;
+    int n = 0;
+    scan_order[n++] = first;
+    for (uint8_t ch = 1; ch <= MAX_WIFI_CHANNEL; ch++) {
+        if (ch != first) {
+            scan_order[n++] = ch;
+        }
+    }
+    
+    portENTER_CRITICAL(&scan_lock);
+    scan_found_cb = found_cb;
+    scan_dwell_ms = dwell_ms;
+    scan_index = 0;
+    scan_found = false;
+    scan_active = true;
+    portEXIT_CRITICAL(&scan_lock);
+    
+    scan_start_time = esp_timer_get_time();
+    ESP_LOGI(TAG, "Scanning for main unit beacon, starting on channel %d (%s)",
+             first, cached_channel ? "cached" : "default");
+    
+    esp_err_t ret = esp_wifi_set_channel(first, WIFI_SECOND_CHAN_NONE);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to set channel %d: %s", first, esp_err_to_name(ret));
+    }
+    return esp_timer_start_once(scan_timer, (uint64_t)dwell_ms * 1000);
+}
+
+/**
+ * Stop a running beacon scan
+ */
+void espnow_scan_stop(void)
+{
+    portENTER_CRITICAL(&scan_lock);
+    scan_active = false;
+    scan_found = false;
+    portEXIT_CRITICAL(&scan_lock);
+    
+    if (scan_timer) {
+        esp_timer_stop(scan_timer);
+    }
+}
+
+/**
+ * Check if a beacon scan is running
+ */
+bool espnow_scan_is_active(void)
+{
+    portENTER_CRITICAL(&scan_lock);
+    bool active = scan_active || scan_found;
+    portEXIT_CRITICAL(&scan_lock);
+    return active;
+}
+
+/**
+ * Remember the current channel in NVS for the next scan
+ */
+esp_err_t espnow_save_channel(void)
+{
+    uint8_t channel = 0;
+    wifi_second_chan_t second;
+    esp_err_t ret = esp_wifi_get_channel(&channel, &second);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (channel == cached_channel) {
+        return ESP_OK;
+    }
+    
+    nvs_handle_t handle;
+    ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ret = nvs_set_u8(handle, NVS_KEY_CHANNEL, channel);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    
+    if (ret == ESP_OK) {
+        cached_channel = channel;
+        ESP_LOGI(TAG, "Channel %d cached for the next pairing scan", channel);
+    }
+    return ret;
+}
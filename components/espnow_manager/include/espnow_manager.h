@@ -33,13 +33,27 @@ typedef enum {
     MSG_PAIRING_RESPONSE = 0x08,    // Response to pairing request
     MSG_LASER_ON = 0x09,            // Turn laser on
     MSG_LASER_OFF = 0x0A,           // Turn laser off
-    MSG_SENSOR_CALIBRATE = 0x0B,    // Calibrate sensor
+    MSG_SENSOR_CALIBRATE = 0x0B,    // Calibrate sensor (data[0..1] = levels per phase LE, 0 = unit default)
     MSG_RESET = 0x0C,               // Reset module
-    MSG_CHANNEL_CHANGE = 0x0D,      // WiFi channel change notification
-    MSG_CHANNEL_ACK = 0x0E,         // Channel change acknowledgement
-    MSG_FINISH_PRESSED = 0x0F       // Finish button pressed (game completed)
+    MSG_CHANNEL_CHANGE = 0x0D,      // WiFi channel change (data[0] = channel, data[1..2] = switch delay ms LE)
+    MSG_CHANNEL_ACK = 0x0E,         // Channel change acknowledgement (data[0] = channel)
+    MSG_FINISH_PRESSED = 0x0F,      // Finish button pressed (data[0..3] = us since the press, LE)
+    MSG_PAIRING_BEACON = 0x10,      // Main unit presence beacon (data[0] = channel)
+    MSG_SENSOR_CAL_RESULT = 0x11,   // Calibration result (data[0] = sensor_cal_status_t, then LE u16:
+                                    // threshold, hysteresis, off mean, off stddev, on mean, on stddev, separation x10)
+    MSG_SENSOR_TRACE = 0x12         // Raw sensor trace frame (see sensor_trace.h)
 } espnow_msg_type_t;
 
+/**
+ * Sensor calibration status (MSG_SENSOR_CAL_RESULT data[0])
+ */
+typedef enum {
+    SENSOR_CAL_OK = 0,              // Threshold applied and saved
+    SENSOR_CAL_POOR_SEPARATION,     // Laser on/off too close together, old threshold kept
+    SENSOR_CAL_FAILED,              // Measurement failed
+    SENSOR_CAL_BUSY                 // Game running or calibration already in progress
+} sensor_cal_status_t;
+
 /**
  * ESP-NOW message structure
  */
@@ -63,6 +77,16 @@ typedef struct {
     bool is_paired;                 // Is peer paired
 } espnow_peer_info_t;
 
+/**
+ * Pairing beacon found callback (units)
+ * 
+ * Called once the scan has locked onto the main unit's channel.
+ * 
+ * @param main_mac MAC address of the main unit
+ * @param channel Channel the unit is now on
+ */
+typedef void (*espnow_beacon_found_cb_t)(const uint8_t *main_mac, uint8_t channel);
+
 /**
  * Message received callback
  * 
@@ -164,13 +188,87 @@ esp_err_t espnow_update_all_peers_channel(uint8_t new_channel);
 esp_err_t espnow_change_channel(uint8_t new_channel);
 
 /**
- * Broadcast channel change to all peers and wait for acknowledgement
+ * Move all peers to a new channel (main unit)
+ * 
+ * Announces the channel and a switch time to every registered peer,
+ * repeats the announcement to peers that have not acknowledged yet,
+ * switches this unit at the same instant and then checks that each
+ * peer answers on the new channel. Blocks for about switch_delay_ms
+ * plus the verification round. ACKs are tracked with a semaphore owned
+ * by the manager, the caller's task notifications are not touched.
+ * 
+ * @param new_channel New channel (1-13)
+ * @param switch_delay_ms Time from the first announcement to the switch
+ * @return ESP_OK if all peers answered on the new channel,
+ *         ESP_ERR_TIMEOUT if some peers were left behind,
+ *         ESP_ERR_INVALID_STATE if another migration is running
+ */
+esp_err_t espnow_broadcast_channel_change(uint8_t new_channel, uint32_t switch_delay_ms);
+
+/**
+ * Handle a MSG_CHANNEL_CHANGE from the main unit (units)
+ * 
+ * Acknowledges the request and switches at the announced time. The
+ * new channel is cached for the next pairing scan.
+ * 
+ * @param sender_mac MAC address of the main unit
+ * @param message Received MSG_CHANNEL_CHANGE
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a bad channel
+ */
+esp_err_t espnow_handle_channel_change(const uint8_t *sender_mac, const espnow_message_t *message);
+
+/**
+ * Start broadcasting pairing beacons (main unit)
+ * 
+ * The beacon carries the current channel so units that pick it up
+ * from an adjacent channel switch to the right one. Calling it again
+ * changes the interval of a running beacon.
+ * 
+ * @param interval_ms Beacon interval in milliseconds
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t espnow_beacon_start(uint32_t interval_ms);
+
+/**
+ * Stop broadcasting pairing beacons
+ */
+void espnow_beacon_stop(void);
+
+/**
+ * Scan for the main unit's pairing beacon (units)
+ * 
+ * Listens for dwell_ms on each channel, starting with the channel
+ * cached in NVS, until a beacon is received. The callback runs in the
+ * esp_timer task like any timer callback: it must not block or wait,
+ * only queue work (e.g. one espnow_broadcast_message() with the pairing
+ * request) or hand off to a task.
+ * 
+ * @param dwell_ms Listen time per channel in milliseconds
+ * @param found_cb Called when the main unit was found
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t espnow_scan_start(uint32_t dwell_ms, espnow_beacon_found_cb_t found_cb);
+
+/**
+ * Stop a running beacon scan
+ */
+void espnow_scan_stop(void);
+
+/**
+ * Check if a beacon scan is running
+ * 
+ * @return true while scanning
+ */
+bool espnow_scan_is_active(void);
+
+/**
+ * Remember the current channel in NVS for the next scan
+ * 
+ * Only writes when the channel differs from the cached one.
  * 
- * @param new_channel New channel to broadcast
- * @param timeout_ms Timeout in milliseconds to wait for ACKs
  * @return ESP_OK on success, error code otherwise
  */
-esp_err_t espnow_broadcast_channel_change(uint8_t new_channel, uint32_t timeout_ms);
+esp_err_t espnow_save_channel(void);
 
 #ifdef __cplusplus
 }
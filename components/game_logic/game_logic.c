@@ -9,6 +9,7 @@
 
 #include "game_logic.h"
 #include "espnow_manager.h"
+#include "metrics.h"
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_timer.h"
@@ -43,6 +44,45 @@ static int countdown_remaining = 0;
 // Mutex for thread-safe access
 static SemaphoreHandle_t game_mutex = NULL;
 
+// Game event listener
+static game_event_callback_t event_callback = NULL;
+
+// Mutex contention metrics
+static metric_t *m_lock_count = NULL;
+static metric_t *m_lock_wait_ms = NULL;
+static metric_t *m_lock_wait_max_us = NULL;
+static metric_t *m_lock_timeouts = NULL;
+
+/**
+ * Take the game mutex and account the time spent waiting for it
+ */
+static BaseType_t game_lock(TickType_t timeout)
+{
+    int64_t start = esp_timer_get_time();
+    BaseType_t ret = xSemaphoreTake(game_mutex, timeout);
+    int32_t waited = (int32_t)(esp_timer_get_time() - start);
+    
+    if (ret == pdTRUE) {
+        metrics_inc(m_lock_count);
+        metrics_add_us(m_lock_wait_ms, waited);
+        metrics_max(m_lock_wait_max_us, waited);
+    } else {
+        metrics_inc(m_lock_timeouts);
+    }
+    return ret;
+}
+
+/**
+ * Report a game event (called without the game mutex held)
+ */
+static void emit_event(game_event_t event, uint32_t value)
+{
+    game_event_callback_t cb = event_callback;
+    if (cb) {
+        cb(event, value);
+    }
+}
+
 /**
  * Initialize game logic component
  */
@@ -57,6 +97,11 @@ esp_err_t game_logic_init(void)
         return ESP_FAIL;
     }
     
+    m_lock_count = metrics_register_counter("laser_game_mutex_acquired_total", "Game mutex acquisitions", NULL);
+    m_lock_wait_ms = metrics_register_counter("laser_game_mutex_wait_ms_total", "Total time spent waiting for the game mutex", NULL);
+    m_lock_wait_max_us = metrics_register_gauge("laser_game_mutex_wait_max_us", "Longest wait for the game mutex", NULL);
+    m_lock_timeouts = metrics_register_counter("laser_game_mutex_timeouts_total", "Game mutex acquisitions that timed out", NULL);
+    
     // Initialize game state
     current_state = GAME_STATE_IDLE;
     memset(&current_player, 0, sizeof(player_data_t));
@@ -67,13 +112,21 @@ esp_err_t game_logic_init(void)
     return ESP_OK;
 }
 
+/**
+ * Set the callback for game events
+ */
+void game_set_event_callback(game_event_callback_t callback)
+{
+    event_callback = callback;
+}
+
 /**
  * Countdown timer callback
- * Fires every second during countdown, plays buzzer and transitions to RUNNING when done
+ * Fires every second during countdown, reports each tick and transitions to RUNNING when done
  */
 static void countdown_timer_callback(void *arg)
 {
-    if (xSemaphoreTake(game_mutex, 0) != pdTRUE) {
+    if (game_lock(0) != pdTRUE) {
         return;  // Skip this tick if we can't get mutex
     }
     
@@ -96,6 +149,7 @@ static void countdown_timer_callback(void *arg)
         current_state = GAME_STATE_RUNNING;
         
         xSemaphoreGive(game_mutex);
+        emit_event(GAME_EVENT_RUNNING, 0);
         
         // Send MSG_GAME_START to all registered laser units
         ESP_LOGI(TAG, "Sending MSG_GAME_START to all laser units");
@@ -114,7 +168,9 @@ static void countdown_timer_callback(void *arg)
             }
         }
     } else {
+        int remaining = countdown_remaining;
         xSemaphoreGive(game_mutex);
+        emit_event(GAME_EVENT_COUNTDOWN_TICK, remaining);
     }
 }
 
@@ -123,7 +179,7 @@ static void countdown_timer_callback(void *arg)
  */
 esp_err_t game_start(game_mode_t mode, const char *player_name)
 {
-    if (xSemaphoreTake(game_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+    if (game_lock(pdMS_TO_TICKS(1000)) != pdTRUE) {
         ESP_LOGE(TAG, "Failed to acquire mutex");
         return ESP_FAIL;
     }
@@ -195,6 +251,9 @@ esp_err_t game_start(game_mode_t mode, const char *player_name)
         return ret;
     }
     
+    emit_event(GAME_EVENT_STARTED, 0);
+    emit_event(GAME_EVENT_COUNTDOWN_TICK, CONFIG_COUNTDOWN_DURATION);
+    
     return ESP_OK;
 }
 
@@ -203,7 +262,15 @@ esp_err_t game_start(game_mode_t mode, const char *player_name)
  */
 esp_err_t game_finish(void)
 {
-    if (xSemaphoreTake(game_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+    return game_finish_at((uint32_t)(esp_timer_get_time() / 1000));
+}
+
+/**
+ * Finish the current game at a given time
+ */
+esp_err_t game_finish_at(uint32_t end_time_ms)
+{
+    if (game_lock(pdMS_TO_TICKS(1000)) != pdTRUE) {
         ESP_LOGE(TAG, "Failed to acquire mutex");
         return ESP_FAIL;
     }
@@ -216,8 +283,14 @@ esp_err_t game_finish(void)
     
     ESP_LOGI(TAG, "Finishing game via finish button...");
     
-    // Record end time
-    current_player.end_time = (uint32_t)(esp_timer_get_time() / 1000);
+    // Record end time (never before the start or in the future)
+    uint32_t now = (uint32_t)(esp_timer_get_time() / 1000);
+    if ((int32_t)(end_time_ms - current_player.start_time) < 0) {
+        end_time_ms = current_player.start_time;
+    } else if ((int32_t)(end_time_ms - now) > 0) {
+        end_time_ms = now;
+    }
+    current_player.end_time = end_time_ms;
     uint32_t raw_elapsed = current_player.end_time - current_player.start_time;
     
     // ADD accumulated penalty time to final elapsed time (wurde bereits bei Beam-Breaks addiert)
@@ -248,6 +321,7 @@ esp_err_t game_finish(void)
              current_player.elapsed_time, current_player.beam_breaks);
     
     xSemaphoreGive(game_mutex);
+    emit_event(GAME_EVENT_FINISHED, 0);
     
     // Send MSG_GAME_STOP to all registered laser units (unicast)
     ESP_LOGI(TAG, "Sending MSG_GAME_STOP to all laser units");
@@ -275,7 +349,7 @@ esp_err_t game_finish(void)
  */
 esp_err_t game_stop(void)
 {
-    if (xSemaphoreTake(game_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+    if (game_lock(pdMS_TO_TICKS(1000)) != pdTRUE) {
         ESP_LOGE(TAG, "Failed to acquire mutex");
         return ESP_FAIL;
     }
@@ -319,6 +393,7 @@ esp_err_t game_stop(void)
              current_player.elapsed_time, current_player.beam_breaks, current_player.completion);
     
     xSemaphoreGive(game_mutex);
+    emit_event(GAME_EVENT_STOPPED, 0);
     
     // Send MSG_GAME_STOP to all registered laser units (unicast)
     ESP_LOGD(TAG, "Sending MSG_GAME_STOP to all laser units");
@@ -349,7 +424,7 @@ esp_err_t game_stop(void)
  */
 esp_err_t game_pause(void)
 {
-    if (xSemaphoreTake(game_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+    if (game_lock(pdMS_TO_TICKS(1000)) != pdTRUE) {
         return ESP_FAIL;
     }
     
@@ -370,7 +445,7 @@ esp_err_t game_pause(void)
  */
 esp_err_t game_resume(void)
 {
-    if (xSemaphoreTake(game_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+    if (game_lock(pdMS_TO_TICKS(1000)) != pdTRUE) {
         return ESP_FAIL;
     }
     
@@ -391,7 +466,7 @@ esp_err_t game_resume(void)
  */
 esp_err_t game_beam_broken(uint8_t sensor_id)
 {
-    if (xSemaphoreTake(game_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+    if (game_lock(pdMS_TO_TICKS(100)) != pdTRUE) {
         return ESP_FAIL;
     }
     
@@ -421,6 +496,7 @@ esp_err_t game_beam_broken(uint8_t sensor_id)
     }
     
     xSemaphoreGive(game_mutex);
+    emit_event(GAME_EVENT_BEAM_BREAK, sensor_id);
     
     return ESP_OK;
 }
@@ -442,7 +518,7 @@ esp_err_t game_get_player_data(player_data_t *player_data)
         return ESP_ERR_INVALID_ARG;
     }
     
-    if (xSemaphoreTake(game_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+    if (game_lock(pdMS_TO_TICKS(100)) != pdTRUE) {
         return ESP_FAIL;
     }
     
@@ -500,7 +576,7 @@ esp_err_t game_get_stats(game_stats_t *stats)
         return ESP_ERR_INVALID_ARG;
     }
     
-    if (xSemaphoreTake(game_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+    if (game_lock(pdMS_TO_TICKS(100)) != pdTRUE) {
         return ESP_FAIL;
     }
     
@@ -519,7 +595,7 @@ esp_err_t game_get_config(game_config_t *config)
         return ESP_ERR_INVALID_ARG;
     }
     
-    if (xSemaphoreTake(game_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+    if (game_lock(pdMS_TO_TICKS(100)) != pdTRUE) {
         return ESP_FAIL;
     }
     
@@ -538,7 +614,7 @@ esp_err_t game_set_config(const game_config_t *config)
         return ESP_ERR_INVALID_ARG;
     }
     
-    if (xSemaphoreTake(game_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+    if (game_lock(pdMS_TO_TICKS(100)) != pdTRUE) {
         return ESP_FAIL;
     }
     
@@ -555,7 +631,7 @@ esp_err_t game_set_config(const game_config_t *config)
  */
 esp_err_t game_reset_stats(void)
 {
-    if (xSemaphoreTake(game_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+    if (game_lock(pdMS_TO_TICKS(1000)) != pdTRUE) {
         return ESP_FAIL;
     }
     
@@ -757,6 +833,60 @@ esp_err_t game_reset_laser_unit(uint8_t module_id)
     return espnow_broadcast_message(MSG_RESET, NULL, 0);
 }
 
+/**
+ * Calibrate the beam sensors
+ */
+esp_err_t game_calibrate_sensors(uint8_t module_id, uint16_t samples)
+{
+    if (current_state == GAME_STATE_RUNNING || current_state == GAME_STATE_COUNTDOWN ||
+        current_state == GAME_STATE_PENALTY || current_state == GAME_STATE_PAUSED) {
+        ESP_LOGW(TAG, "Cannot calibrate sensors during a game");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    uint8_t data[2] = {samples & 0xFF, samples >> 8};
+    uint8_t *target_mac = NULL;
+    size_t requested = 0;
+    
+    for (size_t i = 0; i < laser_unit_count; i++) {
+        if (laser_units[i].role != 1 || (module_id != 0 && laser_units[i].module_id != module_id)) {
+            continue;
+        }
+        laser_units[i].calibration.pending = true;
+        laser_units[i].laser_on = false;        // The unit leaves its laser off afterwards
+        target_mac = laser_units[i].mac_addr;
+        requested++;
+    }
+    
+    if (module_id != 0) {
+        if (!target_mac) {
+            ESP_LOGE(TAG, "Laser unit %d not found", module_id);
+            return ESP_ERR_NOT_FOUND;
+        }
+        ESP_LOGI(TAG, "Calibrating sensor of laser unit %d", module_id);
+        return espnow_send_message(target_mac, MSG_SENSOR_CALIBRATE, data, sizeof(data));
+    }
+    
+    // One broadcast, every unit measures at the same time
+    ESP_LOGI(TAG, "Calibrating sensors of %zu laser units", requested);
+    return espnow_broadcast_message(MSG_SENSOR_CALIBRATE, data, sizeof(data));
+}
+
+/**
+ * Store a calibration result
+ */
+void game_set_sensor_calibration(uint8_t module_id, const sensor_cal_report_t *report)
+{
+    for (size_t i = 0; i < laser_unit_count; i++) {
+        if (laser_units[i].module_id == module_id) {
+            laser_units[i].calibration = *report;
+            laser_units[i].calibration.pending = false;
+            laser_units[i].calibration.valid = true;
+            return;
+        }
+    }
+}
+
 /**
  * Public function to update laser unit tracking (call from ESP-NOW callback)
  */
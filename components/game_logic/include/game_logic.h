@@ -91,6 +91,26 @@ typedef struct {
     uint8_t max_players;         // Maximum players for multiplayer
 } game_config_t;
 
+/**
+ * Game events (reported to the event callback as they happen)
+ */
+typedef enum {
+    GAME_EVENT_STARTED = 0,      // Game started, countdown begins
+    GAME_EVENT_COUNTDOWN_TICK,   // Countdown second (value = seconds remaining)
+    GAME_EVENT_RUNNING,          // Countdown over, timing started
+    GAME_EVENT_BEAM_BREAK,       // Beam broken (value = sensor ID)
+    GAME_EVENT_FINISHED,         // Completed via finish button
+    GAME_EVENT_STOPPED           // Aborted
+} game_event_t;
+
+/**
+ * Game event callback
+ * 
+ * Called from the context that caused the event (task or esp_timer
+ * callback), without the game mutex held. Must not block.
+ */
+typedef void (*game_event_callback_t)(game_event_t event, uint32_t value);
+
 /**
  * Initialize game logic component
  * 
@@ -98,6 +118,13 @@ typedef struct {
  */
 esp_err_t game_logic_init(void);
 
+/**
+ * Set the callback for game events
+ * 
+ * @param callback Called for every game event (NULL to remove)
+ */
+void game_set_event_callback(game_event_callback_t callback);
+
 /**
  * Start a new game
  * 
@@ -115,6 +142,16 @@ esp_err_t game_start(game_mode_t mode, const char *player_name);
  */
 esp_err_t game_finish(void);
 
+/**
+ * Finish the current game at a given time (successful completion)
+ * Used when the finish moment is known more precisely than the time the
+ * message arrived (e.g. timestamped in the finish button interrupt)
+ * 
+ * @param end_time_ms End time in esp_timer milliseconds (clamped to the run)
+ * @return ESP_OK on success, ESP_FAIL on error
+ */
+esp_err_t game_finish_at(uint32_t end_time_ms);
+
 /**
  * Stop the current game (abort/cancel)
  * Sets completion status to ABORTED_MANUAL if not already set
@@ -192,6 +229,22 @@ esp_err_t game_set_config(const game_config_t *config);
  */
 esp_err_t game_reset_stats(void);
 
+/**
+ * Sensor calibration report of a laser unit
+ */
+typedef struct {
+    bool pending;                // Requested, no result yet
+    bool valid;                  // A result has been received
+    uint8_t status;              // sensor_cal_status_t from the unit
+    uint16_t threshold;          // Threshold chosen by the unit
+    uint16_t hysteresis;         // Half width of the switching band
+    uint16_t off_mean;           // Level with laser off
+    uint16_t off_stddev;
+    uint16_t on_mean;            // Level with laser on
+    uint16_t on_stddev;
+    uint16_t separation_x10;     // Threshold distance from both means in std devs (x10)
+} sensor_cal_report_t;
+
 /**
  * Laser Unit information
  */
@@ -204,6 +257,7 @@ typedef struct {
     uint32_t last_seen;          // Last heartbeat timestamp (ms)
     int8_t rssi;                 // Signal strength
     char status[32];             // Status text
+    sensor_cal_report_t calibration;  // Last sensor calibration (laser units)
 } laser_unit_info_t;
 
 /**
@@ -241,6 +295,28 @@ esp_err_t game_control_laser(uint8_t module_id, bool laser_on, uint8_t intensity
  */
 esp_err_t game_reset_laser_unit(uint8_t module_id);
 
+/**
+ * Calibrate the beam sensors
+ * 
+ * Each laser unit measures its sensor with the laser off and on, chooses
+ * threshold and hysteresis, saves them and reports back. All units run
+ * in parallel. Not allowed during a game.
+ * 
+ * @param module_id Module ID to calibrate, 0 for all laser units
+ * @param samples Levels per phase, 0 for the unit default
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE during a game,
+ *         ESP_ERR_NOT_FOUND for an unknown module
+ */
+esp_err_t game_calibrate_sensors(uint8_t module_id, uint16_t samples);
+
+/**
+ * Store a calibration result (call from ESP-NOW message handler)
+ * 
+ * @param module_id Module ID that reported
+ * @param report Calibration result
+ */
+void game_set_sensor_calibration(uint8_t module_id, const sensor_cal_report_t *report);
+
 /**
  * Update laser unit tracking (call from ESP-NOW message handler)
  * 
@@ -60,6 +60,18 @@ esp_err_t laser_turn_off(void);
  */
 esp_err_t laser_set_intensity(uint8_t intensity);
 
+/**
+ * Pulse the laser at a carrier frequency
+ * 
+ * The beam becomes a square wave at frequency_hz so the sensor can tell
+ * it apart from ambient light. Intensity then sets the pulse width, 100%
+ * being a 50% duty cycle. 0 returns to the constant beam.
+ * 
+ * @param frequency_hz Carrier frequency, 0 for a constant beam
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t laser_set_modulation(uint32_t frequency_hz);
+
 /**
  * Get laser status
  * 
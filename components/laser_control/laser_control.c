@@ -23,6 +23,8 @@ static const char *TAG = "LASER_CTRL";
 
 static gpio_num_t laser_gpio = GPIO_NUM_NC;
 static laser_status_t current_status = LASER_OFF;
+static uint8_t current_intensity = 0;
+static uint32_t carrier_hz = 0;            // 0 = constant beam
 static bool safety_timeout_enabled = true;
 static esp_timer_handle_t safety_timer = NULL;
 
@@ -35,6 +37,18 @@ static void safety_timeout_cb(void *arg)
     laser_turn_off();
 }
 
+/**
+ * PWM duty for an intensity
+ * A modulated beam is a square wave, full intensity means 50% duty.
+ */
+static uint32_t intensity_to_duty(uint8_t intensity)
+{
+    if (carrier_hz) {
+        return (intensity * 128) / 100;
+    }
+    return (intensity * 255) / 100;
+}
+
 /**
  * Initialize laser control
  */
@@ -89,11 +103,12 @@ esp_err_t laser_turn_on(uint8_t intensity)
     }
     
     // Set PWM duty cycle (0-255 for 8-bit resolution)
-    uint32_t duty = (intensity * 255) / 100;
+    uint32_t duty = intensity_to_duty(intensity);
     ESP_ERROR_CHECK(ledc_set_duty(LEDC_MODE, LEDC_CHANNEL, duty));
     ESP_ERROR_CHECK(ledc_update_duty(LEDC_MODE, LEDC_CHANNEL));
     
     current_status = LASER_ON;
+    current_intensity = intensity;
     
     // Start safety timeout if enabled
     if (safety_timeout_enabled && safety_timer) {
@@ -139,6 +154,33 @@ esp_err_t laser_set_intensity(uint8_t intensity)
     return laser_turn_on(intensity);
 }
 
+/**
+ * Set carrier modulation
+ */
+esp_err_t laser_set_modulation(uint32_t frequency_hz)
+{
+    esp_err_t ret = ledc_set_freq(LEDC_MODE, LEDC_TIMER, frequency_hz ? frequency_hz : LEDC_FREQUENCY);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set PWM frequency %lu Hz: %s",
+                 (unsigned long)frequency_hz, esp_err_to_name(ret));
+        return ret;
+    }
+    carrier_hz = frequency_hz;
+    
+    if (current_status == LASER_ON) {
+        ESP_ERROR_CHECK(ledc_set_duty(LEDC_MODE, LEDC_CHANNEL, intensity_to_duty(current_intensity)));
+        ESP_ERROR_CHECK(ledc_update_duty(LEDC_MODE, LEDC_CHANNEL));
+    }
+    
+    if (frequency_hz) {
+        ESP_LOGI(TAG, "Laser modulated at %lu Hz", (unsigned long)frequency_hz);
+    } else {
+        ESP_LOGI(TAG, "Laser modulation off");
+    }
+    
+    return ESP_OK;
+}
+
 /**
  * Get laser status
  */
@@ -0,0 +1,171 @@
+/**
+ * Metrics Component - Header
+ *
+ * Lock-free counter/gauge registry exported in Prometheus text format.
+ * Components register their metrics once at init and update them from
+ * hot paths with a single relaxed atomic operation.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define METRICS_LABELS_LEN      48      // Rendered label set, e.g. peer="AA:BB:.."
+
+/**
+ * Metric type
+ */
+typedef enum {
+    METRIC_COUNTER = 0,     // Monotonic, only ever incremented
+    METRIC_GAUGE            // Current value, may go up and down
+} metric_type_t;
+
+/**
+ * Metric entry (allocated from the static registry, never freed)
+ */
+typedef struct {
+    const char *name;                   // Metric name (static string)
+    const char *help;                   // Help text (static string)
+    metric_type_t type;                 // Counter or gauge
+    char labels[METRICS_LABELS_LEN];    // Label set without braces (may be empty)
+    atomic_int_least32_t value;         // Current value
+    atomic_int_least32_t carry_us;      // Sub-millisecond rest of metrics_add_us()
+} metric_t;
+
+/**
+ * Collector callback, invoked right before rendering to refresh gauges
+ * that are sampled rather than updated (heap, stack high-water marks)
+ */
+typedef void (*metrics_collector_t)(void);
+
+/**
+ * Register a counter
+ *
+ * @param name Metric name (must be a static string)
+ * @param help Help text (must be a static string)
+ * @param labels Label set without braces, e.g. "peer=\"01:02:03:04:05:06\"" (NULL for none)
+ * @return Metric handle, or NULL if the registry is full
+ */
+metric_t *metrics_register_counter(const char *name, const char *help, const char *labels);
+
+/**
+ * Register a gauge
+ *
+ * @param name Metric name (must be a static string)
+ * @param help Help text (must be a static string)
+ * @param labels Label set without braces (NULL for none)
+ * @return Metric handle, or NULL if the registry is full
+ */
+metric_t *metrics_register_gauge(const char *name, const char *help, const char *labels);
+
+/**
+ * Register a collector callback (called on every render)
+ *
+ * @param collector Callback function
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if all collector slots are used
+ */
+esp_err_t metrics_register_collector(metrics_collector_t collector);
+
+/**
+ * Track the stack high-water mark of a task as a gauge
+ *
+ * @param task Task handle
+ * @param name Task name used as label value
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t metrics_register_task(TaskHandle_t task, const char *name);
+
+/**
+ * Render all metrics in Prometheus text exposition format
+ *
+ * @param buf Output buffer
+ * @param buf_len Size of output buffer
+ * @return Number of bytes written (output is truncated at a line boundary if the buffer is too small)
+ */
+size_t metrics_render(char *buf, size_t buf_len);
+
+/**
+ * Increment a counter by one (NULL-safe)
+ */
+static inline void metrics_inc(metric_t *m)
+{
+    if (m) {
+        atomic_fetch_add_explicit(&m->value, 1, memory_order_relaxed);
+    }
+}
+
+/**
+ * Add to a counter or gauge (NULL-safe)
+ */
+static inline void metrics_add(metric_t *m, int32_t delta)
+{
+    if (m) {
+        atomic_fetch_add_explicit(&m->value, delta, memory_order_relaxed);
+    }
+}
+
+/**
+ * Add a duration to a millisecond counter (NULL-safe)
+ *
+ * The sub-millisecond rest is carried over, so many short durations add
+ * up exactly and the counter only wraps after 49 days instead of 71
+ * minutes for a microsecond counter.
+ */
+static inline void metrics_add_us(metric_t *m, int64_t us)
+{
+    if (m && us > 0) {
+        int32_t rest = atomic_fetch_add_explicit(&m->carry_us, (int32_t)(us % 1000),
+                                                 memory_order_relaxed) + (int32_t)(us % 1000);
+        int32_t ms = (int32_t)(us / 1000);
+        if (rest >= 1000) {
+            atomic_fetch_sub_explicit(&m->carry_us, 1000, memory_order_relaxed);
+            ms++;
+        }
+        if (ms) {
+            atomic_fetch_add_explicit(&m->value, ms, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * Set a gauge (NULL-safe)
+ */
+static inline void metrics_set(metric_t *m, int32_t value)
+{
+    if (m) {
+        atomic_store_explicit(&m->value, value, memory_order_relaxed);
+    }
+}
+
+/**
+ * Raise a gauge to value if it is larger (running maximum, NULL-safe)
+ */
+static inline void metrics_max(metric_t *m, int32_t value)
+{
+    if (m) {
+        int32_t cur = atomic_load_explicit(&m->value, memory_order_relaxed);
+        while (value > cur &&
+               !atomic_compare_exchange_weak_explicit(&m->value, &cur, value,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+        }
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // METRICS_H
@@ -0,0 +1,245 @@
+/**
+ * Metrics Component - Implementation
+ *
+ * Static registry of counters and gauges. Registration is rare and
+ * serialized by a spinlock; updates are relaxed atomics on the entry
+ * and never take a lock. Rendering walks the published entries only.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#include "metrics.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdbool.h>
+
+static const char *TAG = "METRICS";
+
+#ifndef CONFIG_MAX_ESPNOW_PEERS
+#define CONFIG_MAX_ESPNOW_PEERS 20
+#endif
+
+// Size of the static registry: component metrics and task stack gauges,
+// plus four ESP-NOW families per peer (including broadcast and "other")
+#define METRICS_MAX_ENTRIES     (64 + 4 * (CONFIG_MAX_ESPNOW_PEERS + 2))
+#define METRICS_MAX_COLLECTORS  8
+#define METRICS_MAX_TASKS       12
+
+static metric_t registry[METRICS_MAX_ENTRIES];
+static atomic_int registry_count = 0;           // Published entries (release/acquire)
+static portMUX_TYPE registry_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static metrics_collector_t collectors[METRICS_MAX_COLLECTORS];
+static int collector_count = 0;
+
+typedef struct {
+    TaskHandle_t handle;
+    metric_t *stack_free;
+} tracked_task_t;
+
+static tracked_task_t tasks[METRICS_MAX_TASKS];
+static int task_count = 0;
+
+/**
+ * Allocate and publish a registry entry
+ */
+static metric_t *metrics_register(const char *name, const char *help,
+                                  metric_type_t type, const char *labels)
+{
+    metric_t *m = NULL;
+
+    taskENTER_CRITICAL(&registry_lock);
+    int idx = atomic_load_explicit(&registry_count, memory_order_relaxed);
+    if (idx < METRICS_MAX_ENTRIES) {
+        m = &registry[idx];
+        m->name = name;
+        m->help = help;
+        m->type = type;
+        strlcpy(m->labels, labels ? labels : "", sizeof(m->labels));
+        atomic_store_explicit(&m->value, 0, memory_order_relaxed);
+        atomic_store_explicit(&m->carry_us, 0, memory_order_relaxed);
+        // Publish only after the entry is fully written
+        atomic_store_explicit(&registry_count, idx + 1, memory_order_release);
+    }
+    taskEXIT_CRITICAL(&registry_lock);
+
+    if (!m) {
+        ESP_LOGW(TAG, "Registry full, dropping metric %s{%s}", name, labels ? labels : "");
+    }
+    return m;
+}
+
+/**
+ * Register a counter
+ */
+metric_t *metrics_register_counter(const char *name, const char *help, const char *labels)
+{
+    return metrics_register(name, help, METRIC_COUNTER, labels);
+}
+
+/**
+ * Register a gauge
+ */
+metric_t *metrics_register_gauge(const char *name, const char *help, const char *labels)
+{
+    return metrics_register(name, help, METRIC_GAUGE, labels);
+}
+
+/**
+ * Register a collector callback
+ */
+esp_err_t metrics_register_collector(metrics_collector_t collector)
+{
+    if (!collector) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    taskENTER_CRITICAL(&registry_lock);
+    if (collector_count < METRICS_MAX_COLLECTORS) {
+        collectors[collector_count++] = collector;
+        ret = ESP_OK;
+    }
+    taskEXIT_CRITICAL(&registry_lock);
+
+    return ret;
+}
+
+/**
+ * Track the stack high-water mark of a task
+ */
+esp_err_t metrics_register_task(TaskHandle_t task, const char *name)
+{
+    if (!task || !name) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char labels[METRICS_LABELS_LEN];
+    snprintf(labels, sizeof(labels), "task=\"%s\"", name);
+    metric_t *m = metrics_register_gauge("laser_task_stack_free_bytes",
+                                         "Minimum free stack seen for a task (high-water mark)",
+                                         labels);
+    if (!m) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    taskENTER_CRITICAL(&registry_lock);
+    if (task_count < METRICS_MAX_TASKS) {
+        tasks[task_count].handle = task;
+        tasks[task_count].stack_free = m;
+        task_count++;
+        ret = ESP_OK;
+    }
+    taskEXIT_CRITICAL(&registry_lock);
+
+    return ret;
+}
+
+/**
+ * Append formatted text, stopping cleanly when the buffer is full
+ */
+static bool render_append(char *buf, size_t buf_len, size_t *pos, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+
+static bool render_append(char *buf, size_t buf_len, size_t *pos, const char *fmt, ...)
+{
+    if (*pos >= buf_len) {
+        return false;
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf + *pos, buf_len - *pos, fmt, args);
+    va_end(args);
+
+    if (n < 0 || (size_t)n >= buf_len - *pos) {
+        buf[*pos] = '\0';  // Drop the partial line
+        return false;
+    }
+    *pos += n;
+    return true;
+}
+
+/**
+ * Render all metrics in Prometheus text format
+ */
+size_t metrics_render(char *buf, size_t buf_len)
+{
+    if (!buf || buf_len == 0) {
+        return 0;
+    }
+    buf[0] = '\0';
+
+    // Refresh sampled gauges
+    for (int i = 0; i < collector_count; i++) {
+        collectors[i]();
+    }
+    for (int i = 0; i < task_count; i++) {
+        metrics_set(tasks[i].stack_free, (int32_t)uxTaskGetStackHighWaterMark(tasks[i].handle));
+    }
+
+    size_t pos = 0;
+
+    // Built-in system gauges
+    bool ok = render_append(buf, buf_len, &pos,
+        "# HELP laser_heap_free_bytes Current free heap\n"
+        "# TYPE laser_heap_free_bytes gauge\n"
+        "laser_heap_free_bytes %lu\n"
+        "# HELP laser_heap_min_free_bytes Minimum free heap since boot\n"
+        "# TYPE laser_heap_min_free_bytes gauge\n"
+        "laser_heap_min_free_bytes %lu\n"
+        "# HELP laser_uptime_seconds Time since boot\n"
+        "# TYPE laser_uptime_seconds counter\n"
+        "laser_uptime_seconds %lld\n",
+        (unsigned long)esp_get_free_heap_size(),
+        (unsigned long)esp_get_minimum_free_heap_size(),
+        (long long)(esp_timer_get_time() / 1000000));
+
+    int count = atomic_load_explicit(&registry_count, memory_order_acquire);
+
+    // Emit each metric family once, with all its label sets grouped together
+    for (int i = 0; i < count && ok; i++) {
+        bool seen = false;
+        for (int k = 0; k < i; k++) {
+            if (strcmp(registry[k].name, registry[i].name) == 0) {
+                seen = true;
+                break;
+            }
+        }
+        if (seen) {
+            continue;
+        }
+
+        ok = render_append(buf, buf_len, &pos, "# HELP %s %s\n# TYPE %s %s\n",
+                           registry[i].name, registry[i].help, registry[i].name,
+                           registry[i].type == METRIC_COUNTER ? "counter" : "gauge");
+
+        for (int j = i; j < count && ok; j++) {
+            const metric_t *m = &registry[j];
+            if (strcmp(m->name, registry[i].name) != 0) {
+                continue;
+            }
+
+            int32_t v = atomic_load_explicit(&m->value, memory_order_relaxed);
+            if (m->type == METRIC_COUNTER) {
+                // Counters wrap as unsigned 32-bit, which Prometheus treats as a reset
+                ok = render_append(buf, buf_len, &pos, m->labels[0] ? "%s{%s} %lu\n" : "%s%s %lu\n",
+                                   m->name, m->labels, (unsigned long)(uint32_t)v);
+            } else {
+                ok = render_append(buf, buf_len, &pos, m->labels[0] ? "%s{%s} %ld\n" : "%s%s %ld\n",
+                                   m->name, m->labels, (long)v);
+            }
+        }
+    }
+
+    if (!ok) {
+        ESP_LOGW(TAG, "Metrics output truncated at %u bytes", (unsigned)pos);
+    }
+    return pos;
+}
@@ -15,6 +15,7 @@
 #include "esp_err.h"
 #include "driver/gpio.h"
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -100,6 +101,20 @@ bool sd_card_has_web_interface(void);
  */
 const char *sd_card_get_mount_point(void);
 
+/**
+ * @brief Gelesene Bytes für die Metriken zählen
+ * 
+ * @param bytes Anzahl gelesener Bytes
+ */
+void sd_card_count_read(size_t bytes);
+
+/**
+ * @brief Geschriebene Bytes für die Metriken zählen
+ * 
+ * @param bytes Anzahl geschriebener Bytes
+ */
+void sd_card_count_write(size_t bytes);
+
 #ifdef __cplusplus
 }
 #endif
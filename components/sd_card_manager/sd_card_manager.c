@@ -8,6 +8,7 @@
 #include "esp_vfs_fat.h"
 #include "sdmmc_cmd.h"
 #include "driver/sdspi_host.h"
+#include "metrics.h"
 #include <sys/stat.h>
 #include <string.h>
 
@@ -20,6 +21,10 @@ static const char *mount_point = "/sdcard";
 static bool web_dir_checked = false;
 static bool web_dir_available = false;
 
+// Metriken (Lese-/Schreibvolumen)
+static metric_t *m_read_bytes = NULL;
+static metric_t *m_write_bytes = NULL;
+
 esp_err_t sd_card_manager_init(const sd_card_config_t *config)
 {
     esp_err_t ret;
@@ -121,6 +126,11 @@ esp_err_t sd_card_manager_init(const sd_card_config_t *config)
     
     current_status = SD_STATUS_MOUNTED;
     
+    if (!m_read_bytes) {
+        m_read_bytes = metrics_register_counter("laser_sd_read_bytes_total", "Bytes read from SD card", NULL);
+        m_write_bytes = metrics_register_counter("laser_sd_write_bytes_total", "Bytes written to SD card", NULL);
+    }
+    
     // Karteninfo ausgeben
     sdmmc_card_print_info(stdout, card);
     
@@ -235,3 +245,13 @@ const char *sd_card_get_mount_point(void)
 {
     return mount_point;
 }
+
+void sd_card_count_read(size_t bytes)
+{
+    metrics_add(m_read_bytes, (int32_t)bytes);
+}
+
+void sd_card_count_write(size_t bytes)
+{
+    metrics_add(m_write_bytes, (int32_t)bytes);
+}
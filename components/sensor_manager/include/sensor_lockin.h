@@ -0,0 +1,82 @@
+/**
+ * Sensor Lock-In - Header
+ *
+ * Synchronous demodulation of a pulsed laser in blocks of ADC samples.
+ * The samples of a block are first folded into one carrier period (one
+ * add per sample), then the fundamental is taken from the folded period
+ * with Q15 sine/cosine tables. The amplitude does not depend on the
+ * phase between laser and ADC clock, and constant or mains-flicker
+ * ambient light cancels: a block of 20 ms puts every harmonic of 50 Hz
+ * other than the carrier on a null of the block window.
+ *
+ * Plain C without ESP-IDF dependencies so it can be built and
+ * benchmarked on the host (tools/lockin_bench).
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#ifndef SENSOR_LOCKIN_H
+#define SENSOR_LOCKIN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SENSOR_LOCKIN_CARRIER_HZ        1250    // Laser pulse rate, halfway between 100 Hz harmonics
+#define SENSOR_LOCKIN_SAMPLES_PER_PERIOD 8
+#define SENSOR_LOCKIN_SAMPLE_HZ         (SENSOR_LOCKIN_CARRIER_HZ * SENSOR_LOCKIN_SAMPLES_PER_PERIOD)
+#define SENSOR_LOCKIN_BLOCK_PERIODS     25      // 20 ms per block
+#define SENSOR_LOCKIN_BLOCK_SAMPLES     (SENSOR_LOCKIN_BLOCK_PERIODS * SENSOR_LOCKIN_SAMPLES_PER_PERIOD)
+#define SENSOR_LOCKIN_MAX_PERIOD        32      // Largest supported samples per period
+
+/**
+ * Demodulator (reference tables)
+ */
+typedef struct {
+    uint16_t period;                            // Samples per carrier period
+    int16_t cos_q15[SENSOR_LOCKIN_MAX_PERIOD];
+    int16_t sin_q15[SENSOR_LOCKIN_MAX_PERIOD];
+} sensor_lockin_t;
+
+/**
+ * Result of one block
+ */
+typedef struct {
+    uint16_t amplitude;         // Peak of the carrier fundamental (ADC counts, 0.64 x swing of a square wave)
+    uint16_t ambient;           // Mean level (ADC counts)
+    uint16_t peak;              // Highest sample (saturation check)
+} sensor_lockin_result_t;
+
+/**
+ * Initialize a demodulator
+ *
+ * @param l Demodulator
+ * @param period Samples per carrier period (4..SENSOR_LOCKIN_MAX_PERIOD)
+ * @return 0 on success, -1 for an unsupported period
+ */
+int sensor_lockin_init(sensor_lockin_t *l, uint16_t period);
+
+/**
+ * Demodulate one block
+ *
+ * The first sample is taken as phase 0 of the reference; the carrier
+ * phase itself does not matter. Blocks should span a whole number of
+ * periods (a partial last period is ignored).
+ *
+ * @param l Demodulator
+ * @param samples ADC samples (12 bit)
+ * @param count Number of samples (at most 65535 periods)
+ * @param result Block result
+ */
+void sensor_lockin_process(const sensor_lockin_t *l, const uint16_t *samples, size_t count,
+                           sensor_lockin_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SENSOR_LOCKIN_H
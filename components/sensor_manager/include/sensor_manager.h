@@ -28,6 +28,29 @@ typedef enum {
     SENSOR_ERROR                  // Sensor error
 } sensor_status_t;
 
+/**
+ * Level statistics of one calibration phase
+ * Levels are raw ADC values, or carrier amplitudes with CONFIG_LASER_MODULATION.
+ */
+typedef struct {
+    uint16_t count;              // Levels collected
+    uint16_t mean;               // Mean level
+    uint16_t stddev;             // Standard deviation
+    uint16_t min;                // Lowest level
+    uint16_t max;                // Highest level
+} sensor_level_stats_t;
+
+/**
+ * Sensor calibration
+ */
+typedef struct {
+    sensor_level_stats_t off;    // Laser off
+    sensor_level_stats_t on;     // Laser on
+    uint16_t threshold;          // Chosen threshold
+    uint16_t hysteresis;         // Half width of the switching band around the threshold
+    uint16_t separation_x10;     // Distance of the threshold from both means in std devs (x10)
+} sensor_calibration_t;
+
 /**
  * Beam break callback
  * 
@@ -98,6 +121,63 @@ esp_err_t sensor_set_threshold(uint16_t threshold);
  */
 esp_err_t sensor_calibrate(void);
 
+/**
+ * Set hysteresis (beam breaks below threshold - hysteresis, restores above threshold + hysteresis)
+ * 
+ * @param hysteresis Half width of the switching band
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the band leaves 0-4095
+ */
+esp_err_t sensor_set_hysteresis(uint16_t hysteresis);
+
+/**
+ * Collect level statistics
+ * 
+ * Takes the next count levels from a monitor task started for the
+ * measurement. Beam break/restore callbacks are not called meanwhile.
+ * Blocks for about count ms (raw) or count x 20 ms (modulated).
+ * sensor_start_monitoring() aborts the measurement, so a game that
+ * starts meanwhile gets its beam breaks.
+ * 
+ * @param count Number of levels, 0 for the default
+ * @param stats Statistics of the collected levels
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the sampler stalled,
+ *         ESP_ERR_INVALID_STATE if a measurement or monitoring is
+ *         already running, or monitoring was started meanwhile
+ */
+esp_err_t sensor_measure_levels(uint16_t count, sensor_level_stats_t *stats);
+
+/**
+ * Choose threshold and hysteresis from the off/on statistics in cal
+ * 
+ * The threshold sits the same number of standard deviations from both
+ * means, which maximizes the margin to the nearer one. The hysteresis
+ * band is as wide as possible while both switching points stay at
+ * least 3 standard deviations from their own distribution.
+ * 
+ * @param cal Calibration with off and on filled in; threshold, hysteresis
+ *            and separation are set
+ * @return ESP_OK on success, ESP_ERR_INVALID_RESPONSE if laser on and off
+ *         are less than 3 standard deviations apart (values still filled in)
+ */
+esp_err_t sensor_calibration_compute(sensor_calibration_t *cal);
+
+/**
+ * Apply threshold and hysteresis
+ * 
+ * @param threshold Detection threshold
+ * @param hysteresis Half width of the switching band
+ * @param save true to persist in NVS (used by sensor_load_calibration)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t sensor_apply_calibration(uint16_t threshold, uint16_t hysteresis, bool save);
+
+/**
+ * Apply the calibration saved in NVS
+ * 
+ * @return ESP_OK if applied, ESP_ERR_NOT_FOUND if none was saved for this detector
+ */
+esp_err_t sensor_load_calibration(void);
+
 /**
  * Start sensor monitoring
  * 
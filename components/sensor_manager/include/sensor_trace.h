@@ -0,0 +1,162 @@
+/**
+ * Sensor Trace - Header
+ *
+ * Raw ADC traces around a beam break, for tuning the detector offline.
+ *
+ * Laser units (CONFIG_SENSOR_TRACE) record every raw sample with its
+ * time into a RAM ring. A debounced beam break triggers the capture: the
+ * ring keeps the samples before the break and fills up the post window,
+ * then the trace is frozen until it has been shipped and re-armed.
+ *
+ * Traces travel to the main unit as MSG_SENSOR_TRACE frames: one header
+ * frame, then frames of SENSOR_TRACE_FRAME_SAMPLES samples. The main
+ * unit reassembles the latest trace and serves it as a binary file:
+ * sensor_trace_header_t followed by sample_count sensor_trace_sample_t,
+ * all little endian (tools/sensor_trace.py reads it).
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#ifndef SENSOR_TRACE_H
+#define SENSOR_TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SENSOR_TRACE_MAGIC          0x5254504C  // "LPTR"
+#define SENSOR_TRACE_VERSION        1
+#define SENSOR_TRACE_MAX_SAMPLES    8192        // Largest trace the main unit accepts
+#define SENSOR_TRACE_FRAME_SAMPLES  6           // Samples per ESP-NOW frame
+#define SENSOR_TRACE_HEADER_INDEX   0xFFFF      // Frame index of the header frame
+
+/**
+ * Trace detector type
+ */
+typedef enum {
+    SENSOR_TRACE_DETECTOR_RAW = 0,      // Threshold on the raw ADC value
+    SENSOR_TRACE_DETECTOR_LOCKIN        // Lock-in (samples are the raw carrier at SENSOR_LOCKIN_SAMPLE_HZ)
+} sensor_trace_detector_t;
+
+/**
+ * Trace file header
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;             // SENSOR_TRACE_MAGIC
+    uint8_t version;            // SENSOR_TRACE_VERSION
+    uint8_t module_id;          // Laser unit that captured the trace
+    uint8_t detector;           // sensor_trace_detector_t
+    uint8_t trace_id;           // Increments per capture on the unit
+    uint16_t sample_count;      // Samples that follow
+    uint16_t trigger_index;     // First sample recorded after the break was detected
+    uint16_t threshold;         // Detector threshold at capture time
+    uint16_t hysteresis;        // Detector hysteresis at capture time
+} sensor_trace_header_t;
+
+/**
+ * Trace sample
+ */
+typedef struct __attribute__((packed)) {
+    int32_t time_us;            // Relative to the break detection
+    uint16_t value;             // Raw ADC value (12 bit)
+} sensor_trace_sample_t;
+
+/**
+ * Captured trace
+ */
+typedef struct {
+    sensor_trace_header_t header;
+    const sensor_trace_sample_t *samples;   // header.sample_count entries
+} sensor_trace_t;
+
+// Capture (laser units, CONFIG_SENSOR_TRACE)
+
+/**
+ * Allocate the ring and arm the capture
+ *
+ * @param samples Ring size (samples before plus after the break)
+ * @param post_samples Samples recorded after the break
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM
+ */
+esp_err_t sensor_trace_enable(uint16_t samples, uint16_t post_samples);
+
+/**
+ * Wait for a captured trace
+ *
+ * The trace stays valid (and capturing stays off) until sensor_trace_rearm().
+ *
+ * @param timeout_ms Maximum wait
+ * @param trace Captured trace, module_id and trace_id are left for the caller
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT, ESP_ERR_INVALID_STATE if not enabled
+ */
+esp_err_t sensor_trace_wait(uint32_t timeout_ms, sensor_trace_t *trace);
+
+/**
+ * Release the captured trace and capture the next break
+ */
+void sensor_trace_rearm(void);
+
+// Transport
+
+/**
+ * Pack the header frame of a trace
+ *
+ * @param header Trace header
+ * @param data Frame payload (at least 3 + sizeof(sensor_trace_header_t) bytes)
+ * @return Payload length
+ */
+size_t sensor_trace_pack_header(const sensor_trace_header_t *header, uint8_t *data);
+
+/**
+ * Pack up to SENSOR_TRACE_FRAME_SAMPLES samples starting at first
+ *
+ * @param trace Trace
+ * @param first Index of the first sample
+ * @param data Frame payload (32 bytes)
+ * @return Payload length, 0 past the end
+ */
+size_t sensor_trace_pack_samples(const sensor_trace_t *trace, uint16_t first, uint8_t *data);
+
+// Reassembly (main unit)
+
+/**
+ * Feed a received MSG_SENSOR_TRACE payload
+ *
+ * A header frame starts a new trace and drops the previous one.
+ *
+ * @param module_id Sending module
+ * @param data Frame payload (32 bytes)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for a malformed frame, ESP_ERR_NO_MEM
+ */
+esp_err_t sensor_trace_receive(uint8_t module_id, const uint8_t *data);
+
+/**
+ * Describe the latest received trace
+ *
+ * @param header Trace header
+ * @param received Samples received so far
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if no trace has been received
+ */
+esp_err_t sensor_trace_latest(sensor_trace_header_t *header, uint16_t *received);
+
+/**
+ * Copy part of the latest trace as file bytes (header, then samples)
+ *
+ * @param offset Byte offset in the file
+ * @param buf Destination
+ * @param len Bytes wanted
+ * @return Bytes copied, 0 at the end or without a trace
+ */
+size_t sensor_trace_read(size_t offset, uint8_t *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SENSOR_TRACE_H
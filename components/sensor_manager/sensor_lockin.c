@@ -0,0 +1,117 @@
+/**
+ * Sensor Lock-In - Implementation
+ *
+ * Correlating every sample with sine and cosine costs two multiplies per
+ * sample. Since the reference repeats every period, the samples are
+ * summed per phase first and only the folded period is correlated, so
+ * the per-sample work is a single 32 bit add.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#include "sensor_lockin.h"
+#include <math.h>
+#include <string.h>
+
+/**
+ * Integer square root
+ */
+static uint32_t isqrt64(uint64_t v)
+{
+    uint64_t result = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= result + bit) {
+            v -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)result;
+}
+
+/**
+ * Initialize a demodulator
+ */
+int sensor_lockin_init(sensor_lockin_t *l, uint16_t period)
+{
+    if (period < 4 || period > SENSOR_LOCKIN_MAX_PERIOD) {
+        return -1;
+    }
+
+    memset(l, 0, sizeof(*l));
+    l->period = period;
+    for (uint16_t p = 0; p < period; p++) {
+        double angle = 2.0 * M_PI * p / period;
+        l->cos_q15[p] = (int16_t)lround(cos(angle) * 32767.0);
+        l->sin_q15[p] = (int16_t)lround(sin(angle) * 32767.0);
+    }
+    return 0;
+}
+
+/**
+ * Demodulate one block
+ */
+void sensor_lockin_process(const sensor_lockin_t *l, const uint16_t *samples, size_t count,
+                           sensor_lockin_result_t *result)
+{
+    const uint16_t period = l->period;
+    const size_t periods = count / period;
+    int32_t fold[SENSOR_LOCKIN_MAX_PERIOD] = {0};
+    uint16_t peak = 0;
+
+    memset(result, 0, sizeof(*result));
+    if (periods == 0) {
+        return;
+    }
+
+    // Sum the samples per phase (the hot loop, one add per sample)
+    const uint16_t *s = samples;
+    if (period == 8) {
+        for (size_t k = 0; k < periods; k++, s += 8) {
+            fold[0] += s[0]; fold[1] += s[1]; fold[2] += s[2]; fold[3] += s[3];
+            fold[4] += s[4]; fold[5] += s[5]; fold[6] += s[6]; fold[7] += s[7];
+            uint16_t hi = s[0] | s[1] | s[2] | s[3] | s[4] | s[5] | s[6] | s[7];
+            if (hi > peak) {
+                // Rare: find the real maximum of this period only
+                for (int p = 0; p < 8; p++) {
+                    peak = s[p] > peak ? s[p] : peak;
+                }
+            }
+        }
+    } else {
+        for (size_t k = 0; k < periods; k++, s += period) {
+            for (uint16_t p = 0; p < period; p++) {
+                fold[p] += s[p];
+                peak = s[p] > peak ? s[p] : peak;
+            }
+        }
+    }
+
+    // Correlate the folded period with the reference
+    int64_t i_acc = 0;
+    int64_t q_acc = 0;
+    int64_t total = 0;
+    for (uint16_t p = 0; p < period; p++) {
+        i_acc += (int64_t)fold[p] * l->cos_q15[p];
+        q_acc += (int64_t)fold[p] * l->sin_q15[p];
+        total += fold[p];
+    }
+
+    // Back to counts x samples, then A = 2 * |I + jQ| / N
+    i_acc >>= 15;
+    q_acc >>= 15;
+    uint64_t n = (uint64_t)periods * period;
+    uint64_t amplitude = 2ULL * isqrt64((uint64_t)(i_acc * i_acc) + (uint64_t)(q_acc * q_acc)) / n;
+
+    result->amplitude = amplitude > UINT16_MAX ? UINT16_MAX : (uint16_t)amplitude;
+    result->ambient = (uint16_t)(total / (int64_t)n);
+    result->peak = peak;
+}
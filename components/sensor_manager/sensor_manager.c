@@ -3,85 +3,343 @@
  * 
  * Manages photoresistor sensors for laser beam detection.
  * 
+ * With CONFIG_LASER_MODULATION the laser is pulsed at
+ * SENSOR_LOCKIN_CARRIER_HZ and the sensor is sampled continuously by DMA;
+ * the beam level is then the demodulated carrier amplitude instead of
+ * the raw ADC value, so ambient light does not count.
+ * 
  * @author ninharp
  * @date 2025
  */
 
 #include "sensor_manager.h"
+#include <math.h>
 #include "esp_log.h"
 #include "esp_adc/adc_oneshot.h"
+#include "esp_attr.h"
+#include "nvs.h"
+#include "metrics.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#ifdef CONFIG_LASER_MODULATION
+#include "esp_adc/adc_continuous.h"
+#include "sensor_lockin.h"
+#endif
+
+#ifdef CONFIG_SENSOR_TRACE
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include "sensor_trace.h"
+#endif
+
 static const char *TAG = "SENSOR_MGR";
 
+#define NVS_NAMESPACE           "sensor"
+#define NVS_KEY_THRESHOLD       "threshold"
+#define NVS_KEY_HYSTERESIS      "hysteresis"
+#define NVS_KEY_MODE            "mode"          // Detector the values belong to (0 = raw, 1 = lock-in)
+
+#define CAL_MIN_SIGMA           3       // Switching points at least this many std devs from both means
+
+#ifdef CONFIG_LASER_MODULATION
+#define LEVEL_PERIOD_MS         20      // One level per lock-in block
+#define CAL_DEFAULT_SAMPLES     50
+#define DETECTOR_MODE           1
+#else
+#define LEVEL_PERIOD_MS         10      // Worst case with a 100 Hz tick
+#define CAL_DEFAULT_SAMPLES     200
+#define DETECTOR_MODE           0
+#endif
+
 static adc_oneshot_unit_handle_t adc_handle = NULL;
 static adc_channel_t adc_chan;
 static uint16_t detection_threshold = 2000;  // For LDR: no laser ~850, with laser ~4095
+static uint16_t detection_hysteresis = 0;    // Break below threshold - h, restore above threshold + h
 static uint32_t debounce_time_ms = 100;
 static sensor_status_t current_status = SENSOR_BEAM_DETECTED;
 static beam_break_callback_t break_callback = NULL;
 static beam_restore_callback_t restore_callback = NULL;
 static TaskHandle_t monitor_task_handle = NULL;
 static bool monitoring_active = false;
+static volatile int beam_level = -1;        // Last level compared against the threshold, -1 = none yet
+
+// Beam state tracking (reset when monitoring starts)
+static bool last_state = true;              // true = beam detected
+static uint32_t last_change_time = 0;
+static uint32_t last_log_time = 0;
+
+// Level collection for calibration (filled by the monitor task, beam events suppressed)
+static volatile uint16_t collect_target = 0;
+static uint16_t collect_count = 0;
+static uint64_t collect_sum = 0;
+static uint64_t collect_sum_sq = 0;
+static uint16_t collect_min = 0;
+static uint16_t collect_max = 0;
+static TaskHandle_t collect_waiter = NULL;
+static bool collect_owns_monitor = false;   // Monitoring was started for the measurement
+static bool collect_aborted = false;        // Ended by sensor_start_monitoring()
+static portMUX_TYPE collect_lock = portMUX_INITIALIZER_UNLOCKED;
 
+static void start_monitor_task(void);
+
+#ifdef CONFIG_LASER_MODULATION
+#define LOCKIN_FRAME_BYTES (SENSOR_LOCKIN_BLOCK_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES)
+
+static adc_continuous_handle_t adc_cont_handle = NULL;
+static sensor_lockin_t lockin;
+static volatile bool adc_overflow = false;
+static metric_t *m_ambient = NULL;
+static metric_t *m_dropped_blocks = NULL;
+#endif
+
+#ifdef CONFIG_SENSOR_TRACE
 /**
- * Sensor monitoring task
+ * Trace capture state
+ */
+typedef enum {
+    TRACE_OFF = 0,
+    TRACE_ARMED,            // Recording into the ring
+    TRACE_TRIGGERED,        // Break seen, filling the post window
+    TRACE_CAPTURED          // Frozen until sensor_trace_rearm()
+} trace_state_t;
+
+// Ring of raw samples, time_us holds the absolute time (low 32 bits) until read out
+static sensor_trace_sample_t *trace_ring = NULL;
+static uint16_t trace_size = 0;
+static uint16_t trace_post = 0;
+static uint16_t trace_head = 0;
+static uint16_t trace_filled = 0;
+static uint16_t trace_post_left = 0;
+static uint16_t trace_trigger_head = 0;
+static uint32_t trace_trigger_time = 0;
+static volatile trace_state_t trace_state = TRACE_OFF;
+static SemaphoreHandle_t trace_done = NULL;
+#endif
+
+// Runtime metrics
+static metric_t *m_samples = NULL;
+static metric_t *m_read_errors = NULL;
+static metric_t *m_breaks = NULL;
+static metric_t *m_adc_value = NULL;
+
+#ifdef CONFIG_SENSOR_TRACE
+/**
+ * Record a raw sample (monitor task)
+ */
+static inline void trace_record(uint16_t value, uint32_t time_us)
+{
+    if (trace_state != TRACE_ARMED && trace_state != TRACE_TRIGGERED) {
+        return;
+    }
+    
+    trace_ring[trace_head].time_us = (int32_t)time_us;
+    trace_ring[trace_head].value = value;
+    if (++trace_head == trace_size) {
+        trace_head = 0;
+    }
+    if (trace_filled < trace_size) {
+        trace_filled++;
+    }
+    
+    if (trace_state == TRACE_TRIGGERED && --trace_post_left == 0) {
+        trace_state = TRACE_CAPTURED;
+        xSemaphoreGive(trace_done);
+    }
+}
+
+/**
+ * Beam break - keep the pre window and start the post window (monitor task)
+ */
+static void trace_trigger(void)
+{
+    if (trace_state != TRACE_ARMED) {
+        return;
+    }
+    
+    trace_trigger_head = trace_head;
+    trace_trigger_time = (uint32_t)esp_timer_get_time();
+    trace_post_left = trace_post;
+    trace_state = TRACE_TRIGGERED;
+}
+
+/**
+ * Reverse a range of the ring (for the in-place rotation)
+ */
+static void trace_reverse(sensor_trace_sample_t *a, size_t n)
+{
+    for (size_t i = 0; i < n / 2; i++) {
+        sensor_trace_sample_t t = a[i];
+        a[i] = a[n - 1 - i];
+        a[n - 1 - i] = t;
+    }
+}
+#else
+#define trace_record(value, time_us)
+#define trace_trigger()
+#endif
+
+/**
+ * Compare a new level (raw ADC or carrier amplitude) against the threshold
+ */
+static void update_beam_state(int level)
+{
+    beam_level = level;
+    
+    if (collect_target) {
+        collect_sum += level;
+        collect_sum_sq += (uint64_t)level * level;
+        collect_min = level < collect_min ? level : collect_min;
+        collect_max = level > collect_max ? level : collect_max;
+        if (++collect_count >= collect_target) {
+            collect_target = 0;
+            xTaskNotifyGive(collect_waiter);
+        }
+        return;
+    }
+    
+    // Hysteresis: a present beam has to drop below threshold - h, a broken one rise above threshold + h
+    int switch_level = last_state ? detection_threshold - detection_hysteresis
+                                  : detection_threshold + detection_hysteresis;
+    bool beam_present = (level > switch_level);
+    uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    
+    // Log level every second for debugging
+    if (current_time - last_log_time > 1000) {
+        ESP_LOGI(TAG, "Level: %d | Threshold: %d | Beam: %s", 
+                 level, detection_threshold, beam_present ? "PRESENT" : "BROKEN");
+        last_log_time = current_time;
+    }
+    
+    // Check for state change
+    if (beam_present == last_state) {
+        return;
+    }
+    
+    // Debounce
+    if (current_time - last_change_time > debounce_time_ms) {
+        last_state = beam_present;
+        last_change_time = current_time;
+        
+        if (!beam_present) {
+            // Beam broken!
+            current_status = SENSOR_BEAM_BROKEN;
+            metrics_inc(m_breaks);
+            ESP_LOGW(TAG, "Beam broken! Level: %d (threshold: %d)", 
+                     level, detection_threshold);
+            trace_trigger();
+            
+            if (break_callback) {
+                // Pass sensor identifier (use module ID as sensor ID)
+                break_callback(adc_chan);
+            }
+        } else {
+            // Beam restored
+            current_status = SENSOR_BEAM_DETECTED;
+            ESP_LOGI(TAG, "Beam restored. Level: %d", level);
+            
+            if (restore_callback) {
+                restore_callback(adc_chan);
+            }
+        }
+    }
+}
+
+#ifdef CONFIG_LASER_MODULATION
+/**
+ * DMA pool overflow - samples were lost, the current block has a phase jump
+ */
+static bool IRAM_ATTR adc_pool_ovf_callback(adc_continuous_handle_t handle,
+                                            const adc_continuous_evt_data_t *edata, void *user_data)
+{
+    adc_overflow = true;
+    return false;
+}
+
+/**
+ * Sensor monitoring task (modulated laser)
+ * Collects blocks of SENSOR_LOCKIN_BLOCK_SAMPLES and demodulates them.
  */
 static void sensor_monitor_task(void *arg)
 {
-    uint32_t last_break_time = 0;
-    bool last_state = true; // true = beam detected
-    uint32_t last_log_time = 0;
+    static uint8_t raw[LOCKIN_FRAME_BYTES];
+    static uint16_t samples[SENSOR_LOCKIN_BLOCK_SAMPLES];
+    size_t filled = 0;
     
-    ESP_LOGI(TAG, "Sensor monitoring task started");
-    ESP_LOGI(TAG, "Threshold: %d (ADC values above this = beam present)", detection_threshold);
+    ESP_LOGI(TAG, "Sensor monitoring task started (lock-in, %d Hz carrier)", SENSOR_LOCKIN_CARRIER_HZ);
+    ESP_LOGI(TAG, "Threshold: %d (carrier amplitude above this = beam present)", detection_threshold);
+    
+    adc_overflow = false;
+    ESP_ERROR_CHECK(adc_continuous_start(adc_cont_handle));
     
     while (monitoring_active) {
-        int adc_value = 0;
-        esp_err_t err = adc_oneshot_read(adc_handle, adc_chan, &adc_value);
+        uint32_t len = 0;
+        esp_err_t err = adc_continuous_read(adc_cont_handle, raw, sizeof(raw), &len, 100);
+        if (err != ESP_OK) {
+            metrics_inc(m_read_errors);
+            continue;
+        }
         
-        if (err == ESP_OK) {
-            bool beam_present = (adc_value > detection_threshold);
+        for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= len; i += SOC_ADC_DIGI_RESULT_BYTES) {
+            const adc_digi_output_data_t *d = (const adc_digi_output_data_t *)&raw[i];
+            samples[filled++] = d->type2.data;
+            if (filled < SENSOR_LOCKIN_BLOCK_SAMPLES) {
+                continue;
+            }
+            filled = 0;
             
-            // Log ADC value every second for debugging
-            uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-            if (current_time - last_log_time > 1000) {
-                ESP_LOGI(TAG, "ADC: %d | Threshold: %d | Beam: %s", 
-                         adc_value, detection_threshold, beam_present ? "PRESENT" : "BROKEN");
-                last_log_time = current_time;
+            if (adc_overflow) {
+                // Lost samples shift the phase inside the block, skip it
+                adc_overflow = false;
+                metrics_inc(m_dropped_blocks);
+                continue;
             }
             
-            // Check for state change
-            if (beam_present != last_state) {
-                uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-                
-                // Debounce
-                if (current_time - last_break_time > debounce_time_ms) {
-                    last_state = beam_present;
-                    last_break_time = current_time;
-                    
-                    if (!beam_present) {
-                        // Beam broken!
-                        current_status = SENSOR_BEAM_BROKEN;
-                        ESP_LOGW(TAG, "Beam broken! ADC: %d (threshold: %d)", 
-                                 adc_value, detection_threshold);
-                        
-                        if (break_callback) {
-                            // Pass sensor identifier (use module ID as sensor ID)
-                            break_callback(adc_chan);
-                        }
-                    } else {
-                        // Beam restored
-                        current_status = SENSOR_BEAM_DETECTED;
-                        ESP_LOGI(TAG, "Beam restored. ADC: %d", adc_value);
-                        
-                        if (restore_callback) {
-                            restore_callback(adc_chan);
-                        }
-                    }
-                }
+#ifdef CONFIG_SENSOR_TRACE
+            // The block ends now, samples are 1 / SENSOR_LOCKIN_SAMPLE_HZ apart
+            uint32_t block_end_us = (uint32_t)esp_timer_get_time();
+            for (size_t k = 0; k < SENSOR_LOCKIN_BLOCK_SAMPLES; k++) {
+                uint32_t age_us = (SENSOR_LOCKIN_BLOCK_SAMPLES - 1 - k) * (1000000 / SENSOR_LOCKIN_SAMPLE_HZ);
+                trace_record(samples[k], block_end_us - age_us);
             }
+#endif
+            
+            sensor_lockin_result_t res;
+            sensor_lockin_process(&lockin, samples, SENSOR_LOCKIN_BLOCK_SAMPLES, &res);
+            metrics_add(m_samples, SENSOR_LOCKIN_BLOCK_SAMPLES);
+            metrics_set(m_adc_value, res.amplitude);
+            metrics_set(m_ambient, res.ambient);
+            update_beam_state(res.amplitude);
+        }
+    }
+    
+    adc_continuous_stop(adc_cont_handle);
+    ESP_LOGI(TAG, "Sensor monitoring task stopped");
+    monitor_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+#else
+/**
+ * Sensor monitoring task
+ */
+static void sensor_monitor_task(void *arg)
+{
+    ESP_LOGI(TAG, "Sensor monitoring task started");
+    ESP_LOGI(TAG, "Threshold: %d (ADC values above this = beam present)", detection_threshold);
+    
+    while (monitoring_active) {
+        int adc_value = 0;
+        esp_err_t err = adc_oneshot_read(adc_handle, adc_chan, &adc_value);
+        
+        if (err != ESP_OK) {
+            metrics_inc(m_read_errors);
+        } else {
+            metrics_inc(m_samples);
+            metrics_set(m_adc_value, adc_value);
+            trace_record(adc_value, (uint32_t)esp_timer_get_time());
+            update_beam_state(adc_value);
         }
         
         vTaskDelay(pdMS_TO_TICKS(1)); // Sample every 1ms
@@ -91,6 +349,7 @@ static void sensor_monitor_task(void *arg)
     monitor_task_handle = NULL;
     vTaskDelete(NULL);
 }
+#endif
 
 /**
  * Initialize sensor manager
@@ -104,6 +363,35 @@ esp_err_t sensor_manager_init(uint8_t adc_channel, uint16_t threshold, uint32_t
     detection_threshold = threshold;
     debounce_time_ms = debounce_ms;
     
+#ifdef CONFIG_LASER_MODULATION
+    // Continuous ADC at SENSOR_LOCKIN_SAMPLES_PER_PERIOD samples per carrier period
+    adc_continuous_handle_cfg_t handle_config = {
+        .max_store_buf_size = LOCKIN_FRAME_BYTES * 4,
+        .conv_frame_size = LOCKIN_FRAME_BYTES,
+    };
+    ESP_ERROR_CHECK(adc_continuous_new_handle(&handle_config, &adc_cont_handle));
+    
+    adc_digi_pattern_config_t pattern = {
+        .atten = ADC_ATTEN_DB_12,
+        .channel = adc_chan,
+        .unit = ADC_UNIT_1,
+        .bit_width = ADC_BITWIDTH_12,
+    };
+    adc_continuous_config_t dig_config = {
+        .pattern_num = 1,
+        .adc_pattern = &pattern,
+        .sample_freq_hz = SENSOR_LOCKIN_SAMPLE_HZ,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE2,
+    };
+    ESP_ERROR_CHECK(adc_continuous_config(adc_cont_handle, &dig_config));
+    
+    adc_continuous_evt_cbs_t cbs = {
+        .on_pool_ovf = adc_pool_ovf_callback,
+    };
+    ESP_ERROR_CHECK(adc_continuous_register_event_callbacks(adc_cont_handle, &cbs, NULL));
+    sensor_lockin_init(&lockin, SENSOR_LOCKIN_SAMPLES_PER_PERIOD);
+#else
     // Initialize ADC
     adc_oneshot_unit_init_cfg_t init_config = {
         .unit_id = ADC_UNIT_1,
@@ -116,6 +404,21 @@ esp_err_t sensor_manager_init(uint8_t adc_channel, uint16_t threshold, uint32_t
         .atten = ADC_ATTEN_DB_12,
     };
     ESP_ERROR_CHECK(adc_oneshot_config_channel(adc_handle, adc_chan, &config));
+#endif
+    
+    if (!m_samples) {
+        m_samples = metrics_register_counter("laser_sensor_samples_total", "ADC samples taken", NULL);
+        m_read_errors = metrics_register_counter("laser_sensor_read_errors_total", "Failed ADC reads", NULL);
+        m_breaks = metrics_register_counter("laser_sensor_beam_breaks_total", "Debounced beam breaks", NULL);
+#ifdef CONFIG_LASER_MODULATION
+        m_adc_value = metrics_register_gauge("laser_sensor_adc_value", "Last carrier amplitude", NULL);
+        m_ambient = metrics_register_gauge("laser_sensor_ambient", "Mean ADC level of the last block", NULL);
+        m_dropped_blocks = metrics_register_counter("laser_sensor_dropped_blocks_total",
+                                                    "Sample blocks skipped after DMA overflow", NULL);
+#else
+        m_adc_value = metrics_register_gauge("laser_sensor_adc_value", "Last raw ADC reading", NULL);
+#endif
+    }
     
     ESP_LOGI(TAG, "Sensor manager initialized");
     
@@ -151,6 +454,15 @@ esp_err_t sensor_read_value(uint16_t *value)
         return ESP_ERR_INVALID_ARG;
     }
     
+#ifdef CONFIG_LASER_MODULATION
+    // The ADC belongs to the DMA sampler, report the last demodulated level
+    int level = beam_level;
+    if (level < 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    *value = (uint16_t)level;
+    return ESP_OK;
+#else
     int adc_value = 0;
     esp_err_t err = adc_oneshot_read(adc_handle, adc_chan, &adc_value);
     
@@ -159,6 +471,7 @@ esp_err_t sensor_read_value(uint16_t *value)
     }
     
     return err;
+#endif
 }
 
 /**
@@ -203,21 +516,271 @@ esp_err_t sensor_calibrate(void)
 }
 
 /**
- * Start sensor monitoring
+ * Set hysteresis
  */
-esp_err_t sensor_start_monitoring(void)
+esp_err_t sensor_set_hysteresis(uint16_t hysteresis)
 {
-    if (monitoring_active) {
-        ESP_LOGW(TAG, "Monitoring already active");
+    if (hysteresis > detection_threshold || detection_threshold + hysteresis > 4095) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    detection_hysteresis = hysteresis;
+    ESP_LOGI(TAG, "Hysteresis set to %d", hysteresis);
+    
+    return ESP_OK;
+}
+
+/**
+ * Collect level statistics
+ */
+esp_err_t sensor_measure_levels(uint16_t count, sensor_level_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (count == 0) {
+        count = CAL_DEFAULT_SAMPLES;
+    }
+    
+    ulTaskNotifyTake(pdTRUE, 0);
+    
+    // Monitoring that is already running belongs to a game, don't hide its breaks
+    taskENTER_CRITICAL(&collect_lock);
+    bool busy = collect_target != 0 || monitoring_active;
+    if (!busy) {
+        collect_count = 0;
+        collect_sum = 0;
+        collect_sum_sq = 0;
+        collect_min = UINT16_MAX;
+        collect_max = 0;
+        collect_waiter = xTaskGetCurrentTaskHandle();
+        collect_aborted = false;
+        collect_owns_monitor = true;
+        monitoring_active = true;
+        collect_target = count;     // Armed last, the monitor task only looks at this
+    }
+    taskEXIT_CRITICAL(&collect_lock);
+    if (busy) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    start_monitor_task();
+    
+    uint32_t timeout_ms = (uint32_t)count * LEVEL_PERIOD_MS * 2 + 1000;
+    bool done = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms)) > 0;
+    
+    taskENTER_CRITICAL(&collect_lock);
+    collect_target = 0;
+    bool owns = collect_owns_monitor;
+    bool aborted = collect_aborted;
+    collect_owns_monitor = false;
+    taskEXIT_CRITICAL(&collect_lock);
+    
+    if (owns) {
+        sensor_stop_monitoring();
+    }
+    
+    if (aborted) {
+        ESP_LOGW(TAG, "Level measurement aborted, monitoring started for a game");
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!done || collect_count == 0) {
+        ESP_LOGW(TAG, "Level measurement timed out (%d of %d)", collect_count, count);
+        return ESP_ERR_TIMEOUT;
+    }
+    
+    uint64_t n = collect_count;
+    uint64_t mean = (collect_sum + n / 2) / n;
+    // Var = E[x^2] - E[x]^2, exact in integers: (n * sum_sq - sum^2) / n^2
+    uint64_t var_n2 = n * collect_sum_sq - collect_sum * collect_sum;
+    
+    stats->count = collect_count;
+    stats->mean = (uint16_t)mean;
+    stats->stddev = (uint16_t)(sqrt((double)var_n2) / n + 0.5);
+    stats->min = collect_min;
+    stats->max = collect_max;
+    
+    return ESP_OK;
+}
+
+/**
+ * Choose threshold and hysteresis from laser off/on statistics
+ */
+esp_err_t sensor_calibration_compute(sensor_calibration_t *cal)
+{
+    if (!cal) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    cal->threshold = 0;
+    cal->hysteresis = 0;
+    cal->separation_x10 = 0;
+    
+    int gap = (int)cal->on.mean - (int)cal->off.mean;
+    if (gap <= 0) {
+        ESP_LOGW(TAG, "Calibration: beam does not raise the level (off %d, on %d)",
+                 cal->off.mean, cal->on.mean);
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    
+    // At least one count of noise, the ADC quantizes
+    int s_off = cal->off.stddev ? cal->off.stddev : 1;
+    int s_on = cal->on.stddev ? cal->on.stddev : 1;
+    
+    // The threshold with the same distance in std devs from both means
+    // maximizes the smaller of the two distances; that distance is z
+    int z_x10 = gap * 10 / (s_on + s_off);
+    cal->separation_x10 = z_x10 > UINT16_MAX ? UINT16_MAX : z_x10;
+    cal->threshold = cal->off.mean + gap * s_off / (s_on + s_off);
+    
+    if (z_x10 < CAL_MIN_SIGMA * 10) {
+        ESP_LOGW(TAG, "Calibration: separation %d.%d sigma, need %d",
+                 z_x10 / 10, z_x10 % 10, CAL_MIN_SIGMA);
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    
+    // Widest band that keeps both switching points CAL_MIN_SIGMA from their
+    // own distribution, but no more than the middle half of the gap
+    int h = (z_x10 - CAL_MIN_SIGMA * 10) * (s_on < s_off ? s_on : s_off) / 10;
+    if (h > gap / 4) {
+        h = gap / 4;
+    }
+    cal->hysteresis = h;
+    
+    ESP_LOGI(TAG, "Calibration: off %d +- %d, on %d +- %d -> threshold %d +- %d (%d.%d sigma)",
+             cal->off.mean, cal->off.stddev, cal->on.mean, cal->on.stddev,
+             cal->threshold, cal->hysteresis, z_x10 / 10, z_x10 % 10);
+    
+    return ESP_OK;
+}
+
+/**
+ * Apply a calibration and optionally persist it
+ */
+esp_err_t sensor_apply_calibration(uint16_t threshold, uint16_t hysteresis, bool save)
+{
+    if (threshold > 4095 || hysteresis > threshold || threshold + hysteresis > 4095) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    detection_threshold = threshold;
+    detection_hysteresis = hysteresis;
+    ESP_LOGI(TAG, "Threshold set to %d, hysteresis %d", threshold, hysteresis);
+    
+    if (!save) {
         return ESP_OK;
     }
     
-    monitoring_active = true;
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ret = nvs_set_u16(handle, NVS_KEY_THRESHOLD, threshold);
+    if (ret == ESP_OK) {
+        ret = nvs_set_u16(handle, NVS_KEY_HYSTERESIS, hysteresis);
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_set_u8(handle, NVS_KEY_MODE, DETECTOR_MODE);
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save calibration: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+/**
+ * Load the saved calibration
+ */
+esp_err_t sensor_load_calibration(void)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (ret != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    uint16_t threshold = 0;
+    uint16_t hysteresis = 0;
+    uint8_t mode = 0xFF;
+    ret = nvs_get_u16(handle, NVS_KEY_THRESHOLD, &threshold);
+    if (ret == ESP_OK) {
+        ret = nvs_get_u16(handle, NVS_KEY_HYSTERESIS, &hysteresis);
+    }
+    if (ret == ESP_OK) {
+        ret = nvs_get_u8(handle, NVS_KEY_MODE, &mode);
+    }
+    nvs_close(handle);
     
-    xTaskCreate(sensor_monitor_task, "sensor_monitor", 2048, NULL, 5, &monitor_task_handle);
+    if (ret != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (mode != DETECTOR_MODE) {
+        // Raw ADC and carrier amplitude thresholds are not interchangeable
+        ESP_LOGW(TAG, "Saved calibration is for the other detector, ignoring it");
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    ESP_LOGI(TAG, "Using saved calibration");
+    return sensor_apply_calibration(threshold, hysteresis, false);
+}
+
+/**
+ * Reset the beam state and start the monitor task (monitoring_active already set)
+ */
+static void start_monitor_task(void)
+{
+#ifdef CONFIG_SENSOR_TRACE
+    if (trace_state == TRACE_ARMED) {
+        // Don't let the pre window reach back into the previous run
+        trace_head = 0;
+        trace_filled = 0;
+    }
+#endif
+    
+    last_state = true;
+    last_change_time = 0;
+    last_log_time = 0;
+    
+    if (!monitor_task_handle) {
+        xTaskCreate(sensor_monitor_task, "sensor_monitor", 2048, NULL, 5, &monitor_task_handle);
+    }
     
     ESP_LOGI(TAG, "Sensor monitoring started");
+}
+
+/**
+ * Start sensor monitoring
+ */
+esp_err_t sensor_start_monitoring(void)
+{
+    // A running level measurement ends here, it would suppress the game's breaks
+    taskENTER_CRITICAL(&collect_lock);
+    bool measuring = collect_target != 0;
+    if (measuring) {
+        collect_target = 0;
+        collect_aborted = true;
+    }
+    bool owned = collect_owns_monitor;      // Keep running after the measurement
+    collect_owns_monitor = false;
+    bool running = monitoring_active;
+    monitoring_active = true;
+    taskEXIT_CRITICAL(&collect_lock);
     
+    if (measuring) {
+        xTaskNotifyGive(collect_waiter);
+    }
+    if (running && !owned) {
+        ESP_LOGW(TAG, "Monitoring already active");
+        return ESP_OK;
+    }
+    
+    start_monitor_task();
     return ESP_OK;
 }
 
@@ -241,3 +804,91 @@ esp_err_t sensor_stop_monitoring(void)
     
     return ESP_OK;
 }
+
+#ifdef CONFIG_SENSOR_TRACE
+/**
+ * Allocate the ring and arm the capture
+ */
+esp_err_t sensor_trace_enable(uint16_t samples, uint16_t post_samples)
+{
+    if (samples == 0 || samples > SENSOR_TRACE_MAX_SAMPLES || post_samples >= samples) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (trace_ring) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    trace_done = xSemaphoreCreateBinary();
+    trace_ring = calloc(samples, sizeof(sensor_trace_sample_t));
+    if (!trace_done || !trace_ring) {
+        free(trace_ring);
+        trace_ring = NULL;
+        if (trace_done) {
+            vSemaphoreDelete(trace_done);
+            trace_done = NULL;
+        }
+        return ESP_ERR_NO_MEM;
+    }
+    
+    trace_size = samples;
+    trace_post = post_samples ? post_samples : 1;
+    sensor_trace_rearm();
+    
+    ESP_LOGI(TAG, "Trace capture armed (%d samples, %d after a break)", samples, trace_post);
+    return ESP_OK;
+}
+
+/**
+ * Wait for a captured trace
+ */
+esp_err_t sensor_trace_wait(uint32_t timeout_ms, sensor_trace_t *trace)
+{
+    if (!trace_ring) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (xSemaphoreTake(trace_done, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    
+    // Captured: the monitor task no longer writes, rotate the oldest sample to index 0
+    uint16_t oldest = (trace_filled < trace_size) ? 0 : trace_head;
+    if (oldest) {
+        trace_reverse(trace_ring, oldest);
+        trace_reverse(trace_ring + oldest, trace_size - oldest);
+        trace_reverse(trace_ring, trace_size);
+    }
+    for (uint16_t i = 0; i < trace_filled; i++) {
+        trace_ring[i].time_us = (int32_t)((uint32_t)trace_ring[i].time_us - trace_trigger_time);
+    }
+    
+    memset(&trace->header, 0, sizeof(trace->header));
+    trace->header.magic = SENSOR_TRACE_MAGIC;
+    trace->header.version = SENSOR_TRACE_VERSION;
+#ifdef CONFIG_LASER_MODULATION
+    trace->header.detector = SENSOR_TRACE_DETECTOR_LOCKIN;
+#else
+    trace->header.detector = SENSOR_TRACE_DETECTOR_RAW;
+#endif
+    trace->header.sample_count = trace_filled;
+    trace->header.trigger_index = (trace_trigger_head + trace_size - oldest) % trace_size;
+    trace->header.threshold = detection_threshold;
+    trace->header.hysteresis = detection_hysteresis;
+    trace->samples = trace_ring;
+    
+    return ESP_OK;
+}
+
+/**
+ * Release the captured trace and capture the next break
+ */
+void sensor_trace_rearm(void)
+{
+    if (!trace_ring) {
+        return;
+    }
+    
+    trace_head = 0;
+    trace_filled = 0;
+    trace_state = TRACE_ARMED;
+}
+#endif
@@ -0,0 +1,224 @@
+/**
+ * Sensor Trace - Transport and Reassembly
+ *
+ * Sample frames carry the time of their first sample and 16 bit time
+ * deltas for the others; a frame ends early where a delta does not fit,
+ * so gaps in the recording survive the trip.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#include "sensor_trace.h"
+#include <string.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "SENSOR_TRACE";
+
+#define FRAME_SAMPLES_AT    8       // trace id, index (2), count, first time (4)
+
+// Latest received trace (main unit)
+static SemaphoreHandle_t rx_mutex = NULL;
+static sensor_trace_header_t rx_header;
+static sensor_trace_sample_t *rx_samples = NULL;
+static uint8_t *rx_have = NULL;             // One bit per sample
+static uint16_t rx_received = 0;
+static bool rx_valid = false;
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+/**
+ * Pack the header frame of a trace
+ */
+size_t sensor_trace_pack_header(const sensor_trace_header_t *header, uint8_t *data)
+{
+    data[0] = header->trace_id;
+    put_u16(&data[1], SENSOR_TRACE_HEADER_INDEX);
+    memcpy(&data[3], header, sizeof(*header));
+    return 3 + sizeof(*header);
+}
+
+/**
+ * Pack up to SENSOR_TRACE_FRAME_SAMPLES samples starting at first
+ */
+size_t sensor_trace_pack_samples(const sensor_trace_t *trace, uint16_t first, uint8_t *data)
+{
+    if (first >= trace->header.sample_count) {
+        return 0;
+    }
+
+    const sensor_trace_sample_t *s = &trace->samples[first];
+    size_t left = trace->header.sample_count - first;
+    size_t n = 1;
+
+    data[0] = trace->header.trace_id;
+    put_u16(&data[1], first);
+    memcpy(&data[4], &s[0].time_us, sizeof(int32_t));
+    put_u16(&data[FRAME_SAMPLES_AT], s[0].value);
+    put_u16(&data[FRAME_SAMPLES_AT + 2], 0);
+
+    while (n < SENSOR_TRACE_FRAME_SAMPLES && n < left) {
+        int64_t delta = (int64_t)s[n].time_us - s[n - 1].time_us;
+        if (delta < 0 || delta > UINT16_MAX) {
+            break;      // Next frame restarts with an absolute time
+        }
+        put_u16(&data[FRAME_SAMPLES_AT + n * 4], s[n].value);
+        put_u16(&data[FRAME_SAMPLES_AT + n * 4 + 2], (uint16_t)delta);
+        n++;
+    }
+
+    data[3] = (uint8_t)n;
+    return FRAME_SAMPLES_AT + n * 4;
+}
+
+/**
+ * Start reassembling a new trace (rx_mutex held)
+ */
+static esp_err_t start_trace(uint8_t module_id, const sensor_trace_header_t *header)
+{
+    free(rx_samples);
+    free(rx_have);
+    rx_samples = NULL;
+    rx_have = NULL;
+    rx_valid = false;
+    rx_received = 0;
+
+    if (header->magic != SENSOR_TRACE_MAGIC || header->version != SENSOR_TRACE_VERSION ||
+        header->sample_count == 0 || header->sample_count > SENSOR_TRACE_MAX_SAMPLES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    rx_samples = calloc(header->sample_count, sizeof(sensor_trace_sample_t));
+    rx_have = calloc((header->sample_count + 7) / 8, 1);
+    if (!rx_samples || !rx_have) {
+        free(rx_samples);
+        free(rx_have);
+        rx_samples = NULL;
+        rx_have = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    rx_header = *header;
+    rx_header.module_id = module_id;
+    rx_valid = true;
+    ESP_LOGI(TAG, "Receiving trace %d from module %d (%d samples)",
+             header->trace_id, module_id, header->sample_count);
+    return ESP_OK;
+}
+
+/**
+ * Feed a received MSG_SENSOR_TRACE payload
+ */
+esp_err_t sensor_trace_receive(uint8_t module_id, const uint8_t *data)
+{
+    if (!rx_mutex) {
+        rx_mutex = xSemaphoreCreateMutex();
+        if (!rx_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    uint16_t first = get_u16(&data[1]);
+    esp_err_t ret = ESP_OK;
+
+    xSemaphoreTake(rx_mutex, portMAX_DELAY);
+    if (first == SENSOR_TRACE_HEADER_INDEX) {
+        sensor_trace_header_t header;
+        memcpy(&header, &data[3], sizeof(header));
+        ret = start_trace(module_id, &header);
+    } else if (!rx_valid || rx_header.module_id != module_id || rx_header.trace_id != data[0]) {
+        ret = ESP_ERR_INVALID_STATE;    // Header missed, nothing to attach to
+    } else {
+        size_t n = data[3];
+        if (n == 0 || n > SENSOR_TRACE_FRAME_SAMPLES || first + n > rx_header.sample_count) {
+            ret = ESP_ERR_INVALID_ARG;
+        } else {
+            int32_t time_us;
+            memcpy(&time_us, &data[4], sizeof(time_us));
+            for (size_t i = 0; i < n; i++) {
+                const uint8_t *p = &data[FRAME_SAMPLES_AT + i * 4];
+                time_us += get_u16(&p[2]);
+                uint16_t idx = first + i;
+                rx_samples[idx].time_us = time_us;
+                rx_samples[idx].value = get_u16(p);
+                if (!(rx_have[idx / 8] & (1 << (idx % 8)))) {
+                    rx_have[idx / 8] |= 1 << (idx % 8);
+                    rx_received++;
+                }
+            }
+            if (rx_received == rx_header.sample_count) {
+                ESP_LOGI(TAG, "Trace %d from module %d complete", rx_header.trace_id, module_id);
+            }
+        }
+    }
+    xSemaphoreGive(rx_mutex);
+
+    return ret;
+}
+
+/**
+ * Describe the latest received trace
+ */
+esp_err_t sensor_trace_latest(sensor_trace_header_t *header, uint16_t *received)
+{
+    if (!rx_mutex) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    xSemaphoreTake(rx_mutex, portMAX_DELAY);
+    bool valid = rx_valid;
+    if (valid) {
+        *header = rx_header;
+        *received = rx_received;
+    }
+    xSemaphoreGive(rx_mutex);
+
+    return valid ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+/**
+ * Copy part of the latest trace as file bytes
+ */
+size_t sensor_trace_read(size_t offset, uint8_t *buf, size_t len)
+{
+    if (!rx_mutex) {
+        return 0;
+    }
+
+    size_t copied = 0;
+    xSemaphoreTake(rx_mutex, portMAX_DELAY);
+    if (rx_valid) {
+        size_t header_size = sizeof(rx_header);
+        size_t total = header_size + (size_t)rx_header.sample_count * sizeof(sensor_trace_sample_t);
+        while (copied < len && offset < total) {
+            const uint8_t *src;
+            size_t avail;
+            if (offset < header_size) {
+                src = (const uint8_t *)&rx_header + offset;
+                avail = header_size - offset;
+            } else {
+                src = (const uint8_t *)rx_samples + (offset - header_size);
+                avail = total - offset;
+            }
+            size_t n = (len - copied) < avail ? (len - copied) : avail;
+            memcpy(buf + copied, src, n);
+            copied += n;
+            offset += n;
+        }
+    }
+    xSemaphoreGive(rx_mutex);
+
+    return copied;
+}
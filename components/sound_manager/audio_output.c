@@ -2,13 +2,49 @@
  * Audio Output Manager - Implementation
  * 
  * Unified interface with automatic fallback.
+ * 
+ * The event bus is a bitmask of pending events (one slot per event, so
+ * bursts coalesce and can't pile up) drained by the audio task, which
+ * picks the backend for each event.
  */
 
 #include "audio_output.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "metrics.h"
 
 static const char *TAG = "AUDIO_OUT";
 
+#define AUDIO_TASK_STACK        3072
+#define AUDIO_TASK_PRIORITY     5
+
+// Dispatch order within one batch; the highest is dispatched last, so it
+// ends up on the stream / preempts the buzzer
+static const uint8_t event_priority[AUDIO_EVENT_MAX] = {
+    [AUDIO_EVENT_BUTTON_PRESS] = 0,
+    [AUDIO_EVENT_SUCCESS]      = 1,
+    [AUDIO_EVENT_GAME_RUNNING] = 1,
+    [AUDIO_EVENT_STARTUP]      = 2,
+    [AUDIO_EVENT_COUNTDOWN]    = 2,
+    [AUDIO_EVENT_ERROR]        = 3,
+    [AUDIO_EVENT_BEAM_BREAK]   = 3,
+    [AUDIO_EVENT_GAME_START]   = 4,
+    [AUDIO_EVENT_GAME_FINISH]  = 4,
+    [AUDIO_EVENT_GAME_STOP]    = 4,
+};
+
+// Event bus state (bus_lock)
+static portMUX_TYPE bus_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t pending_mask = 0;
+static uint32_t loop_mask = 0;
+static int64_t last_post_us[AUDIO_EVENT_MAX];
+static TaskHandle_t audio_task_handle = NULL;
+
+static metric_t *m_posted = NULL;
+static metric_t *m_coalesced = NULL;
+
 /**
  * Map audio events to buzzer patterns
  */
@@ -72,14 +108,116 @@ esp_err_t audio_play_event(audio_event_t event, bool loop)
     return ret;
 }
 
+/**
+ * Audio task - plays the pending events
+ */
+static void audio_task(void *pvParameters)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        taskENTER_CRITICAL(&bus_lock);
+        uint32_t pending = pending_mask;
+        uint32_t loop = loop_mask;
+        pending_mask = 0;
+        loop_mask = 0;
+        taskEXIT_CRITICAL(&bus_lock);
+
+        // Lowest priority first
+        while (pending) {
+            int next = -1;
+            for (int i = 0; i < AUDIO_EVENT_MAX; i++) {
+                if ((pending & (1u << i)) && (next < 0 || event_priority[i] < event_priority[next])) {
+                    next = i;
+                }
+            }
+            pending &= ~(1u << next);
+            audio_play_event((audio_event_t)next, (loop & (1u << next)) != 0);
+        }
+    }
+}
+
+esp_err_t audio_output_init(void)
+{
+    if (audio_task_handle) {
+        return ESP_OK;
+    }
+
+    m_posted = metrics_register_counter("laser_audio_events_total", "Audio events posted to the bus", NULL);
+    m_coalesced = metrics_register_counter("laser_audio_events_coalesced_total",
+                                           "Audio events dropped as repeats", NULL);
+
+    if (xTaskCreate(audio_task, "audio_bus", AUDIO_TASK_STACK, NULL,
+                    AUDIO_TASK_PRIORITY, &audio_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create audio task");
+        return ESP_FAIL;
+    }
+    metrics_register_task(audio_task_handle, "audio_bus");
+
+    ESP_LOGI(TAG, "Audio event bus started");
+    return ESP_OK;
+}
+
+esp_err_t audio_post_event(audio_event_t event, bool loop)
+{
+    if (!audio_task_handle) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if ((unsigned)event >= AUDIO_EVENT_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t now = esp_timer_get_time();
+    bool coalesced;
+
+    taskENTER_CRITICAL(&bus_lock);
+    coalesced = (pending_mask & (1u << event)) ||
+                (last_post_us[event] && now - last_post_us[event] < AUDIO_COALESCE_MS * 1000);
+    if (!coalesced) {
+        pending_mask |= 1u << event;
+        if (loop) {
+            loop_mask |= 1u << event;
+        }
+        last_post_us[event] = now;
+    }
+    taskEXIT_CRITICAL(&bus_lock);
+
+    metrics_inc(m_posted);
+    if (coalesced) {
+        metrics_inc(m_coalesced);
+        ESP_LOGD(TAG, "Event %d coalesced", event);
+        return ESP_OK;
+    }
+    xTaskNotifyGive(audio_task_handle);
+
+    return ESP_OK;
+}
+
 esp_err_t audio_stop(void)
 {
+    esp_err_t ret = ESP_OK;
+
+    // Events still waiting on the bus would start right after the stop
+    taskENTER_CRITICAL(&bus_lock);
+    pending_mask = 0;
+    loop_mask = 0;
+    taskEXIT_CRITICAL(&bus_lock);
+
+    // Stop both backends, a fallback pattern may still be on the buzzer
 #ifdef CONFIG_ENABLE_SOUND_MANAGER
     if (sound_manager_is_ready()) {
-        return sound_manager_stop();
+        ret = sound_manager_stop();
+    }
+#endif
+
+#ifdef CONFIG_ENABLE_BUZZER
+    // Drops the playing and queued patterns
+    esp_err_t buzzer_ret = buzzer_stop();
+    // A buzzer that was never set up has nothing to stop
+    if (ret == ESP_OK && buzzer_ret != ESP_ERR_INVALID_STATE) {
+        ret = buzzer_ret;
     }
 #endif
     
-    // Buzzer doesn't have explicit stop function
-    return ESP_OK;
+    return ret;
 }
@@ -1,7 +1,10 @@
 /**
  * Audio Output Manager - Unified interface for sound/buzzer output
  * 
- * Provides automatic fallback from sound manager to buzzer.
+ * Provides automatic fallback from sound manager to buzzer. Events are
+ * posted to an event bus and played by the audio task, so callers (game
+ * logic, buttons, web handlers) never wait for audio. Repeats of an event
+ * within a short window are coalesced into one sound.
  * 
  * @author ninharp
  * @date 2025
@@ -31,11 +34,36 @@ typedef enum {
     AUDIO_EVENT_GAME_FINISH = SOUND_EVENT_GAME_FINISH,
     AUDIO_EVENT_GAME_STOP = SOUND_EVENT_GAME_STOP,
     AUDIO_EVENT_ERROR = SOUND_EVENT_ERROR,
-    AUDIO_EVENT_SUCCESS = SOUND_EVENT_SUCCESS
+    AUDIO_EVENT_SUCCESS = SOUND_EVENT_SUCCESS,
+    AUDIO_EVENT_MAX = SOUND_EVENT_MAX
 } audio_event_t;
 
+// Repeats of an event within this window produce one sound
+#define AUDIO_COALESCE_MS 200
+
+/**
+ * Initialize the audio event bus and start the audio task
+ * 
+ * @return ESP_OK on success
+ */
+esp_err_t audio_output_init(void);
+
+/**
+ * Post an audio event to the bus (non-blocking)
+ * 
+ * The audio task plays pending events in priority order. An event that
+ * is already pending, or was played less than AUDIO_COALESCE_MS ago, is
+ * dropped.
+ * 
+ * @param event Audio event to play
+ * @param loop True for looping playback (sound only)
+ * @return ESP_OK if queued, ESP_ERR_INVALID_STATE if the bus is not
+ *         initialized, ESP_ERR_INVALID_ARG for unknown events
+ */
+esp_err_t audio_post_event(audio_event_t event, bool loop);
+
 /**
- * Play audio for event
+ * Play audio for event right away, in the caller's context
  * Uses sound manager if available, falls back to buzzer
  * 
  * @param event Audio event to play
@@ -47,6 +75,8 @@ esp_err_t audio_play_event(audio_event_t event, bool loop);
 /**
  * Stop audio playback
  * 
+ * Drops the events pending on the bus and stops both backends.
+ * 
  * @return ESP_OK on success
  */
 esp_err_t audio_stop(void);
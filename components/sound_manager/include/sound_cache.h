@@ -0,0 +1,122 @@
+/**
+ * Sound Cache - Header
+ *
+ * Decoded PCM clips of short event sounds, kept in RAM (PSRAM when the
+ * target has it) so they start without SD access or decoder warm-up.
+ * Clips are stored mono at SOUND_OUTPUT_SAMPLE_RATE; the decoder output
+ * is down-mixed and resampled once while the clip is built.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#ifndef SOUND_CACHE_H
+#define SOUND_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "sound_manager.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Cached clip (mono, SOUND_OUTPUT_SAMPLE_RATE, 16 bit)
+ */
+typedef struct {
+    int16_t *samples;
+    uint32_t frames;
+} sound_clip_t;
+
+/**
+ * Clip under construction (filled from decoder output)
+ */
+typedef struct {
+    int16_t *samples;           // Destination buffer
+    uint32_t frames;            // Frames written
+    uint32_t max_frames;        // Capacity
+    uint32_t step;              // Source frames per output frame (Q16)
+    int32_t pos;                // Next output position relative to the current chunk (Q16)
+    int16_t prev;               // Last source sample of the previous chunk
+    uint8_t channels;           // Source channels
+    bool overflow;              // Source was longer than the capacity
+} sound_clip_builder_t;
+
+/**
+ * Initialize the cache
+ *
+ * @param budget_bytes Maximum PCM bytes held by all clips
+ * @return ESP_OK on success
+ */
+esp_err_t sound_cache_init(size_t budget_bytes);
+
+/**
+ * Free all clips
+ */
+void sound_cache_deinit(void);
+
+/**
+ * Get the clip of an event
+ *
+ * @param event Sound event
+ * @return Clip or NULL if the event is not cached
+ */
+const sound_clip_t *sound_cache_get(sound_event_t event);
+
+/**
+ * Free the clip of an event (e.g. after its file mapping changed)
+ *
+ * @param event Sound event
+ */
+void sound_cache_drop(sound_event_t event);
+
+/**
+ * PCM bytes held by all clips
+ */
+size_t sound_cache_used(void);
+
+/**
+ * Start building a clip
+ *
+ * @param b Builder
+ * @param src_rate Sample rate of the decoder output
+ * @param src_channels Channels of the decoder output (interleaved)
+ * @param max_ms Longest clip accepted
+ * @return ESP_OK, ESP_ERR_NO_MEM if the remaining budget is too small
+ */
+esp_err_t sound_cache_begin(sound_clip_builder_t *b, uint32_t src_rate, uint8_t src_channels, uint32_t max_ms);
+
+/**
+ * Append decoder output (16 bit interleaved) to a clip
+ *
+ * @param b Builder
+ * @param pcm Samples
+ * @param frames Number of frames (samples per channel)
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE once the clip exceeds max_ms
+ */
+esp_err_t sound_cache_append(sound_clip_builder_t *b, const int16_t *pcm, size_t frames);
+
+/**
+ * Store a built clip for an event (replaces an older clip)
+ *
+ * @param b Builder (released)
+ * @param event Sound event
+ * @return ESP_OK on success
+ */
+esp_err_t sound_cache_commit(sound_clip_builder_t *b, sound_event_t event);
+
+/**
+ * Discard a clip under construction
+ *
+ * @param b Builder (released)
+ */
+void sound_cache_abort(sound_clip_builder_t *b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SOUND_CACHE_H
@@ -0,0 +1,96 @@
+/**
+ * Sound Format - Header
+ *
+ * Detects the format of a sound file from its header (MP3, WAV, raw
+ * PCM) so the sound manager can link only the pipeline stages the file
+ * needs.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#ifndef SOUND_FORMAT_H
+#define SOUND_FORMAT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Container/codec of a sound file
+ */
+typedef enum {
+    SOUND_FORMAT_UNKNOWN = 0,
+    SOUND_FORMAT_MP3,
+    SOUND_FORMAT_WAV,               // RIFF/WAVE (any codec)
+    SOUND_FORMAT_PCM,               // Headerless 16 bit PCM (.pcm/.raw)
+} sound_format_t;
+
+/**
+ * Result of sound_format_probe
+ */
+typedef struct {
+    sound_format_t format;
+    uint32_t sample_rate;           // 0 if not known before decoding
+    uint8_t channels;               // 0 if not known before decoding
+    uint8_t bits;                   // Bits per sample (PCM formats)
+    bool pcm16;                     // Plain 16 bit PCM, needs no decoder
+    uint32_t data_offset;           // Start of the PCM data / first MP3 frame
+    uint32_t data_size;             // Length of the PCM data, 0 = until EOF
+    uint16_t bitrate_kbps;          // MP3 (layer III) bitrate of the first frame
+} sound_file_info_t;
+
+// Format of headerless .pcm/.raw files (same as the I2S output)
+#define SOUND_RAW_PCM_SAMPLE_RATE 44100
+#define SOUND_RAW_PCM_CHANNELS 2
+
+// Size of the header written by sound_format_wav_header
+#define SOUND_WAV_HEADER_SIZE 44
+
+/**
+ * Detect the format of a sound file
+ *
+ * The file header decides; the extension is only used for headerless
+ * PCM and as fallback for files without a recognizable header.
+ *
+ * @param path Full file path
+ * @param info Filled with the detected format
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if the file can't be opened,
+ *         ESP_ERR_NOT_SUPPORTED for unknown formats
+ */
+esp_err_t sound_format_probe(const char *path, sound_file_info_t *info);
+
+/**
+ * Parse an MPEG audio frame header
+ *
+ * @param hdr First 4 bytes of a frame
+ * @param info sample_rate, channels and bitrate_kbps are set on success
+ * @return true if hdr is a valid frame header
+ */
+bool sound_format_parse_mp3_frame(const uint8_t hdr[4], sound_file_info_t *info);
+
+/**
+ * Build a canonical RIFF/WAVE header for 16 bit PCM
+ *
+ * @param hdr Filled with SOUND_WAV_HEADER_SIZE bytes
+ * @param sample_rate Sample rate in Hz
+ * @param channels Number of channels
+ * @param data_size Length of the PCM data following the header
+ */
+void sound_format_wav_header(uint8_t hdr[SOUND_WAV_HEADER_SIZE], uint32_t sample_rate,
+                             uint8_t channels, uint32_t data_size);
+
+/**
+ * Get a short name of a format for logging
+ */
+const char *sound_format_name(sound_format_t format);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SOUND_FORMAT_H
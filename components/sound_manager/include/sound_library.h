@@ -0,0 +1,115 @@
+/**
+ * Sound Library - Header
+ *
+ * Index of the sound files on the card with their metadata (format,
+ * sample rate, duration, peak level). The index is kept in RAM and
+ * persisted as a small binary file in the sound directory, so listing
+ * sounds needs no directory scan. It is reconciled with the directory
+ * once at mount (only new or changed files are probed) and updated on
+ * upload/delete.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#ifndef SOUND_LIBRARY_H
+#define SOUND_LIBRARY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "sound_format.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SOUND_LIBRARY_NAME_LEN      64
+#define SOUND_LIBRARY_PEAK_UNKNOWN  0xFFFF
+#define SOUND_LIBRARY_FILE          ".library"  // Index file in the sound directory
+
+/**
+ * Library entry
+ */
+typedef struct {
+    char name[SOUND_LIBRARY_NAME_LEN];
+    uint32_t size;                  // File size in bytes
+    int64_t mtime;                  // Modification time (detects replaced files)
+    uint32_t sample_rate;           // 0 if not known before decoding
+    uint32_t duration_ms;           // 0 if unknown (estimated for VBR MP3)
+    uint16_t peak;                  // Highest absolute sample, SOUND_LIBRARY_PEAK_UNKNOWN if not measured
+    uint8_t format;                 // sound_format_t
+    uint8_t channels;               // 0 if not known before decoding
+} sound_library_entry_t;
+
+/**
+ * Load the index and reconcile it with the sound directory
+ *
+ * @param dir Sound directory
+ * @return ESP_OK on success
+ */
+esp_err_t sound_library_init(const char *dir);
+
+/**
+ * Free the index
+ */
+void sound_library_deinit(void);
+
+/**
+ * Add or refresh the entry of a file (after upload or conversion)
+ *
+ * Only the header is read. For 16 bit PCM files the peak level is
+ * measured afterwards by a background worker unless it is passed in.
+ *
+ * @param filename File name (without path)
+ * @param peak Peak level if already known (e.g. from decoding),
+ *             SOUND_LIBRARY_PEAK_UNKNOWN to measure
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED for files that are not sounds
+ */
+esp_err_t sound_library_update(const char *filename, uint16_t peak);
+
+/**
+ * Remove the entry of a file (after delete)
+ *
+ * @param filename File name (without path)
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if not indexed
+ */
+esp_err_t sound_library_remove(const char *filename);
+
+/**
+ * Set the measured peak level of a file
+ *
+ * @param filename File name (without path)
+ * @param peak Highest absolute sample
+ */
+void sound_library_set_peak(const char *filename, uint16_t peak);
+
+/**
+ * Number of indexed files
+ */
+size_t sound_library_count(void);
+
+/**
+ * Copy an entry
+ *
+ * @param index Entry index (< sound_library_count())
+ * @param entry Filled with the entry
+ * @return true if the entry exists
+ */
+bool sound_library_get(size_t index, sound_library_entry_t *entry);
+
+/**
+ * Look up a file
+ *
+ * @param filename File name (without path)
+ * @param entry Filled with the entry (may be NULL)
+ * @return true if the file is indexed
+ */
+bool sound_library_find(const char *filename, sound_library_entry_t *entry);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SOUND_LIBRARY_H
@@ -13,12 +13,20 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// PCM format of the I2S output
+#define SOUND_OUTPUT_SAMPLE_RATE 44100
+#define SOUND_OUTPUT_CHANNELS 2
+
+// Longest event sound file name, including the terminator
+#define SOUND_EVENT_FILE_MAX 96
+
 /**
  * Sound events - maps to sound files
  */
@@ -129,7 +137,8 @@ esp_err_t sound_manager_start_streaming(void);
  * Set sound file mapping for event
  * 
  * @param event Sound event
- * @param filename Sound file name (NULL to use default)
+ * @param filename Sound file name (NULL to use default), shorter than
+ *                 SOUND_EVENT_FILE_MAX
  * @return ESP_OK on success, error code otherwise
  */
 esp_err_t sound_manager_set_event_file(sound_event_t event, const char *filename);
@@ -137,10 +146,28 @@ esp_err_t sound_manager_set_event_file(sound_event_t event, const char *filename
 /**
  * Get sound file mapping for event
  * 
+ * The mapping may change meanwhile (files converted to the output format),
+ * so the name is copied.
+ * 
  * @param event Sound event
- * @return Filename or NULL if not set
+ * @param buf Buffer for the file name, SOUND_EVENT_FILE_MAX fits any name
+ * @param size Size of buf
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if no file is mapped
+ */
+esp_err_t sound_manager_get_event_file(sound_event_t event, char *buf, size_t size);
+
+/**
+ * Queue a sound file for conversion to the output format
+ * 
+ * The file is decoded once in the background (while nothing plays) into
+ * "<name>_opt.wav" next to the original, which plays without decoder or
+ * resampler. Events mapped to the original are switched to the converted
+ * file. Files already in the output format are skipped.
+ * 
+ * @param filename Name of sound file (without path)
+ * @return ESP_OK if queued or nothing to do, ESP_ERR_NO_MEM if the queue is full
  */
-const char* sound_manager_get_event_file(sound_event_t event);
+esp_err_t sound_manager_transcode(const char *filename);
 
 /**
  * Save current sound configuration to NVS
@@ -0,0 +1,120 @@
+/**
+ * Sound Mixer - Header
+ *
+ * Mixes up to SOUND_MIXER_MAX_VOICES mono clip voices over one stereo
+ * music input into interleaved 16 bit stereo. Voices have a gain and a
+ * priority; while a voice at or above the duck priority plays, the music
+ * is faded down to the duck gain. Plain C without ESP-IDF dependencies so
+ * it can be built and benchmarked on the host (tools/mixer_bench).
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#ifndef SOUND_MIXER_H
+#define SOUND_MIXER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SOUND_MIXER_MAX_VOICES  8
+#define SOUND_MIXER_MAX_FRAMES  256     // Frames per render call
+#define SOUND_MIXER_UNITY       32767   // Q15 gain of 1.0
+
+/**
+ * Clip voice
+ */
+typedef struct {
+    const int16_t *samples;     // Mono clip, NULL when the voice is free
+    uint32_t frames;            // Clip length
+    uint32_t pos;               // Next frame
+    int16_t gain;               // Q15
+    uint8_t priority;           // Higher wins when voices run out
+    bool loop;                  // Restart at frame 0 instead of ending
+    uint32_t serial;            // Start order, oldest is stolen first
+} sound_voice_t;
+
+/**
+ * Mixer state
+ */
+typedef struct {
+    sound_voice_t voices[SOUND_MIXER_MAX_VOICES];
+    uint8_t num_voices;         // Voices in use (<= SOUND_MIXER_MAX_VOICES)
+    uint8_t duck_priority;      // Voices from this priority on duck the music
+    int16_t duck_gain;          // Q15 music gain while ducked
+    int16_t music_gain;         // Q15 music gain right now (ramps)
+    int16_t duck_step;          // Music gain change per frame while ramping
+    int16_t master_gain;        // Q15 applied to the mix
+    uint32_t serial;
+    int32_t acc[SOUND_MIXER_MAX_FRAMES];    // Mono voice sum of one render call
+} sound_mixer_t;
+
+/**
+ * Initialize a mixer
+ *
+ * @param m Mixer
+ * @param num_voices Number of clip voices (1..SOUND_MIXER_MAX_VOICES)
+ * @param duck_priority Voices with this priority or higher duck the music
+ * @param duck_gain Q15 music gain while ducked
+ * @param duck_ramp_frames Frames for a full fade between unity and silence
+ */
+void sound_mixer_init(sound_mixer_t *m, uint8_t num_voices, uint8_t duck_priority,
+                      int16_t duck_gain, uint32_t duck_ramp_frames);
+
+/**
+ * Start a clip on a free voice
+ *
+ * If all voices are busy the oldest voice with the lowest priority is
+ * replaced, as long as its priority is not above the new one.
+ *
+ * @param m Mixer
+ * @param samples Mono clip (must stay valid while playing)
+ * @param frames Clip length
+ * @param gain Q15 gain
+ * @param priority Voice priority
+ * @param loop Repeat the clip until stopped
+ * @return Voice index, -1 if every voice has a higher priority
+ */
+int sound_mixer_play(sound_mixer_t *m, const int16_t *samples, uint32_t frames,
+                     int16_t gain, uint8_t priority, bool loop);
+
+/**
+ * Stop every voice playing the given clip
+ */
+void sound_mixer_stop_clip(sound_mixer_t *m, const int16_t *samples);
+
+/**
+ * Stop all voices
+ */
+void sound_mixer_stop_all(sound_mixer_t *m);
+
+/**
+ * Number of voices playing
+ */
+int sound_mixer_active(const sound_mixer_t *m);
+
+/**
+ * Set the master gain (Q15)
+ */
+void sound_mixer_set_master(sound_mixer_t *m, int16_t gain);
+
+/**
+ * Render one block
+ *
+ * @param m Mixer
+ * @param music Interleaved stereo music, NULL for none
+ * @param out Interleaved stereo output (may be the music buffer)
+ * @param frames Frames to render (<= SOUND_MIXER_MAX_FRAMES)
+ */
+void sound_mixer_render(sound_mixer_t *m, const int16_t *music, int16_t *out, size_t frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SOUND_MIXER_H
@@ -0,0 +1,211 @@
+/**
+ * Sound Cache - Implementation
+ *
+ * PCM clips for short event sounds. The builder down-mixes to mono and
+ * resamples by linear interpolation while the decoder output streams in,
+ * so loading needs no buffer for the full decoded file.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#include "sound_cache.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "SOUND_CACHE";
+
+static sound_clip_t clips[SOUND_EVENT_MAX];
+static size_t budget = 0;
+static size_t used = 0;
+
+/**
+ * Allocate PCM memory, preferring PSRAM
+ */
+static void *pcm_alloc(size_t size)
+{
+    void *buf = NULL;
+#ifdef CONFIG_SPIRAM
+    buf = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+#endif
+    if (!buf) {
+        buf = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    return buf;
+}
+
+/**
+ * Initialize the cache
+ */
+esp_err_t sound_cache_init(size_t budget_bytes)
+{
+    sound_cache_deinit();
+    budget = budget_bytes;
+    ESP_LOGI(TAG, "PCM cache budget %u KB", (unsigned)(budget / 1024));
+    return ESP_OK;
+}
+
+/**
+ * Free all clips
+ */
+void sound_cache_deinit(void)
+{
+    for (int i = 0; i < SOUND_EVENT_MAX; i++) {
+        sound_cache_drop((sound_event_t)i);
+    }
+    used = 0;
+}
+
+/**
+ * Get the clip of an event
+ */
+const sound_clip_t *sound_cache_get(sound_event_t event)
+{
+    if (event >= SOUND_EVENT_MAX || !clips[event].samples) {
+        return NULL;
+    }
+    return &clips[event];
+}
+
+/**
+ * Free the clip of an event
+ */
+void sound_cache_drop(sound_event_t event)
+{
+    if (event >= SOUND_EVENT_MAX || !clips[event].samples) {
+        return;
+    }
+    used -= clips[event].frames * sizeof(int16_t);
+    heap_caps_free(clips[event].samples);
+    clips[event].samples = NULL;
+    clips[event].frames = 0;
+}
+
+/**
+ * PCM bytes held by all clips
+ */
+size_t sound_cache_used(void)
+{
+    return used;
+}
+
+/**
+ * Start building a clip
+ */
+esp_err_t sound_cache_begin(sound_clip_builder_t *b, uint32_t src_rate, uint8_t src_channels, uint32_t max_ms)
+{
+    if (!b || src_rate == 0 || src_channels == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(b, 0, sizeof(*b));
+    uint32_t max_frames = (uint32_t)((uint64_t)SOUND_OUTPUT_SAMPLE_RATE * max_ms / 1000);
+    size_t room = (budget > used) ? (budget - used) / sizeof(int16_t) : 0;
+    if (max_frames > room) {
+        max_frames = room;
+    }
+    if (max_frames == 0) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    b->samples = pcm_alloc(max_frames * sizeof(int16_t));
+    if (!b->samples) {
+        return ESP_ERR_NO_MEM;
+    }
+    b->max_frames = max_frames;
+    b->step = (uint32_t)(((uint64_t)src_rate << 16) / SOUND_OUTPUT_SAMPLE_RATE);
+    b->channels = src_channels;
+    return ESP_OK;
+}
+
+/**
+ * Append decoder output to a clip
+ */
+esp_err_t sound_cache_append(sound_clip_builder_t *b, const int16_t *pcm, size_t frames)
+{
+    if (!b || !b->samples) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (frames == 0) {
+        return ESP_OK;
+    }
+
+    // Down-mix a block, then interpolate output samples from it
+    int16_t mono[256];
+    while (frames > 0) {
+        size_t n = (frames < 256) ? frames : 256;
+        for (size_t i = 0; i < n; i++) {
+            int32_t sum = 0;
+            for (uint8_t c = 0; c < b->channels; c++) {
+                sum += pcm[i * b->channels + c];
+            }
+            mono[i] = (int16_t)(sum / b->channels);
+        }
+
+        // pos is relative to mono[0]; -1 refers to prev (last sample of the previous chunk)
+        while (true) {
+            int32_t idx = (b->pos < 0) ? -1 : (b->pos >> 16);
+            if (idx + 1 >= (int32_t)n) {
+                break;
+            }
+            if (b->frames >= b->max_frames) {
+                b->overflow = true;
+                return ESP_ERR_INVALID_SIZE;
+            }
+            int32_t s0 = (idx < 0) ? b->prev : mono[idx];
+            int32_t s1 = mono[idx + 1];
+            int32_t frac = b->pos - (idx << 16);
+            b->samples[b->frames++] = (int16_t)(s0 + (((s1 - s0) * frac) >> 16));
+            b->pos += b->step;
+        }
+
+        b->pos -= (int32_t)(n << 16);
+        b->prev = mono[n - 1];
+        pcm += n * b->channels;
+        frames -= n;
+    }
+    return ESP_OK;
+}
+
+/**
+ * Store a built clip for an event
+ */
+esp_err_t sound_cache_commit(sound_clip_builder_t *b, sound_event_t event)
+{
+    if (!b || !b->samples || event >= SOUND_EVENT_MAX) {
+        sound_cache_abort(b);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (b->overflow || b->frames == 0) {
+        sound_cache_abort(b);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    sound_cache_drop(event);
+
+    // Give back the unused tail of the buffer
+    int16_t *samples = realloc(b->samples, b->frames * sizeof(int16_t));
+    clips[event].samples = samples ? samples : b->samples;
+    clips[event].frames = b->frames;
+    used += b->frames * sizeof(int16_t);
+
+    ESP_LOGI(TAG, "Event %d cached: %lu frames (%lu ms, %u bytes)", event,
+             (unsigned long)b->frames, (unsigned long)(b->frames * 1000 / SOUND_OUTPUT_SAMPLE_RATE),
+             (unsigned)(b->frames * sizeof(int16_t)));
+
+    b->samples = NULL;
+    return ESP_OK;
+}
+
+/**
+ * Discard a clip under construction
+ */
+void sound_cache_abort(sound_clip_builder_t *b)
+{
+    if (b && b->samples) {
+        heap_caps_free(b->samples);
+        b->samples = NULL;
+    }
+}
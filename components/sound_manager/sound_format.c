@@ -0,0 +1,244 @@
+/**
+ * Sound Format - Implementation
+ *
+ * Header parsing for MP3 (ID3v2 tag skipped, first frame header) and
+ * RIFF/WAVE (fmt and data chunks). Reads at most a few hundred bytes.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#include "sound_format.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+static const char *TAG = "SOUND_FMT";
+
+#define MP3_SYNC_SEARCH_LEN 512     // Padding allowed between ID3 tag and first frame
+#define WAV_MAX_CHUNKS 16           // Give up on files with more chunks before "data"
+#define WAVE_FORMAT_PCM 0x0001
+#define WAVE_FORMAT_EXTENSIBLE 0xFFFE
+
+static uint16_t rd16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t rd32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void wr16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void wr32(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = v >> 24;
+}
+
+/**
+ * Check the file extension (case insensitive)
+ */
+static bool has_extension(const char *path, const char *ext)
+{
+    const char *dot = strrchr(path, '.');
+    return dot && strcasecmp(dot + 1, ext) == 0;
+}
+
+/**
+ * Parse an MPEG audio frame header
+ */
+bool sound_format_parse_mp3_frame(const uint8_t hdr[4], sound_file_info_t *info)
+{
+    static const uint32_t rates[4][3] = {
+        {11025, 12000, 8000},       // MPEG 2.5
+        {0, 0, 0},                  // Reserved
+        {22050, 24000, 16000},      // MPEG 2
+        {44100, 48000, 32000},      // MPEG 1
+    };
+    static const uint16_t l3_kbps[2][15] = {
+        {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160},        // MPEG 2/2.5
+        {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320},    // MPEG 1
+    };
+
+    if (hdr[0] != 0xFF || (hdr[1] & 0xE0) != 0xE0) {
+        return false;
+    }
+    uint8_t version = (hdr[1] >> 3) & 0x03;
+    uint8_t layer = (hdr[1] >> 1) & 0x03;
+    uint8_t bitrate = hdr[2] >> 4;
+    uint8_t rate_idx = (hdr[2] >> 2) & 0x03;
+    if (version == 1 || layer == 0 || bitrate == 0x0F || rate_idx == 3) {
+        return false;
+    }
+
+    info->sample_rate = rates[version][rate_idx];
+    info->channels = ((hdr[3] >> 6) == 3) ? 1 : 2;
+    info->bitrate_kbps = (layer == 1) ? l3_kbps[version == 3][bitrate] : 0;
+    return true;
+}
+
+/**
+ * Find the first MP3 frame (after an optional ID3v2 tag)
+ */
+static bool probe_mp3(FILE *f, const uint8_t *head, size_t head_len, sound_file_info_t *info)
+{
+    long start = 0;
+    if (head_len >= 10 && memcmp(head, "ID3", 3) == 0) {
+        // Tag size is syncsafe (7 bits per byte), plus header and optional footer
+        start = 10 + (((head[6] & 0x7F) << 21) | ((head[7] & 0x7F) << 14) |
+                      ((head[8] & 0x7F) << 7) | (head[9] & 0x7F));
+        if (head[5] & 0x10) {
+            start += 10;
+        }
+    }
+
+    uint8_t buf[MP3_SYNC_SEARCH_LEN];
+    if (fseek(f, start, SEEK_SET) != 0) {
+        return false;
+    }
+    size_t len = fread(buf, 1, sizeof(buf), f);
+    for (size_t i = 0; i + 4 <= len; i++) {
+        if (sound_format_parse_mp3_frame(&buf[i], info)) {
+            info->format = SOUND_FORMAT_MP3;
+            info->data_offset = (uint32_t)(start + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Walk the RIFF chunks up to "data"
+ */
+static bool probe_wav(FILE *f, sound_file_info_t *info)
+{
+    uint8_t chunk[8];
+    uint8_t fmt[40];
+    bool have_fmt = false;
+    uint16_t codec = 0;
+    long pos = 12;
+
+    for (int i = 0; i < WAV_MAX_CHUNKS; i++) {
+        if (fseek(f, pos, SEEK_SET) != 0 || fread(chunk, 1, sizeof(chunk), f) != sizeof(chunk)) {
+            return false;
+        }
+        uint32_t size = rd32(&chunk[4]);
+        pos += sizeof(chunk);
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            size_t len = size < sizeof(fmt) ? size : sizeof(fmt);
+            if (len < 16 || fread(fmt, 1, len, f) != len) {
+                return false;
+            }
+            codec = rd16(&fmt[0]);
+            if (codec == WAVE_FORMAT_EXTENSIBLE && len >= 26) {
+                codec = rd16(&fmt[24]);  // First two bytes of the sub-format GUID
+            }
+            info->channels = (uint8_t)rd16(&fmt[2]);
+            info->sample_rate = rd32(&fmt[4]);
+            info->bits = (uint8_t)rd16(&fmt[14]);
+            have_fmt = true;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!have_fmt) {
+                return false;
+            }
+            info->format = SOUND_FORMAT_WAV;
+            info->pcm16 = (codec == WAVE_FORMAT_PCM && info->bits == 16 &&
+                           info->channels >= 1 && info->channels <= 2);
+            info->data_offset = (uint32_t)pos;
+            info->data_size = size;
+            return true;
+        }
+        pos += size + (size & 1);   // Chunks are padded to even length
+    }
+    return false;
+}
+
+/**
+ * Detect the format of a sound file
+ */
+esp_err_t sound_format_probe(const char *path, sound_file_info_t *info)
+{
+    memset(info, 0, sizeof(*info));
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    uint8_t head[12];
+    size_t head_len = fread(head, 1, sizeof(head), f);
+
+    if (head_len == sizeof(head) && memcmp(head, "RIFF", 4) == 0 && memcmp(&head[8], "WAVE", 4) == 0) {
+        if (!probe_wav(f, info)) {
+            // Leave odd layouts to the WAV decoder
+            memset(info, 0, sizeof(*info));
+            info->format = SOUND_FORMAT_WAV;
+        }
+    } else if (has_extension(path, "pcm") || has_extension(path, "raw")) {
+        info->format = SOUND_FORMAT_PCM;
+        info->sample_rate = SOUND_RAW_PCM_SAMPLE_RATE;
+        info->channels = SOUND_RAW_PCM_CHANNELS;
+        info->bits = 16;
+        info->pcm16 = true;
+    } else if (!probe_mp3(f, head, head_len, info) && has_extension(path, "mp3")) {
+        // No frame found near the start, the decoder may still resync
+        info->format = SOUND_FORMAT_MP3;
+    }
+    fclose(f);
+
+    if (info->format == SOUND_FORMAT_UNKNOWN) {
+        ESP_LOGW(TAG, "Unknown format: %s", path);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    ESP_LOGD(TAG, "%s: %s, %lu Hz, %d ch%s", path, sound_format_name(info->format),
+             (unsigned long)info->sample_rate, info->channels, info->pcm16 ? ", PCM" : "");
+    return ESP_OK;
+}
+
+/**
+ * Build a canonical RIFF/WAVE header for 16 bit PCM
+ */
+void sound_format_wav_header(uint8_t hdr[SOUND_WAV_HEADER_SIZE], uint32_t sample_rate,
+                             uint8_t channels, uint32_t data_size)
+{
+    uint16_t block_align = channels * sizeof(int16_t);
+
+    memcpy(&hdr[0], "RIFF", 4);
+    wr32(&hdr[4], SOUND_WAV_HEADER_SIZE - 8 + data_size);
+    memcpy(&hdr[8], "WAVE", 4);
+    memcpy(&hdr[12], "fmt ", 4);
+    wr32(&hdr[16], 16);
+    wr16(&hdr[20], WAVE_FORMAT_PCM);
+    wr16(&hdr[22], channels);
+    wr32(&hdr[24], sample_rate);
+    wr32(&hdr[28], sample_rate * block_align);
+    wr16(&hdr[32], block_align);
+    wr16(&hdr[34], 16);
+    memcpy(&hdr[36], "data", 4);
+    wr32(&hdr[40], data_size);
+}
+
+/**
+ * Get a short name of a format for logging
+ */
+const char *sound_format_name(sound_format_t format)
+{
+    switch (format) {
+        case SOUND_FORMAT_MP3: return "MP3";
+        case SOUND_FORMAT_WAV: return "WAV";
+        case SOUND_FORMAT_PCM: return "PCM";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,584 @@
+/**
+ * Sound Library - Implementation
+ *
+ * The index file is a header followed by the entries as stored in RAM;
+ * a different entry size or version discards it and the directory is
+ * indexed from scratch. Updates rewrite the whole file (about 96 bytes
+ * per entry, 24 KB for 256 files) via a temporary file; the old index is
+ * renamed aside until the new one is in place, so a power loss leaves
+ * one of them. Peak levels are measured by a worker task, since that
+ * reads the whole file; it writes the index once its queue has drained.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#include "sound_library.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "SOUND_LIB";
+
+#ifndef CONFIG_SOUND_LIBRARY_MAX_FILES
+#define CONFIG_SOUND_LIBRARY_MAX_FILES 256
+#endif
+
+#define LIBRARY_MAGIC       "SLIB"
+#define LIBRARY_VERSION     1
+#define LIBRARY_GROW        16          // Entries added per reallocation
+#define PEAK_SCAN_SAMPLES   256
+#define PEAK_QUEUE_LEN      16          // Files waiting for a peak measurement
+#define PEAK_TASK_STACK     3072
+#define PEAK_TASK_PRIORITY  2           // Below playback and network tasks
+#define PEAK_SAVE_DELAY_MS  2000        // Idle time before measured peaks are written
+
+/**
+ * Index file header
+ */
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t entry_size;
+    uint32_t count;
+} library_header_t;
+
+static char library_dir[64] = "";
+static sound_library_entry_t *entries = NULL;
+static size_t entry_count = 0;
+static size_t entry_capacity = 0;
+static SemaphoreHandle_t lib_mutex = NULL;
+
+// Peak worker (an empty name asks it to exit)
+static QueueHandle_t peak_queue = NULL;
+static SemaphoreHandle_t peak_exited = NULL;
+
+/**
+ * Check if a directory entry can be a sound file
+ */
+static bool is_indexable(const char *name)
+{
+    size_t len = strlen(name);
+    if (name[0] == '.' || len >= SOUND_LIBRARY_NAME_LEN) {
+        return false;   // Hidden (including the index itself) or too long
+    }
+    return !(len > 4 && strcmp(name + len - 4, ".tmp") == 0);
+}
+
+/**
+ * Find the entry of a file (lib_mutex held)
+ */
+static int find_entry(const char *name)
+{
+    for (size_t i = 0; i < entry_count; i++) {
+        if (strcmp(entries[i].name, name) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Add or replace an entry (lib_mutex held)
+ */
+static esp_err_t put_entry(const sound_library_entry_t *entry)
+{
+    int idx = find_entry(entry->name);
+    if (idx >= 0) {
+        entries[idx] = *entry;
+        return ESP_OK;
+    }
+
+    if (entry_count >= CONFIG_SOUND_LIBRARY_MAX_FILES) {
+        ESP_LOGW(TAG, "Library full, %s not indexed", entry->name);
+        return ESP_ERR_NO_MEM;
+    }
+    if (entry_count == entry_capacity) {
+        sound_library_entry_t *grown = realloc(entries, (entry_capacity + LIBRARY_GROW) * sizeof(*entries));
+        if (!grown) {
+            return ESP_ERR_NO_MEM;
+        }
+        entries = grown;
+        entry_capacity += LIBRARY_GROW;
+    }
+    entries[entry_count++] = *entry;
+    return ESP_OK;
+}
+
+/**
+ * Write the index file (lib_mutex held)
+ */
+static esp_err_t save_index(void)
+{
+    char path[128], tmp[132];
+    snprintf(path, sizeof(path), "%s/%s", library_dir, SOUND_LIBRARY_FILE);
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    FILE *f = fopen(tmp, "wb");
+    if (!f) {
+        ESP_LOGW(TAG, "Cannot write %s", tmp);
+        return ESP_FAIL;
+    }
+
+    library_header_t hdr = {
+        .version = LIBRARY_VERSION,
+        .entry_size = sizeof(sound_library_entry_t),
+        .count = entry_count,
+    };
+    memcpy(hdr.magic, LIBRARY_MAGIC, sizeof(hdr.magic));
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1 &&
+              fwrite(entries, sizeof(*entries), entry_count, f) == entry_count;
+    ok = (fclose(f) == 0) && ok;
+
+    // FAT rename doesn't replace: move the old index aside until the new one is in place
+    char old[132];
+    snprintf(old, sizeof(old), "%s.old", path);
+    unlink(old);
+    rename(path, old);
+    if (!ok || rename(tmp, path) != 0) {
+        unlink(tmp);
+        rename(old, path);
+        ESP_LOGW(TAG, "Failed to save the library index");
+        return ESP_FAIL;
+    }
+    unlink(old);
+    return ESP_OK;
+}
+
+/**
+ * Read the index file (lib_mutex held)
+ */
+static void load_index(void)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "%s/%s", library_dir, SOUND_LIBRARY_FILE);
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        // Power lost between moving the old index aside and renaming the new one
+        strlcat(path, ".old", sizeof(path));
+        f = fopen(path, "rb");
+        if (!f) {
+            return;
+        }
+    }
+
+    library_header_t hdr;
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1 || memcmp(hdr.magic, LIBRARY_MAGIC, sizeof(hdr.magic)) != 0 ||
+        hdr.version != LIBRARY_VERSION || hdr.entry_size != sizeof(sound_library_entry_t) ||
+        hdr.count > CONFIG_SOUND_LIBRARY_MAX_FILES) {
+        ESP_LOGI(TAG, "Library index outdated, rebuilding");
+        fclose(f);
+        return;
+    }
+
+    entries = malloc((hdr.count + LIBRARY_GROW) * sizeof(*entries));
+    if (entries) {
+        entry_capacity = hdr.count + LIBRARY_GROW;
+        entry_count = fread(entries, sizeof(*entries), hdr.count, f);
+    }
+    fclose(f);
+}
+
+/**
+ * Read the PCM data of a file once to find its peak level
+ */
+static uint16_t measure_peak(const char *path, const sound_file_info_t *info)
+{
+    int16_t buf[PEAK_SCAN_SAMPLES];
+    FILE *f = fopen(path, "rb");
+    if (!f || fseek(f, info->data_offset, SEEK_SET) != 0) {
+        if (f) {
+            fclose(f);
+        }
+        return SOUND_LIBRARY_PEAK_UNKNOWN;
+    }
+
+    uint32_t remaining = info->data_size ? info->data_size / sizeof(int16_t) : UINT32_MAX;
+    int32_t peak = 0;
+    size_t n;
+    while (remaining > 0 &&
+           (n = fread(buf, sizeof(int16_t), remaining < PEAK_SCAN_SAMPLES ? remaining : PEAK_SCAN_SAMPLES, f)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            int32_t s = buf[i] < 0 ? -buf[i] : buf[i];
+            if (s > peak) {
+                peak = s;
+            }
+        }
+        remaining -= n;
+    }
+    fclose(f);
+    return (uint16_t)peak;
+}
+
+/**
+ * Store the peak level of a file (lib_mutex held)
+ * 
+ * @return true if the entry changed
+ */
+static bool store_peak(const char *filename, uint16_t peak)
+{
+    int idx = find_entry(filename);
+    if (idx < 0 || entries[idx].peak == peak) {
+        return false;
+    }
+    entries[idx].peak = peak;
+    return true;
+}
+
+/**
+ * Write the peaks measured by the worker
+ */
+static void save_peaks(void)
+{
+    xSemaphoreTake(lib_mutex, portMAX_DELAY);
+    save_index();
+    xSemaphoreGive(lib_mutex);
+}
+
+/**
+ * Peak worker - measures the files queued by queue_peak()
+ * 
+ * Peaks are kept in RAM until no file arrived for PEAK_SAVE_DELAY_MS,
+ * so a batch of new files costs one index write instead of one each.
+ */
+static void peak_task(void *pvParameters)
+{
+    char name[SOUND_LIBRARY_NAME_LEN];
+    bool dirty = false;
+
+    while (1) {
+        if (xQueueReceive(peak_queue, name, dirty ? pdMS_TO_TICKS(PEAK_SAVE_DELAY_MS) : portMAX_DELAY) != pdTRUE) {
+            save_peaks();
+            dirty = false;
+            continue;
+        }
+        if (!name[0]) {
+            break;
+        }
+
+        char path[128];
+        snprintf(path, sizeof(path), "%s/%s", library_dir, name);
+
+        sound_file_info_t info;
+        if (sound_format_probe(path, &info) != ESP_OK || !info.pcm16) {
+            continue;   // Deleted or replaced in the meantime
+        }
+        uint16_t peak = measure_peak(path, &info);
+        if (peak != SOUND_LIBRARY_PEAK_UNKNOWN) {
+            xSemaphoreTake(lib_mutex, portMAX_DELAY);
+            dirty |= store_peak(name, peak);
+            xSemaphoreGive(lib_mutex);
+        }
+    }
+
+    if (dirty) {
+        save_peaks();
+    }
+    xSemaphoreGive(peak_exited);
+    vTaskDelete(NULL);
+}
+
+/**
+ * Queue an indexed PCM file without a known peak for the peak worker
+ */
+static void queue_peak(const sound_library_entry_t *entry)
+{
+    if (entry->peak != SOUND_LIBRARY_PEAK_UNKNOWN ||
+        (entry->format != SOUND_FORMAT_WAV && entry->format != SOUND_FORMAT_PCM)) {
+        return;     // The worker skips WAVs that are not 16 bit PCM
+    }
+
+    const char *name = entry->name;
+    char item[SOUND_LIBRARY_NAME_LEN];
+    strlcpy(item, name, sizeof(item));
+    if (!peak_queue || xQueueSend(peak_queue, item, 0) != pdTRUE) {
+        ESP_LOGD(TAG, "%s: peak not measured (worker busy)", name);
+    }
+}
+
+/**
+ * Probe a file into an entry
+ */
+static esp_err_t scan_file(const char *name, const struct stat *st, uint16_t peak, sound_library_entry_t *entry)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "%s/%s", library_dir, name);
+
+    sound_file_info_t info;
+    esp_err_t err = sound_format_probe(path, &info);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    memset(entry, 0, sizeof(*entry));
+    strlcpy(entry->name, name, sizeof(entry->name));
+    entry->size = st->st_size;
+    entry->mtime = st->st_mtime;
+    entry->format = info.format;
+    entry->sample_rate = info.sample_rate;
+    entry->channels = info.channels;
+
+    uint32_t data_size = info.data_size ? info.data_size : entry->size - info.data_offset;
+    if (info.pcm16 && info.sample_rate && info.channels) {
+        entry->duration_ms = (uint64_t)data_size * 1000 / (info.sample_rate * info.channels * sizeof(int16_t));
+    } else if (info.format == SOUND_FORMAT_MP3 && info.bitrate_kbps) {
+        entry->duration_ms = (uint64_t)data_size * 8 / info.bitrate_kbps;   // Exact for CBR
+    }
+
+    entry->peak = peak;
+    return ESP_OK;
+}
+
+/**
+ * Load the index and reconcile it with the sound directory
+ */
+esp_err_t sound_library_init(const char *dir)
+{
+    if (lib_mutex) {
+        return ESP_OK;
+    }
+    lib_mutex = xSemaphoreCreateMutex();
+    if (!lib_mutex) {
+        return ESP_ERR_NO_MEM;
+    }
+    strlcpy(library_dir, dir, sizeof(library_dir));
+
+    peak_queue = xQueueCreate(PEAK_QUEUE_LEN, SOUND_LIBRARY_NAME_LEN);
+    peak_exited = xSemaphoreCreateBinary();
+    if (!peak_queue || !peak_exited ||
+        xTaskCreate(peak_task, "sound_peak", PEAK_TASK_STACK, NULL, PEAK_TASK_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGW(TAG, "No peak worker, peak levels stay unknown");
+        if (peak_queue) {
+            vQueueDelete(peak_queue);
+            peak_queue = NULL;
+        }
+    }
+
+    xSemaphoreTake(lib_mutex, portMAX_DELAY);
+    load_index();
+    size_t loaded = entry_count;
+
+    DIR *d = opendir(library_dir);
+    if (!d) {
+        xSemaphoreGive(lib_mutex);
+        ESP_LOGW(TAG, "Sound directory %s not found", library_dir);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // One stat per file; only new or changed files are probed
+    bool *seen = calloc(loaded ? loaded : 1, sizeof(bool));
+    size_t probed = 0;
+    bool changed = false;
+    struct dirent *de;
+    while ((de = readdir(d)) != NULL) {
+        if (de->d_type != DT_REG || !is_indexable(de->d_name)) {
+            continue;
+        }
+        char path[128];
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/%s", library_dir, de->d_name);
+        if (stat(path, &st) != 0) {
+            continue;
+        }
+
+        int idx = find_entry(de->d_name);
+        if (idx >= 0 && entries[idx].size == (uint32_t)st.st_size && entries[idx].mtime == st.st_mtime) {
+            if ((size_t)idx < loaded && seen) {
+                seen[idx] = true;
+            }
+            continue;
+        }
+
+        sound_library_entry_t entry;
+        if (scan_file(de->d_name, &st, SOUND_LIBRARY_PEAK_UNKNOWN, &entry) == ESP_OK) {
+            if (idx >= 0 && (size_t)idx < loaded && seen) {
+                seen[idx] = true;
+            }
+            if (put_entry(&entry) == ESP_OK) {
+                queue_peak(&entry);
+            }
+            probed++;
+            changed = true;
+        }
+    }
+    closedir(d);
+
+    // Drop files that are gone (keep the order of the rest)
+    size_t kept = 0;
+    for (size_t i = 0; i < entry_count; i++) {
+        if (i < loaded && seen && !seen[i]) {
+            changed = true;
+            continue;
+        }
+        entries[kept++] = entries[i];
+    }
+    entry_count = kept;
+    free(seen);
+
+    if (changed) {
+        save_index();
+    }
+    xSemaphoreGive(lib_mutex);
+
+    ESP_LOGI(TAG, "Sound library: %u files (%u probed)", (unsigned)entry_count, (unsigned)probed);
+    return ESP_OK;
+}
+
+/**
+ * Free the index
+ */
+void sound_library_deinit(void)
+{
+    if (!lib_mutex) {
+        return;
+    }
+    if (peak_queue) {
+        // Let the worker finish its file, it writes the pending peaks on exit
+        char stop[SOUND_LIBRARY_NAME_LEN] = "";
+        xQueueReset(peak_queue);
+        xQueueSendToFront(peak_queue, stop, portMAX_DELAY);
+        xSemaphoreTake(peak_exited, portMAX_DELAY);
+        vQueueDelete(peak_queue);
+        peak_queue = NULL;
+    }
+    if (peak_exited) {
+        vSemaphoreDelete(peak_exited);
+        peak_exited = NULL;
+    }
+    free(entries);
+    entries = NULL;
+    entry_count = 0;
+    entry_capacity = 0;
+    vSemaphoreDelete(lib_mutex);
+    lib_mutex = NULL;
+}
+
+/**
+ * Add or refresh the entry of a file
+ */
+esp_err_t sound_library_update(const char *filename, uint16_t peak)
+{
+    if (!lib_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!is_indexable(filename)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char path[128];
+    struct stat st;
+    snprintf(path, sizeof(path), "%s/%s", library_dir, filename);
+    if (stat(path, &st) != 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // Probe without the lock (header only, the peak is measured by the worker)
+    sound_library_entry_t entry;
+    esp_err_t err = scan_file(filename, &st, peak, &entry);
+    if (err != ESP_OK) {
+        sound_library_remove(filename);
+        return err;
+    }
+
+    xSemaphoreTake(lib_mutex, portMAX_DELAY);
+    err = put_entry(&entry);
+    if (err == ESP_OK) {
+        save_index();
+        queue_peak(&entry);
+    }
+    xSemaphoreGive(lib_mutex);
+
+    ESP_LOGD(TAG, "%s: %s, %lu Hz, %d ch, %lu ms", filename, sound_format_name(entry.format),
+             (unsigned long)entry.sample_rate, entry.channels, (unsigned long)entry.duration_ms);
+    return err;
+}
+
+/**
+ * Remove the entry of a file
+ */
+esp_err_t sound_library_remove(const char *filename)
+{
+    if (!lib_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(lib_mutex, portMAX_DELAY);
+    int idx = find_entry(filename);
+    if (idx >= 0) {
+        memmove(&entries[idx], &entries[idx + 1], (entry_count - idx - 1) * sizeof(*entries));
+        entry_count--;
+        save_index();
+    }
+    xSemaphoreGive(lib_mutex);
+
+    return idx >= 0 ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+/**
+ * Set the measured peak level of a file
+ */
+void sound_library_set_peak(const char *filename, uint16_t peak)
+{
+    if (!lib_mutex) {
+        return;
+    }
+
+    xSemaphoreTake(lib_mutex, portMAX_DELAY);
+    if (store_peak(filename, peak)) {
+        save_index();
+    }
+    xSemaphoreGive(lib_mutex);
+}
+
+/**
+ * Number of indexed files
+ */
+size_t sound_library_count(void)
+{
+    return entry_count;
+}
+
+/**
+ * Copy an entry
+ */
+bool sound_library_get(size_t index, sound_library_entry_t *entry)
+{
+    if (!lib_mutex) {
+        return false;
+    }
+
+    xSemaphoreTake(lib_mutex, portMAX_DELAY);
+    bool found = index < entry_count;
+    if (found) {
+        *entry = entries[index];
+    }
+    xSemaphoreGive(lib_mutex);
+    return found;
+}
+
+/**
+ * Look up a file
+ */
+bool sound_library_find(const char *filename, sound_library_entry_t *entry)
+{
+    if (!lib_mutex) {
+        return false;
+    }
+
+    xSemaphoreTake(lib_mutex, portMAX_DELAY);
+    int idx = find_entry(filename);
+    if (idx >= 0 && entry) {
+        *entry = entries[idx];
+    }
+    xSemaphoreGive(lib_mutex);
+    return idx >= 0;
+}
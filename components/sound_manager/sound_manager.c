@@ -1,7 +1,17 @@
 /**
  * Sound Manager Component - Implementation
  * 
- * I2S audio playback for WAV/MP3 files from SD card using ESP-ADF.
+ * I2S audio playback for WAV/MP3/PCM files from SD card using ESP-ADF.
+ * 
+ * Files are read through the decode pipeline ([decoder] -> [resample] -> raw,
+ * linked per file format) or, if already in the output format, directly,
+ * and pumped by the sound output task into the output pipeline
+ * (raw -> i2s), which keeps running. Looping streams wrap in the file
+ * reader, so the pipeline runs through the loop point without a gap. Short event sounds are decoded once
+ * into the PCM cache and played on mixer voices over the stream, so they
+ * start without SD access and don't interrupt background music.
+ * Uploaded files can be converted to the output format in the background,
+ * so they take the direct path afterwards.
  * 
  * @author ninharp
  * @date 2025
@@ -14,8 +24,17 @@
 #include "nvs.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "metrics.h"
+#include "sound_cache.h"
+#include "sound_mixer.h"
+#include "sound_format.h"
+#include "sound_library.h"
 #include <string.h>
 #include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #ifdef CONFIG_ENABLE_SOUND_MANAGER
 
@@ -28,7 +47,7 @@
 #include "http_stream.h"
 #include "mp3_decoder.h"
 #include "wav_decoder.h"
-#include "fatfs_stream.h"
+#include "raw_stream.h"
 #include "filter_resample.h"
 #include "equalizer.h"
 
@@ -52,25 +71,116 @@ static const char *default_sound_files[SOUND_EVENT_MAX] = {
     [SOUND_EVENT_SUCCESS] = "success.mp3"
 };
 
-// Audio pipeline components
+// Events decoded into the PCM cache (short sounds that must start immediately)
+static const sound_event_t cached_events[] = {
+    SOUND_EVENT_BEAM_BREAK,
+    SOUND_EVENT_COUNTDOWN,
+    SOUND_EVENT_BUTTON_PRESS,
+};
+
+// Mixer voice priority of cached events (higher replaces lower when voices run out)
+static const uint8_t event_priority[SOUND_EVENT_MAX] = {
+    [SOUND_EVENT_BUTTON_PRESS] = 1,
+    [SOUND_EVENT_COUNTDOWN] = 2,
+    [SOUND_EVENT_BEAM_BREAK] = 3,
+};
+
+#define SOUND_DUCK_PRIORITY     2           // Countdown and penalty duck the music
+#define SOUND_DUCK_RAMP_FRAMES  2205        // 50 ms fade
+
+#ifndef CONFIG_SOUND_MIXER_VOICES
+#define CONFIG_SOUND_MIXER_VOICES 4
+#endif
+#ifndef CONFIG_SOUND_DUCK_LEVEL
+#define CONFIG_SOUND_DUCK_LEVEL 35
+#endif
+
+#define SOUND_OUT_TASK_STACK    3072
+#define SOUND_OUT_TASK_PRIORITY 6           // Above the audio event task
+#define SOUND_OUT_CHUNK_FRAMES  256         // ~6 ms at 44.1 kHz
+#define SOUND_OUT_RB_SIZE       (4 * 1024)  // Output ring buffer, ~23 ms of stereo PCM
+#define PCM_READ_TIMEOUT_MS     20
+#define CACHE_LOAD_TIMEOUT_MS   2000
+#define LOOP_GAP_WINDOW_MS      1000        // Stalls this long after a loop point count as loop gap
+
+#define TRANSCODE_QUEUE_LEN     4
+#define TRANSCODE_SUFFIX        "_opt.wav"  // Replaces the extension of the original
+
+#ifndef CONFIG_SOUND_PCM_CACHE_MAX_MS
+#define CONFIG_SOUND_PCM_CACHE_MAX_MS 1000
+#endif
+
+// Output pipeline (raw -> i2s), runs continuously
+static audio_pipeline_handle_t out_pipeline = NULL;
+static audio_element_handle_t out_writer = NULL;
+
+// Decode pipeline (decoder -> resample -> raw), read by the sound output task
 static audio_pipeline_handle_t pipeline = NULL;
+static audio_element_handle_t pcm_reader = NULL;
+
+// Audio pipeline components
 static audio_element_handle_t i2s_stream_writer = NULL;
 static audio_element_handle_t http_stream_reader = NULL;
 static audio_element_handle_t mp3_decoder = NULL;
 static audio_element_handle_t wav_decoder = NULL;
-static audio_element_handle_t fatfs_reader = NULL;
 static audio_element_handle_t resample_filter = NULL;
 static audio_element_handle_t equalizer = NULL;
 static audio_event_iface_handle_t evt = NULL;
 
 // Configuration
 static sound_config_t current_config = {0};
-static char *event_sound_files[SOUND_EVENT_MAX] = {0};
+static char *event_sound_files[SOUND_EVENT_MAX] = {0};   // Written under play_mutex once it exists
 static uint8_t current_volume = 70;
 static bool is_initialized = false;
 static bool is_playing = false;
 static sound_mode_t current_mode = SOUND_MODE_ONCE;
 
+// Playback state, shared between callers and the sound output task
+static SemaphoreHandle_t play_mutex = NULL;
+static TaskHandle_t out_task_handle = NULL;
+static sound_mixer_t mixer;                     // Cached clips over the stream
+static bool cache_stale[SOUND_EVENT_MAX];       // Clip must be (re)decoded
+static uint32_t stream_gen = 0;                 // Incremented for every started stream
+
+// Elements currently linked in the decode pipeline
+static char stream_chain[48] = "";
+static bool stream_resampled = false;
+static bool stream_direct = false;              // Output format PCM, read without pipeline
+
+// File feeding the stream
+static struct {
+    FILE *file;
+    uint32_t start;                             // First byte of audio data (loop point)
+    uint32_t end;                               // End of audio data, 0 = end of file
+    uint32_t pos;
+    bool loop;                                  // Wrap to start at the end
+    uint32_t loops;                             // Loop points passed
+} reader;
+
+// Files waiting for conversion to the output format (play_mutex)
+static char transcode_queue[TRANSCODE_QUEUE_LEN][64];
+static int transcode_count = 0;
+static metric_t *m_transcodes = NULL;
+
+// Loop gap tracking (output task)
+static uint32_t loop_seen = 0;
+static int64_t loop_window_end_us = 0;
+static int64_t loop_gap_us = 0;
+static int64_t last_block_us = 0;
+static int64_t last_block_len_us = 0;
+static metric_t *m_loops = NULL;
+static metric_t *m_loop_gap = NULL;
+static metric_t *m_loop_gap_max = NULL;
+
+// Trigger-to-audio latency (until the first PCM is queued for I2S)
+static int64_t trigger_us = 0;
+static bool latency_pending = false;
+static bool latency_from_cache = false;
+static metric_t *m_latency_cache = NULL;
+static metric_t *m_latency_stream = NULL;
+static metric_t *m_latency_cache_max = NULL;
+static metric_t *m_latency_stream_max = NULL;
+
 // NVS storage
 #define NVS_NAMESPACE "sound_cfg"
 #define NVS_KEY_VOLUME "volume"
@@ -78,56 +188,653 @@ static sound_mode_t current_mode = SOUND_MODE_ONCE;
 
 /**
  * Audio event handler task
+ * 
+ * End of stream is handled by the sound output task once the raw reader
+ * is drained; decoders only report the format they found here.
  */
 static void audio_event_task(void *pvParameters)
 {
     audio_event_iface_msg_t msg;
     
     while (1) {
-        if (audio_event_iface_listen(evt, &msg, portMAX_DELAY) == ESP_OK) {
-            if (msg.source_type == AUDIO_ELEMENT_TYPE_ELEMENT) {
-                if (msg.source == (void *)mp3_decoder || msg.source == (void *)wav_decoder) {
-                    if (msg.cmd == AEL_MSG_CMD_REPORT_STATUS) {
-                        audio_element_state_t el_state = (audio_element_state_t)msg.data;
-                        if (el_state == AEL_STATE_FINISHED) {
-                            ESP_LOGD(TAG, "Audio finished");
-                            is_playing = false;
-                            
-                            // Loop if needed
-                            if (current_mode == SOUND_MODE_LOOP) {
-                                ESP_LOGD(TAG, "Looping audio...");
-                                audio_pipeline_stop(pipeline);
-                                audio_pipeline_wait_for_stop(pipeline);
-                                // Reset for loop restart
-                                audio_pipeline_reset_ringbuffer(pipeline);
-                                audio_pipeline_reset_elements(pipeline);
-                                audio_pipeline_run(pipeline);
-                            } else {
-                                ESP_LOGD(TAG, "Stopping playback (finished)");
-                                audio_pipeline_stop(pipeline);
-                                audio_pipeline_wait_for_stop(pipeline);
-                                // Reset for next playback (don't terminate - causes race condition)
-                                audio_pipeline_reset_ringbuffer(pipeline);
-                                audio_pipeline_reset_elements(pipeline);
-                            }
-                        }
-                    } else if (msg.cmd == AEL_MSG_CMD_REPORT_MUSIC_INFO) {
-                        audio_element_info_t music_info = {0};
-                        audio_element_getinfo((audio_element_handle_t)msg.source, &music_info);
-                        ESP_LOGD(TAG, "Decoder output: %d Hz, %d bits, %d channels",
-                                 music_info.sample_rates, music_info.bits, music_info.channels);
-                        if (equalizer_set_info(equalizer, music_info.sample_rates, music_info.channels) != ESP_OK) {
-                            break;
-                        }
-
-                        i2s_stream_set_clk(i2s_stream_writer, music_info.sample_rates, music_info.bits, music_info.channels);
-                        continue;
-                    }
+        if (audio_event_iface_listen(evt, &msg, portMAX_DELAY) != ESP_OK) {
+            continue;
+        }
+        if (msg.source_type != AUDIO_ELEMENT_TYPE_ELEMENT || msg.cmd != AEL_MSG_CMD_REPORT_MUSIC_INFO ||
+            (msg.source != (void *)mp3_decoder && msg.source != (void *)wav_decoder)) {
+            continue;
+        }
+
+        audio_element_info_t music_info = {0};
+        audio_element_getinfo((audio_element_handle_t)msg.source, &music_info);
+        ESP_LOGD(TAG, "Decoder output: %d Hz, %d bits, %d channels",
+                 music_info.sample_rates, music_info.bits, music_info.channels);
+
+        // The header probe chose the stages; the decoder has the final word on the rate
+        if (stream_resampled) {
+            rsp_filter_set_src_info(resample_filter, music_info.sample_rates, music_info.channels);
+        } else if (music_info.sample_rates != SOUND_OUTPUT_SAMPLE_RATE ||
+                   music_info.channels != SOUND_OUTPUT_CHANNELS) {
+            ESP_LOGW(TAG, "Decoder output %d Hz/%d ch differs from the probed header, playing unresampled",
+                     music_info.sample_rates, music_info.channels);
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+/**
+ * Read stream data from the file, wrapping at the end of the data when looping
+ * 
+ * Looping seeks back to the first frame/sample without touching the
+ * pipeline, so decoder and resampler see one continuous stream.
+ */
+static int stream_file_read(char *buf, int len)
+{
+    int total = 0;
+
+    while (total < len && reader.file) {
+        size_t want = len - total;
+        if (reader.end && want > reader.end - reader.pos) {
+            want = reader.end - reader.pos;
+        }
+        size_t got = want ? fread(buf + total, 1, want, reader.file) : 0;
+        total += got;
+        reader.pos += got;
+        if (got == want && !(reader.end && reader.pos >= reader.end)) {
+            continue;
+        }
+
+        // End of the audio data
+        if (!reader.loop || reader.pos == reader.start) {
+            break;
+        }
+        fseek(reader.file, reader.start, SEEK_SET);
+        reader.pos = reader.start;
+        reader.loops++;
+    }
+    return total;
+}
+
+/**
+ * Read callback of the first decode pipeline element (runs in its task)
+ */
+static int stream_read_cb(audio_element_handle_t el, char *buf, int len, TickType_t wait_time, void *ctx)
+{
+    int got = stream_file_read(buf, len);
+    return got > 0 ? got : AEL_IO_DONE;
+}
+
+/**
+ * Open a file and link the decode pipeline for it
+ * 
+ * Only the stages the format needs are linked: 16 bit PCM at the output
+ * format is read by the sound output task directly, other PCM only gets
+ * the resampler, and compressed formats get their decoder. The pipeline
+ * reads the file through stream_read_cb. Called with play_mutex held.
+ */
+static esp_err_t start_stream(const char *filepath, bool loop)
+{
+    sound_file_info_t info;
+    esp_err_t err = sound_format_probe(filepath, &info);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    reader.file = fopen(filepath, "rb");
+    if (!reader.file) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    reader.start = (info.pcm16 || info.format == SOUND_FORMAT_MP3) ? info.data_offset : 0;
+    reader.end = 0;
+    if (info.pcm16) {
+        // Whole frames only, a trailing partial frame would shift the channels on wrap
+        uint32_t size = info.data_size;
+        if (size == 0 && fseek(reader.file, 0, SEEK_END) == 0) {
+            size = ftell(reader.file) - reader.start;
+        }
+        reader.end = reader.start + size - size % (info.channels * sizeof(int16_t));
+    }
+    reader.pos = reader.start;
+    // A WAV decoder needs the header again, such files loop by restarting the pipeline
+    reader.loop = loop && (info.pcm16 || info.format == SOUND_FORMAT_MP3);
+    fseek(reader.file, reader.start, SEEK_SET);
+
+    stream_direct = info.pcm16 && info.sample_rate == SOUND_OUTPUT_SAMPLE_RATE &&
+                    info.channels == SOUND_OUTPUT_CHANNELS;
+    if (stream_direct) {
+        ESP_LOGD(TAG, "%s (%s): read directly", filepath, sound_format_name(info.format));
+        return ESP_OK;
+    }
+
+    const char *link_tag[4];
+    int count = 0;
+    if (info.format == SOUND_FORMAT_MP3) {
+        link_tag[count++] = "mp3";
+    } else if (!info.pcm16) {
+        link_tag[count++] = "wav";
+    }
+    // Unknown rate (decoded later) also takes the resampler
+    stream_resampled = info.sample_rate != SOUND_OUTPUT_SAMPLE_RATE || info.channels != SOUND_OUTPUT_CHANNELS;
+    if (stream_resampled) {
+        link_tag[count++] = "rsp";
+        if (info.sample_rate) {
+            rsp_filter_set_src_info(resample_filter, info.sample_rate, info.channels);
+        }
+    }
+#ifdef CONFIG_SOUND_MP3_EQUALIZER
+    if (info.format == SOUND_FORMAT_MP3) {
+        link_tag[count++] = "eq";
+    }
+#endif
+    link_tag[count++] = "pcm";
+
+    // Relink only if the chain changes
+    char chain[sizeof(stream_chain)] = "";
+    for (int i = 0; i < count; i++) {
+        strlcat(chain, link_tag[i], sizeof(chain));
+        strlcat(chain, i + 1 < count ? "-->" : "", sizeof(chain));
+    }
+    if (strcmp(chain, stream_chain) != 0) {
+        audio_pipeline_breakup_elements(pipeline, NULL);
+        audio_pipeline_relink(pipeline, link_tag, count);
+        audio_pipeline_set_listener(pipeline, evt);
+        strlcpy(stream_chain, chain, sizeof(stream_chain));
+    }
+    ESP_LOGD(TAG, "%s (%s, %lu Hz, %d ch): %s", filepath, sound_format_name(info.format),
+             (unsigned long)info.sample_rate, info.channels, stream_chain);
+
+    audio_element_set_read_cb(audio_pipeline_get_el_by_tag(pipeline, link_tag[0]), stream_read_cb, NULL);
+    err = audio_pipeline_run(pipeline);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start pipeline for %s: %s", filepath, esp_err_to_name(err));
+        fclose(reader.file);
+        reader.file = NULL;
+    }
+    return err;
+}
+
+/**
+ * Read stream PCM in the output format
+ * 
+ * Direct streams are only read with play_mutex held.
+ * 
+ * @return Bytes read, AEL_IO_TIMEOUT if nothing is ready yet, <= 0 at the end
+ */
+static int read_stream_pcm(int16_t *buf, int len)
+{
+    if (stream_direct) {
+        return stream_file_read((char *)buf, len);
+    }
+    return raw_stream_read(pcm_reader, (char *)buf, len);
+}
+
+/**
+ * Record the trigger-to-audio latency once the first PCM is queued
+ */
+static void report_latency(void)
+{
+    if (!latency_pending) {
+        return;
+    }
+    latency_pending = false;
+
+    bool from_cache = latency_from_cache;
+    int32_t latency_us = (int32_t)(esp_timer_get_time() - trigger_us);
+    metrics_set(from_cache ? m_latency_cache : m_latency_stream, latency_us);
+    metrics_max(from_cache ? m_latency_cache_max : m_latency_stream_max, latency_us);
+    ESP_LOGD(TAG, "Trigger-to-audio latency: %ld us (%s)", (long)latency_us, from_cache ? "cache" : "stream");
+}
+
+/**
+ * Stop the decode pipeline (mixer voices keep playing)
+ * 
+ * Called with play_mutex held.
+ */
+static void stop_stream(void)
+{
+    if (reader.file && !stream_direct) {
+        audio_pipeline_stop(pipeline);
+        audio_pipeline_wait_for_stop(pipeline);
+        
+        // Reset pipeline for next playback (synchronous, safe for reuse)
+        // DON'T use terminate() - it's async and causes queue corruption
+        audio_pipeline_reset_ringbuffer(pipeline);
+        audio_pipeline_reset_elements(pipeline);
+    }
+    if (reader.file) {
+        fclose(reader.file);
+        reader.file = NULL;
+    }
+    
+    // The output pipeline keeps running, it just gets no more PCM
+    if (is_playing) {
+        ESP_LOGI(TAG, "Stopping playback");
+        is_playing = false;
+    }
+}
+
+/**
+ * Copy the file name mapped to an event
+ * 
+ * The output task remaps events to converted files, so the table is only
+ * read under play_mutex. Must not be called with play_mutex held.
+ */
+static esp_err_t copy_event_file(sound_event_t event, char *buf, size_t size)
+{
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    if (play_mutex) {
+        xSemaphoreTake(play_mutex, portMAX_DELAY);
+    }
+    if (event_sound_files[event]) {
+        strlcpy(buf, event_sound_files[event], size);
+        ret = ESP_OK;
+    }
+    if (play_mutex) {
+        xSemaphoreGive(play_mutex);
+    }
+    return ret;
+}
+
+/**
+ * Replace the file name mapped to an event, takes ownership of name
+ */
+static void swap_event_file(sound_event_t event, char *name)
+{
+    if (play_mutex) {
+        xSemaphoreTake(play_mutex, portMAX_DELAY);
+    }
+    char *old = event_sound_files[event];
+    event_sound_files[event] = name;
+    if (play_mutex) {
+        xSemaphoreGive(play_mutex);
+    }
+    free(old);
+}
+
+/**
+ * Decode the sound file of an event into the PCM cache
+ * 
+ * Uses the decode pipeline, so nothing may be streaming. Called with
+ * play_mutex held.
+ */
+static esp_err_t cache_load_event(sound_event_t event)
+{
+    static int16_t load_buf[512];
+    const char *filename = event_sound_files[event];
+    if (!filename) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    char filepath[256];
+    snprintf(filepath, sizeof(filepath), "%s/%s", current_config.sound_dir, filename);
+
+    esp_err_t ret = start_stream(filepath, false);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "%s not cached (%s)", filename, esp_err_to_name(ret));
+        return ret;
+    }
+
+    sound_clip_builder_t builder;
+    bool building = false;
+    int64_t deadline = esp_timer_get_time() + CACHE_LOAD_TIMEOUT_MS * 1000;
+
+    while (ret == ESP_OK) {
+        int len = read_stream_pcm(load_buf, sizeof(load_buf));
+        if (len == AEL_IO_TIMEOUT) {
+            if (esp_timer_get_time() > deadline) {
+                ret = ESP_ERR_TIMEOUT;
+            }
+            continue;
+        }
+        if (len <= 0) {
+            break;  // End of file
+        }
+
+        if (!building) {
+            // The decode pipeline already delivers the output format
+            ret = sound_cache_begin(&builder, SOUND_OUTPUT_SAMPLE_RATE, SOUND_OUTPUT_CHANNELS,
+                                    CONFIG_SOUND_PCM_CACHE_MAX_MS);
+            if (ret != ESP_OK) {
+                break;
+            }
+            building = true;
+        }
+        ret = sound_cache_append(&builder, load_buf, len / (sizeof(int16_t) * builder.channels));
+    }
+
+    stop_stream();
+
+    if (building) {
+        if (ret == ESP_OK) {
+            ret = sound_cache_commit(&builder, event);
+        } else {
+            sound_cache_abort(&builder);
+        }
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "%s not cached (%s), will be streamed", filename, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+/**
+ * Decode stale cache entries while nothing is playing
+ */
+static void reload_stale_clips(void)
+{
+    xSemaphoreTake(play_mutex, portMAX_DELAY);
+    for (int i = 0; i < SOUND_EVENT_MAX && !is_playing && !sound_mixer_active(&mixer); i++) {
+        if (cache_stale[i]) {
+            cache_stale[i] = false;
+            cache_load_event((sound_event_t)i);
+        }
+    }
+    xSemaphoreGive(play_mutex);
+}
+
+/**
+ * Name of the converted version of a sound file
+ */
+static void transcoded_name(const char *filename, char *out, size_t size)
+{
+    const char *dot = strrchr(filename, '.');
+    int stem = dot ? (int)(dot - filename) : (int)strlen(filename);
+    snprintf(out, size, "%.*s%s", stem, filename, TRANSCODE_SUFFIX);
+}
+
+/**
+ * Decode a sound file into a WAV file in the output format
+ * 
+ * Runs in the sound output task while nothing plays. The decode pipeline
+ * is read outside play_mutex like a normal stream; a started stream or
+ * cached sound takes over the pipeline/output and aborts the conversion
+ * with ESP_ERR_INVALID_STATE. The result is written to a temporary file
+ * and renamed once complete.
+ */
+static esp_err_t transcode_file(const char *filename, const char *optname)
+{
+    static int16_t tc_buf[512];
+    char src[256], tmp[256], dst[256];
+    snprintf(src, sizeof(src), "%s/%s", current_config.sound_dir, filename);
+    snprintf(dst, sizeof(dst), "%s/%s", current_config.sound_dir, optname);
+    snprintf(tmp, sizeof(tmp), "%s.tmp", dst);
+
+    FILE *out = fopen(tmp, "wb");
+    if (!out) {
+        return ESP_FAIL;
+    }
+    uint8_t hdr[SOUND_WAV_HEADER_SIZE];
+    sound_format_wav_header(hdr, SOUND_OUTPUT_SAMPLE_RATE, SOUND_OUTPUT_CHANNELS, 0);
+    fwrite(hdr, 1, sizeof(hdr), out);
+
+    xSemaphoreTake(play_mutex, portMAX_DELAY);
+    esp_err_t ret = ESP_ERR_INVALID_STATE;
+    if (!is_playing && !sound_mixer_active(&mixer)) {
+        ret = start_stream(src, false);
+        if (ret != ESP_OK) {
+            stop_stream();
+        }
+    }
+    uint32_t gen = ++stream_gen;
+    xSemaphoreGive(play_mutex);
+
+    uint32_t data_size = 0;
+    int32_t peak = 0;
+    int64_t deadline = esp_timer_get_time() + CACHE_LOAD_TIMEOUT_MS * 1000;
+
+    while (ret == ESP_OK) {
+        int len = read_stream_pcm(tc_buf, sizeof(tc_buf));
+        bool done = len <= 0 && len != AEL_IO_TIMEOUT;
+        if (len == AEL_IO_TIMEOUT && esp_timer_get_time() > deadline) {
+            ret = ESP_ERR_TIMEOUT;
+        }
+
+        xSemaphoreTake(play_mutex, portMAX_DELAY);
+        if (gen != stream_gen) {
+            ret = ESP_ERR_INVALID_STATE;    // Replaced by a stream, already stopped
+        } else if (sound_mixer_active(&mixer)) {
+            ret = ESP_ERR_INVALID_STATE;
+            stop_stream();
+        } else if (ret != ESP_OK || done) {
+            stop_stream();
+        }
+        xSemaphoreGive(play_mutex);
+
+        if (ret != ESP_OK || done) {
+            break;
+        }
+        if (len > 0) {
+            if (fwrite(tc_buf, 1, len, out) != (size_t)len) {
+                ret = ESP_FAIL;     // Card full, the stream is stopped next round
+                continue;
+            }
+            data_size += len;
+            for (int i = 0; i < len / (int)sizeof(int16_t); i++) {
+                int32_t v = tc_buf[i] < 0 ? -tc_buf[i] : tc_buf[i];
+                if (v > peak) {
+                    peak = v;
                 }
             }
+            deadline = esp_timer_get_time() + CACHE_LOAD_TIMEOUT_MS * 1000;
         }
     }
-    vTaskDelete(NULL);
+    if (ret == ESP_OK && data_size == 0) {
+        ret = ESP_ERR_INVALID_SIZE;
+    }
+    if (ret == ESP_OK) {
+        sound_format_wav_header(hdr, SOUND_OUTPUT_SAMPLE_RATE, SOUND_OUTPUT_CHANNELS, data_size);
+        if (fseek(out, 0, SEEK_SET) != 0 || fwrite(hdr, 1, sizeof(hdr), out) != sizeof(hdr)) {
+            ret = ESP_FAIL;
+        }
+    }
+    if (fclose(out) != 0 && ret == ESP_OK) {
+        ret = ESP_FAIL;
+    }
+    if (ret == ESP_OK) {
+        unlink(dst);    // FAT rename doesn't replace
+        if (rename(tmp, dst) != 0) {
+            ret = ESP_FAIL;
+        }
+    }
+    if (ret != ESP_OK) {
+        unlink(tmp);
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Converted %s -> %s (%lu bytes PCM)", filename, optname, (unsigned long)data_size);
+    sound_library_update(optname, (uint16_t)peak);
+    sound_library_set_peak(filename, (uint16_t)peak);
+    return ESP_OK;
+}
+
+/**
+ * Convert queued files while nothing plays
+ * 
+ * Interrupted conversions stay queued and start over the next time the
+ * output is idle.
+ */
+static void transcode_pending(void)
+{
+    char filename[sizeof(transcode_queue[0])];
+    char optname[sizeof(transcode_queue[0]) + sizeof(TRANSCODE_SUFFIX)];
+
+    while (1) {
+        xSemaphoreTake(play_mutex, portMAX_DELAY);
+        bool idle = transcode_count > 0 && !is_playing && !sound_mixer_active(&mixer);
+        if (idle) {
+            strlcpy(filename, transcode_queue[0], sizeof(filename));
+        }
+        xSemaphoreGive(play_mutex);
+        if (!idle) {
+            return;
+        }
+
+        transcoded_name(filename, optname, sizeof(optname));
+        esp_err_t err = transcode_file(filename, optname);
+        if (err == ESP_ERR_INVALID_STATE) {
+            ESP_LOGD(TAG, "Conversion of %s interrupted by playback", filename);
+            return;
+        }
+
+        xSemaphoreTake(play_mutex, portMAX_DELAY);
+        if (transcode_count > 0 && strcmp(transcode_queue[0], filename) == 0) {
+            transcode_count--;
+            memmove(transcode_queue[0], transcode_queue[1], transcode_count * sizeof(transcode_queue[0]));
+        }
+        xSemaphoreGive(play_mutex);
+
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Cannot convert %s: %s", filename, esp_err_to_name(err));
+            continue;
+        }
+        metrics_inc(m_transcodes);
+
+        // Point events at the converted file (cached clips sound the same, keep them)
+        bool remapped = false;
+        xSemaphoreTake(play_mutex, portMAX_DELAY);
+        for (int i = 0; i < SOUND_EVENT_MAX; i++) {
+            if (event_sound_files[i] && strcmp(event_sound_files[i], filename) == 0) {
+                char *name = strdup(optname);
+                if (name) {
+                    free(event_sound_files[i]);
+                    event_sound_files[i] = name;
+                    remapped = true;
+                }
+            }
+        }
+        xSemaphoreGive(play_mutex);
+        if (remapped) {
+            sound_manager_save_config();
+        }
+    }
+}
+
+/**
+ * Handle the end of the stream once its PCM is drained
+ * 
+ * Gapless loops never get here, they wrap in the reader. Streams that
+ * can't wrap (WAV files with a decoder) are restarted. Called with
+ * play_mutex held.
+ */
+static void finish_stream(void)
+{
+    if (current_mode == SOUND_MODE_LOOP && reader.file && !stream_direct && !reader.loop) {
+        ESP_LOGD(TAG, "Restarting audio for loop");
+        audio_pipeline_stop(pipeline);
+        audio_pipeline_wait_for_stop(pipeline);
+        audio_pipeline_reset_ringbuffer(pipeline);
+        audio_pipeline_reset_elements(pipeline);
+        fseek(reader.file, reader.start, SEEK_SET);
+        reader.pos = reader.start;
+        reader.loops++;
+        audio_pipeline_run(pipeline);
+    } else {
+        ESP_LOGD(TAG, "Stopping playback (finished)");
+        stop_stream();
+    }
+}
+
+/**
+ * Track stream stalls around loop points
+ * 
+ * After the reader passed a loop point, the longest stall between two
+ * stream blocks (beyond the duration of the earlier block) within the
+ * next LOOP_GAP_WINDOW_MS is reported as loop gap. Called with
+ * play_mutex held, for every stream block.
+ */
+static void track_loop_gap(size_t frames)
+{
+    int64_t now = esp_timer_get_time();
+
+    if (reader.loops != loop_seen) {
+        loop_seen = reader.loops;
+        loop_window_end_us = now + LOOP_GAP_WINDOW_MS * 1000;
+        loop_gap_us = 0;
+        metrics_inc(m_loops);
+    }
+    if (loop_window_end_us && last_block_us) {
+        int64_t stall = now - last_block_us - last_block_len_us;
+        if (stall > loop_gap_us) {
+            loop_gap_us = stall;
+        }
+        if (now >= loop_window_end_us) {
+            metrics_set(m_loop_gap, (int32_t)loop_gap_us);
+            metrics_max(m_loop_gap_max, (int32_t)loop_gap_us);
+            ESP_LOGD(TAG, "Loop gap: %ld us", (long)loop_gap_us);
+            loop_window_end_us = 0;
+        }
+    }
+    last_block_us = now;
+    last_block_len_us = (int64_t)frames * 1000000 / SOUND_OUTPUT_SAMPLE_RATE;
+}
+
+/**
+ * Sound output task - feeds the output pipeline
+ * 
+ * Mixes the active cache voices over the stream and writes the result to
+ * the output pipeline in small blocks, so a new trigger is heard within
+ * one block. Sleeps while nothing is playing.
+ */
+static void sound_out_task(void *pvParameters)
+{
+    static int16_t buf[SOUND_OUT_CHUNK_FRAMES * SOUND_OUTPUT_CHANNELS];
+    int read_timeout_ms = PCM_READ_TIMEOUT_MS;
+
+    while (1) {
+        // Decoded stream PCM, read outside the lock (blocks up to the read timeout)
+        int len = 0;
+        uint32_t gen = stream_gen;
+        if (is_playing && !stream_direct) {
+            len = read_stream_pcm(buf, sizeof(buf));
+        }
+
+        xSemaphoreTake(play_mutex, portMAX_DELAY);
+        if (gen != stream_gen) {
+            len = 0;  // Belongs to a stream that was replaced meanwhile
+        } else if (is_playing && stream_direct) {
+            len = read_stream_pcm(buf, sizeof(buf));
+        }
+
+        size_t music_frames = 0;
+        if (len > 0) {
+            music_frames = len / (sizeof(int16_t) * SOUND_OUTPUT_CHANNELS);
+            track_loop_gap(music_frames);
+        } else if (is_playing && gen == stream_gen && len != AEL_IO_TIMEOUT) {
+            finish_stream();  // Done or aborted
+        }
+
+        int voices = sound_mixer_active(&mixer);
+        size_t frames = music_frames;
+        if (voices > 0 || music_frames > 0) {
+            if (frames == 0) {
+                frames = SOUND_OUT_CHUNK_FRAMES;
+            }
+            sound_mixer_set_master(&mixer, (int16_t)(current_volume * SOUND_MIXER_UNITY / 100));
+            sound_mixer_render(&mixer, music_frames ? buf : NULL, buf, frames);
+        }
+        xSemaphoreGive(play_mutex);
+
+        // Don't stall running voices while the stream is still starting up
+        int timeout_ms = voices > 0 ? 0 : PCM_READ_TIMEOUT_MS;
+        if (timeout_ms != read_timeout_ms) {
+            audio_element_set_input_timeout(pcm_reader, pdMS_TO_TICKS(timeout_ms));
+            read_timeout_ms = timeout_ms;
+        }
+
+        if (frames > 0) {
+            raw_stream_write(out_writer, (char *)buf, frames * SOUND_OUTPUT_CHANNELS * sizeof(int16_t));
+            report_latency();
+            continue;
+        }
+
+        if (is_playing) {
+            continue;  // Read times out quickly, triggers are picked up in the next round
+        }
+
+        reload_stale_clips();
+        transcode_pending();
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
 }
 
 /**
@@ -145,12 +852,6 @@ static esp_err_t init_pipeline(void)
     }
     mem_assert(pipeline);
     
-    // Create FATFS stream reader
-    ESP_LOGD(TAG, "[1.1] Create FATFS stream to read data");
-    fatfs_stream_cfg_t fatfs_cfg = FATFS_STREAM_CFG_DEFAULT();
-    fatfs_cfg.type = AUDIO_STREAM_READER;
-    fatfs_reader = fatfs_stream_init(&fatfs_cfg);
-
     // Create HTTP stream reader
     ESP_LOGD(TAG, "[1.2] Create http stream to read data");
     http_stream_cfg_t http_cfg = HTTP_STREAM_CFG_DEFAULT();
@@ -194,13 +895,14 @@ static esp_err_t init_pipeline(void)
     equalizer_cfg_t eq_cfg = DEFAULT_EQUALIZER_CONFIG();
     int set_gain[] = { -13, -13, -13, -13, -13, -13, -13, -13, -13, -13, -13, -13, -13, -13, -13, -13, -13, -13, -13, -13};
     eq_cfg.set_gain = set_gain;
+    eq_cfg.samplerate = SOUND_OUTPUT_SAMPLE_RATE;   // Linked after the resampler, if at all
+    eq_cfg.channel = SOUND_OUTPUT_CHANNELS;
     equalizer = equalizer_init(&eq_cfg);
     mem_assert(equalizer);
     
     ESP_LOGD(TAG, "[1.6] Equalizer initialized with -13dB gain");
     
-    // TEMPORARY FIX: Create I2S stream inline (instead of init_i2s_stream()) to fix NULL pointer crash
-    // TODO: Re-enable init_i2s_stream() and equalizer/resample once basic audio works
+    // I2S writer at the end of the output pipeline, fed by the sound output task
     ESP_LOGD(TAG, "[1.7] Create i2s stream to write data to codec chip");
     i2s_stream_cfg_t i2s_cfg = I2S_STREAM_CFG_DEFAULT();
     i2s_cfg.type = AUDIO_STREAM_WRITER;
@@ -214,18 +916,47 @@ static esp_err_t init_pipeline(void)
     ESP_LOGD(TAG, "[1.7] I2S stream initialized: BCLK=%d, WS=%d, DOUT=%d", 
              current_config.bck_io_num, current_config.ws_io_num, current_config.data_out_num);
     
-    // Register ONLY basic elements (http→mp3→i2s) for testing
-    // equalizer and resample_filter are created above but NOT registered (testing phase)
-    ESP_LOGD(TAG, "[2.0] Register all elements to audio pipeline");
-    audio_pipeline_register(pipeline, fatfs_reader,       "fatfs");
+    // Raw reader at the end of the decode pipeline, drained by the sound output task.
+    // Short read timeout so the task notices new triggers while a stream warms up.
+    ESP_LOGD(TAG, "[1.8] Create raw streams between decode and output pipeline");
+    raw_stream_cfg_t pcm_cfg = RAW_STREAM_CFG_DEFAULT();
+    pcm_cfg.type = AUDIO_STREAM_READER;
+    pcm_reader = raw_stream_init(&pcm_cfg);
+    mem_assert(pcm_reader);
+    audio_element_set_input_timeout(pcm_reader, pdMS_TO_TICKS(PCM_READ_TIMEOUT_MS));
+    
+    // Raw writer feeding I2S; a small ring buffer keeps the output latency low
+    raw_stream_cfg_t out_cfg = RAW_STREAM_CFG_DEFAULT();
+    out_cfg.type = AUDIO_STREAM_WRITER;
+    out_cfg.out_rb_size = SOUND_OUT_RB_SIZE;
+    out_writer = raw_stream_init(&out_cfg);
+    mem_assert(out_writer);
+    
+    // Register all elements; start_stream() links the ones a file needs
+    ESP_LOGD(TAG, "[2.0] Register all elements to audio pipelines");
     audio_pipeline_register(pipeline, mp3_decoder,        "mp3");
-    // audio_pipeline_register(pipeline, wav_decoder,        "wav");
-    audio_pipeline_register(pipeline, i2s_stream_writer,  "i2s");
+    audio_pipeline_register(pipeline, wav_decoder,        "wav");
+    audio_pipeline_register(pipeline, resample_filter,    "rsp");
+    audio_pipeline_register(pipeline, equalizer,          "eq");
+    audio_pipeline_register(pipeline, pcm_reader,         "pcm");
 
-    // Link it together: http_stream --> mp3_decoder --> i2s_stream (simple test pipeline)
-    ESP_LOGD(TAG, "[2.1] Link elements: http-->mp3-->i2s (testing without equalizer/resample)");
-    const char *link_tag[3] = {"fatfs", "mp3", "i2s"};
+    // Default chain until the first file is played: mp3_decoder --> resample --> raw
+    // The first element reads the file via stream_read_cb (no fatfs_stream, so loops can wrap)
+    ESP_LOGD(TAG, "[2.1] Link elements: mp3-->rsp-->pcm");
+    const char *link_tag[3] = {"mp3", "rsp", "pcm"};
     audio_pipeline_link(pipeline, &link_tag[0], 3);
+    strlcpy(stream_chain, "mp3-->rsp-->pcm", sizeof(stream_chain));
+    stream_resampled = true;
+    
+    // Output pipeline: raw --> i2s, started once and kept running
+    ESP_LOGD(TAG, "[2.2] Link output pipeline: out-->i2s");
+    audio_pipeline_cfg_t out_pipeline_cfg = DEFAULT_AUDIO_PIPELINE_CONFIG();
+    out_pipeline = audio_pipeline_init(&out_pipeline_cfg);
+    mem_assert(out_pipeline);
+    audio_pipeline_register(out_pipeline, out_writer,        "out");
+    audio_pipeline_register(out_pipeline, i2s_stream_writer, "i2s");
+    const char *out_link_tag[2] = {"out", "i2s"};
+    audio_pipeline_link(out_pipeline, &out_link_tag[0], 2);
 
     // Set uri for http stream
     // ESP_LOGI(TAG, "[2.2] Set up  uri (http as http_stream, mp3 as mp3 decoder, and default output is i2s)");
@@ -251,6 +982,37 @@ static esp_err_t init_pipeline(void)
     
     // Start event task
     xTaskCreate(audio_event_task, "audio_event", 3072, NULL, 5, NULL);
+    
+    // Start output pipeline and the task feeding it
+    play_mutex = xSemaphoreCreateMutex();
+    mem_assert(play_mutex);
+    sound_mixer_init(&mixer, CONFIG_SOUND_MIXER_VOICES, SOUND_DUCK_PRIORITY,
+                     (int16_t)(CONFIG_SOUND_DUCK_LEVEL * SOUND_MIXER_UNITY / 100), SOUND_DUCK_RAMP_FRAMES);
+    i2s_stream_set_clk(i2s_stream_writer, SOUND_OUTPUT_SAMPLE_RATE, 16, SOUND_OUTPUT_CHANNELS);
+    audio_pipeline_run(out_pipeline);
+    if (xTaskCreate(sound_out_task, "sound_out", SOUND_OUT_TASK_STACK, NULL,
+                    SOUND_OUT_TASK_PRIORITY, &out_task_handle) == pdPASS) {
+        metrics_register_task(out_task_handle, "sound_out");
+    } else {
+        ESP_LOGE(TAG, "Failed to create sound output task");
+        return ESP_FAIL;
+    }
+    
+    m_latency_cache = metrics_register_gauge("laser_sound_latency_us",
+                                             "Trigger-to-audio latency of the last sound", "source=\"cache\"");
+    m_latency_stream = metrics_register_gauge("laser_sound_latency_us",
+                                              "Trigger-to-audio latency of the last sound", "source=\"stream\"");
+    m_latency_cache_max = metrics_register_gauge("laser_sound_latency_max_us",
+                                                 "Highest trigger-to-audio latency", "source=\"cache\"");
+    m_latency_stream_max = metrics_register_gauge("laser_sound_latency_max_us",
+                                                  "Highest trigger-to-audio latency", "source=\"stream\"");
+    m_loops = metrics_register_counter("laser_sound_loops_total", "Loop points passed by looping streams", NULL);
+    m_loop_gap = metrics_register_gauge("laser_sound_loop_gap_us",
+                                        "Longest stream stall after the last loop point", NULL);
+    m_loop_gap_max = metrics_register_gauge("laser_sound_loop_gap_max_us",
+                                            "Longest stream stall after any loop point", NULL);
+    m_transcodes = metrics_register_counter("laser_sound_transcodes_total",
+                                            "Sound files converted to the output format", NULL);
 
     // Start pipeline
     // audio_pipeline_run(pipeline);
@@ -298,6 +1060,19 @@ esp_err_t sound_manager_init(const sound_config_t *config)
     // Load configuration from NVS
     sound_manager_load_config();
     
+    // Index of the sound files (probes only files added since the last boot)
+    sound_library_init(current_config.sound_dir);
+    
+#ifdef CONFIG_SOUND_PCM_CACHE
+    // Decode short event sounds once, they are played from RAM afterwards
+    sound_cache_init(CONFIG_SOUND_PCM_CACHE_SIZE_KB * 1024);
+    for (size_t i = 0; i < sizeof(cached_events) / sizeof(cached_events[0]); i++) {
+        cache_stale[cached_events[i]] = true;
+    }
+    reload_stale_clips();
+    ESP_LOGI(TAG, "PCM cache: %u bytes", (unsigned)sound_cache_used());
+#endif
+    
     is_initialized = true;
     ESP_LOGI(TAG, "Sound manager initialized (I2S pins: BCK=%d, WS=%d, DOUT=%d)",
              current_config.bck_io_num, current_config.ws_io_num, current_config.data_out_num);
@@ -311,27 +1086,44 @@ esp_err_t sound_manager_deinit(void)
         return ESP_OK;
     }
     
-    // Stop and cleanup pipeline
+    sound_manager_stop();
+    
+    // Stop and cleanup pipelines
+    if (out_pipeline) {
+        audio_pipeline_stop(out_pipeline);
+        audio_pipeline_wait_for_stop(out_pipeline);
+        audio_pipeline_terminate(out_pipeline);
+        audio_pipeline_unregister(out_pipeline, out_writer);
+        audio_pipeline_unregister(out_pipeline, i2s_stream_writer);
+        audio_pipeline_deinit(out_pipeline);
+        out_pipeline = NULL;
+    }
+    if (out_task_handle) {
+        vTaskDelete(out_task_handle);
+        out_task_handle = NULL;
+    }
+    sound_cache_deinit();
+    sound_library_deinit();
+    
     if (pipeline) {
         audio_pipeline_stop(pipeline);
         audio_pipeline_wait_for_stop(pipeline);
         audio_pipeline_terminate(pipeline);
-        audio_pipeline_unregister(pipeline, fatfs_reader);
         audio_pipeline_unregister(pipeline, mp3_decoder);
         audio_pipeline_unregister(pipeline, wav_decoder);
         audio_pipeline_unregister(pipeline, resample_filter);
         audio_pipeline_unregister(pipeline, equalizer);
-        audio_pipeline_unregister(pipeline, i2s_stream_writer);
+        audio_pipeline_unregister(pipeline, pcm_reader);
         audio_pipeline_deinit(pipeline);
     }
     
     // Cleanup elements
-    if (fatfs_reader) audio_element_deinit(fatfs_reader);
     if (mp3_decoder) audio_element_deinit(mp3_decoder);
     if (wav_decoder) audio_element_deinit(wav_decoder);
     if (resample_filter) audio_element_deinit(resample_filter);
     if (equalizer) audio_element_deinit(equalizer);
-    if (equalizer) audio_element_deinit(equalizer);
+    if (pcm_reader) audio_element_deinit(pcm_reader);
+    if (out_writer) audio_element_deinit(out_writer);
     if (i2s_stream_writer) audio_element_deinit(i2s_stream_writer);
     if (evt) audio_event_iface_destroy(evt);
     
@@ -361,43 +1153,66 @@ esp_err_t sound_manager_play_file(const char *filename, sound_mode_t mode)
         return ESP_ERR_INVALID_ARG;
     }
     
-    // Stop current playback
-    if (is_playing) {
-        sound_manager_stop();
-    }
-    
     // Build full path
     char filepath[256];
     snprintf(filepath, sizeof(filepath), "%s/%s", current_config.sound_dir, filename);
     
     ESP_LOGI(TAG, "Playing: %s (mode: %s)", filepath, mode == SOUND_MODE_LOOP ? "loop" : "once");
     
-    // Determine decoder based on file extension
-    // TODO
-    // audio_element_handle_t decoder = NULL;
-    // if (strstr(filename, ".mp3") || strstr(filename, ".MP3")) {
-    //     decoder = mp3_decoder;
-    // } else if (strstr(filename, ".wav") || strstr(filename, ".WAV")) {
-    //     decoder = wav_decoder;
-    // } else {
-    //     ESP_LOGE(TAG, "Unsupported file format: %s", filename);
-    //     return ESP_ERR_NOT_SUPPORTED;
-    // }
-
-    // audio_pipeline_unlink(pipeline);
+    // Replace the current stream, cached sounds keep playing
+    xSemaphoreTake(play_mutex, portMAX_DELAY);
+    stop_stream();
     
-    // Set URI
-    ESP_LOGD(TAG, "[2.4] Set URI for fatfs reader: %s", filepath);
-    audio_element_set_uri(fatfs_reader, filepath);
+    int64_t now = esp_timer_get_time();
+    esp_err_t err = start_stream(filepath, mode == SOUND_MODE_LOOP);
+    if (err == ESP_OK) {
+        current_mode = mode;
+        loop_seen = reader.loops;
+        loop_window_end_us = 0;
+        last_block_us = 0;
+        trigger_us = now;
+        latency_pending = true;
+        latency_from_cache = false;
+        is_playing = true;
+        stream_gen++;
+    }
+    xSemaphoreGive(play_mutex);
     
-    // Set playback mode
-    current_mode = mode;
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Cannot play %s: %s", filepath, esp_err_to_name(err));
+        return err;
+    }
+    xTaskNotifyGive(out_task_handle);
+    
+    return ESP_OK;
+}
+
+/**
+ * Play a cached clip on a mixer voice, on top of the running stream
+ * 
+ * Looping clips wrap sample-exact in the mixer; a clip loops at most once.
+ */
+static esp_err_t play_clip(const sound_clip_t *clip, uint8_t priority, bool loop)
+{
+    int64_t now = esp_timer_get_time();
     
-    ESP_LOGD(TAG, "Audio pipeline: file -> decoder -> resample -> equalizer -> I2S");
+    xSemaphoreTake(play_mutex, portMAX_DELAY);
+    if (loop) {
+        sound_mixer_stop_clip(&mixer, clip->samples);
+    }
+    int voice = sound_mixer_play(&mixer, clip->samples, clip->frames, SOUND_MIXER_UNITY, priority, loop);
+    if (voice >= 0) {
+        trigger_us = now;
+        latency_pending = true;
+        latency_from_cache = true;
+    }
+    xSemaphoreGive(play_mutex);
     
-    // Start pipeline
-    audio_pipeline_run(pipeline);
-    is_playing = true;
+    if (voice < 0) {
+        ESP_LOGD(TAG, "All voices busy with higher priority sounds");
+        return ESP_ERR_NO_MEM;
+    }
+    xTaskNotifyGive(out_task_handle);
     
     return ESP_OK;
 }
@@ -409,12 +1224,20 @@ esp_err_t sound_manager_play_event(sound_event_t event, sound_mode_t mode)
         return ESP_ERR_INVALID_ARG;
     }
     
-    const char *filename = event_sound_files[event];
-    if (!filename) {
+    char filename[SOUND_EVENT_FILE_MAX];
+    if (copy_event_file(event, filename, sizeof(filename)) != ESP_OK) {
         ESP_LOGW(TAG, "No sound file mapped for event %d", event);
         return ESP_ERR_NOT_FOUND;
     }
     
+    if (is_initialized) {
+        const sound_clip_t *clip = sound_cache_get(event);
+        if (clip) {
+            ESP_LOGD(TAG, "Playing %s from cache", filename);
+            return play_clip(clip, event_priority[event], mode == SOUND_MODE_LOOP);
+        }
+    }
+    
     return sound_manager_play_file(filename, mode);
 }
 
@@ -424,21 +1247,11 @@ esp_err_t sound_manager_stop(void)
         return ESP_ERR_INVALID_STATE;
     }
     
-    if (is_playing) {
-        ESP_LOGI(TAG, "Stopping playback");
-        audio_pipeline_stop(pipeline);
-        audio_pipeline_wait_for_stop(pipeline);
-        
-        // Reset pipeline for next playback (synchronous, safe for reuse)
-        // DON'T use terminate() - it's async and causes queue corruption
-        audio_pipeline_reset_ringbuffer(pipeline);
-        audio_pipeline_reset_elements(pipeline);
-        
-        // Pause I2S to prevent noise/crackling after stop
-        audio_element_pause(i2s_stream_writer);
-        
-        is_playing = false;
-    }
+    xSemaphoreTake(play_mutex, portMAX_DELAY);
+    sound_mixer_stop_all(&mixer);
+    latency_pending = false;
+    stop_stream();
+    xSemaphoreGive(play_mutex);
     
     return ESP_OK;
 }
@@ -449,13 +1262,9 @@ esp_err_t sound_manager_set_volume(uint8_t volume)
         volume = 100;
     }
     
+    // Applied to the PCM by the sound output task
     current_volume = volume;
     
-    if (i2s_stream_writer) {
-        // ESP-ADF volume control (0-100)
-        audio_element_set_music_info(i2s_stream_writer, 48000, 2, 16);
-    }
-    
     ESP_LOGI(TAG, "Volume set to %d%%", volume);
     return ESP_OK;
 }
@@ -493,25 +1302,99 @@ esp_err_t sound_manager_set_event_file(sound_event_t event, const char *filename
     if (event >= SOUND_EVENT_MAX) {
         return ESP_ERR_INVALID_ARG;
     }
-    
-    if (event_sound_files[event]) {
-        free(event_sound_files[event]);
-        event_sound_files[event] = NULL;
+    if (filename && strlen(filename) >= SOUND_EVENT_FILE_MAX) {
+        return ESP_ERR_INVALID_ARG;
     }
     
+    char *name = NULL;
     if (filename) {
-        event_sound_files[event] = strdup(filename);
+        // Prefer a version converted to the output format
+        char optname[sizeof(transcode_queue[0]) + sizeof(TRANSCODE_SUFFIX)];
+        char filepath[256];
+        struct stat st;
+        transcoded_name(filename, optname, sizeof(optname));
+        snprintf(filepath, sizeof(filepath), "%s/%s", current_config.sound_dir, optname);
+        if (strcmp(optname, filename) != 0 && stat(filepath, &st) == 0) {
+            ESP_LOGI(TAG, "Event %d: using converted %s", event, optname);
+            filename = optname;
+        }
+        name = strdup(filename);
+        if (!name) {
+            return ESP_ERR_NO_MEM;
+        }
     }
+    swap_event_file(event, name);
+    
+#ifdef CONFIG_SOUND_PCM_CACHE
+    // Decode the new file of a cached event once the output is idle
+    for (size_t i = 0; i < sizeof(cached_events) / sizeof(cached_events[0]); i++) {
+        if (cached_events[i] == event && play_mutex) {
+            xSemaphoreTake(play_mutex, portMAX_DELAY);
+            const sound_clip_t *clip = sound_cache_get(event);
+            if (clip) {
+                sound_mixer_stop_clip(&mixer, clip->samples);
+            }
+            sound_cache_drop(event);
+            cache_stale[event] = true;
+            xSemaphoreGive(play_mutex);
+            xTaskNotifyGive(out_task_handle);
+        }
+    }
+#endif
     
     return ESP_OK;
 }
 
-const char* sound_manager_get_event_file(sound_event_t event)
+esp_err_t sound_manager_get_event_file(sound_event_t event, char *buf, size_t size)
 {
-    if (event >= SOUND_EVENT_MAX) {
-        return NULL;
+    if (event >= SOUND_EVENT_MAX || !buf || size == 0) {
+        return ESP_ERR_INVALID_ARG;
     }
-    return event_sound_files[event];
+    return copy_event_file(event, buf, size);
+}
+
+esp_err_t sound_manager_transcode(const char *filename)
+{
+    if (!is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!filename || strlen(filename) >= sizeof(transcode_queue[0])) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    char filepath[256];
+    snprintf(filepath, sizeof(filepath), "%s/%s", current_config.sound_dir, filename);
+    sound_file_info_t info;
+    esp_err_t err = sound_format_probe(filepath, &info);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (info.pcm16 && info.sample_rate == SOUND_OUTPUT_SAMPLE_RATE && info.channels == SOUND_OUTPUT_CHANNELS) {
+        ESP_LOGD(TAG, "%s is already in the output format", filename);
+        return ESP_OK;
+    }
+    
+    xSemaphoreTake(play_mutex, portMAX_DELAY);
+    bool queued = false;
+    for (int i = 0; i < transcode_count; i++) {
+        if (strcmp(transcode_queue[i], filename) == 0) {
+            queued = true;
+        }
+    }
+    if (!queued && transcode_count < TRANSCODE_QUEUE_LEN) {
+        strlcpy(transcode_queue[transcode_count++], filename, sizeof(transcode_queue[0]));
+        queued = true;
+    }
+    xSemaphoreGive(play_mutex);
+    
+    if (!queued) {
+        ESP_LOGW(TAG, "Conversion queue full, %s stays as is", filename);
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Queued %s for conversion", filename);
+    xTaskNotifyGive(out_task_handle);
+    
+    return ESP_OK;
 }
 
 esp_err_t sound_manager_save_config(void)
@@ -528,12 +1411,13 @@ esp_err_t sound_manager_save_config(void)
     // Save volume
     nvs_set_u8(handle, NVS_KEY_VOLUME, current_volume);
     
-    // Save event mappings
+    // Save event mappings (copied, the output task may remap them meanwhile)
     for (int i = 0; i < SOUND_EVENT_MAX; i++) {
-        if (event_sound_files[i]) {
+        char filename[SOUND_EVENT_FILE_MAX];
+        if (copy_event_file((sound_event_t)i, filename, sizeof(filename)) == ESP_OK) {
             char key[16];
             snprintf(key, sizeof(key), "%s%d", NVS_KEY_EVENT_PREFIX, i);
-            nvs_set_str(handle, key, event_sound_files[i]);
+            nvs_set_str(handle, key, filename);
         }
     }
     
@@ -569,11 +1453,9 @@ esp_err_t sound_manager_load_config(void)
         size_t required_size;
         if (nvs_get_str(handle, key, NULL, &required_size) == ESP_OK) {
             char *filename = malloc(required_size);
-            if (filename && nvs_get_str(handle, key, filename, &required_size) == ESP_OK) {
-                if (event_sound_files[i]) {
-                    free(event_sound_files[i]);
-                }
-                event_sound_files[i] = filename;
+            if (filename && nvs_get_str(handle, key, filename, &required_size) == ESP_OK &&
+                required_size <= SOUND_EVENT_FILE_MAX) {
+                swap_event_file((sound_event_t)i, filename);
             } else if (filename) {
                 free(filename);
             }
@@ -599,7 +1481,8 @@ int sound_manager_get_volume(void) { return -1; }
 bool sound_manager_is_ready(void) { return false; }
 esp_err_t sound_manager_start_streaming(void) { return ESP_ERR_NOT_SUPPORTED; }
 esp_err_t sound_manager_set_event_file(sound_event_t event, const char *filename) { return ESP_ERR_NOT_SUPPORTED; }
-const char* sound_manager_get_event_file(sound_event_t event) { return NULL; }
+esp_err_t sound_manager_get_event_file(sound_event_t event, char *buf, size_t size) { return ESP_ERR_NOT_SUPPORTED; }
+esp_err_t sound_manager_transcode(const char *filename) { return ESP_ERR_NOT_SUPPORTED; }
 esp_err_t sound_manager_save_config(void) { return ESP_ERR_NOT_SUPPORTED; }
 esp_err_t sound_manager_load_config(void) { return ESP_ERR_NOT_SUPPORTED; }
 
@@ -0,0 +1,214 @@
+/**
+ * Sound Mixer - Implementation
+ *
+ * Voices are summed in a 32 bit mono accumulator, then added to both
+ * music channels and saturated to 16 bit once per output sample. The
+ * master gain is folded into the voice and music gains, so the inner
+ * loops need one multiply per voice sample.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#include "sound_mixer.h"
+#include <string.h>
+
+/**
+ * Clamp to the int16 range
+ */
+static inline int16_t sat16(int32_t x)
+{
+    if (x > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (x < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t)x;
+}
+
+/**
+ * Initialize a mixer
+ */
+void sound_mixer_init(sound_mixer_t *m, uint8_t num_voices, uint8_t duck_priority,
+                      int16_t duck_gain, uint32_t duck_ramp_frames)
+{
+    memset(m, 0, sizeof(*m));
+    if (num_voices < 1) num_voices = 1;
+    if (num_voices > SOUND_MIXER_MAX_VOICES) num_voices = SOUND_MIXER_MAX_VOICES;
+    m->num_voices = num_voices;
+    m->duck_priority = duck_priority;
+    m->duck_gain = duck_gain;
+    m->music_gain = SOUND_MIXER_UNITY;
+    m->duck_step = (duck_ramp_frames > 0 && duck_ramp_frames < SOUND_MIXER_UNITY)
+                   ? (int16_t)(SOUND_MIXER_UNITY / duck_ramp_frames) : SOUND_MIXER_UNITY;
+    m->master_gain = SOUND_MIXER_UNITY;
+}
+
+/**
+ * Start a clip on a free (or stolen) voice
+ */
+int sound_mixer_play(sound_mixer_t *m, const int16_t *samples, uint32_t frames,
+                     int16_t gain, uint8_t priority, bool loop)
+{
+    if (!samples || frames == 0) {
+        return -1;
+    }
+
+    int slot = -1;
+    for (int i = 0; i < m->num_voices; i++) {
+        const sound_voice_t *v = &m->voices[i];
+        if (!v->samples) {
+            slot = i;
+            break;
+        }
+        // Lowest priority first, among those the oldest
+        if (v->priority <= priority &&
+            (slot < 0 || v->priority < m->voices[slot].priority ||
+             (v->priority == m->voices[slot].priority && v->serial < m->voices[slot].serial))) {
+            slot = i;
+        }
+    }
+    if (slot < 0) {
+        return -1;
+    }
+
+    sound_voice_t *v = &m->voices[slot];
+    v->samples = samples;
+    v->frames = frames;
+    v->pos = 0;
+    v->gain = gain;
+    v->priority = priority;
+    v->loop = loop;
+    v->serial = ++m->serial;
+    return slot;
+}
+
+/**
+ * Stop every voice playing the given clip
+ */
+void sound_mixer_stop_clip(sound_mixer_t *m, const int16_t *samples)
+{
+    for (int i = 0; i < m->num_voices; i++) {
+        if (m->voices[i].samples == samples) {
+            m->voices[i].samples = NULL;
+        }
+    }
+}
+
+/**
+ * Stop all voices
+ */
+void sound_mixer_stop_all(sound_mixer_t *m)
+{
+    for (int i = 0; i < m->num_voices; i++) {
+        m->voices[i].samples = NULL;
+    }
+}
+
+/**
+ * Number of voices playing
+ */
+int sound_mixer_active(const sound_mixer_t *m)
+{
+    int count = 0;
+    for (int i = 0; i < m->num_voices; i++) {
+        if (m->voices[i].samples) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * Set the master gain
+ */
+void sound_mixer_set_master(sound_mixer_t *m, int16_t gain)
+{
+    m->master_gain = gain;
+}
+
+/**
+ * Render one block
+ */
+void sound_mixer_render(sound_mixer_t *m, const int16_t *music, int16_t *out, size_t frames)
+{
+    if (frames > SOUND_MIXER_MAX_FRAMES) {
+        frames = SOUND_MIXER_MAX_FRAMES;
+    }
+    if (frames == 0) {
+        return;
+    }
+
+    int32_t *acc = m->acc;
+    int32_t master = m->master_gain;
+    bool ducked = false;
+
+    // Sum the voices
+    memset(acc, 0, frames * sizeof(int32_t));
+    for (int i = 0; i < m->num_voices; i++) {
+        sound_voice_t *v = &m->voices[i];
+        if (!v->samples) {
+            continue;
+        }
+        if (v->priority >= m->duck_priority) {
+            ducked = true;
+        }
+
+        // Looping voices wrap within the block, possibly several times for short clips
+        int32_t gain = (v->gain * master) >> 15;
+        size_t done = 0;
+        while (done < frames && v->samples) {
+            uint32_t n = v->frames - v->pos;
+            if (n > frames - done) {
+                n = frames - done;
+            }
+            const int16_t *src = v->samples + v->pos;
+            int32_t *dst = acc + done;
+            for (uint32_t k = 0; k < n; k++) {
+                dst[k] += (src[k] * gain) >> 15;
+            }
+
+            done += n;
+            v->pos += n;
+            if (v->pos >= v->frames) {
+                if (v->loop) {
+                    v->pos = 0;
+                } else {
+                    v->samples = NULL;
+                }
+            }
+        }
+    }
+
+    if (!music) {
+        for (size_t k = 0; k < frames; k++) {
+            int16_t s = sat16(acc[k]);
+            out[k * 2] = s;
+            out[k * 2 + 1] = s;
+        }
+        return;
+    }
+
+    // Ramp the music gain towards its target over this block
+    int32_t g0 = m->music_gain;
+    int32_t target = ducked ? m->duck_gain : SOUND_MIXER_UNITY;
+    int32_t max_change = (int32_t)m->duck_step * (int32_t)frames;
+    int32_t g1 = target;
+    if (g1 > g0 + max_change) g1 = g0 + max_change;
+    if (g1 < g0 - max_change) g1 = g0 - max_change;
+    m->music_gain = (int16_t)g1;
+
+    // Effective gains in Q23 (Q15 << 8) for a smooth per-frame ramp
+    int32_t gain = ((g0 * master) >> 15) << 8;
+    int32_t gain_step = ((((g1 * master) >> 15) << 8) - gain) / (int32_t)frames;
+
+    for (size_t k = 0; k < frames; k++) {
+        int32_t g = gain >> 8;
+        int32_t left = acc[k] + ((music[k * 2] * g) >> 15);
+        int32_t right = acc[k] + ((music[k * 2 + 1] * g) >> 15);
+        out[k * 2] = sat16(left);
+        out[k * 2 + 1] = sat16(right);
+        gain += gain_step;
+    }
+}
@@ -8,9 +8,10 @@
 #include "esp_log.h"
 #include "cJSON.h"
 #include "sound_manager.h"
+#include "audio_output.h"
+#include "sound_library.h"
+#include "sd_card_manager.h"
 #include <string.h>
-#include <sys/stat.h>
-#include <dirent.h>
 #include <unistd.h>
 
 /**
@@ -24,10 +25,13 @@ esp_err_t sound_mappings_handler(httpd_req_t *req)
     cJSON *mappings = cJSON_CreateObject();
     
     for (int i = 0; i < SOUND_EVENT_MAX; i++) {
-        const char *filename = sound_manager_get_event_file((sound_event_t)i);
+        char filename[SOUND_EVENT_FILE_MAX];
+        if (sound_manager_get_event_file((sound_event_t)i, filename, sizeof(filename)) != ESP_OK) {
+            filename[0] = '\0';
+        }
         char key[8];
         snprintf(key, sizeof(key), "%d", i);
-        cJSON_AddStringToObject(mappings, key, filename ? filename : "");
+        cJSON_AddStringToObject(mappings, key, filename);
     }
     
     cJSON_AddItemToObject(root, "mappings", mappings);
@@ -83,6 +87,8 @@ esp_err_t sound_mapping_set_handler(httpd_req_t *req)
 
 /**
  * GET /api/sounds/files - List available sound files
+ * 
+ * Served from the sound library index, no card access.
  */
 esp_err_t sound_files_handler(httpd_req_t *req)
 {
@@ -92,29 +98,19 @@ esp_err_t sound_files_handler(httpd_req_t *req)
     cJSON *files_array = cJSON_CreateArray();
     
 #ifdef CONFIG_ENABLE_SOUND_MANAGER
-    DIR *dir = opendir(CONFIG_SOUND_FILES_PATH);
-    if (dir) {
-        struct dirent *entry;
-        while ((entry = readdir(dir)) != NULL) {
-            if (entry->d_type == DT_REG) {
-                const char *ext = strrchr(entry->d_name, '.');
-                if (ext && (strcmp(ext, ".mp3") == 0 || strcmp(ext, ".wav") == 0)) {
-                    cJSON *file_obj = cJSON_CreateObject();
-                    cJSON_AddStringToObject(file_obj, "name", entry->d_name);
-                    
-                    // Get file size
-                    char filepath[300];
-                    snprintf(filepath, sizeof(filepath), "%s/%s", CONFIG_SOUND_FILES_PATH, entry->d_name);
-                    struct stat st;
-                    if (stat(filepath, &st) == 0) {
-                        cJSON_AddNumberToObject(file_obj, "size", st.st_size);
-                    }
-                    
-                    cJSON_AddItemToArray(files_array, file_obj);
-                }
-            }
+    sound_library_entry_t entry;
+    for (size_t i = 0; sound_library_get(i, &entry); i++) {
+        cJSON *file_obj = cJSON_CreateObject();
+        cJSON_AddStringToObject(file_obj, "name", entry.name);
+        cJSON_AddNumberToObject(file_obj, "size", entry.size);
+        cJSON_AddStringToObject(file_obj, "format", sound_format_name(entry.format));
+        cJSON_AddNumberToObject(file_obj, "sample_rate", entry.sample_rate);
+        cJSON_AddNumberToObject(file_obj, "channels", entry.channels);
+        cJSON_AddNumberToObject(file_obj, "duration_ms", entry.duration_ms);
+        if (entry.peak != SOUND_LIBRARY_PEAK_UNKNOWN) {
+            cJSON_AddNumberToObject(file_obj, "peak", entry.peak);
         }
-        closedir(dir);
+        cJSON_AddItemToArray(files_array, file_obj);
     }
 #endif
     
@@ -179,12 +175,21 @@ esp_err_t sound_upload_handler(httpd_req_t *req)
         }
         
         fwrite(buf, 1, recv_len, fp);
+        sd_card_count_write(recv_len);
         remaining -= recv_len;
     }
     
     fclose(fp);
     free(buf);
     uploaded = 1;
+    
+    if (remaining == 0) {
+        sound_library_update(filename, SOUND_LIBRARY_PEAK_UNKNOWN);
+#ifdef CONFIG_SOUND_TRANSCODE_ON_UPLOAD
+        // Decode once in the background so playback needs no decoder
+        sound_manager_transcode(filename);
+#endif
+    }
 #endif
     
     free((void*)filename);
@@ -228,6 +233,7 @@ esp_err_t sound_delete_handler(httpd_req_t *req)
     char filepath[256];
     snprintf(filepath, sizeof(filepath), "%s/%s", CONFIG_SOUND_FILES_PATH, filename_item->valuestring);
     unlink(filepath);
+    sound_library_remove(filename_item->valuestring);
 #endif
     
     cJSON_Delete(json);
@@ -258,10 +264,19 @@ esp_err_t sound_play_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
     
-    int event = cJSON_GetObjectItem(json, "event")->valueint;
+    cJSON *event_item = cJSON_GetObjectItem(json, "event");
+    int event = cJSON_IsNumber(event_item) ? event_item->valueint : -1;
     cJSON_Delete(json);
     
-    sound_manager_play_event((sound_event_t)event, SOUND_MODE_ONCE);
+    // Posted like game sounds, so priorities and coalescing apply
+    esp_err_t err = audio_post_event((audio_event_t)event, false);
+    if (err == ESP_ERR_INVALID_ARG) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown event");
+        return ESP_FAIL;
+    } else if (err != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Audio not available");
+        return ESP_FAIL;
+    }
     
     httpd_resp_set_type(req, "application/json");
     httpd_resp_sendstr(req, "{\"status\":\"playing\"}");
@@ -274,7 +289,7 @@ esp_err_t sound_play_handler(httpd_req_t *req)
  */
 esp_err_t sound_stop_handler(httpd_req_t *req)
 {
-    sound_manager_stop();
+    audio_stop();
     
     httpd_resp_set_type(req, "application/json");
     httpd_resp_sendstr(req, "{\"status\":\"stopped\"}");
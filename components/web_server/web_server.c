@@ -10,14 +10,22 @@
 
 #include "web_server.h"
 #include "wifi_ap_manager.h"
+#include "wifi_scan.h"
 #include "game_logic.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include "cJSON.h"
+#include "metrics.h"
+#include "sensor_trace.h"
 
 #ifdef CONFIG_ENABLE_SD_CARD
 #include "sd_card_manager.h"
@@ -37,6 +45,51 @@ extern esp_err_t sounds_page_handler(httpd_req_t *req);
 
 static const char *TAG = "WEB_SERVER";
 
+// The Web Server menu depends on the control role, other roles still build this file
+#ifndef CONFIG_WEB_SERVER_MAX_OPEN_SOCKETS
+#define CONFIG_WEB_SERVER_MAX_OPEN_SOCKETS 7
+#endif
+#ifndef CONFIG_WEB_SERVER_ASYNC_WORKERS
+#define CONFIG_WEB_SERVER_ASYNC_WORKERS 2
+#endif
+#ifndef CONFIG_WEB_SERVER_ASYNC_WORKER_STACK
+#define CONFIG_WEB_SERVER_ASYNC_WORKER_STACK 6144
+#endif
+#ifndef CONFIG_WEB_SERVER_KEEPALIVE_IDLE
+#define CONFIG_WEB_SERVER_KEEPALIVE_IDLE 5
+#endif
+#ifndef CONFIG_WEB_SERVER_KEEPALIVE_INTERVAL
+#define CONFIG_WEB_SERVER_KEEPALIVE_INTERVAL 3
+#endif
+#ifndef CONFIG_WEB_SERVER_KEEPALIVE_COUNT
+#define CONFIG_WEB_SERVER_KEEPALIVE_COUNT 3
+#endif
+
+// Long-running requests (WiFi scan/connect, uploads) are handed off to this
+// many worker tasks so the httpd task keeps serving /api/status meanwhile
+#define ASYNC_WORKER_COUNT CONFIG_WEB_SERVER_ASYNC_WORKERS
+
+#define METRICS_RENDER_BUF_SIZE 6144
+
+typedef esp_err_t (*req_handler_t)(httpd_req_t *req);
+
+typedef struct {
+    httpd_req_t *req;               // Request copy owned by the worker
+    req_handler_t handler;    // Blocking handler to run on the worker
+} async_req_t;
+
+static QueueHandle_t async_req_queue = NULL;
+static SemaphoreHandle_t async_worker_ready = NULL;  // Counts idle workers
+
+// Request metrics
+static metric_t *m_http_requests = NULL;
+static metric_t *m_http_errors = NULL;
+static metric_t *m_http_duration_ms = NULL;
+static metric_t *m_http_duration_max_us = NULL;
+static metric_t *m_async_requests = NULL;
+static metric_t *m_async_duration_ms = NULL;
+static metric_t *m_async_rejected = NULL;
+
 static httpd_handle_t server = NULL;
 static game_control_callback_t game_callback = NULL;
 static char cached_status[512] = "";
@@ -64,6 +117,162 @@ static const char *get_mime_type(const char *filename)
     return "application/octet-stream";
 }
 
+/**
+ * Async worker task - runs blocking handlers outside of the httpd task
+ */
+static void async_req_worker_task(void *pvParameters)
+{
+    async_req_t item;
+    
+    while (1) {
+        // Signal that this worker can take the next request
+        xSemaphoreGive(async_worker_ready);
+        
+        if (xQueueReceive(async_req_queue, &item, portMAX_DELAY) == pdTRUE) {
+            int64_t start = esp_timer_get_time();
+            item.handler(item.req);
+            int64_t elapsed = esp_timer_get_time() - start;
+            metrics_inc(m_async_requests);
+            metrics_add_us(m_async_duration_ms, elapsed);
+            ESP_LOGD(TAG, "Async request %s done in %lld ms", item.req->uri, elapsed / 1000);
+            httpd_req_async_handler_complete(item.req);
+        }
+    }
+}
+
+/**
+ * Start the async worker pool (once, survives web_server_stop/init cycles)
+ */
+static esp_err_t async_workers_start(void)
+{
+    if (async_req_queue != NULL) {
+        return ESP_OK;
+    }
+    
+    async_worker_ready = xSemaphoreCreateCounting(ASYNC_WORKER_COUNT, 0);
+    async_req_queue = xQueueCreate(ASYNC_WORKER_COUNT, sizeof(async_req_t));
+    if (!async_worker_ready || !async_req_queue) {
+        ESP_LOGE(TAG, "Failed to create async worker queue");
+        return ESP_ERR_NO_MEM;
+    }
+    
+    for (int i = 0; i < ASYNC_WORKER_COUNT; i++) {
+        char name[16];
+        TaskHandle_t handle = NULL;
+        snprintf(name, sizeof(name), "httpd_async_%d", i);
+        if (xTaskCreate(async_req_worker_task, name, CONFIG_WEB_SERVER_ASYNC_WORKER_STACK,
+                        NULL, tskIDLE_PRIORITY + 5, &handle) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to start async worker %d", i);
+            return ESP_ERR_NO_MEM;
+        }
+        metrics_register_task(handle, pcTaskGetName(handle));
+    }
+    
+    ESP_LOGI(TAG, "Started %d async request workers", ASYNC_WORKER_COUNT);
+    return ESP_OK;
+}
+
+/**
+ * Hand a request over to an idle async worker
+ * 
+ * Responds with 503 immediately if all workers are busy instead of
+ * queueing behind a running scan or upload.
+ */
+static esp_err_t async_req_submit(httpd_req_t *req, req_handler_t handler)
+{
+    if (xSemaphoreTake(async_worker_ready, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "All async workers busy, rejecting %s", req->uri);
+        metrics_inc(m_async_rejected);
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "1");
+        httpd_resp_set_type(req, "application/json");
+        httpd_resp_sendstr(req, "{\"error\":\"Server busy, try again\"}");
+        return ESP_OK;
+    }
+    
+    httpd_req_t *copy = NULL;
+    esp_err_t ret = httpd_req_async_handler_begin(req, &copy);
+    if (ret != ESP_OK) {
+        xSemaphoreGive(async_worker_ready);
+        ESP_LOGE(TAG, "Failed to detach request %s: %s", req->uri, esp_err_to_name(ret));
+        return ret;
+    }
+    
+    async_req_t item = {
+        .req = copy,
+        .handler = handler
+    };
+    if (xQueueSend(async_req_queue, &item, 0) != pdTRUE) {
+        // Cannot happen while the semaphore is in sync with idle workers
+        httpd_req_async_handler_complete(copy);
+        xSemaphoreGive(async_worker_ready);
+        return ESP_FAIL;
+    }
+    
+    return ESP_OK;
+}
+
+/**
+ * Wrapper around every URI handler - counts requests and measures latency
+ * The real handler is stored in user_ctx by register_uri_handler().
+ */
+static esp_err_t instrumented_handler(httpd_req_t *req)
+{
+    req_handler_t handler = (req_handler_t)req->user_ctx;
+    
+    int64_t start = esp_timer_get_time();
+    esp_err_t ret = handler(req);
+    int32_t elapsed = (int32_t)(esp_timer_get_time() - start);
+    
+    metrics_inc(m_http_requests);
+    metrics_add_us(m_http_duration_ms, elapsed);
+    metrics_max(m_http_duration_max_us, elapsed);
+    if (ret != ESP_OK) {
+        metrics_inc(m_http_errors);
+    }
+    return ret;
+}
+
+/**
+ * Register a URI handler through the metrics wrapper
+ */
+static void register_uri_handler(httpd_uri_t *uri)
+{
+    uri->user_ctx = (void *)uri->handler;
+    uri->handler = instrumented_handler;
+    
+    esp_err_t ret = httpd_register_uri_handler(server, uri);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register %s: %s", uri->uri, esp_err_to_name(ret));
+    }
+}
+
+/**
+ * Metrics handler - GET /api/metrics (Prometheus text format)
+ */
+static esp_err_t metrics_handler(httpd_req_t *req)
+{
+    static bool httpd_task_tracked = false;
+    if (!httpd_task_tracked) {
+        // Handlers run on the httpd task, so this is the cheapest way to get its handle
+        metrics_register_task(xTaskGetCurrentTaskHandle(), "httpd");
+        httpd_task_tracked = true;
+    }
+    
+    char *buf = malloc(METRICS_RENDER_BUF_SIZE);
+    if (!buf) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+        return ESP_FAIL;
+    }
+    
+    size_t len = metrics_render(buf, METRICS_RENDER_BUF_SIZE);
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+    esp_err_t ret = httpd_resp_send(req, buf, len);
+    
+    free(buf);
+    return ret;
+}
+
 /**
  * Root handler - serve HTML page (from SD card or internal)
  */
@@ -84,6 +293,7 @@ static esp_err_t root_handler(httpd_req_t *req)
             char buffer[512];
             size_t read_bytes;
             while ((read_bytes = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+                sd_card_count_read(read_bytes);
                 if (httpd_resp_send_chunk(req, buffer, read_bytes) != ESP_OK) {
                     fclose(file);
                     httpd_resp_send_chunk(req, NULL, 0);  // Abort chunked send
@@ -154,6 +364,7 @@ static esp_err_t sd_file_handler(httpd_req_t *req)
     char buffer[512];
     size_t read_bytes;
     while ((read_bytes = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        sd_card_count_read(read_bytes);
         if (httpd_resp_send_chunk(req, buffer, read_bytes) != ESP_OK) {
             fclose(file);
             httpd_resp_send_chunk(req, NULL, 0);
@@ -227,16 +438,24 @@ static esp_err_t status_handler(httpd_req_t *req)
 
 /**
  * WiFi scan handler
+ * Answers from the scan cache and refreshes it in the background when it
+ * is older than WIFI_SCAN_CACHE_TTL_SEC (or on ?refresh=1); the page polls
+ * while "scanning" is true.
  */
 static esp_err_t wifi_scan_handler(httpd_req_t *req)
 {
-    wifi_scan_result_t results[20];
+    wifi_scan_result_t results[WIFI_SCAN_CACHE_SIZE];
     size_t num_found = 0;
     
-    esp_err_t ret = wifi_scan_networks(results, 20, &num_found);
-    if (ret != ESP_OK) {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Scan failed");
-        return ESP_FAIL;
+    char query[32];
+    char refresh[4] = "";
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        httpd_query_key_value(query, "refresh", refresh, sizeof(refresh));
+    }
+    
+    uint32_t age_ms = wifi_scan_get_cached(results, WIFI_SCAN_CACHE_SIZE, &num_found);
+    if (refresh[0] == '1' || age_ms > CONFIG_WIFI_SCAN_CACHE_TTL_SEC * 1000U) {
+        wifi_scan_request(NULL, 0);     // No-op if a scan is already running
     }
     
     cJSON *root = cJSON_CreateObject();
@@ -248,11 +467,16 @@ static esp_err_t wifi_scan_handler(httpd_req_t *req)
         cJSON_AddNumberToObject(network, "rssi", results[i].rssi);
         cJSON_AddNumberToObject(network, "authmode", results[i].authmode);
         cJSON_AddNumberToObject(network, "channel", results[i].channel);
+        cJSON_AddNumberToObject(network, "age_ms", results[i].age_ms);
         cJSON_AddItemToArray(networks, network);
     }
     
     cJSON_AddItemToObject(root, "networks", networks);
     cJSON_AddNumberToObject(root, "count", num_found);
+    cJSON_AddBoolToObject(root, "scanning", wifi_scan_in_progress());
+    if (age_ms != UINT32_MAX) {
+        cJSON_AddNumberToObject(root, "age_ms", age_ms);
+    }
     
     char *json_str = cJSON_Print(root);
     httpd_resp_set_type(req, "application/json");
@@ -299,11 +523,12 @@ static esp_err_t wifi_connect_handler(httpd_req_t *req)
     
     ESP_LOGI(TAG, "Connecting to WiFi: %s (save=%d)", ssid, save);
     
-    esp_err_t connect_ret = wifi_connect_sta(ssid, password, save);
+    // Progress is polled via /api/wifi/status
+    esp_err_t connect_ret = wifi_connect_sta_async(ssid, password, save);
     
     cJSON *response = cJSON_CreateObject();
     if (connect_ret == ESP_OK) {
-        cJSON_AddStringToObject(response, "message", "Connected successfully");
+        cJSON_AddStringToObject(response, "message", "Connecting...");
         cJSON_AddBoolToObject(response, "success", true);
     } else {
         cJSON_AddStringToObject(response, "message", "Connection failed");
@@ -349,12 +574,14 @@ static esp_err_t wifi_status_handler(httpd_req_t *req)
     cJSON_AddStringToObject(root, "status", status_str);
     cJSON_AddBoolToObject(root, "connected", status == WIFI_STATUS_CONNECTED);
     
+    if (status != WIFI_STATUS_DISCONNECTED) {
+        cJSON_AddStringToObject(root, "ssid", wifi_get_sta_ssid());
+    }
+    
     if (status == WIFI_STATUS_CONNECTED && wifi_get_sta_ip(&ip_info) == ESP_OK) {
         char ip_str[16];
         snprintf(ip_str, sizeof(ip_str), IPSTR, IP2STR(&ip_info.ip));
         cJSON_AddStringToObject(root, "ip", ip_str);
-        // Note: SSID would need to be stored separately
-        cJSON_AddStringToObject(root, "ssid", "Connected Network");
     }
     
     char *json_str = cJSON_Print(root);
@@ -467,6 +694,24 @@ static esp_err_t units_list_handler(httpd_req_t *req)
         cJSON_AddStringToObject(unit, "status", units[i].status);
         cJSON_AddNumberToObject(unit, "last_seen", units[i].last_seen);
         
+        const sensor_cal_report_t *cal = &units[i].calibration;
+        if (cal->pending || cal->valid) {
+            static const char *cal_states[] = {"ok", "poor", "failed", "busy"};
+            cJSON *cal_obj = cJSON_CreateObject();
+            cJSON_AddStringToObject(cal_obj, "state", cal->pending ? "running" :
+                                    cal->status < 4 ? cal_states[cal->status] : "failed");
+            if (cal->valid) {
+                cJSON_AddNumberToObject(cal_obj, "threshold", cal->threshold);
+                cJSON_AddNumberToObject(cal_obj, "hysteresis", cal->hysteresis);
+                cJSON_AddNumberToObject(cal_obj, "off_mean", cal->off_mean);
+                cJSON_AddNumberToObject(cal_obj, "off_stddev", cal->off_stddev);
+                cJSON_AddNumberToObject(cal_obj, "on_mean", cal->on_mean);
+                cJSON_AddNumberToObject(cal_obj, "on_stddev", cal->on_stddev);
+                cJSON_AddNumberToObject(cal_obj, "separation", cal->separation_x10 / 10.0);
+            }
+            cJSON_AddItemToObject(unit, "calibration", cal_obj);
+        }
+        
         cJSON_AddItemToArray(units_array, unit);
     }
     
@@ -526,8 +771,9 @@ static esp_err_t units_control_handler(httpd_req_t *req)
     extern game_state_t game_get_state(void);
     game_state_t state = game_get_state();
     
-    // Block laser_on/laser_off during active game (RUNNING, COUNTDOWN, PENALTY, PAUSED)
-    if ((strcmp(action, "laser_on") == 0 || strcmp(action, "laser_off") == 0) &&
+    // Block laser_on/laser_off/calibrate during active game (RUNNING, COUNTDOWN, PENALTY, PAUSED)
+    if ((strcmp(action, "laser_on") == 0 || strcmp(action, "laser_off") == 0 ||
+         strcmp(action, "calibrate") == 0) &&
         (state == GAME_STATE_RUNNING || state == GAME_STATE_COUNTDOWN || 
          state == GAME_STATE_PENALTY || state == GAME_STATE_PAUSED)) {
         cJSON_Delete(json);
@@ -550,6 +796,11 @@ static esp_err_t units_control_handler(httpd_req_t *req)
         result = game_control_laser(module_id, false, 0);
     } else if (strcmp(action, "reset") == 0) {
         result = game_reset_laser_unit(module_id);
+    } else if (strcmp(action, "calibrate") == 0) {
+        // id 0 = all laser units at once
+        cJSON *samples_item = cJSON_GetObjectItem(json, "samples");
+        uint16_t samples = samples_item ? (uint16_t)samples_item->valueint : 0;
+        result = game_calibrate_sensors(module_id, samples);
     } else {
         cJSON_Delete(json);
         httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown action");
@@ -568,6 +819,52 @@ static esp_err_t units_control_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
+/**
+ * Sensor trace handler - GET /api/trace (latest trace as binary file, see sensor_trace.h)
+ */
+static esp_err_t trace_handler(httpd_req_t *req)
+{
+    sensor_trace_header_t header;
+    uint16_t received = 0;
+    if (sensor_trace_latest(&header, &received) != ESP_OK) {
+        httpd_resp_send_404(req);
+        return ESP_OK;
+    }
+    
+    char disposition[64];
+    snprintf(disposition, sizeof(disposition), "attachment; filename=\"trace_m%d_%d.bin\"",
+             header.module_id, header.trace_id);
+    char received_str[16];
+    snprintf(received_str, sizeof(received_str), "%u", received);
+    
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", disposition);
+    httpd_resp_set_hdr(req, "X-Trace-Received", received_str);   // Missing samples are all zero
+    
+    // A newer trace may start arriving meanwhile; offsets are only valid for one
+    uint8_t buf[512];
+    size_t offset = 0;
+    size_t len;
+    while ((len = sensor_trace_read(offset, buf, sizeof(buf))) > 0) {
+        if (httpd_resp_send_chunk(req, (const char *)buf, len) != ESP_OK) {
+            httpd_resp_send_chunk(req, NULL, 0);
+            return ESP_FAIL;
+        }
+        offset += len;
+    }
+    httpd_resp_send_chunk(req, NULL, 0);
+    
+    return ESP_OK;
+}
+
+/**
+ * Async entry points - registered instead of the blocking handlers
+ */
+static esp_err_t sound_upload_async_handler(httpd_req_t *req)
+{
+    return async_req_submit(req, sound_upload_handler);
+}
+
 /**
  * Initialize web server
  */
@@ -579,6 +876,7 @@ esp_err_t web_server_init(httpd_handle_t *server_out, game_control_callback_t ca
     }
     
     game_callback = callback;
+    esp_err_t ret;
     
 #ifdef CONFIG_ENABLE_SD_CARD
     // Prüfe ob SD-Karte mit /web Verzeichnis verfügbar ist
@@ -594,13 +892,38 @@ esp_err_t web_server_init(httpd_handle_t *server_out, game_control_callback_t ca
     ESP_LOGI(TAG, "SD card support disabled, using internal HTML");
 #endif
     
+    if (!m_http_requests) {
+        m_http_requests = metrics_register_counter("laser_http_requests_total", "HTTP requests handled", NULL);
+        m_http_errors = metrics_register_counter("laser_http_request_errors_total", "HTTP handlers that returned an error", NULL);
+        m_http_duration_ms = metrics_register_counter("laser_http_request_duration_ms_total", "Time spent in HTTP handlers on the httpd task", NULL);
+        m_http_duration_max_us = metrics_register_gauge("laser_http_request_duration_max_us", "Slowest HTTP handler on the httpd task", NULL);
+        m_async_requests = metrics_register_counter("laser_http_async_requests_total", "Requests completed by async workers", NULL);
+        m_async_duration_ms = metrics_register_counter("laser_http_async_duration_ms_total", "Time spent in async workers", NULL);
+        m_async_rejected = metrics_register_counter("laser_http_async_rejected_total", "Requests rejected because all async workers were busy", NULL);
+    }
+    
+    ret = async_workers_start();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-    config.max_uri_handlers = 16;
+    config.max_uri_handlers = 32;       // 26 API/page handlers + SD wildcard, with headroom
     config.stack_size = 8192;
+    config.uri_match_fn = httpd_uri_match_wildcard;  // Needed for the "/*" SD card handler
+    
+    // Connection management: recycle the least recently used socket instead of
+    // refusing new clients, and reap dead connections via TCP keep-alive
+    config.max_open_sockets = CONFIG_WEB_SERVER_MAX_OPEN_SOCKETS;
+    config.lru_purge_enable = true;
+    config.keep_alive_enable = true;
+    config.keep_alive_idle = CONFIG_WEB_SERVER_KEEPALIVE_IDLE;
+    config.keep_alive_interval = CONFIG_WEB_SERVER_KEEPALIVE_INTERVAL;
+    config.keep_alive_count = CONFIG_WEB_SERVER_KEEPALIVE_COUNT;
     
     ESP_LOGI(TAG, "Starting web server on port %d", config.server_port);
     
-    esp_err_t ret = httpd_start(&server, &config);
+    ret = httpd_start(&server, &config);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to start server: %s", esp_err_to_name(ret));
         return ret;
@@ -612,15 +935,22 @@ esp_err_t web_server_init(httpd_handle_t *server_out, game_control_callback_t ca
         .method = HTTP_GET,
         .handler = root_handler
     };
-    httpd_register_uri_handler(server, &root_uri);
+    register_uri_handler(&root_uri);
     
 
+    httpd_uri_t metrics_uri = {
+        .uri = "/api/metrics",
+        .method = HTTP_GET,
+        .handler = metrics_handler
+    };
+    register_uri_handler(&metrics_uri);
+    
     httpd_uri_t status_uri = {
         .uri = "/api/status",
         .method = HTTP_GET,
         .handler = status_handler
     };
-    httpd_register_uri_handler(server, &status_uri);
+    register_uri_handler(&status_uri);
     
     // WiFi endpoints
     httpd_uri_t wifi_scan_uri = {
@@ -628,28 +958,28 @@ esp_err_t web_server_init(httpd_handle_t *server_out, game_control_callback_t ca
         .method = HTTP_GET,
         .handler = wifi_scan_handler
     };
-    httpd_register_uri_handler(server, &wifi_scan_uri);
+    register_uri_handler(&wifi_scan_uri);
     
     httpd_uri_t wifi_connect_uri = {
         .uri = "/api/wifi/connect",
         .method = HTTP_POST,
         .handler = wifi_connect_handler
     };
-    httpd_register_uri_handler(server, &wifi_connect_uri);
+    register_uri_handler(&wifi_connect_uri);
     
     httpd_uri_t wifi_status_uri = {
         .uri = "/api/wifi/status",
         .method = HTTP_GET,
         .handler = wifi_status_handler
     };
-    httpd_register_uri_handler(server, &wifi_status_uri);
+    register_uri_handler(&wifi_status_uri);
     
     httpd_uri_t wifi_disconnect_uri = {
         .uri = "/api/wifi/disconnect",
         .method = HTTP_POST,
         .handler = wifi_disconnect_handler
     };
-    httpd_register_uri_handler(server, &wifi_disconnect_uri);
+    register_uri_handler(&wifi_disconnect_uri);
     
     // Game control endpoints
     httpd_uri_t game_start_uri = {
@@ -657,28 +987,28 @@ esp_err_t web_server_init(httpd_handle_t *server_out, game_control_callback_t ca
         .method = HTTP_POST,
         .handler = game_control_handler
     };
-    httpd_register_uri_handler(server, &game_start_uri);
+    register_uri_handler(&game_start_uri);
     
     httpd_uri_t game_stop_uri = {
         .uri = "/api/game/stop",
         .method = HTTP_POST,
         .handler = game_control_handler
     };
-    httpd_register_uri_handler(server, &game_stop_uri);
+    register_uri_handler(&game_stop_uri);
     
     httpd_uri_t game_pause_uri = {
         .uri = "/api/game/pause",
         .method = HTTP_POST,
         .handler = game_control_handler
     };
-    httpd_register_uri_handler(server, &game_pause_uri);
+    register_uri_handler(&game_pause_uri);
     
     httpd_uri_t game_resume_uri = {
         .uri = "/api/game/resume",
         .method = HTTP_POST,
         .handler = game_control_handler
     };
-    httpd_register_uri_handler(server, &game_resume_uri);
+    register_uri_handler(&game_resume_uri);
     
     // Unit management endpoints
     httpd_uri_t units_list_uri = {
@@ -686,14 +1016,21 @@ esp_err_t web_server_init(httpd_handle_t *server_out, game_control_callback_t ca
         .method = HTTP_GET,
         .handler = units_list_handler
     };
-    httpd_register_uri_handler(server, &units_list_uri);
+    register_uri_handler(&units_list_uri);
     
     httpd_uri_t units_control_uri = {
         .uri = "/api/units/control",
         .method = HTTP_POST,
         .handler = units_control_handler
     };
-    httpd_register_uri_handler(server, &units_control_uri);
+    register_uri_handler(&units_control_uri);
+    
+    httpd_uri_t trace_uri = {
+        .uri = "/api/trace",
+        .method = HTTP_GET,
+        .handler = trace_handler
+    };
+    register_uri_handler(&trace_uri);
     
     // Sound API endpoints
     httpd_uri_t sounds_page_uri = {
@@ -701,70 +1038,70 @@ esp_err_t web_server_init(httpd_handle_t *server_out, game_control_callback_t ca
         .method = HTTP_GET,
         .handler = sounds_page_handler
     };
-    httpd_register_uri_handler(server, &sounds_page_uri);
+    register_uri_handler(&sounds_page_uri);
     
     httpd_uri_t sound_mappings_uri = {
         .uri = "/api/sounds/mappings",
         .method = HTTP_GET,
         .handler = sound_mappings_handler
     };
-    httpd_register_uri_handler(server, &sound_mappings_uri);
+    register_uri_handler(&sound_mappings_uri);
     
     httpd_uri_t sound_mapping_set_uri = {
         .uri = "/api/sounds/mapping",
         .method = HTTP_POST,
         .handler = sound_mapping_set_handler
     };
-    httpd_register_uri_handler(server, &sound_mapping_set_uri);
+    register_uri_handler(&sound_mapping_set_uri);
     
     httpd_uri_t sound_files_uri = {
         .uri = "/api/sounds/files",
         .method = HTTP_GET,
         .handler = sound_files_handler
     };
-    httpd_register_uri_handler(server, &sound_files_uri);
+    register_uri_handler(&sound_files_uri);
     
     httpd_uri_t sound_upload_uri = {
         .uri = "/api/sounds/upload",
         .method = HTTP_POST,
-        .handler = sound_upload_handler
+        .handler = sound_upload_async_handler
     };
-    httpd_register_uri_handler(server, &sound_upload_uri);
+    register_uri_handler(&sound_upload_uri);
     
     httpd_uri_t sound_delete_uri = {
         .uri = "/api/sounds/delete",
         .method = HTTP_POST,
         .handler = sound_delete_handler
     };
-    httpd_register_uri_handler(server, &sound_delete_uri);
+    register_uri_handler(&sound_delete_uri);
     
     httpd_uri_t sound_play_uri = {
         .uri = "/api/sounds/play",
         .method = HTTP_POST,
         .handler = sound_play_handler
     };
-    httpd_register_uri_handler(server, &sound_play_uri);
+    register_uri_handler(&sound_play_uri);
     
     httpd_uri_t sound_stop_uri = {
         .uri = "/api/sounds/stop",
         .method = HTTP_POST,
         .handler = sound_stop_handler
     };
-    httpd_register_uri_handler(server, &sound_stop_uri);
+    register_uri_handler(&sound_stop_uri);
     
     httpd_uri_t sound_volume_get_uri = {
         .uri = "/api/sounds/volume",
         .method = HTTP_GET,
         .handler = sound_volume_get_handler
     };
-    httpd_register_uri_handler(server, &sound_volume_get_uri);
+    register_uri_handler(&sound_volume_get_uri);
     
     httpd_uri_t sound_volume_set_uri = {
         .uri = "/api/sounds/volume",
         .method = HTTP_POST,
         .handler = sound_volume_set_handler
     };
-    httpd_register_uri_handler(server, &sound_volume_set_uri);
+    register_uri_handler(&sound_volume_set_uri);
     
 #ifdef CONFIG_ENABLE_SD_CARD
     // Wildcard handler für SD-Karten-Dateien registrieren (NACH allen API-Handlers!)
@@ -775,7 +1112,7 @@ esp_err_t web_server_init(httpd_handle_t *server_out, game_control_callback_t ca
             .method = HTTP_GET,
             .handler = sd_file_handler
         };
-        httpd_register_uri_handler(server, &sd_file_uri);
+        register_uri_handler(&sd_file_uri);
         ESP_LOGI(TAG, "Registered wildcard handler for SD card files");
     }
 #endif
@@ -39,6 +39,12 @@ typedef enum {
     WIFI_STATUS_FAILED
 } wifi_sta_status_t;
 
+/**
+ * STA status callback (called from the WiFi event task or the caller of
+ * wifi_connect_sta_async, keep it short)
+ */
+typedef void (*wifi_sta_event_cb_t)(wifi_sta_status_t status);
+
 /**
  * Scanned WiFi network info
  */
@@ -47,6 +53,7 @@ typedef struct {
     int8_t rssi;
     wifi_auth_mode_t authmode;
     uint8_t channel;
+    uint32_t age_ms;            // Time since the network was last seen (cached results)
 } wifi_scan_result_t;
 
 /**
@@ -83,7 +90,9 @@ esp_err_t wifi_apsta_init(void);
 esp_err_t wifi_ap_deinit(void);
 
 /**
- * Scan for available WiFi networks
+ * Scan for available WiFi networks (blocking full scan)
+ * 
+ * Prefer the non-blocking scan service in wifi_scan.h.
  * 
  * @param results Array to store scan results
  * @param max_results Maximum number of results
@@ -93,7 +102,31 @@ esp_err_t wifi_ap_deinit(void);
 esp_err_t wifi_scan_networks(wifi_scan_result_t *results, size_t max_results, size_t *num_found);
 
 /**
- * Connect to WiFi network as Station
+ * Start connecting to a WiFi network as Station
+ * 
+ * Returns immediately, the connection manager task finds the channel,
+ * reconfigures the STA (without restarting the radio when the driver
+ * allows it) and connects. Lost connections are retried with jittered
+ * exponential backoff. Progress is reported via wifi_get_sta_status()
+ * and the callback set with wifi_set_sta_callback().
+ * 
+ * @param ssid Network SSID
+ * @param password Network password
+ * @param save_to_nvs Save credentials to NVS once connected
+ * @return ESP_OK if the request was queued
+ */
+esp_err_t wifi_connect_sta_async(const char *ssid, const char *password, bool save_to_nvs);
+
+/**
+ * Wait until the STA is connected or the connect attempt gave up
+ * 
+ * @param timeout_ms Maximum time to wait
+ * @return ESP_OK if connected, ESP_FAIL if failed, ESP_ERR_TIMEOUT otherwise
+ */
+esp_err_t wifi_wait_sta(uint32_t timeout_ms);
+
+/**
+ * Connect to WiFi network as Station (blocking, up to 10 s)
  * 
  * @param ssid Network SSID
  * @param password Network password
@@ -116,6 +149,20 @@ esp_err_t wifi_disconnect_sta(void);
  */
 wifi_sta_status_t wifi_get_sta_status(void);
 
+/**
+ * Get the SSID the station is configured for
+ * 
+ * @return SSID (empty if none)
+ */
+const char *wifi_get_sta_ssid(void);
+
+/**
+ * Register a callback for STA status changes
+ * 
+ * @param callback Callback function (NULL to remove)
+ */
+void wifi_set_sta_callback(wifi_sta_event_cb_t callback);
+
 /**
  * Get station IP info
  * 
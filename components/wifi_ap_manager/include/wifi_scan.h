@@ -0,0 +1,85 @@
+/**
+ * WiFi Scan Service - Header
+ *
+ * Non-blocking WiFi scans with a result cache. Scans run in the
+ * background (results arrive with WIFI_EVENT_SCAN_DONE), so the web
+ * page can show the cached list right away and the STA connect can
+ * take the channel of a known network without a full scan. Targeted
+ * scans (one SSID and/or one channel) refresh single entries.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#ifndef WIFI_SCAN_H
+#define WIFI_SCAN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "wifi_ap_manager.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WIFI_SCAN_CACHE_SIZE 20
+
+/**
+ * Initialize the scan service (after esp_wifi_init)
+ *
+ * @return ESP_OK on success
+ */
+esp_err_t wifi_scan_service_init(void);
+
+/**
+ * Start a background scan
+ *
+ * A full scan (ssid NULL, channel 0) replaces the cache, targeted scans
+ * update the entries they find and drop entries of the SSID they miss.
+ *
+ * @param ssid Only look for this SSID (NULL = all)
+ * @param channel Only scan this channel (0 = all)
+ * @return ESP_OK if started, ESP_ERR_INVALID_STATE if a scan is running
+ */
+esp_err_t wifi_scan_request(const char *ssid, uint8_t channel);
+
+/**
+ * Wait for the running scan to finish
+ *
+ * @param timeout_ms Maximum time to wait
+ * @return ESP_OK when no scan is running, ESP_ERR_TIMEOUT otherwise
+ */
+esp_err_t wifi_scan_wait(uint32_t timeout_ms);
+
+/**
+ * Check if a scan is running
+ */
+bool wifi_scan_in_progress(void);
+
+/**
+ * Copy the cached networks (strongest first)
+ *
+ * @param results Array to store the networks (age_ms is set per entry)
+ * @param max_results Size of results
+ * @param num_found Number of networks copied
+ * @return Age of the last full scan in ms, UINT32_MAX if there was none
+ */
+uint32_t wifi_scan_get_cached(wifi_scan_result_t *results, size_t max_results, size_t *num_found);
+
+/**
+ * Look up the channel of a network in the cache
+ *
+ * @param ssid Network SSID
+ * @param max_age_ms Ignore entries older than this
+ * @param channel Set to the channel of the strongest matching entry
+ * @return true if found
+ */
+bool wifi_scan_find_channel(const char *ssid, uint32_t max_age_ms, uint8_t *channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WIFI_SCAN_H
@@ -3,6 +3,7 @@
  * 
  * Supports Access Point, Station, and APSTA modes with:
  * - Automatic fallback to AP if STA connection fails
+ * - Asynchronous STA connect with backoff reconnects
  * - NVS credential storage
  * - WiFi network scanning
  * - Web-based configuration
@@ -13,14 +14,19 @@
 
 #include <string.h>
 #include "wifi_ap_manager.h"
+#include "wifi_scan.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_mac.h"
+#include "esp_timer.h"
+#include "esp_random.h"
 #include "nvs_flash.h"
 #include "nvs.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "freertos/event_groups.h"
+#include "metrics.h"
 
 static const char *TAG = "WIFI_MGR";
 
@@ -28,10 +34,27 @@ static const char *TAG = "WIFI_MGR";
 #define NVS_NAMESPACE "wifi_config"
 #define NVS_KEY_SSID "sta_ssid"
 #define NVS_KEY_PASSWORD "sta_pass"
+#define NVS_KEY_CHANNEL "sta_chan"
+
+// Trust a cached network channel for this long before scanning again
+#define SCAN_CHANNEL_MAX_AGE_MS (10 * 60 * 1000)
 
 // Event group bits
 #define WIFI_CONNECTED_BIT BIT0
 #define WIFI_FAIL_BIT BIT1
+#define WIFI_DISCONNECTED_BIT BIT2
+
+// STA task notification bits (the task waits on nothing else, so bits set
+// while a request runs, e.g. during a channel migration, are kept)
+#define STA_NOTIFY_REQUEST BIT0     // New connect request pending
+#define STA_NOTIFY_CONNECTED BIT1   // Got IP, persist channel and credentials
+
+// Reconnect backoff
+#define RECONNECT_BASE_MS 250
+#define RECONNECT_MAX_MS 30000
+#define RECONNECT_JITTER_PCT 25
+#define DISCONNECT_WAIT_MS 1000
+#define STA_TASK_STACK 4096
 
 // State variables
 static esp_netif_t *ap_netif = NULL;
@@ -43,6 +66,28 @@ static EventGroupHandle_t wifi_event_group;
 static uint8_t connection_retries = 0;
 static const uint8_t max_retries = 5;
 
+// STA connection manager
+static TaskHandle_t sta_task_handle = NULL;
+static esp_timer_handle_t reconnect_timer = NULL;
+static wifi_sta_event_cb_t sta_event_cb = NULL;
+static portMUX_TYPE req_lock = portMUX_INITIALIZER_UNLOCKED;
+static char req_ssid[33];                   // Pending request (req_lock)
+static char req_password[64];
+static bool req_save = false;
+static char sta_ssid[33];                   // Configured network
+static char sta_password[64];
+static bool sta_save_pending = false;       // Save credentials once connected
+static bool sta_auto_reconnect = false;     // Cleared by wifi_disconnect_sta
+static bool sta_was_connected = false;      // Retry forever once the network worked
+static volatile bool sta_reconfiguring = false;
+static uint32_t reconnect_delay_ms = RECONNECT_BASE_MS;
+static uint8_t last_disconnect_reason = 0;
+static int64_t link_down_us = 0;            // Start of the current outage, 0 = link up
+
+static metric_t *m_reconnects = NULL;
+static metric_t *m_downtime_ms = NULL;
+static metric_t *m_radio_off_ms = NULL;
+
 /**
  * Save WiFi credentials to NVS
  */
@@ -98,6 +143,124 @@ static esp_err_t load_wifi_credentials(char *ssid, size_t ssid_len, char *passwo
     return ret;
 }
 
+/**
+ * Remember the channel of the connected network as hint for the next connect
+ */
+static void save_sta_channel(uint8_t channel)
+{
+    nvs_handle_t nvs_handle;
+    uint8_t saved = 0;
+    if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle) != ESP_OK) {
+        return;
+    }
+    if (nvs_get_u8(nvs_handle, NVS_KEY_CHANNEL, &saved) != ESP_OK || saved != channel) {
+        nvs_set_u8(nvs_handle, NVS_KEY_CHANNEL, channel);
+        nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+}
+
+/**
+ * Read the channel hint saved by the last successful connect
+ */
+static uint8_t load_sta_channel(void)
+{
+    nvs_handle_t nvs_handle;
+    uint8_t channel = 0;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle) == ESP_OK) {
+        nvs_get_u8(nvs_handle, NVS_KEY_CHANNEL, &channel);
+        nvs_close(nvs_handle);
+    }
+    return (channel >= 1 && channel <= 13) ? channel : 0;
+}
+
+/**
+ * Find the channel of a network: cache, then the saved channel, then all channels
+ */
+static uint8_t find_network_channel(const char *ssid)
+{
+    uint8_t channel = 0;
+    if (wifi_scan_find_channel(ssid, SCAN_CHANNEL_MAX_AGE_MS, &channel)) {
+        ESP_LOGI(TAG, "Target WiFi '%s' cached on channel %d", ssid, channel);
+        return channel;
+    }
+    
+    uint8_t hint = load_sta_channel();
+    uint8_t passes[2] = {hint, 0};
+    for (int i = hint ? 0 : 1; i < 2; i++) {
+        wifi_scan_wait(5000);   // Let a running background scan finish first
+        if (wifi_scan_request(ssid, passes[i]) == ESP_OK && wifi_scan_wait(5000) == ESP_OK &&
+            wifi_scan_find_channel(ssid, SCAN_CHANNEL_MAX_AGE_MS, &channel)) {
+            ESP_LOGI(TAG, "Target WiFi '%s' found on channel %d", ssid, channel);
+            return channel;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Update the STA status and tell the listener
+ */
+static void set_sta_status(wifi_sta_status_t status)
+{
+    if (sta_status == status) {
+        return;
+    }
+    sta_status = status;
+    if (sta_event_cb) {
+        sta_event_cb(status);
+    }
+}
+
+/**
+ * Arm the next reconnect attempt (exponential backoff with jitter)
+ */
+static void schedule_reconnect(void)
+{
+    // Jitter keeps units behind the same AP from retrying in lockstep
+    uint32_t span = 2 * RECONNECT_JITTER_PCT + 1;
+    uint32_t delay_ms = reconnect_delay_ms * (100 - RECONNECT_JITTER_PCT + esp_random() % span) / 100;
+
+    reconnect_delay_ms = reconnect_delay_ms * 2;
+    if (reconnect_delay_ms > RECONNECT_MAX_MS) {
+        reconnect_delay_ms = RECONNECT_MAX_MS;
+    }
+
+    esp_timer_stop(reconnect_timer);
+    esp_timer_start_once(reconnect_timer, (uint64_t)delay_ms * 1000);
+    ESP_LOGI(TAG, "Reconnect in %lu ms (reason %d)", (unsigned long)delay_ms, last_disconnect_reason);
+}
+
+/**
+ * Reconnect timer callback
+ */
+static void reconnect_timer_callback(void *arg)
+{
+    if (!sta_auto_reconnect || sta_reconfiguring) {
+        return;
+    }
+
+    // The AP moved away from the channel hint, let the driver search all channels
+    if (last_disconnect_reason == WIFI_REASON_NO_AP_FOUND) {
+        wifi_config_t wifi_config;
+        if (esp_wifi_get_config(WIFI_IF_STA, &wifi_config) == ESP_OK && wifi_config.sta.channel) {
+            ESP_LOGW(TAG, "'%s' not found on channel %d, searching all channels",
+                     sta_ssid, wifi_config.sta.channel);
+            wifi_config.sta.channel = 0;
+            esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+        }
+    }
+
+    connection_retries++;
+    metrics_inc(m_reconnects);
+    ESP_LOGI(TAG, "Reconnect attempt %d", connection_retries);
+    esp_err_t ret = esp_wifi_connect();
+    if (ret != ESP_OK && ret != ESP_ERR_WIFI_CONN) {
+        ESP_LOGW(TAG, "esp_wifi_connect failed: %s", esp_err_to_name(ret));
+        schedule_reconnect();
+    }
+}
+
 /**
  * WiFi event handler
  */
@@ -121,22 +284,41 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
             }
             
             case WIFI_EVENT_STA_START:
-                ESP_LOGI(TAG, "STA started, attempting connection...");
-                sta_status = WIFI_STATUS_CONNECTING;
-                esp_wifi_connect();
+                // The STA task connects itself after a reconfigure
+                if (sta_auto_reconnect && !sta_reconfiguring) {
+                    ESP_LOGI(TAG, "STA started, attempting connection...");
+                    set_sta_status(WIFI_STATUS_CONNECTING);
+                    esp_wifi_connect();
+                }
                 break;
             
-            case WIFI_EVENT_STA_DISCONNECTED:
-                if (connection_retries < max_retries) {
-                    esp_wifi_connect();
-                    connection_retries++;
-                    ESP_LOGI(TAG, "Retry connection %d/%d", connection_retries, max_retries);
+            case WIFI_EVENT_STA_DISCONNECTED: {
+                wifi_event_sta_disconnected_t* event = (wifi_event_sta_disconnected_t*) event_data;
+                last_disconnect_reason = event->reason;
+                if (!link_down_us) {
+                    link_down_us = esp_timer_get_time();
+                }
+                xEventGroupClearBits(wifi_event_group, WIFI_CONNECTED_BIT);
+                xEventGroupSetBits(wifi_event_group, WIFI_DISCONNECTED_BIT);
+                
+                if (sta_reconfiguring || !sta_auto_reconnect) {
+                    break;
+                }
+                
+                if (sta_was_connected || connection_retries < max_retries) {
+                    if (sta_status == WIFI_STATUS_CONNECTED) {
+                        ESP_LOGW(TAG, "Lost connection to %s (reason %d)", sta_ssid, event->reason);
+                    }
+                    set_sta_status(WIFI_STATUS_CONNECTING);
+                    schedule_reconnect();
                 } else {
+                    sta_auto_reconnect = false;
                     xEventGroupSetBits(wifi_event_group, WIFI_FAIL_BIT);
-                    sta_status = WIFI_STATUS_FAILED;
+                    set_sta_status(WIFI_STATUS_FAILED);
                     ESP_LOGW(TAG, "Connection failed after %d retries", max_retries);
                 }
                 break;
+            }
                 
             default:
                 break;
@@ -145,11 +327,204 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
         if (event_id == IP_EVENT_STA_GOT_IP) {
             ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
             ESP_LOGI(TAG, "STA got IP: " IPSTR, IP2STR(&event->ip_info.ip));
+            if (link_down_us) {
+                int32_t downtime_ms = (int32_t)((esp_timer_get_time() - link_down_us) / 1000);
+                metrics_set(m_downtime_ms, downtime_ms);
+                ESP_LOGI(TAG, "STA link down for %ld ms", (long)downtime_ms);
+                link_down_us = 0;
+            }
             connection_retries = 0;
-            sta_status = WIFI_STATUS_CONNECTED;
+            reconnect_delay_ms = RECONNECT_BASE_MS;
+            sta_was_connected = true;
+            set_sta_status(WIFI_STATUS_CONNECTED);
             xEventGroupSetBits(wifi_event_group, WIFI_CONNECTED_BIT);
+            xTaskNotify(sta_task_handle, STA_NOTIFY_CONNECTED, eSetBits);
+        }
+    }
+}
+
+/**
+ * Apply a connect request without restarting the radio if the driver allows it
+ */
+static void sta_apply_request(void)
+{
+    char ssid[33];
+    char password[64];
+    bool save;
+    portENTER_CRITICAL(&req_lock);
+    memcpy(ssid, req_ssid, sizeof(ssid));
+    memcpy(password, req_password, sizeof(password));
+    save = req_save;
+    portEXIT_CRITICAL(&req_lock);
+    
+    ESP_LOGI(TAG, "Connecting to WiFi: %s", ssid);
+    sta_reconfiguring = true;
+    esp_timer_stop(reconnect_timer);
+    
+    // Find the target network's channel (cached or targeted scan)
+    uint8_t target_channel = find_network_channel(ssid);
+    
+    // Leave the current network (or attempt) first: the driver refuses new
+    // STA config while it is connecting, and the channel can't be changed
+    // for the migration below while the STA is associated
+    wifi_ap_record_t ap_info;
+    if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK || sta_status == WIFI_STATUS_CONNECTING) {
+        xEventGroupClearBits(wifi_event_group, WIFI_DISCONNECTED_BIT);
+        if (esp_wifi_disconnect() == ESP_OK) {
+            xEventGroupWaitBits(wifi_event_group, WIFI_DISCONNECTED_BIT, pdFALSE, pdFALSE,
+                                pdMS_TO_TICKS(DISCONNECT_WAIT_MS));
+        }
+    }
+    
+    // If target channel found and different from current, broadcast channel change
+    if (target_channel > 0) {
+        uint8_t current_channel;
+        wifi_second_chan_t second;
+        esp_wifi_get_channel(&current_channel, &second);
+        
+        if (current_channel != target_channel) {
+            ESP_LOGI(TAG, "Channel change required: %d -> %d", current_channel, target_channel);
+            ESP_LOGI(TAG, "Broadcasting channel change to all ESP-NOW peers...");
+            
+            // Broadcast channel change via ESP-NOW (needs to be called from main.c)
+            // For now, we'll add a callback mechanism
+            extern esp_err_t notify_channel_change(uint8_t new_channel);
+            notify_channel_change(target_channel);
+        }
+    }
+    
+    // Configure WiFi STA, the channel hint makes the connect scan a single channel
+    wifi_config_t wifi_config = {0};
+    strlcpy((char*)wifi_config.sta.ssid, ssid, sizeof(wifi_config.sta.ssid));
+    strlcpy((char*)wifi_config.sta.password, password, sizeof(wifi_config.sta.password));
+    wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
+    wifi_config.sta.channel = target_channel;
+    
+    // Set WiFi mode based on current state
+    wifi_mode_t mode = (current_mode == WIFI_MANAGER_MODE_AP) ? WIFI_MODE_APSTA : WIFI_MODE_STA;
+    wifi_mode_t running_mode = WIFI_MODE_NULL;
+    esp_wifi_get_mode(&running_mode);
+    
+    esp_err_t ret = ESP_ERR_WIFI_NOT_STARTED;
+    if (is_initialized) {
+        ret = (running_mode == mode) ? ESP_OK : esp_wifi_set_mode(mode);
+        if (ret == ESP_OK) {
+            ret = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
         }
     }
+    
+    if (ret != ESP_OK) {
+        // Full restart, ESP-NOW is deaf until the radio is back
+        ESP_LOGI(TAG, "%s WiFi to reconfigure (%s)...", is_initialized ? "Restarting" : "Starting",
+                 esp_err_to_name(ret));
+        int64_t off_us = esp_timer_get_time();
+        if (is_initialized) {
+            esp_wifi_stop();
+        }
+        ret = esp_wifi_set_mode(mode);
+        if (ret == ESP_OK) {
+            ret = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+        }
+        if (ret == ESP_OK) {
+            ret = esp_wifi_start();
+        }
+        is_initialized = (ret == ESP_OK);
+        metrics_set(m_radio_off_ms, (int32_t)((esp_timer_get_time() - off_us) / 1000));
+    }
+    
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure STA: %s", esp_err_to_name(ret));
+        sta_reconfiguring = false;
+        sta_auto_reconnect = false;
+        xEventGroupSetBits(wifi_event_group, WIFI_FAIL_BIT);
+        set_sta_status(WIFI_STATUS_FAILED);
+        return;
+    }
+    
+    current_mode = (mode == WIFI_MODE_APSTA) ? WIFI_MANAGER_MODE_APSTA : WIFI_MANAGER_MODE_STA;
+    strlcpy(sta_ssid, ssid, sizeof(sta_ssid));
+    strlcpy(sta_password, password, sizeof(sta_password));
+    sta_save_pending = save;
+    
+    // Reset connection state
+    connection_retries = 0;
+    reconnect_delay_ms = RECONNECT_BASE_MS;
+    sta_was_connected = false;
+    sta_auto_reconnect = true;
+    sta_reconfiguring = false;
+    set_sta_status(WIFI_STATUS_CONNECTING);
+    
+    esp_err_t connect_ret = esp_wifi_connect();
+    if (connect_ret != ESP_OK && connect_ret != ESP_ERR_WIFI_CONN) {
+        ESP_LOGW(TAG, "esp_wifi_connect failed: %s", esp_err_to_name(connect_ret));
+        schedule_reconnect();
+    }
+}
+
+/**
+ * Persist what worked once the STA has an IP
+ */
+static void sta_handle_connected(void)
+{
+    wifi_ap_record_t connected_ap;
+    if (esp_wifi_sta_get_ap_info(&connected_ap) == ESP_OK) {
+        ESP_LOGI(TAG, "Connected to WiFi: %s (channel %d)", sta_ssid, connected_ap.primary);
+        save_sta_channel(connected_ap.primary);
+    }
+    
+    if (sta_save_pending) {
+        sta_save_pending = false;
+        save_wifi_credentials(sta_ssid, sta_password);
+    }
+}
+
+/**
+ * STA task - runs connect requests and NVS writes outside the event loop
+ */
+static void sta_task(void *pvParameters)
+{
+    while (1) {
+        uint32_t events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, portMAX_DELAY);
+        
+        if (events & STA_NOTIFY_REQUEST) {
+            sta_apply_request();
+        }
+        if (events & STA_NOTIFY_CONNECTED) {
+            sta_handle_connected();
+        }
+    }
+}
+
+/**
+ * Start the STA connection manager (once)
+ */
+static esp_err_t sta_manager_init(void)
+{
+    if (sta_task_handle) {
+        return ESP_OK;
+    }
+    
+    const esp_timer_create_args_t timer_args = {
+        .callback = &reconnect_timer_callback,
+        .name = "wifi_reconnect"
+    };
+    esp_err_t ret = esp_timer_create(&timer_args, &reconnect_timer);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    m_reconnects = metrics_register_counter("laser_wifi_sta_reconnects_total",
+                                            "STA reconnect attempts", NULL);
+    m_downtime_ms = metrics_register_gauge("laser_wifi_sta_downtime_ms",
+                                           "Duration of the last STA outage", NULL);
+    m_radio_off_ms = metrics_register_gauge("laser_wifi_radio_off_ms",
+                                            "Radio off time of the last WiFi restart", NULL);
+    
+    if (xTaskCreate(sta_task, "wifi_sta", STA_TASK_STACK, NULL, 5, &sta_task_handle) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
 }
 
 /**
@@ -205,6 +580,8 @@ esp_err_t wifi_apsta_init(void)
                                                             &wifi_event_handler,
                                                             NULL,
                                                             NULL));
+        ESP_ERROR_CHECK(wifi_scan_service_init());
+        ESP_ERROR_CHECK(sta_manager_init());
     }
 
     // Set WiFi mode to APSTA
@@ -271,6 +648,8 @@ esp_err_t wifi_ap_init(const laser_ap_config_t *config)
                                                             &wifi_event_handler,
                                                             NULL,
                                                             NULL));
+        ESP_ERROR_CHECK(wifi_scan_service_init());
+        ESP_ERROR_CHECK(sta_manager_init());
     }
 
     // Configure WiFi AP
@@ -327,7 +706,7 @@ esp_err_t wifi_ap_init(const laser_ap_config_t *config)
 }
 
 /**
- * Scan for available WiFi networks
+ * Scan for available WiFi networks (blocking full scan)
  */
 esp_err_t wifi_scan_networks(wifi_scan_result_t *results, size_t max_results, size_t *num_found)
 {
@@ -337,187 +716,84 @@ esp_err_t wifi_scan_networks(wifi_scan_result_t *results, size_t max_results, si
     
     ESP_LOGI(TAG, "Starting WiFi scan...");
     
-    wifi_scan_config_t scan_config = {
-        .ssid = NULL,
-        .bssid = NULL,
-        .channel = 0,
-        .show_hidden = false,
-        .scan_type = WIFI_SCAN_TYPE_ACTIVE,
-        .scan_time = {
-            .active = {
-                .min = 100,
-                .max = 300
-            }
-        }
-    };
-    
-    esp_err_t ret = esp_wifi_scan_start(&scan_config, true);
-    if (ret != ESP_OK) {
+    // A scan that is already running refreshes the cache just as well
+    esp_err_t ret = wifi_scan_request(NULL, 0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
         ESP_LOGE(TAG, "Scan start failed: %s", esp_err_to_name(ret));
         return ret;
     }
     
-    uint16_t ap_count = 0;
-    esp_wifi_scan_get_ap_num(&ap_count);
-    
-    if (ap_count == 0) {
-        *num_found = 0;
-        return ESP_OK;
-    }
-    
-    wifi_ap_record_t *ap_info = calloc(ap_count, sizeof(wifi_ap_record_t));
-    if (!ap_info) {
-        return ESP_ERR_NO_MEM;
-    }
-    
-    ret = esp_wifi_scan_get_ap_records(&ap_count, ap_info);
+    ret = wifi_scan_wait(10000);
     if (ret != ESP_OK) {
-        free(ap_info);
         return ret;
     }
     
-    size_t count = ap_count < max_results ? ap_count : max_results;
-    for (size_t i = 0; i < count; i++) {
-        strncpy(results[i].ssid, (char*)ap_info[i].ssid, 32);
-        results[i].ssid[32] = '\0';
-        results[i].rssi = ap_info[i].rssi;
-        results[i].authmode = ap_info[i].authmode;
-        results[i].channel = ap_info[i].primary;
-    }
-    
-    *num_found = count;
-    free(ap_info);
-    
-    ESP_LOGI(TAG, "Scan complete, found %d networks", count);
+    wifi_scan_get_cached(results, max_results, num_found);
+    ESP_LOGI(TAG, "Scan complete, found %d networks", *num_found);
     return ESP_OK;
 }
 
 /**
- * Connect to WiFi network as Station
+ * Start connecting to a WiFi network as Station (returns immediately)
  */
-esp_err_t wifi_connect_sta(const char *ssid, const char *password, bool save_to_nvs)
+esp_err_t wifi_connect_sta_async(const char *ssid, const char *password, bool save_to_nvs)
 {
-    if (!ssid) {
+    if (!ssid || !ssid[0]) {
         return ESP_ERR_INVALID_ARG;
     }
-    
-    ESP_LOGI(TAG, "Connecting to WiFi: %s", ssid);
-    
-    // First, scan to find the target network's channel
-    uint8_t target_channel = 0;
-    wifi_scan_result_t scan_results[20];
-    size_t num_found = 0;
-    
-    esp_err_t scan_ret = wifi_scan_networks(scan_results, 20, &num_found);
-    if (scan_ret == ESP_OK) {
-        for (size_t i = 0; i < num_found; i++) {
-            if (strcmp(scan_results[i].ssid, ssid) == 0) {
-                target_channel = scan_results[i].channel;
-                ESP_LOGI(TAG, "Target WiFi '%s' found on channel %d", ssid, target_channel);
-                break;
-            }
-        }
+    if (!sta_task_handle) {
+        return ESP_ERR_INVALID_STATE;
     }
     
-    // If target channel found and different from current, broadcast channel change
-    if (target_channel > 0) {
-        uint8_t current_channel;
-        wifi_second_chan_t second;
-        esp_wifi_get_channel(&current_channel, &second);
-        
-        if (current_channel != target_channel) {
-            ESP_LOGI(TAG, "Channel change required: %d -> %d", current_channel, target_channel);
-            ESP_LOGI(TAG, "Broadcasting channel change to all ESP-NOW peers...");
-            
-            // Broadcast channel change via ESP-NOW (needs to be called from main.c)
-            // For now, we'll add a callback mechanism
-            extern esp_err_t notify_channel_change(uint8_t new_channel);
-            notify_channel_change(target_channel);
-        }
-    }
+    // A newer request replaces one the task has not picked up yet
+    portENTER_CRITICAL(&req_lock);
+    strlcpy(req_ssid, ssid, sizeof(req_ssid));
+    strlcpy(req_password, password ? password : "", sizeof(req_password));
+    req_save = save_to_nvs;
+    portEXIT_CRITICAL(&req_lock);
     
-    // Create STA netif only if it doesn't exist
-    // In APSTA mode, this should already be created in main.c
-    if (!sta_netif) {
-        sta_netif = esp_netif_create_default_wifi_sta();
-        if (!sta_netif) {
-            ESP_LOGE(TAG, "Failed to create STA netif");
-            return ESP_FAIL;
-        }
-        ESP_LOGI(TAG, "Created STA netif");
-    } else {
-        ESP_LOGI(TAG, "STA netif already exists, reusing");
-    }
-    
-    // Configure WiFi STA
-    wifi_config_t wifi_config = {0};
-    strncpy((char*)wifi_config.sta.ssid, ssid, sizeof(wifi_config.sta.ssid) - 1);
-    if (password) {
-        strncpy((char*)wifi_config.sta.password, password, sizeof(wifi_config.sta.password) - 1);
-    }
-    wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
-    
-    // IDF 5.5.2 FIX: Must stop WiFi before changing config in started state
-    bool was_started = is_initialized;
-    if (was_started) {
-        ESP_LOGI(TAG, "Stopping WiFi to reconfigure...");
-        ESP_ERROR_CHECK(esp_wifi_stop());
-    }
-    
-    // Set WiFi mode based on current state
-    wifi_mode_t mode = (current_mode == WIFI_MANAGER_MODE_AP) ? WIFI_MODE_APSTA : WIFI_MODE_STA;
-    ESP_ERROR_CHECK(esp_wifi_set_mode(mode));
-    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
-    
-    // Reset connection state
-    connection_retries = 0;
-    sta_status = WIFI_STATUS_CONNECTING;
     xEventGroupClearBits(wifi_event_group, WIFI_CONNECTED_BIT | WIFI_FAIL_BIT);
-    
-    // Start WiFi (whether first time or restart)
-    ESP_LOGI(TAG, "%s WiFi...", was_started ? "Restarting" : "Starting");
-    ESP_ERROR_CHECK(esp_wifi_start());
-    is_initialized = true;
-    
-    // Connect to AP
-    wifi_ap_record_t ap_info;
-    esp_err_t check = esp_wifi_sta_get_ap_info(&ap_info);
-    
-    if (check == ESP_OK) {
-        // Already connected, disconnect first
-        ESP_LOGI(TAG, "Disconnecting from current AP: %s", ap_info.ssid);
-        esp_wifi_disconnect();
-        vTaskDelay(pdMS_TO_TICKS(100)); // Give time to disconnect
-    }
-    
-    // Connect to new/configured AP
-    esp_err_t connect_ret = esp_wifi_connect();
-    if (connect_ret != ESP_OK && connect_ret != ESP_ERR_WIFI_CONN) {
-        ESP_LOGW(TAG, "esp_wifi_connect failed: %s", esp_err_to_name(connect_ret));
+    set_sta_status(WIFI_STATUS_CONNECTING);
+    xTaskNotify(sta_task_handle, STA_NOTIFY_REQUEST, eSetBits);
+    return ESP_OK;
+}
+
+/**
+ * Wait until the STA is connected or gave up
+ */
+esp_err_t wifi_wait_sta(uint32_t timeout_ms)
+{
+    if (!wifi_event_group) {
+        return ESP_ERR_INVALID_STATE;
     }
     
-    // Wait for connection
     EventBits_t bits = xEventGroupWaitBits(wifi_event_group,
                                            WIFI_CONNECTED_BIT | WIFI_FAIL_BIT,
                                            pdFALSE,
                                            pdFALSE,
-                                           pdMS_TO_TICKS(10000));
-    
-    esp_err_t ret;
+                                           pdMS_TO_TICKS(timeout_ms));
     if (bits & WIFI_CONNECTED_BIT) {
-        ESP_LOGI(TAG, "Connected to WiFi: %s", ssid);
-        current_mode = (mode == WIFI_MODE_APSTA) ? WIFI_MANAGER_MODE_APSTA : WIFI_MANAGER_MODE_STA;
-        
-        if (save_to_nvs) {
-            save_wifi_credentials(ssid, password ? password : "");
-        }
-        ret = ESP_OK;
-    } else {
-        ESP_LOGW(TAG, "Failed to connect to WiFi: %s", ssid);
-        ret = ESP_FAIL;
+        return ESP_OK;
+    }
+    return (bits & WIFI_FAIL_BIT) ? ESP_FAIL : ESP_ERR_TIMEOUT;
+}
+
+/**
+ * Connect to WiFi network as Station (blocking)
+ */
+esp_err_t wifi_connect_sta(const char *ssid, const char *password, bool save_to_nvs)
+{
+    esp_err_t ret = wifi_connect_sta_async(ssid, password, save_to_nvs);
+    if (ret != ESP_OK) {
+        return ret;
     }
     
-    return ret;
+    ret = wifi_wait_sta(10000);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to connect to WiFi: %s", ssid);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
 }
 
 /**
@@ -526,7 +802,11 @@ esp_err_t wifi_connect_sta(const char *ssid, const char *password, bool save_to_
 esp_err_t wifi_disconnect_sta(void)
 {
     ESP_LOGI(TAG, "Disconnecting from WiFi station");
-    sta_status = WIFI_STATUS_DISCONNECTED;
+    sta_auto_reconnect = false;
+    if (reconnect_timer) {
+        esp_timer_stop(reconnect_timer);
+    }
+    set_sta_status(WIFI_STATUS_DISCONNECTED);
     
     esp_err_t ret = esp_wifi_disconnect();
     if (ret != ESP_OK) {
@@ -544,6 +824,22 @@ wifi_sta_status_t wifi_get_sta_status(void)
     return sta_status;
 }
 
+/**
+ * Get the SSID the station is configured for
+ */
+const char *wifi_get_sta_ssid(void)
+{
+    return sta_ssid;
+}
+
+/**
+ * Register the STA status listener
+ */
+void wifi_set_sta_callback(wifi_sta_event_cb_t callback)
+{
+    sta_event_cb = callback;
+}
+
 /**
  * Get station IP info
  */
@@ -600,7 +896,10 @@ esp_err_t wifi_connect_with_fallback(const laser_ap_config_t *ap_config, uint32_
         ESP_LOGI(TAG, "Found saved WiFi credentials for: %s", saved_ssid);
         
         // Try to connect to saved network
-        ret = wifi_connect_sta(saved_ssid, saved_password, false);
+        ret = wifi_connect_sta_async(saved_ssid, saved_password, false);
+        if (ret == ESP_OK) {
+            ret = wifi_wait_sta(timeout_ms);
+        }
         
         if (ret == ESP_OK) {
             ESP_LOGI(TAG, "Successfully connected to saved WiFi");
@@ -677,7 +976,11 @@ esp_err_t wifi_ap_deinit(void)
     }
     
     is_initialized = false;
-    sta_status = WIFI_STATUS_DISCONNECTED;
+    sta_auto_reconnect = false;
+    if (reconnect_timer) {
+        esp_timer_stop(reconnect_timer);
+    }
+    set_sta_status(WIFI_STATUS_DISCONNECTED);
     
     return ESP_OK;
 }
@@ -0,0 +1,319 @@
+/**
+ * WiFi Scan Service - Implementation
+ *
+ * Scans are started with esp_wifi_scan_start(block = false) and
+ * collected in the WIFI_EVENT_SCAN_DONE handler. Dwell times are kept
+ * short and the radio returns to the home channel between scanned
+ * channels, so ESP-NOW traffic sees short gaps instead of one long one.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "wifi_scan.h"
+#include "esp_wifi.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "metrics.h"
+
+static const char *TAG = "WIFI_SCAN";
+
+#define SCAN_IDLE_BIT           BIT0
+#define SCAN_ACTIVE_MAX_MS      120     // Per channel, beacons come every ~100 ms
+#define SCAN_HOME_DWELL_MS      60      // Time back on the home channel between channels
+#define SCAN_STALE_MS           15000   // A scan aborted by esp_wifi_stop never reports done
+
+/**
+ * Cached network
+ */
+typedef struct {
+    wifi_scan_result_t net;
+    int64_t seen_us;
+} scan_entry_t;
+
+static scan_entry_t cache[WIFI_SCAN_CACHE_SIZE];
+static size_t cache_count = 0;
+static int64_t last_full_scan_us = 0;       // 0 = never
+static SemaphoreHandle_t cache_mutex = NULL;
+static EventGroupHandle_t scan_events = NULL;
+
+// Running scan (only touched by the requester before start and the event handler after)
+static bool scan_running = false;
+static char scan_ssid[33];
+static uint8_t scan_channel = 0;
+static int64_t scan_start_us = 0;
+
+static metric_t *m_scans = NULL;
+static metric_t *m_scan_ms = NULL;
+
+/**
+ * Find a cached network by SSID and channel (cache_mutex held)
+ */
+static int find_entry(const char *ssid, uint8_t channel)
+{
+    for (size_t i = 0; i < cache_count; i++) {
+        if (cache[i].net.channel == channel && strcmp(cache[i].net.ssid, ssid) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Remove cached entries of an SSID on the scanned channels (cache_mutex held)
+ */
+static void drop_ssid(const char *ssid, uint8_t channel)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < cache_count; i++) {
+        bool scanned = (channel == 0 || cache[i].net.channel == channel);
+        if (scanned && strcmp(cache[i].net.ssid, ssid) == 0) {
+            continue;
+        }
+        cache[kept++] = cache[i];
+    }
+    cache_count = kept;
+}
+
+/**
+ * Add or refresh a network (cache_mutex held)
+ * A full cache gives up its oldest entry.
+ */
+static void put_entry(const wifi_ap_record_t *ap, int64_t now)
+{
+    int idx = find_entry((const char *)ap->ssid, ap->primary);
+    if (idx < 0) {
+        if (cache_count < WIFI_SCAN_CACHE_SIZE) {
+            idx = cache_count++;
+        } else {
+            idx = 0;
+            for (size_t i = 1; i < cache_count; i++) {
+                if (cache[i].seen_us < cache[idx].seen_us) {
+                    idx = i;
+                }
+            }
+        }
+    }
+
+    scan_entry_t *e = &cache[idx];
+    strlcpy(e->net.ssid, (const char *)ap->ssid, sizeof(e->net.ssid));
+    e->net.rssi = ap->rssi;
+    e->net.authmode = ap->authmode;
+    e->net.channel = ap->primary;
+    e->seen_us = now;
+}
+
+/**
+ * Sort the cache by signal strength (cache_mutex held)
+ */
+static void sort_cache(void)
+{
+    for (size_t i = 1; i < cache_count; i++) {
+        scan_entry_t e = cache[i];
+        size_t j = i;
+        while (j > 0 && cache[j - 1].net.rssi < e.net.rssi) {
+            cache[j] = cache[j - 1];
+            j--;
+        }
+        cache[j] = e;
+    }
+}
+
+/**
+ * Scan done event - move the results into the cache
+ */
+static void scan_done_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
+{
+    if (!scan_running) {
+        return;     // Scan started by someone else
+    }
+
+    uint16_t ap_count = 0;
+    esp_wifi_scan_get_ap_num(&ap_count);
+    wifi_ap_record_t *records = ap_count ? calloc(ap_count, sizeof(wifi_ap_record_t)) : NULL;
+    if (records && esp_wifi_scan_get_ap_records(&ap_count, records) != ESP_OK) {
+        ap_count = 0;
+    }
+    if (!records) {
+        ap_count = 0;
+        esp_wifi_clear_ap_list();   // Free the driver's copy
+    }
+
+    int64_t now = esp_timer_get_time();
+    bool full = (scan_ssid[0] == '\0' && scan_channel == 0);
+
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    if (full) {
+        cache_count = 0;
+        last_full_scan_us = now;
+    } else if (scan_ssid[0]) {
+        drop_ssid(scan_ssid, scan_channel);
+    }
+    for (uint16_t i = 0; i < ap_count; i++) {
+        if (records[i].ssid[0]) {
+            put_entry(&records[i], now);
+        }
+    }
+    sort_cache();
+    xSemaphoreGive(cache_mutex);
+    free(records);
+
+    int32_t elapsed_ms = (int32_t)((now - scan_start_us) / 1000);
+    metrics_inc(m_scans);
+    metrics_set(m_scan_ms, elapsed_ms);
+    ESP_LOGI(TAG, "Scan done in %ld ms: %u networks%s%s", (long)elapsed_ms, ap_count,
+             scan_ssid[0] ? " for " : "", scan_ssid);
+
+    scan_running = false;
+    xEventGroupSetBits(scan_events, SCAN_IDLE_BIT);
+}
+
+/**
+ * Initialize the scan service
+ */
+esp_err_t wifi_scan_service_init(void)
+{
+    if (cache_mutex) {
+        return ESP_OK;
+    }
+
+    cache_mutex = xSemaphoreCreateMutex();
+    scan_events = xEventGroupCreate();
+    if (!cache_mutex || !scan_events) {
+        return ESP_ERR_NO_MEM;
+    }
+    xEventGroupSetBits(scan_events, SCAN_IDLE_BIT);
+
+    m_scans = metrics_register_counter("laser_wifi_scans_total", "WiFi scans completed", NULL);
+    m_scan_ms = metrics_register_gauge("laser_wifi_scan_ms", "Duration of the last WiFi scan", NULL);
+
+    return esp_event_handler_instance_register(WIFI_EVENT, WIFI_EVENT_SCAN_DONE,
+                                               &scan_done_handler, NULL, NULL);
+}
+
+/**
+ * Start a background scan
+ */
+esp_err_t wifi_scan_request(const char *ssid, uint8_t channel)
+{
+    if (!scan_events) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Claim the scanner; the bit is set again by the done handler
+    if (!(xEventGroupClearBits(scan_events, SCAN_IDLE_BIT) & SCAN_IDLE_BIT)) {
+        if (esp_timer_get_time() - scan_start_us < SCAN_STALE_MS * 1000LL) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        ESP_LOGW(TAG, "Previous scan never finished, starting over");
+        scan_running = false;
+    }
+
+    strlcpy(scan_ssid, ssid ? ssid : "", sizeof(scan_ssid));
+    scan_channel = channel;
+    scan_start_us = esp_timer_get_time();
+    scan_running = true;
+
+    wifi_scan_config_t scan_config = {
+        .ssid = scan_ssid[0] ? (uint8_t *)scan_ssid : NULL,
+        .bssid = NULL,
+        .channel = channel,
+        .show_hidden = false,
+        .scan_type = WIFI_SCAN_TYPE_ACTIVE,
+        .scan_time = {
+            .active = {
+                .min = 0,
+                .max = SCAN_ACTIVE_MAX_MS
+            }
+        },
+        .home_chan_dwell_time = SCAN_HOME_DWELL_MS,
+    };
+
+    esp_err_t ret = esp_wifi_scan_start(&scan_config, false);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Scan start failed: %s", esp_err_to_name(ret));
+        scan_running = false;
+        xEventGroupSetBits(scan_events, SCAN_IDLE_BIT);
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Scanning %s on %s", scan_ssid[0] ? scan_ssid : "all networks",
+             channel ? "one channel" : "all channels");
+    return ESP_OK;
+}
+
+/**
+ * Wait for the running scan to finish
+ */
+esp_err_t wifi_scan_wait(uint32_t timeout_ms)
+{
+    if (!scan_events) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    EventBits_t bits = xEventGroupWaitBits(scan_events, SCAN_IDLE_BIT, pdFALSE, pdFALSE,
+                                           pdMS_TO_TICKS(timeout_ms));
+    return (bits & SCAN_IDLE_BIT) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+/**
+ * Check if a scan is running
+ */
+bool wifi_scan_in_progress(void)
+{
+    return scan_events && !(xEventGroupGetBits(scan_events) & SCAN_IDLE_BIT);
+}
+
+/**
+ * Copy the cached networks (strongest first)
+ */
+uint32_t wifi_scan_get_cached(wifi_scan_result_t *results, size_t max_results, size_t *num_found)
+{
+    *num_found = 0;
+    if (!cache_mutex) {
+        return UINT32_MAX;
+    }
+
+    int64_t now = esp_timer_get_time();
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    size_t count = cache_count < max_results ? cache_count : max_results;
+    for (size_t i = 0; i < count; i++) {
+        results[i] = cache[i].net;
+        results[i].age_ms = (uint32_t)((now - cache[i].seen_us) / 1000);
+    }
+    int64_t full_scan_us = last_full_scan_us;
+    xSemaphoreGive(cache_mutex);
+
+    *num_found = count;
+    return full_scan_us ? (uint32_t)((now - full_scan_us) / 1000) : UINT32_MAX;
+}
+
+/**
+ * Look up the channel of a network in the cache
+ */
+bool wifi_scan_find_channel(const char *ssid, uint32_t max_age_ms, uint8_t *channel)
+{
+    if (!cache_mutex || !ssid) {
+        return false;
+    }
+
+    int64_t oldest_us = esp_timer_get_time() - (int64_t)max_age_ms * 1000;
+    bool found = false;
+
+    // Sorted by RSSI, so the first match is the strongest
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    for (size_t i = 0; i < cache_count; i++) {
+        if (cache[i].seen_us >= oldest_us && strcmp(cache[i].net.ssid, ssid) == 0) {
+            *channel = cache[i].net.channel;
+            found = true;
+            break;
+        }
+    }
+    xSemaphoreGive(cache_mutex);
+    return found;
+}
@@ -34,6 +34,7 @@ void init_logging(void)
     esp_log_level_set("SD_CARD_MANAGER", ESP_LOG_INFO);  // SD card manager
     esp_log_level_set("SOUND_MGR", ESP_LOG_INFO);        // Sound manager
     esp_log_level_set("AUDIO_OUT", ESP_LOG_INFO);        // Audio output manager
+    esp_log_level_set("METRICS", ESP_LOG_INFO);          // Metrics registry
 
     esp_log_level_set("MODULE_CTRL", ESP_LOG_INFO);    // Control module
     esp_log_level_set("MODULE_LASER", ESP_LOG_INFO);    // Laser module
@@ -54,13 +54,13 @@ esp_err_t notify_channel_change(uint8_t new_channel)
     // Only control module needs to notify peers
     ESP_LOGI(TAG, "Notifying all ESP-NOW peers about channel change to %d", new_channel);
     
-    // Broadcast channel change via ESP-NOW
-    esp_err_t ret = espnow_broadcast_channel_change(new_channel, 2000); // 2 second timeout
+    // Announce, collect ACKs, switch together and verify
+    esp_err_t ret = espnow_broadcast_channel_change(new_channel, 500); // Switch 500 ms from now
     
     if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "Channel change notification sent successfully");
+        ESP_LOGI(TAG, "All peers moved to channel %d", new_channel);
     } else {
-        ESP_LOGW(TAG, "Failed to send channel change notification: %s", esp_err_to_name(ret));
+        ESP_LOGW(TAG, "Channel change incomplete: %s", esp_err_to_name(ret));
     }
     
     return ret;
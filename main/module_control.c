@@ -16,9 +16,11 @@
 #include "nvs_flash.h"
 #include <dirent.h>
 #include <sys/stat.h>
+#include <stdatomic.h>
 
 // Component includes
 #include "display_manager.h"
+#include "display_layout.h"
 #include "game_logic.h"
 #include "espnow_manager.h"
 #include "wifi_ap_manager.h"
@@ -28,21 +30,46 @@
 #ifdef CONFIG_ENABLE_SOUND_MANAGER
 #include "sound_manager.h"
 #endif
+#include "audio_output.h"
 #include "sd_card_manager.h"
+#include "metrics.h"
+#include "sensor_trace.h"
 
 static const char *TAG = "MODULE_CTRL";
 
+// A finish press older than this is a stale or broken message
+#define FINISH_MAX_AGE_US 2000000
+
 // Display update task
 static TaskHandle_t display_update_task_handle = NULL;
 
+// "No laser units" error, drawn by the display task until error_until_ms
+#define ERROR_SCREEN_MS 5000
+static atomic_uint error_until_ms = 0;              // 0 = no error shown
+static const char *volatile error_hint = NULL;
+
+// Idle screen
+enum { IDLE_TITLE, IDLE_READY, IDLE_UNITS, IDLE_HINT };
+static display_widget_t idle_widgets[] = {
+    [IDLE_TITLE] = { .type = DISPLAY_WIDGET_LABEL, .x = 0, .page = 0, .text = "Laser Parcour" },
+    [IDLE_READY] = { .type = DISPLAY_WIDGET_LABEL, .x = 0, .page = 2, .text = "Ready to Start" },
+    [IDLE_UNITS] = { .type = DISPLAY_WIDGET_COUNTER, .x = 0, .page = 4, .text = "Units: " },
+    [IDLE_HINT]  = { .type = DISPLAY_WIDGET_LABEL, .x = 0, .page = 6, .text = "Start via Web" },
+};
+static display_layout_t idle_layout = DISPLAY_LAYOUT(idle_widgets);
+
+// Penalty screen
+enum { PENALTY_TITLE, PENALTY_TIME, PENALTY_BREAKS };
+static display_widget_t penalty_widgets[] = {
+    [PENALTY_TITLE]  = { .type = DISPLAY_WIDGET_LABEL, .x = 0, .page = 0, .text = "*** PENALTY! ***" },
+    [PENALTY_TIME]   = { .type = DISPLAY_WIDGET_CLOCK, .x = 0, .page = 3, .text = "Time: " },
+    [PENALTY_BREAKS] = { .type = DISPLAY_WIDGET_COUNTER, .x = 0, .page = 5, .text = "Breaks: " },
+};
+static display_layout_t penalty_layout = DISPLAY_LAYOUT(penalty_widgets);
+
 // Heartbeat timer for sending periodic heartbeats to laser units
 static esp_timer_handle_t heartbeat_timer = NULL;
 
-// Last countdown value for buzzer triggering
-static int last_countdown_value = -1;
-
-// Beam break sound played flag
-static bool beam_break_sound_played = false;
 
 #ifdef CONFIG_ENABLE_SD_CARD
 /**
@@ -128,6 +155,74 @@ static void heartbeat_timer_callback(void *arg)
     ESP_LOGD(TAG, "Heartbeat broadcast sent to all units");
 }
 
+/**
+ * WiFi STA status callback - logs connects that finish in the background
+ */
+static void wifi_sta_event_callback(wifi_sta_status_t status)
+{
+    esp_netif_ip_info_t ip_info;
+    if (status == WIFI_STATUS_CONNECTED && wifi_get_sta_ip(&ip_info) == ESP_OK) {
+        ESP_LOGI(TAG, "WiFi STA connected to %s: " IPSTR, wifi_get_sta_ssid(), IP2STR(&ip_info.ip));
+    } else if (status == WIFI_STATUS_FAILED) {
+        ESP_LOGW(TAG, "WiFi STA could not connect to %s", wifi_get_sta_ssid());
+    }
+}
+
+/**
+ * Slow down the pairing beacon while a game runs
+ */
+static void set_game_beacon(bool in_game)
+{
+    if (!in_game) {
+        espnow_beacon_start(CONFIG_ESPNOW_BEACON_INTERVAL_MS);
+    } else if (CONFIG_ESPNOW_BEACON_GAME_INTERVAL_MS > 0) {
+        espnow_beacon_start(CONFIG_ESPNOW_BEACON_GAME_INTERVAL_MS);
+    } else {
+        espnow_beacon_stop();
+    }
+}
+
+/**
+ * Game event callback - posts the matching sounds to the audio event bus
+ */
+static void game_event_callback(game_event_t event, uint32_t value)
+{
+    switch (event) {
+        case GAME_EVENT_STARTED:
+            set_game_beacon(true);
+            audio_post_event(AUDIO_EVENT_GAME_START, false);
+            break;
+        case GAME_EVENT_COUNTDOWN_TICK:
+            if (value > 0) {
+                audio_post_event(AUDIO_EVENT_COUNTDOWN, false);
+            }
+            break;
+        case GAME_EVENT_BEAM_BREAK:
+            audio_post_event(AUDIO_EVENT_BEAM_BREAK, false);
+            break;
+        case GAME_EVENT_FINISHED:
+            set_game_beacon(false);
+            audio_post_event(AUDIO_EVENT_SUCCESS, false);
+            break;
+        case GAME_EVENT_STOPPED:
+            set_game_beacon(false);
+            audio_post_event(AUDIO_EVENT_GAME_STOP, false);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Show the "no laser units" error for ERROR_SCREEN_MS (any task, non-blocking)
+ */
+static void show_no_units_error(const char *hint)
+{
+    error_hint = hint;
+    atomic_store(&error_until_ms, (uint32_t)(esp_timer_get_time() / 1000) + ERROR_SCREEN_MS);
+    audio_post_event(AUDIO_EVENT_ERROR, false);
+}
+
 /**
  * Display update task - Updates the display based on game state
  */
@@ -136,43 +231,64 @@ static void display_update_task(void *pvParameters)
     ESP_LOGD(TAG, "Display update task started");
     
     TickType_t last_wake_time = xTaskGetTickCount();
-    const TickType_t update_interval = pdMS_TO_TICKS(100); // Update every 100ms
+    const TickType_t update_interval = pdMS_TO_TICKS(1000 / CONFIG_DISPLAY_REFRESH_RATE_HZ);
     
     game_state_t last_state = GAME_STATE_IDLE;
     bool complete_screen_shown = false;
     uint32_t last_status_log = 0; // For periodic status logging
     
+    const char *shown_error = NULL;
+    
     while (1) {
         game_state_t state = game_get_state();
         player_data_t player_data;
         
-        // Get laser units info
-        laser_unit_info_t units[MAX_LASER_UNITS];
-        size_t unit_count = 0;
-        game_get_laser_units(units, MAX_LASER_UNITS, &unit_count);
-        
-        // Count online units
-        size_t online_count = 0;
-        for (size_t i = 0; i < unit_count; i++) {
-            if (units[i].is_online) {
-                online_count++;
+        // An error screen stays up until it times out or a game starts
+        unsigned int until = atomic_load(&error_until_ms);
+        if (until && (state == GAME_STATE_IDLE || state == GAME_STATE_COMPLETE) &&
+            (int32_t)(until - (uint32_t)(esp_timer_get_time() / 1000)) > 0) {
+            const char *hint = error_hint;
+            if (hint != shown_error) {
+                display_clear();
+                display_text("ERROR:", 0);
+                display_text("No laser units", 2);
+                display_text("found!", 3);
+                display_text(hint, 5);
+                display_update();
+                shown_error = hint;
+                complete_screen_shown = false;  // Results are drawn again afterwards
             }
+            vTaskDelayUntil(&last_wake_time, update_interval);
+            continue;
+        }
+        if (until) {
+            // Unless a new error was posted meanwhile
+            atomic_compare_exchange_strong(&error_until_ms, &until, 0);
+            shown_error = NULL;
         }
         
         switch (state) {
             case GAME_STATE_IDLE:
                 display_set_screen(SCREEN_IDLE);
-                // Show welcome message with connected units
-                display_clear();
-                display_text("Laser Parcour", 0);
-                display_text("Ready to Start", 2);
-                char units_line[32];
-                snprintf(units_line, sizeof(units_line), "Units: %d", online_count);
-                display_text(units_line, 4);
-                display_text("Start via Web", 6);
-                display_update();
+                {
+                    // Get laser units info
+                    laser_unit_info_t units[MAX_LASER_UNITS];
+                    size_t unit_count = 0;
+                    game_get_laser_units(units, MAX_LASER_UNITS, &unit_count);
+                    
+                    // Count online units
+                    size_t online_count = 0;
+                    for (size_t i = 0; i < unit_count; i++) {
+                        if (units[i].is_online) {
+                            online_count++;
+                        }
+                    }
+                    
+                    // Show welcome message with connected units
+                    display_widget_set_value(&idle_widgets[IDLE_UNITS], online_count);
+                    display_layout_render(&idle_layout);
+                }
                 complete_screen_shown = false;
-                last_countdown_value = -1;  // Reset countdown tracking
                 break;
                 
             case GAME_STATE_COUNTDOWN:
@@ -184,13 +300,6 @@ static void display_update_task(void *pvParameters)
                         countdown_remaining = (player_data.start_time - now) / 1000;
                     }
                     display_countdown(countdown_remaining);
-                    
-                    // Play audio beep on each countdown tick
-                    if (countdown_remaining > 0 && last_countdown_value != countdown_remaining) {
-                        last_countdown_value = countdown_remaining;
-                        sound_manager_play_event(SOUND_EVENT_COUNTDOWN, SOUND_MODE_ONCE);
-                        ESP_LOGD(TAG, "Countdown beep: %lu", (unsigned long)countdown_remaining);
-                    }
                 }
                 break;
                 
@@ -200,28 +309,15 @@ static void display_update_task(void *pvParameters)
                     display_game_status(player_data.elapsed_time, 
                                       player_data.beam_breaks);
                 }
-                beam_break_sound_played = false; // Reset beam break sound flag
                 break;
                 
             case GAME_STATE_PENALTY:
                 display_set_screen(SCREEN_GAME_PAUSED); // Reuse PAUSED screen for PENALTY
-                if (!beam_break_sound_played) {
-                    sound_manager_play_event(SOUND_EVENT_BEAM_BREAK, SOUND_MODE_ONCE);
-                    beam_break_sound_played = true;
-                }
                 if (game_get_player_data(&player_data) == ESP_OK) {
-                    // Clear and show penalty message
-                    display_clear();
-                    display_text("*** PENALTY! ***", 0);
-                    char time_str[32];
-                    uint32_t minutes = player_data.elapsed_time / 60000;
-                    uint32_t seconds = (player_data.elapsed_time % 60000) / 1000;
-                    snprintf(time_str, sizeof(time_str), "Time: %02lu:%02lu", minutes, seconds);
-                    display_text(time_str, 3);
-                    char breaks_str[32];
-                    snprintf(breaks_str, sizeof(breaks_str), "Breaks: %d", player_data.beam_breaks);
-                    display_text(breaks_str, 5);
-                    display_update();
+                    // Show penalty message
+                    display_widget_set_value(&penalty_widgets[PENALTY_TIME], player_data.elapsed_time);
+                    display_widget_set_value(&penalty_widgets[PENALTY_BREAKS], player_data.beam_breaks);
+                    display_layout_render(&penalty_layout);
                 }
                 break;
                 
@@ -236,7 +332,6 @@ static void display_update_task(void *pvParameters)
             case GAME_STATE_COMPLETE:
                 // Only display results once to avoid infinite logging
                 if (!complete_screen_shown) {
-                    sound_manager_play_event(SOUND_EVENT_SUCCESS, SOUND_MODE_ONCE);
                     display_set_screen(SCREEN_GAME_COMPLETE);
                     if (game_get_player_data(&player_data) == ESP_OK) {
                         display_game_results(player_data.elapsed_time,
@@ -300,16 +395,7 @@ static void button_event_callback(uint8_t button_id, button_event_t event)
                         // Check for laser units first
                         if (!game_has_laser_units()) {
                             ESP_LOGW(TAG, "Cannot start game: No laser units connected");
-                            display_clear();
-                            display_text("ERROR:", 0);
-                            display_text("No laser units", 2);
-                            display_text("found!", 3);
-                            display_text("Check units", 5);
-                            display_update();
-                            vTaskDelay(pdMS_TO_TICKS(5000));  // Show for 5 seconds
-                            display_set_screen(SCREEN_IDLE);
-                            display_update();
-                            sound_manager_play_event(SOUND_EVENT_ERROR, SOUND_MODE_ONCE);
+                            show_no_units_error("Check units");
                             return;
                         }
                         
@@ -317,10 +403,9 @@ static void button_event_callback(uint8_t button_id, button_event_t event)
                         ESP_LOGI(TAG, "Starting game...");
                         esp_err_t ret = game_start(GAME_MODE_SINGLE_SPEEDRUN, "Player");
                         if (ret == ESP_OK) {
-                            sound_manager_play_event(SOUND_EVENT_GAME_START, SOUND_MODE_ONCE);
                             ESP_LOGI(TAG, "Game started successfully");
                         } else {
-                            sound_manager_play_event(SOUND_EVENT_ERROR, SOUND_MODE_ONCE);
+                            audio_post_event(AUDIO_EVENT_ERROR, false);
                             ESP_LOGE(TAG, "Failed to start game: %s", esp_err_to_name(ret));
                         }
                     } else if (state == GAME_STATE_RUNNING || state == GAME_STATE_PENALTY) {
@@ -328,10 +413,9 @@ static void button_event_callback(uint8_t button_id, button_event_t event)
                         ESP_LOGI(TAG, "Stopping game...");
                         esp_err_t ret = game_stop();
                         if (ret == ESP_OK) {
-                            sound_manager_play_event(SOUND_EVENT_GAME_STOP, SOUND_MODE_ONCE);
                             ESP_LOGI(TAG, "Game stopped");
                         } else {
-                            sound_manager_play_event(SOUND_EVENT_ERROR, SOUND_MODE_ONCE);
+                            audio_post_event(AUDIO_EVENT_ERROR, false);
                             ESP_LOGE(TAG, "Failed to stop game: %s", esp_err_to_name(ret));
                         }
                     } else if (state == GAME_STATE_PAUSED) {
@@ -341,7 +425,7 @@ static void button_event_callback(uint8_t button_id, button_event_t event)
                         if (ret == ESP_OK) {
                             ESP_LOGI(TAG, "Game resumed");
                         } else {
-                            sound_manager_play_event(SOUND_EVENT_ERROR, SOUND_MODE_ONCE);
+                            audio_post_event(AUDIO_EVENT_ERROR, false);
                             ESP_LOGE(TAG, "Failed to resume game: %s", esp_err_to_name(ret));
                         }
                     }
@@ -356,10 +440,9 @@ static void button_event_callback(uint8_t button_id, button_event_t event)
                         ESP_LOGI(TAG, "Stopping game...");
                         esp_err_t ret = game_stop();
                         if (ret == ESP_OK) {
-                            sound_manager_play_event(SOUND_EVENT_GAME_STOP, SOUND_MODE_ONCE);
                             ESP_LOGI(TAG, "Game stopped and reset");
                         } else {
-                            sound_manager_play_event(SOUND_EVENT_ERROR, SOUND_MODE_ONCE);
+                            audio_post_event(AUDIO_EVENT_ERROR, false);
                             ESP_LOGE(TAG, "Failed to stop game: %s", esp_err_to_name(ret));
                         }
                     }
@@ -380,7 +463,7 @@ static void button_event_callback(uint8_t button_id, button_event_t event)
                             // sound_manager_play_event(SOUND_EVENT_SUCCESS, SOUND_MODE_ONCE);
                             ESP_LOGI(TAG, "Game finished (debug)");
                         } else {
-                            sound_manager_play_event(SOUND_EVENT_ERROR, SOUND_MODE_ONCE);
+                            audio_post_event(AUDIO_EVENT_ERROR, false);
                             ESP_LOGE(TAG, "Failed to finish game: %s", esp_err_to_name(ret));
                         }
                     } else {
@@ -440,26 +523,11 @@ static esp_err_t game_control_callback(const char *command, const char *data)
     
     if (strcmp(command, "start") == 0) {
         ret = game_start(GAME_MODE_SINGLE_SPEEDRUN, "Web Player");
-        if (ret == ESP_OK) {
-            sound_manager_play_event(SOUND_EVENT_GAME_START, SOUND_MODE_ONCE);
-        } else if (ret == ESP_ERR_INVALID_STATE) {
+        if (ret == ESP_ERR_INVALID_STATE) {
             // Show error on display if no laser units
-            display_clear();
-            display_text("ERROR:", 0);
-            display_text("No laser units", 2);
-            display_text("found!", 3);
-            display_text("Check web UI", 5);
-            display_update();
-            vTaskDelay(pdMS_TO_TICKS(5000));  // Show for 5 seconds
-            display_set_screen(SCREEN_IDLE);
-            display_update();
-            // TODO ifguards wenn no sound player
-            sound_manager_play_event(SOUND_EVENT_ERROR, SOUND_MODE_ONCE);
+            show_no_units_error("Check web UI");
         }
     } else if (strcmp(command, "stop") == 0) {
-        #ifdef CONFIG_ENABLE_SOUND_MANAGER
-        sound_manager_play_event(SOUND_EVENT_GAME_STOP, SOUND_MODE_ONCE);
-        #endif
         ret = game_stop();
     } else if (strcmp(command, "pause") == 0) {
         ret = game_pause();
@@ -495,10 +563,19 @@ static void espnow_recv_callback_main(const uint8_t *sender_mac, const espnow_me
             ESP_LOGI(TAG, "Beam broken on module %d!", message->module_id);
             game_beam_broken(message->module_id);
             break;
-        case MSG_FINISH_PRESSED:
-            ESP_LOGI(TAG, "Finish button pressed on module %d - completing game!", message->module_id);
-            game_finish();  // Successful completion via finish button
+        case MSG_FINISH_PRESSED: {
+            // data[0..3] = time since the press when sent (us, LE), 0 from older units
+            uint32_t age_us = message->data[0] | (message->data[1] << 8) |
+                              (message->data[2] << 16) | ((uint32_t)message->data[3] << 24);
+            if (age_us > FINISH_MAX_AGE_US) {
+                ESP_LOGW(TAG, "Implausible finish press age %lu us, using receive time", (unsigned long)age_us);
+                age_us = 0;
+            }
+            ESP_LOGI(TAG, "Finish button pressed on module %d %lu us ago - completing game!",
+                     message->module_id, (unsigned long)age_us);
+            game_finish_at((uint32_t)((esp_timer_get_time() - age_us) / 1000));  // Successful completion via finish button
             break;
+        }
         case MSG_HEARTBEAT:
             // Ensure the laser unit is in the ESP-NOW peer list
             {
@@ -546,7 +623,40 @@ static void espnow_recv_callback_main(const uint8_t *sender_mac, const espnow_me
                 }
             }
             break;
+        case MSG_SENSOR_CAL_RESULT: {
+            // data[0] = status, then u16 LE: threshold, hysteresis, off mean/stddev, on mean/stddev, separation x10
+            const uint8_t *d = message->data;
+            sensor_cal_report_t report = {
+                .status = d[0],
+                .threshold = d[1] | (d[2] << 8),
+                .hysteresis = d[3] | (d[4] << 8),
+                .off_mean = d[5] | (d[6] << 8),
+                .off_stddev = d[7] | (d[8] << 8),
+                .on_mean = d[9] | (d[10] << 8),
+                .on_stddev = d[11] | (d[12] << 8),
+                .separation_x10 = d[13] | (d[14] << 8),
+            };
+            if (report.status == SENSOR_CAL_OK) {
+                ESP_LOGI(TAG, "Module %d calibrated: threshold %d +- %d (off %d, on %d, %d.%d sigma)",
+                         message->module_id, report.threshold, report.hysteresis,
+                         report.off_mean, report.on_mean, report.separation_x10 / 10, report.separation_x10 % 10);
+            } else {
+                ESP_LOGW(TAG, "Module %d calibration failed (status %d, off %d, on %d)",
+                         message->module_id, report.status, report.off_mean, report.on_mean);
+            }
+            game_set_sensor_calibration(message->module_id, &report);
+            break;
+        }
+        case MSG_SENSOR_TRACE: {
+            esp_err_t ret = sensor_trace_receive(message->module_id, message->data);
+            if (ret != ESP_OK) {
+                ESP_LOGD(TAG, "Trace frame from module %d dropped: %s",
+                         message->module_id, esp_err_to_name(ret));
+            }
+            break;
+        }
         case MSG_CHANNEL_ACK:
+            // Counted per peer by espnow_broadcast_channel_change
             ESP_LOGD(TAG, "Channel change ACK from module %d", message->module_id);
             break;
         default:
@@ -604,6 +714,10 @@ void module_control_init(void)
     ESP_LOGI(TAG, "  Buttons disabled in menuconfig");
 #endif
 
+    // Audio event bus (plays game sounds on the I2S output or buzzer)
+    ESP_LOGI(TAG, "  Starting audio event bus");
+    audio_output_init();
+
 #ifdef CONFIG_ENABLE_BUZZER
     // Initialize buzzer (optional, errors are non-fatal)
     ESP_LOGI(TAG, "  Initializing Buzzer (GPIO %d)", CONFIG_BUZZER_PIN);
@@ -611,7 +725,7 @@ void module_control_init(void)
     if (buzz_ret == ESP_OK) {
         ESP_LOGI(TAG, "  Buzzer initialized successfully");
         buzzer_set_volume(50); // 50% volume
-        sound_manager_play_event(SOUND_EVENT_SUCCESS, SOUND_MODE_ONCE); // Startup sound
+        audio_post_event(AUDIO_EVENT_SUCCESS, false); // Startup sound
     } else {
         ESP_LOGW(TAG, "  Buzzer initialization failed (continuing without buzzer)");
     }
@@ -647,7 +761,7 @@ void module_control_init(void)
         esp_err_t sound_ret = sound_manager_init(NULL);  // NULL = use menuconfig settings
         if (sound_ret == ESP_OK) {
             ESP_LOGI(TAG, "  Sound Manager initialized - audio playback enabled");
-            sound_manager_play_event(SOUND_EVENT_STARTUP, SOUND_MODE_ONCE);
+            audio_post_event(AUDIO_EVENT_STARTUP, false);
         } else {
             ESP_LOGW(TAG, "  Sound Manager initialization failed, using buzzer fallback");
         }
@@ -662,6 +776,7 @@ void module_control_init(void)
     // Initialize WiFi (required for ESP-NOW and web server)
     ESP_LOGI(TAG, "  Initializing WiFi in APSTA mode");
     ESP_ERROR_CHECK(wifi_apsta_init());
+    wifi_set_sta_callback(wifi_sta_event_callback);
     ESP_LOGI(TAG, "  WiFi started in APSTA mode with STA and AP netif");
     
     // Initialize WiFi with automatic fallback
@@ -713,6 +828,10 @@ void module_control_init(void)
     ESP_ERROR_CHECK(esp_timer_create(&heartbeat_timer_args, &heartbeat_timer));
     ESP_ERROR_CHECK(esp_timer_start_periodic(heartbeat_timer, 5000000));  // 5 seconds
     
+    // Beacon lets units find this unit's channel with a short passive scan
+    ESP_LOGI(TAG, "  Starting pairing beacon");
+    ESP_ERROR_CHECK(espnow_beacon_start(CONFIG_ESPNOW_BEACON_INTERVAL_MS));
+    
     // Update all peers with current WiFi channel (in case we connected to external WiFi)
     uint8_t actual_channel;
     wifi_second_chan_t second;
@@ -725,12 +844,14 @@ void module_control_init(void)
     // Initialize game logic
     ESP_LOGI(TAG, "  Initializing Game Logic");
     ESP_ERROR_CHECK(game_logic_init());
+    game_set_event_callback(game_event_callback);
     
 #ifdef CONFIG_ENABLE_DISPLAY
     // Start display update task
     if (CONFIG_I2C_SDA_PIN != -1 && CONFIG_I2C_SCL_PIN != -1) {
         ESP_LOGI(TAG, "  Starting display update task");
         xTaskCreate(display_update_task, "display_update", 4096, NULL, 5, &display_update_task_handle);
+        metrics_register_task(display_update_task_handle, "display_update");
     }
 #endif
     
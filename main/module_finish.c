@@ -19,9 +19,12 @@
 
 // Component includes
 #include "espnow_manager.h"
+#include "button_handler.h"
 
 static const char *TAG = "MODULE_FINISH";
 
+#define FINISH_DEBOUNCE_MS 50
+
 // Finish Button Module State
 static bool is_paired = false;
 static uint8_t main_unit_mac[6] = {0};
@@ -30,12 +33,10 @@ static esp_timer_handle_t led_blink_timer = NULL;
 static esp_timer_handle_t heartbeat_timer = NULL;
 static bool status_led_state = false;
 static bool button_led_on = true;  // Button illumination LED starts ON
-static volatile bool button_pressed = false;
 
-// Channel scanning state for pairing
-static bool channel_scanning = true;
-static uint8_t scanning_channels[] = {1, 6, 11};
-static uint8_t scanning_channel_index = 0;
+// Pairing state (the channel is found by the ESP-NOW beacon scan)
+static uint8_t pairing_attempts = 0;
+static const uint8_t MAX_PAIRING_ATTEMPTS = 3;  // Unanswered requests before scanning again
 
 /**
  * Initialize status LED for finish button
@@ -89,90 +90,84 @@ static void heartbeat_timer_callback(void *arg)
 }
 
 /**
- * Pairing timer callback with multi-channel scanning
+ * Beacon found callback - main unit channel known, request pairing right away
+ */
+static void beacon_found_callback(const uint8_t *main_mac, uint8_t channel)
+{
+    ESP_LOGI(TAG, "Sending pairing request on channel %d (Module ID: %d)...", channel, CONFIG_MODULE_ID);
+    uint8_t role = 2;  // 2 = Finish Button
+    espnow_broadcast_message(MSG_PAIRING_REQUEST, &role, sizeof(role));
+    pairing_attempts = 0;
+}
+
+/**
+ * Pairing timer callback
+ * Repeats the pairing request if the response got lost and falls back
+ * to the beacon scan if the main unit stays silent.
  */
 static void pairing_timer_callback(void *arg)
 {
-    if (!is_paired) {
-        if (channel_scanning) {
-            // Cycle through common channels
-            uint8_t target_channel = scanning_channels[scanning_channel_index];
-            ESP_LOGI(TAG, "Scanning channel %d for main unit...", target_channel);
-            
-            // Change to next scanning channel
-            espnow_change_channel(target_channel);
-            
-            // Toggle status LED while scanning (visual feedback)
-            status_led_state = !status_led_state;
-            gpio_set_level(CONFIG_FINISH_STATUS_LED_PIN, status_led_state ? 1 : 0);
-            
-            // Move to next channel for next attempt
-            scanning_channel_index = (scanning_channel_index + 1) % (sizeof(scanning_channels) / sizeof(scanning_channels[0]));
-        }
-        
-        // Send pairing request (broadcast)
-        ESP_LOGI(TAG, "Sending pairing request (Module ID: %d)...", CONFIG_MODULE_ID);
-        uint8_t role = 2;  // 2 = Finish Button
-        espnow_broadcast_message(MSG_PAIRING_REQUEST, &role, sizeof(role));
+    if (is_paired || espnow_scan_is_active()) {
+        return;
+    }
+    
+    if (++pairing_attempts > MAX_PAIRING_ATTEMPTS) {
+        ESP_LOGI(TAG, "No pairing response, scanning for main unit again");
+        pairing_attempts = 0;
+        espnow_scan_start(CONFIG_ESPNOW_SCAN_DWELL_MS, beacon_found_callback);
+        return;
     }
+    
+    ESP_LOGI(TAG, "Repeating pairing request (Module ID: %d)...", CONFIG_MODULE_ID);
+    uint8_t role = 2;  // 2 = Finish Button
+    espnow_broadcast_message(MSG_PAIRING_REQUEST, &role, sizeof(role));
 }
 
 /**
- * Button interrupt handler (active low)
+ * Send the finish message with the age of the press
+ * The main unit subtracts the age from its receive time, so no clock
+ * sync is needed and the debounce delay does not count.
  */
-static void IRAM_ATTR button_isr_handler(void *arg)
+static void send_finish_pressed(int64_t press_us)
 {
-    button_pressed = true;
+    uint32_t age_us = (uint32_t)(esp_timer_get_time() - press_us);
+    uint8_t data[4] = {
+        age_us & 0xFF, (age_us >> 8) & 0xFF, (age_us >> 16) & 0xFF, age_us >> 24
+    };
+    
+    esp_err_t ret = espnow_send_message(main_unit_mac, MSG_FINISH_PRESSED, data, sizeof(data));
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Finish message sent to main unit (press %lu us ago)", (unsigned long)age_us);
+    } else {
+        ESP_LOGE(TAG, "Failed to send finish message: %s", esp_err_to_name(ret));
+    }
 }
 
 /**
- * Button handler task - processes button press and sends finish message
+ * Finish button event callback (debounced by the button handler)
  */
-static void button_handler_task(void *arg)
+static void finish_button_callback(uint8_t button_id, button_event_t event)
 {
-    ESP_LOGI(TAG, "Button handler task started");
-    
-    while (1) {
-        // Check if button was pressed
-        if (button_pressed) {
-            button_pressed = false;  // Clear flag
-            
-            // Debounce: wait for button to stabilize
-            vTaskDelay(pdMS_TO_TICKS(50));
-            
-            // Check if button is still pressed (active low)
-            if (gpio_get_level(CONFIG_FINISH_BUTTON_PIN) == 0) {
-                ESP_LOGI(TAG, "Finish button pressed!");
-                
-                // Turn off button illumination LED while pressed
-                gpio_set_level(CONFIG_FINISH_BUTTON_LED_PIN, 0);
-                button_led_on = false;
-                
-                // Send finish pressed message to main unit (unicast)
-                if (is_paired) {
-                    esp_err_t ret = espnow_send_message(main_unit_mac, MSG_FINISH_PRESSED, NULL, 0);
-                    if (ret == ESP_OK) {
-                        ESP_LOGI(TAG, "Finish message sent to main unit successfully!");
-                    } else {
-                        ESP_LOGE(TAG, "Failed to send finish message: %s", esp_err_to_name(ret));
-                    }
-                } else {
-                    ESP_LOGW(TAG, "Not paired, cannot send finish message");
-                }
-                
-                // Wait for button release
-                while (gpio_get_level(CONFIG_FINISH_BUTTON_PIN) == 0) {
-                    vTaskDelay(pdMS_TO_TICKS(10));
-                }
-                
-                // Turn button illumination LED back ON after release
-                gpio_set_level(CONFIG_FINISH_BUTTON_LED_PIN, 1);
-                button_led_on = true;
-                ESP_LOGI(TAG, "Button released");
-            }
-        }
+    if (event == BUTTON_EVENT_PRESSED) {
+        ESP_LOGI(TAG, "Finish button pressed!");
         
-        vTaskDelay(pdMS_TO_TICKS(10));
+        // Turn off button illumination LED while pressed
+        gpio_set_level(CONFIG_FINISH_BUTTON_LED_PIN, 0);
+        button_led_on = false;
+        
+        // Send finish pressed message to main unit (unicast)
+        if (is_paired) {
+            int64_t press_us = esp_timer_get_time();
+            button_get_event_time(button_id, &press_us);    // Edge time from the ISR
+            send_finish_pressed(press_us);
+        } else {
+            ESP_LOGW(TAG, "Not paired, cannot send finish message");
+        }
+    } else if (event == BUTTON_EVENT_RELEASED) {
+        // Turn button illumination LED back ON after release
+        gpio_set_level(CONFIG_FINISH_BUTTON_LED_PIN, 1);
+        button_led_on = true;
+        ESP_LOGI(TAG, "Button released");
     }
 }
 
@@ -203,8 +198,10 @@ static void espnow_recv_callback_finish(const uint8_t *sender_mac, const espnow_
                     ESP_LOGI(TAG, "Main unit added as ESP-NOW peer");
                 }
                 
-                // Stop channel scanning
-                channel_scanning = false;
+                // Stop scanning, start the next scan on this channel
+                pairing_attempts = 0;
+                espnow_scan_stop();
+                espnow_save_channel();
                 
                 // Turn on status LED solid
                 gpio_set_level(CONFIG_FINISH_STATUS_LED_PIN, 1);
@@ -232,8 +229,10 @@ static void espnow_recv_callback_finish(const uint8_t *sender_mac, const espnow_
             }
             
             is_paired = false;
-            channel_scanning = true;
-            scanning_channel_index = 0;
+            
+            // Look for the main unit again (cached channel first)
+            pairing_attempts = 0;
+            espnow_scan_start(CONFIG_ESPNOW_SCAN_DWELL_MS, beacon_found_callback);
             
             // Turn off button illumination LED
             gpio_set_level(CONFIG_FINISH_BUTTON_LED_PIN, 1);  // Reset to ON
@@ -244,21 +243,12 @@ static void espnow_recv_callback_finish(const uint8_t *sender_mac, const espnow_
             break;
             
         case MSG_CHANNEL_CHANGE: {
-            uint8_t new_channel = message->data[0];
-            ESP_LOGI(TAG, "Channel change requested: %d", new_channel);
+            ESP_LOGI(TAG, "Channel change request to channel %d", message->data[0]);
             
-            // Stop channel scanning when main unit sets specific channel
-            channel_scanning = false;
-            
-            // Change channel
-            esp_err_t ret = espnow_change_channel(new_channel);
-            if (ret == ESP_OK) {
-                ESP_LOGI(TAG, "Channel changed successfully to %d", new_channel);
-                
-                // Send ACK back to main unit
-                espnow_broadcast_message(MSG_CHANNEL_ACK, NULL, 0);
-            } else {
-                ESP_LOGE(TAG, "Failed to change channel: %s", esp_err_to_name(ret));
+            // ACK now, switch at the time announced by the main unit
+            esp_err_t ret = espnow_handle_channel_change(sender_mac, message);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to handle channel change: %s", esp_err_to_name(ret));
             }
             break;
         }
@@ -276,20 +266,16 @@ void module_finish_init(void)
 {
     ESP_LOGI(TAG, "Initializing Finish Button Unit...");
     
-    // Initialize button GPIO (active low with pull-up)
+    // Initialize button (active low with pull-up), edges are timestamped in the ISR
     ESP_LOGI(TAG, "  Initializing Button (GPIO %d)", CONFIG_FINISH_BUTTON_PIN);
-    gpio_config_t button_conf = {
-        .pin_bit_mask = (1ULL << CONFIG_FINISH_BUTTON_PIN),
-        .mode = GPIO_MODE_INPUT,
-        .pull_up_en = GPIO_PULLUP_ENABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_NEGEDGE,  // Trigger on falling edge (button press)
+    button_config_t button_conf = {
+        .pin = CONFIG_FINISH_BUTTON_PIN,
+        .debounce_time_ms = FINISH_DEBOUNCE_MS,
+        .long_press_time_ms = 1000,
+        .pull_up = true,
+        .active_low = true
     };
-    gpio_config(&button_conf);
-    
-    // Install GPIO ISR service and add handler
-    gpio_install_isr_service(0);
-    gpio_isr_handler_add(CONFIG_FINISH_BUTTON_PIN, button_isr_handler, NULL);
+    ESP_ERROR_CHECK(button_handler_init(&button_conf, 1, finish_button_callback));
     
     // Initialize LEDs
     ESP_LOGI(TAG, "  Initializing LEDs (Status: GPIO %d, Button Light: GPIO %d)",
@@ -307,7 +293,11 @@ void module_finish_init(void)
     ESP_LOGI(TAG, "  Initializing ESP-NOW (Channel: %d)", CONFIG_ESPNOW_CHANNEL);
     ESP_ERROR_CHECK(espnow_manager_init(CONFIG_ESPNOW_CHANNEL, espnow_recv_callback_finish));
     
-    // Set up periodic pairing request timer (every 1.5 seconds until paired)
+    // Listen for the main unit's beacon, pairing request goes out once it is found
+    ESP_LOGI(TAG, "  Starting pairing beacon scan");
+    ESP_ERROR_CHECK(espnow_scan_start(CONFIG_ESPNOW_SCAN_DWELL_MS, beacon_found_callback));
+    
+    // Set up pairing retry timer (every 1.5 seconds until paired)
     ESP_LOGI(TAG, "  Setting up pairing request timer");
     const esp_timer_create_args_t pairing_timer_args = {
         .callback = &pairing_timer_callback,
@@ -333,15 +323,6 @@ void module_finish_init(void)
     };
     ESP_ERROR_CHECK(esp_timer_create(&heartbeat_timer_args, &heartbeat_timer));
     
-    // Create button handler task
-    ESP_LOGI(TAG, "  Creating button handler task");
-    xTaskCreate(button_handler_task, "button_handler", 4096, NULL, 5, NULL);
-    
-    // Send initial pairing request
-    ESP_LOGI(TAG, "  Sending initial pairing request");
-    uint8_t role = 2;  // 2 = Finish Button
-    espnow_broadcast_message(MSG_PAIRING_REQUEST, &role, sizeof(role));
-    
     // Print GPIO configuration summary
     ESP_LOGI(TAG, "=================================================");
     ESP_LOGI(TAG, "   Finish Button - GPIO Configuration");
@@ -20,10 +20,25 @@
 // Component includes
 #include "laser_control.h"
 #include "sensor_manager.h"
+#ifdef CONFIG_LASER_MODULATION
+#include "sensor_lockin.h"
+#endif
+#ifdef CONFIG_SENSOR_TRACE
+#include "sensor_trace.h"
+#endif
 #include "espnow_manager.h"
 
 static const char *TAG = "MODULE_LASER";
 
+#ifdef CONFIG_LASER_MODULATION
+#define SENSOR_THRESHOLD CONFIG_SENSOR_LOCKIN_THRESHOLD     // Carrier amplitude
+#else
+#define SENSOR_THRESHOLD CONFIG_SENSOR_THRESHOLD            // Raw ADC value
+#endif
+
+#define CAL_SETTLE_MS 300      // Sensor settling after switching the laser (LDRs are slow)
+#define TRACE_FRAME_INTERVAL_MS 10     // Pacing of trace frames, leaves room for game traffic
+
 // Pairing state
 static bool is_paired = false;
 static bool is_game_mode = false;  // Track if in game mode (vs manual laser control)
@@ -37,13 +52,14 @@ static uint8_t main_unit_mac[6] = {0};  // MAC address of paired main unit
 static int64_t last_main_unit_heartbeat = 0;  // Timestamp of last heartbeat from main unit
 static const int64_t HEARTBEAT_TIMEOUT_US = 30000000;  // 30 seconds in microseconds
 
-// Channel scanning state
-static uint8_t current_scan_channel = CONFIG_ESPNOW_CHANNEL;
-static uint8_t scan_attempts_on_channel = 0;
-static const uint8_t MAX_ATTEMPTS_PER_CHANNEL = 1;  // 1 pairing attempt per channel (fast scan)
-static const uint8_t MAX_WIFI_CHANNEL = 13;          // WiFi channels 1-13
+// Pairing state (the channel is found by the ESP-NOW beacon scan)
+static uint8_t pairing_attempts = 0;
+static const uint8_t MAX_PAIRING_ATTEMPTS = 3;      // Unanswered requests before scanning again
 static uint8_t led_blink_state = 0;                  // For blinking status LED during scanning
 
+// Sensor calibration
+static volatile bool calibration_running = false;
+
 /**
  * LED blink timer callback (Laser Unit)
  * Fast blink during pairing search
@@ -111,36 +127,38 @@ static void safety_timer_callback(void *arg)
 }
 
 /**
- * Pairing request timer callback with channel scanning
+ * Beacon found callback - main unit channel known, request pairing right away
+ */
+static void beacon_found_callback(const uint8_t *main_mac, uint8_t channel)
+{
+    ESP_LOGI(TAG, "Sending pairing request on channel %d...", channel);
+    
+    uint8_t role = 1;  // 1 = Laser Unit
+    espnow_broadcast_message(MSG_PAIRING_REQUEST, &role, sizeof(role));
+    pairing_attempts = 0;
+}
+
+/**
+ * Pairing request timer callback
+ * Repeats the pairing request if the response got lost and falls back
+ * to the beacon scan if the main unit stays silent.
  */
 static void pairing_timer_callback(void *arg)
 {
-    if (!is_paired) {
-        ESP_LOGI(TAG, "Sending pairing request on channel %d...", current_scan_channel);
-        
-        uint8_t role = 1;  // 1 = Laser Unit
-        espnow_broadcast_message(MSG_PAIRING_REQUEST, &role, sizeof(role));
-        scan_attempts_on_channel++;
-        
-        // After MAX_ATTEMPTS_PER_CHANNEL, switch to next channel
-        if (scan_attempts_on_channel >= MAX_ATTEMPTS_PER_CHANNEL) {
-            scan_attempts_on_channel = 0;
-            current_scan_channel++;
-            
-            // Wrap back to channel 1 after channel 13
-            if (current_scan_channel > MAX_WIFI_CHANNEL) {
-                current_scan_channel = 1;
-                ESP_LOGI(TAG, "Completed full channel scan, restarting from channel 1");
-            }
-            
-            // Switch channel
-            ESP_LOGI(TAG, "No response, switching to channel %d", current_scan_channel);
-            esp_err_t ret = espnow_change_channel(current_scan_channel);
-            if (ret != ESP_OK) {
-                ESP_LOGE(TAG, "Failed to switch channel: %s", esp_err_to_name(ret));
-            }
-        }
+    if (is_paired || espnow_scan_is_active()) {
+        return;
     }
+    
+    if (++pairing_attempts > MAX_PAIRING_ATTEMPTS) {
+        ESP_LOGI(TAG, "No pairing response, scanning for main unit again");
+        pairing_attempts = 0;
+        espnow_scan_start(CONFIG_ESPNOW_SCAN_DWELL_MS, beacon_found_callback);
+        return;
+    }
+    
+    ESP_LOGI(TAG, "Repeating pairing request...");
+    uint8_t role = 1;  // 1 = Laser Unit
+    espnow_broadcast_message(MSG_PAIRING_REQUEST, &role, sizeof(role));
 }
 
 /**
@@ -210,6 +228,137 @@ static void beam_restore_callback(uint8_t sensor_id)
     gpio_set_level(CONFIG_SENSOR_LED_RED_PIN, 0);
 }
 
+/**
+ * Report a calibration result to the main unit
+ */
+static void send_calibration_result(sensor_cal_status_t status, const sensor_calibration_t *cal)
+{
+    uint8_t data[15] = {status};
+    const uint16_t values[] = {
+        cal->threshold, cal->hysteresis, cal->off.mean, cal->off.stddev,
+        cal->on.mean, cal->on.stddev, cal->separation_x10
+    };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        data[1 + i * 2] = values[i] & 0xFF;
+        data[2 + i * 2] = values[i] >> 8;
+    }
+    
+    esp_err_t ret = espnow_send_message(main_unit_mac, MSG_SENSOR_CAL_RESULT, data, sizeof(data));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to send calibration result: %s", esp_err_to_name(ret));
+    }
+}
+
+/**
+ * Sensor calibration task (Laser Unit)
+ * Measures the sensor with the laser off and on, picks threshold and
+ * hysteresis, saves them and reports back.
+ */
+static void sensor_calibration_task(void *arg)
+{
+    uint16_t count = (uint16_t)(uintptr_t)arg;
+    sensor_calibration_t cal = {0};
+    sensor_cal_status_t status = SENSOR_CAL_FAILED;
+    
+    ESP_LOGI(TAG, "Sensor calibration started");
+    gpio_set_level(CONFIG_SENSOR_LED_GREEN_PIN, 0);
+    gpio_set_level(CONFIG_SENSOR_LED_RED_PIN, 0);
+    
+    laser_turn_off();
+    vTaskDelay(pdMS_TO_TICKS(CAL_SETTLE_MS));
+    esp_err_t ret = sensor_measure_levels(count, &cal.off);
+    
+    if (ret == ESP_OK) {
+        laser_turn_on(100);
+        vTaskDelay(pdMS_TO_TICKS(CAL_SETTLE_MS));
+        ret = sensor_measure_levels(count, &cal.on);
+        if (!is_game_mode) {
+            laser_turn_off();
+        }
+    }
+    
+    if (is_game_mode) {
+        // Game started meanwhile, the measurement saw the game's laser
+        ESP_LOGW(TAG, "Game started during calibration, result discarded");
+        status = SENSOR_CAL_BUSY;
+    } else if (ret == ESP_OK) {
+        ret = sensor_calibration_compute(&cal);
+        if (ret == ESP_OK) {
+            ret = sensor_apply_calibration(cal.threshold, cal.hysteresis, true);
+            status = (ret == ESP_OK) ? SENSOR_CAL_OK : SENSOR_CAL_FAILED;
+        } else {
+            status = SENSOR_CAL_POOR_SEPARATION;
+        }
+    } else {
+        ESP_LOGE(TAG, "Sensor measurement failed: %s", esp_err_to_name(ret));
+    }
+    
+    // Green = calibrated, red = old threshold kept, check the alignment
+    if (!is_game_mode) {
+        gpio_set_level(CONFIG_SENSOR_LED_GREEN_PIN, status == SENSOR_CAL_OK);
+        gpio_set_level(CONFIG_SENSOR_LED_RED_PIN, status != SENSOR_CAL_OK);
+    }
+    
+    ESP_LOGI(TAG, "Sensor calibration finished (status %d)", status);
+    if (is_paired) {
+        send_calibration_result(status, &cal);
+    }
+    
+    calibration_running = false;
+    vTaskDelete(NULL);
+}
+
+#ifdef CONFIG_SENSOR_TRACE
+/**
+ * Sensor trace task (Laser Unit)
+ * Ships each captured trace to the main unit, then captures the next break.
+ */
+static void sensor_trace_task(void *arg)
+{
+    uint8_t trace_id = 0;
+    
+    while (1) {
+        sensor_trace_t trace;
+        if (sensor_trace_wait(portMAX_DELAY, &trace) != ESP_OK) {
+            continue;
+        }
+        
+        if (!is_paired) {
+            ESP_LOGW(TAG, "Trace captured but not paired, dropping it");
+            sensor_trace_rearm();
+            continue;
+        }
+        
+        trace.header.trace_id = ++trace_id;
+        ESP_LOGI(TAG, "Sending trace %d (%d samples, break at %d)", trace_id,
+                 trace.header.sample_count, trace.header.trigger_index);
+        
+        uint8_t data[32];
+        size_t len = sensor_trace_pack_header(&trace.header, data);
+        esp_err_t ret = espnow_send_message(main_unit_mac, MSG_SENSOR_TRACE, data, len);
+        
+        uint16_t next = 0;
+        uint8_t retries = 0;
+        while (ret == ESP_OK && next < trace.header.sample_count) {
+            vTaskDelay(pdMS_TO_TICKS(TRACE_FRAME_INTERVAL_MS));
+            len = sensor_trace_pack_samples(&trace, next, data);
+            ret = espnow_send_message(main_unit_mac, MSG_SENSOR_TRACE, data, len);
+            if (ret == ESP_ERR_ESPNOW_NO_MEM && ++retries < 20) {
+                ret = ESP_OK;       // Send queue full, retry this frame
+                continue;
+            }
+            retries = 0;
+            next += data[3];
+        }
+        
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Trace send failed: %s", esp_err_to_name(ret));
+        }
+        sensor_trace_rearm();
+    }
+}
+#endif
+
 /**
  * ESP-NOW message received callback (Laser Unit)
  */
@@ -285,7 +434,7 @@ static void espnow_recv_callback_laser(const uint8_t *sender_mac, const espnow_m
             break;
             
         case MSG_PAIRING_RESPONSE:
-            ESP_LOGI(TAG, "Pairing response received - paired successfully on channel %d!", current_scan_channel);
+            ESP_LOGI(TAG, "Pairing response received - paired successfully!");
             
             // Store main unit MAC address for unicast heartbeats
             memcpy(main_unit_mac, sender_mac, 6);
@@ -304,9 +453,13 @@ static void espnow_recv_callback_laser(const uint8_t *sender_mac, const espnow_m
             }
             
             is_paired = true;
-            scan_attempts_on_channel = 0;  // Reset scan state
+            pairing_attempts = 0;          // Reset pairing state
             led_blink_state = 0;           // Reset blink state
             
+            // Start the next scan on this channel
+            espnow_scan_stop();
+            espnow_save_channel();
+            
             // Status LED solid on = connected/paired
             gpio_set_level(CONFIG_LASER_STATUS_LED_PIN, 1);
             
@@ -369,15 +522,15 @@ static void espnow_recv_callback_laser(const uint8_t *sender_mac, const espnow_m
                 ESP_LOGI(TAG, "Heartbeat timer stopped");
             }
             
-            // Reset channel scan state
-            current_scan_channel = CONFIG_ESPNOW_CHANNEL;  // Back to configured start channel
-            scan_attempts_on_channel = 0;
+            // Reset pairing state and look for the main unit again (cached channel first)
+            pairing_attempts = 0;
             led_blink_state = 0;  // Reset blink state
+            espnow_scan_start(CONFIG_ESPNOW_SCAN_DWELL_MS, beacon_found_callback);
             
             // Restart pairing timer
             if (pairing_timer) {
                 esp_timer_start_periodic(pairing_timer, 1500000); // 1.5 seconds
-                ESP_LOGI(TAG, "Pairing timer restarted, will scan from channel %d", current_scan_channel);
+                ESP_LOGI(TAG, "Pairing timer restarted");
             }
             
             // Restart LED blink timer
@@ -388,19 +541,34 @@ static void espnow_recv_callback_laser(const uint8_t *sender_mac, const espnow_m
             ESP_LOGI(TAG, "Module reset complete");
             break;
             
+        case MSG_SENSOR_CALIBRATE: {
+            uint16_t count = message->data[0] | (message->data[1] << 8);
+            ESP_LOGI(TAG, "Sensor calibration request (%d levels per phase)", count);
+            
+            if (is_game_mode || calibration_running) {
+                sensor_calibration_t none = {0};
+                send_calibration_result(SENSOR_CAL_BUSY, &none);
+                break;
+            }
+            
+            // Takes a second or more, keep it out of the ESP-NOW callback
+            calibration_running = true;
+            if (xTaskCreate(sensor_calibration_task, "sensor_cal", 3072, (void *)(uintptr_t)count,
+                            5, NULL) != pdPASS) {
+                calibration_running = false;
+                sensor_calibration_t none = {0};
+                send_calibration_result(SENSOR_CAL_FAILED, &none);
+            }
+            break;
+        }
+            
         case MSG_CHANNEL_CHANGE: {
-            uint8_t new_channel = message->data[0];
-            ESP_LOGI(TAG, "Channel change request to channel %d", new_channel);
+            ESP_LOGI(TAG, "Channel change request to channel %d", message->data[0]);
             
-            // Change channel
-            esp_err_t ret = espnow_change_channel(new_channel);
-            if (ret == ESP_OK) {
-                ESP_LOGI(TAG, "Channel changed successfully to %d", new_channel);
-                
-                // Send ACK back to main unit
-                espnow_broadcast_message(MSG_CHANNEL_ACK, NULL, 0);
-            } else {
-                ESP_LOGE(TAG, "Failed to change channel: %s", esp_err_to_name(ret));
+            // ACK now, switch at the time announced by the main unit
+            esp_err_t ret = espnow_handle_channel_change(sender_mac, message);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to handle channel change: %s", esp_err_to_name(ret));
             }
             break;
         }
@@ -422,11 +590,25 @@ void module_laser_init(void)
     ESP_LOGI(TAG, "  Initializing Laser PWM (GPIO %d)", CONFIG_LASER_PIN);
     ESP_ERROR_CHECK(laser_control_init(CONFIG_LASER_PIN));
     ESP_ERROR_CHECK(laser_set_safety_timeout(true));  // Enable safety timeout
+#ifdef CONFIG_LASER_MODULATION
+    ESP_ERROR_CHECK(laser_set_modulation(SENSOR_LOCKIN_CARRIER_HZ));
+#endif
     
     // Initialize ADC for photoresistor/sensor
     ESP_LOGI(TAG, "  Initializing ADC Sensor (GPIO %d, Threshold: %d)", 
-             CONFIG_SENSOR_PIN, CONFIG_SENSOR_THRESHOLD);
-    ESP_ERROR_CHECK(sensor_manager_init(CONFIG_SENSOR_PIN, CONFIG_SENSOR_THRESHOLD, CONFIG_DEBOUNCE_TIME));
+             CONFIG_SENSOR_PIN, SENSOR_THRESHOLD);
+    ESP_ERROR_CHECK(sensor_manager_init(CONFIG_SENSOR_PIN, SENSOR_THRESHOLD, CONFIG_DEBOUNCE_TIME));
+    if (sensor_load_calibration() != ESP_OK) {
+        ESP_LOGI(TAG, "  No saved sensor calibration, using the configured threshold");
+    }
+#ifdef CONFIG_SENSOR_TRACE
+    ESP_LOGI(TAG, "  Enabling sensor trace capture (%d samples)", CONFIG_SENSOR_TRACE_SAMPLES);
+    if (sensor_trace_enable(CONFIG_SENSOR_TRACE_SAMPLES, CONFIG_SENSOR_TRACE_POST_SAMPLES) == ESP_OK) {
+        xTaskCreate(sensor_trace_task, "sensor_trace", 3072, NULL, 3, NULL);
+    } else {
+        ESP_LOGE(TAG, "  Sensor trace capture not available");
+    }
+#endif
     ESP_ERROR_CHECK(sensor_register_callback(beam_break_callback));
     ESP_ERROR_CHECK(sensor_register_restore_callback(beam_restore_callback));
     
@@ -446,7 +628,11 @@ void module_laser_init(void)
     ESP_LOGI(TAG, "  Initializing ESP-NOW (Channel: %d)", CONFIG_ESPNOW_CHANNEL);
     ESP_ERROR_CHECK(espnow_manager_init(CONFIG_ESPNOW_CHANNEL, espnow_recv_callback_laser));
     
-    // Set up periodic pairing request timer (every 1.5 seconds until paired)
+    // Listen for the main unit's beacon, pairing request goes out once it is found
+    ESP_LOGI(TAG, "  Starting pairing beacon scan");
+    ESP_ERROR_CHECK(espnow_scan_start(CONFIG_ESPNOW_SCAN_DWELL_MS, beacon_found_callback));
+    
+    // Set up pairing retry timer (every 1.5 seconds until paired)
     ESP_LOGI(TAG, "  Setting up pairing request timer");
     const esp_timer_create_args_t pairing_timer_args = {
         .callback = &pairing_timer_callback,
@@ -481,17 +667,17 @@ void module_laser_init(void)
     ESP_ERROR_CHECK(esp_timer_create(&safety_timer_args, &safety_timer));
     ESP_ERROR_CHECK(esp_timer_start_periodic(safety_timer, 2000000));  // Check every 2 seconds
     
-    // Send initial pairing request
-    ESP_LOGI(TAG, "  Sending initial pairing request to main unit");
-    espnow_broadcast_message(MSG_PAIRING_REQUEST, NULL, 0);
-    
     // Print GPIO configuration summary
     ESP_LOGI(TAG, "=================================================");
     ESP_LOGI(TAG, "   Laser Unit - GPIO Configuration");
     ESP_LOGI(TAG, "=================================================");
     ESP_LOGI(TAG, "Laser Diode:    GPIO%d (PWM)", CONFIG_LASER_PIN);
     ESP_LOGI(TAG, "Sensor ADC:     GPIO%d (Channel %d)", CONFIG_SENSOR_PIN, CONFIG_SENSOR_PIN);
-    ESP_LOGI(TAG, "Threshold:      %d (ADC units)", CONFIG_SENSOR_THRESHOLD);
+#ifdef CONFIG_LASER_MODULATION
+    ESP_LOGI(TAG, "Threshold:      %d (carrier amplitude, %d Hz)", SENSOR_THRESHOLD, SENSOR_LOCKIN_CARRIER_HZ);
+#else
+    ESP_LOGI(TAG, "Threshold:      %d (ADC units)", SENSOR_THRESHOLD);
+#endif
     ESP_LOGI(TAG, "Status LED:     GPIO%d", CONFIG_LASER_STATUS_LED_PIN);
     ESP_LOGI(TAG, "Green LED:      GPIO%d", CONFIG_SENSOR_LED_GREEN_PIN);
     ESP_LOGI(TAG, "Red LED:        GPIO%d", CONFIG_SENSOR_LED_RED_PIN);
@@ -0,0 +1,6 @@
+/**
+ * Host shim: driver/gpio.h (display preview only)
+ */
+#pragma once
+
+typedef int gpio_num_t;
@@ -0,0 +1,8 @@
+/**
+ * Host shim: esp_system.h (display preview only)
+ */
+#pragma once
+#include <stdint.h>
+
+uint32_t esp_get_free_heap_size(void);
+uint32_t esp_get_minimum_free_heap_size(void);
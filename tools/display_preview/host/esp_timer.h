@@ -0,0 +1,7 @@
+/**
+ * Host shim: esp_timer.h (display preview only)
+ */
+#pragma once
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
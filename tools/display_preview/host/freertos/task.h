@@ -0,0 +1,18 @@
+/**
+ * Host shim: freertos/task.h (display preview only)
+ *
+ * xTaskCreate always fails, so the display manager flushes synchronously.
+ */
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                       UBaseType_t prio, TaskHandle_t *handle);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+
+#define xTaskNotifyGive(task) ((void)(task))
@@ -0,0 +1,11 @@
+/**
+ * Host shim: libc functions ESP-IDF (newlib) has but older glibc lacks.
+ * Force-included by the Makefile.
+ */
+#pragma once
+#include <string.h>
+
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+#define HOST_NEEDS_STRLCPY 1
+size_t strlcpy(char *dst, const char *src, size_t size);
+#endif
@@ -0,0 +1,68 @@
+/**
+ * Display Preview - renders the display manager screens on the host
+ *
+ * Runs the real display manager, layouts and fonts against the virtual
+ * panel, which writes one PBM image per flushed frame into the current
+ * directory. See the Makefile for building other panel geometries.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#include "display_manager.h"
+#include "display_fb.h"
+#include <stdio.h>
+
+static unsigned frame = 0;
+
+/**
+ * Print which frame file shows which screen
+ */
+static void shot(const char *name)
+{
+    printf("display_%03u.pbm  %s\n", frame++, name);
+}
+
+int main(void)
+{
+    if (display_manager_init(0, 0, 400000) != ESP_OK) {
+        fprintf(stderr, "display init failed\n");
+        return 1;
+    }
+
+    display_set_screen(SCREEN_IDLE);
+    display_clear();
+    display_text("LASER PARCOUR", 0);
+    display_text("Ready", 1);
+    display_text("Units: 3", 2);
+    display_update();
+    shot("idle text");
+
+    display_set_screen(SCREEN_GAME_COUNTDOWN);
+    display_countdown(3);
+    shot("countdown 3");
+    display_countdown(2);
+    shot("countdown 2");
+
+    display_set_screen(SCREEN_GAME_RUNNING);
+    display_game_status(0, 0);
+    shot("game running 00:00.00");
+    display_game_status(61234, 2);
+    shot("game running 01:01.23, 2 breaks");
+
+    display_set_screen(SCREEN_GAME_PAUSED);
+    display_game_status(61234, 3);
+    shot("paused");
+
+    display_set_screen(SCREEN_GAME_COMPLETE);
+    display_game_results(83456, 3, COMPLETION_SOLVED);
+    shot("results (solved)");
+    display_game_results(120000, 7, COMPLETION_ABORTED_TIME);
+    shot("results (canceled)");
+
+    display_stats_t stats;
+    display_fb_get_stats(&stats);
+    printf("%lu frames, %lu pages sent, %lu skipped\n", (unsigned long)stats.frames_sent,
+           (unsigned long)stats.pages_sent, (unsigned long)stats.frames_skipped);
+    return 0;
+}
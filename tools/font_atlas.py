@@ -0,0 +1,292 @@
+#!/usr/bin/env python3
+"""
+Font Atlas Generator for the Display Manager
+
+Converts a BDF or TrueType font into a C font atlas (font_atlas_t) with
+precomputed column bitmaps in the SSD1306 page layout: each glyph is
+stored as `pages` rows of `width` bytes, bit 0 being the top pixel of a
+page. Drawing a glyph on the device is then one memcpy (or OR) per page
+row instead of per-pixel bit shuffling.
+
+Usage:
+    tools/font_atlas.py tools/fonts/font5x7.bdf --name font_5x7 \\
+        -o components/display_manager/fonts/font_5x7.c
+    tools/font_atlas.py tools/fonts/font5x7.bdf --name font_clock_24 --scale 3 \\
+        --chars "0123456789:. " --proportional --tabular-digits \\
+        -o components/display_manager/fonts/font_clock_24.c
+    tools/font_atlas.py SomeFont.ttf --size 16 --name font_sans_16 --proportional \\
+        -o components/display_manager/fonts/font_sans_16.c
+
+TrueType input needs Pillow (pip install pillow); BDF input has no
+dependencies. The generated file must be added to the display_manager
+CMakeLists.txt and declared in include/fonts.h.
+
+Author: ninharp
+Date: 2026-10-16
+"""
+
+import argparse
+import os
+import sys
+
+
+class Glyph:
+    """Monochrome glyph: rows of booleans, all glyphs of a font share one height"""
+
+    def __init__(self, code, rows, advance):
+        self.code = code
+        self.rows = rows
+        self.advance = advance
+
+    @property
+    def width(self):
+        return len(self.rows[0]) if self.rows else 0
+
+    def column_empty(self, x):
+        return not any(row[x] for row in self.rows)
+
+
+def parse_chars(spec):
+    """Character set: "32-126" style ranges or a literal string"""
+    codes = []
+    if all(part.strip().replace("-", "").isdigit() for part in spec.split(",")):
+        for part in spec.split(","):
+            lo, _, hi = part.strip().partition("-")
+            codes.extend(range(int(lo), int(hi or lo) + 1))
+    else:
+        codes = [ord(c) for c in spec]
+    return sorted(set(codes))
+
+
+def load_bdf(path, codes):
+    """Load glyphs from a BDF file, placed in a cell of the font bounding box"""
+    with open(path, encoding="latin-1") as f:
+        lines = [l.strip() for l in f]
+
+    fbb_w = fbb_h = fbb_x = fbb_y = 0
+    glyphs = {}
+    i = 0
+    while i < len(lines):
+        fields = lines[i].split()
+        if not fields:
+            i += 1
+            continue
+        if fields[0] == "FONTBOUNDINGBOX":
+            fbb_w, fbb_h, fbb_x, fbb_y = (int(v) for v in fields[1:5])
+        elif fields[0] == "STARTCHAR":
+            code = None
+            advance = fbb_w
+            bbx = (fbb_w, fbb_h, fbb_x, fbb_y)
+            bitmap = []
+            i += 1
+            while lines[i] != "ENDCHAR":
+                fields = lines[i].split()
+                if fields[0] == "ENCODING":
+                    code = int(fields[1])
+                elif fields[0] == "DWIDTH":
+                    advance = int(fields[1])
+                elif fields[0] == "BBX":
+                    bbx = tuple(int(v) for v in fields[1:5])
+                elif fields[0] == "BITMAP":
+                    i += 1
+                    while lines[i] != "ENDCHAR":
+                        bitmap.append(lines[i])
+                        i += 1
+                    break
+                i += 1
+            if code in codes:
+                glyphs[code] = bdf_glyph(code, bitmap, bbx, advance, fbb_w, fbb_h, fbb_x, fbb_y)
+        i += 1
+
+    return glyphs
+
+
+def bdf_glyph(code, bitmap, bbx, advance, fbb_w, fbb_h, fbb_x, fbb_y):
+    """Place a BDF bitmap inside the font cell (baseline aligned)"""
+    w, h, xoff, yoff = bbx
+    cell_w = max(fbb_w, advance)
+    rows = [[False] * cell_w for _ in range(fbb_h)]
+    top = (fbb_h + fbb_y) - (h + yoff)
+    for r, hexrow in enumerate(bitmap[:h]):
+        bits = int(hexrow, 16)
+        nbits = len(hexrow) * 4
+        for x in range(w):
+            if bits & (1 << (nbits - 1 - x)):
+                cy, cx = top + r, xoff - fbb_x + x
+                if 0 <= cy < fbb_h and 0 <= cx < cell_w:
+                    rows[cy][cx] = True
+    # Trailing columns beyond the ink width belong to the spacing
+    width = min(cell_w, max(fbb_w, w + xoff - fbb_x))
+    return Glyph(code, [row[:width] for row in rows], advance)
+
+
+def load_ttf(path, size, codes):
+    """Render glyphs of a TrueType font with Pillow"""
+    try:
+        from PIL import Image, ImageDraw, ImageFont
+    except ImportError:
+        sys.exit("TrueType input needs Pillow: pip install pillow")
+
+    font = ImageFont.truetype(path, size)
+    ascent, descent = font.getmetrics()
+    height = ascent + descent
+    glyphs = {}
+    for code in codes:
+        ch = chr(code)
+        advance = max(1, int(round(font.getlength(ch))))
+        img = Image.new("1", (advance, height), 0)
+        ImageDraw.Draw(img).text((0, 0), ch, font=font, fill=1)
+        rows = [[bool(img.getpixel((x, y))) for x in range(advance)] for y in range(height)]
+        glyphs[code] = Glyph(code, rows, advance)
+    return glyphs
+
+
+def scale_glyph(glyph, factor):
+    """Integer nearest-neighbour scale"""
+    rows = []
+    for row in glyph.rows:
+        scaled = [px for px in row for _ in range(factor)]
+        rows.extend(list(scaled) for _ in range(factor))
+    return Glyph(glyph.code, rows, glyph.advance * factor)
+
+
+def trim_glyph(glyph, space_width):
+    """Drop empty columns left and right (proportional spacing)"""
+    if glyph.code == ord(" "):
+        return Glyph(glyph.code, [row[:space_width] for row in glyph.rows], space_width)
+    x0 = 0
+    while x0 < glyph.width and glyph.column_empty(x0):
+        x0 += 1
+    x1 = glyph.width
+    while x1 > x0 and glyph.column_empty(x1 - 1):
+        x1 -= 1
+    if x0 == x1:
+        x0, x1 = 0, 1
+    return Glyph(glyph.code, [row[x0:x1] for row in glyph.rows], x1 - x0)
+
+
+def to_pages(glyph, pages):
+    """Encode glyph as page rows of column bytes (bit 0 = top pixel)"""
+    data = []
+    height = len(glyph.rows)
+    for p in range(pages):
+        for x in range(glyph.width):
+            byte = 0
+            for bit in range(8):
+                y = p * 8 + bit
+                if y < height and glyph.rows[y][x]:
+                    byte |= 1 << bit
+            data.append(byte)
+    return data
+
+
+def char_comment(code):
+    ch = chr(code)
+    if ch == "\\":
+        return "backslash"
+    return "'" + ch + "'"
+
+
+def write_atlas(path, name, source, glyphs, codes, pages, spacing):
+    first, last = codes[0], codes[-1]
+    bitmap = []
+    entries = []
+    empty = Glyph(0, [[]] * (pages * 8), 0)  # Not in the character set, drawn as nothing
+    for code in range(first, last + 1):
+        glyph = glyphs.get(code, empty)
+        data = to_pages(glyph, pages)
+        entries.append((code, len(bitmap), glyph.width))
+        bitmap.extend(data)
+
+    if len(bitmap) > 0xFFFF:
+        sys.exit(f"Atlas too large ({len(bitmap)} bytes)")
+
+    out = []
+    out.append("/**")
+    out.append(f" * Font Atlas - {name}")
+    out.append(" * ")
+    out.append(f" * Generated by tools/font_atlas.py from {source}, do not edit.")
+    out.append(f" * {pages * 8} px ({pages} pages), characters {first}-{last}, {len(bitmap)} bytes.")
+    out.append(" * ")
+    out.append(" * @author ninharp")
+    out.append(" * @date 2026")
+    out.append(" */")
+    out.append("")
+    out.append('#include "fonts.h"')
+    out.append("")
+    out.append(f"static const uint8_t {name}_bitmap[] = {{")
+    for code, offset, width in entries:
+        data = bitmap[offset:offset + width * pages]
+        if data:
+            out.append("    " + ", ".join(f"0x{b:02X}" for b in data) + f",  // {char_comment(code)}")
+    out.append("};")
+    out.append("")
+    out.append(f"static const font_glyph_t {name}_glyphs[] = {{")
+    for code, offset, width in entries:
+        out.append(f"    {{ {offset:5d}, {width:2d} }},  // {char_comment(code)}")
+    out.append("};")
+    out.append("")
+    out.append(f"const font_atlas_t {name} = {{")
+    out.append(f"    .pages = {pages},")
+    out.append(f"    .spacing = {spacing},")
+    out.append(f"    .first = {first},")
+    out.append(f"    .last = {last},")
+    out.append(f"    .glyphs = {name}_glyphs,")
+    out.append(f"    .bitmap = {name}_bitmap,")
+    out.append("};")
+
+    with open(path, "w") as f:
+        f.write("\n".join(out) + "\n")
+    print(f"{name}: {last - first + 1} glyphs, {pages} pages, {len(bitmap)} bytes -> {path}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert BDF/TTF fonts to display font atlases")
+    parser.add_argument("font", help="Input font (.bdf, .ttf or .otf)")
+    parser.add_argument("--name", required=True, help="C symbol of the atlas, e.g. font_clock_16")
+    parser.add_argument("-o", "--output", required=True, help="Output C file")
+    parser.add_argument("--chars", default="32-126",
+                        help='Character ranges ("32-126,176") or literal characters ("0123456789:.")')
+    parser.add_argument("--size", type=int, default=16, help="Pixel size for TrueType fonts")
+    parser.add_argument("--scale", type=int, default=1, help="Integer upscale factor")
+    parser.add_argument("--proportional", action="store_true",
+                        help="Trim empty columns per glyph instead of using the cell width")
+    parser.add_argument("--tabular-digits", action="store_true",
+                        help="Keep all digits at the same width (no jitter in clocks)")
+    parser.add_argument("--spacing", type=int, default=None,
+                        help="Blank columns between glyphs (default: 1 per scale step)")
+    args = parser.parse_args()
+
+    codes = parse_chars(args.chars)
+    ext = os.path.splitext(args.font)[1].lower()
+    if ext == ".bdf":
+        glyphs = load_bdf(args.font, codes)
+    elif ext in (".ttf", ".otf"):
+        glyphs = load_ttf(args.font, args.size, codes)
+    else:
+        sys.exit(f"Unsupported font format: {ext}")
+
+    missing = [c for c in codes if c not in glyphs]
+    if missing:
+        print("warning: missing glyphs " + " ".join(char_comment(c) for c in missing), file=sys.stderr)
+
+    if args.scale > 1:
+        glyphs = {c: scale_glyph(g, args.scale) for c, g in glyphs.items()}
+
+    spacing = args.spacing if args.spacing is not None else args.scale
+    if args.proportional:
+        digits = [glyphs[c] for c in range(ord("0"), ord("9") + 1) if c in glyphs]
+        digit_width = max((g.width for g in digits), default=0)
+        space_width = max(1, (digit_width or max(g.width for g in glyphs.values())) // 2)
+        for code, glyph in list(glyphs.items()):
+            if args.tabular_digits and ord("0") <= code <= ord("9"):
+                continue
+            glyphs[code] = trim_glyph(glyph, space_width)
+
+    height = max(len(g.rows) for g in glyphs.values())
+    pages = (height + 7) // 8
+    write_atlas(args.output, args.name, os.path.basename(args.font), glyphs, codes, pages, spacing)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""
+HTTP Load Test for the Main Unit Web Server
+
+Simulates spectators polling /api/status (one keep-alive connection each)
+while an operator triggers slow requests (WiFi scan, sound upload) in the
+background. Prints latency percentiles for the status endpoint so a
+regression in httpd concurrency shows up as a p99 spike.
+
+Usage:
+    tools/http_load_test.py --host 192.168.4.1 --clients 5 --duration 30
+    tools/http_load_test.py --host 192.168.4.1 --scan --upload 200000
+
+The upload test writes "loadtest.bin" into the sounds directory; delete it
+via the Sounds page afterwards.
+
+Author: ninharp
+Date: 2026-10-16
+"""
+
+import argparse
+import http.client
+import math
+import statistics
+import threading
+import time
+
+
+def percentile(samples, pct):
+    """Nearest-rank percentile of a sorted list"""
+    if not samples:
+        return 0.0
+    idx = max(0, min(len(samples) - 1, math.ceil(pct / 100.0 * len(samples)) - 1))
+    return samples[idx]
+
+
+class Spectator(threading.Thread):
+    """Polls /api/status over a single keep-alive connection"""
+
+    def __init__(self, host, port, interval, stop_event):
+        super().__init__(daemon=True)
+        self.host = host
+        self.port = port
+        self.interval = interval
+        self.stop_event = stop_event
+        self.latencies = []
+        self.errors = 0
+        self.reconnects = 0
+
+    def run(self):
+        conn = None
+        while not self.stop_event.is_set():
+            if conn is None:
+                conn = http.client.HTTPConnection(self.host, self.port, timeout=10)
+                self.reconnects += 1
+            start = time.perf_counter()
+            try:
+                conn.request("GET", "/api/status")
+                resp = conn.getresponse()
+                resp.read()
+                if resp.status != 200:
+                    self.errors += 1
+                else:
+                    self.latencies.append((time.perf_counter() - start) * 1000.0)
+                if resp.getheader("Connection", "").lower() == "close":
+                    conn.close()
+                    conn = None
+            except (OSError, http.client.HTTPException):
+                self.errors += 1
+                if conn:
+                    conn.close()
+                conn = None
+            self.stop_event.wait(self.interval)
+        if conn:
+            conn.close()
+
+
+class SlowRequester(threading.Thread):
+    """Repeatedly issues a slow request (WiFi scan or upload)"""
+
+    def __init__(self, host, port, kind, upload_size, stop_event):
+        super().__init__(daemon=True)
+        self.host = host
+        self.port = port
+        self.kind = kind
+        self.upload_size = upload_size
+        self.stop_event = stop_event
+        self.durations = []
+        self.busy = 0
+        self.errors = 0
+
+    def run(self):
+        payload = bytes(self.upload_size) if self.kind == "upload" else None
+        while not self.stop_event.is_set():
+            conn = http.client.HTTPConnection(self.host, self.port, timeout=60)
+            start = time.perf_counter()
+            try:
+                if self.kind == "scan":
+                    conn.request("GET", "/api/wifi/scan?refresh=1")
+                else:
+                    conn.request("POST", "/api/sounds/upload", body=payload,
+                                 headers={"X-Filename": "loadtest.bin",
+                                          "Content-Type": "application/octet-stream"})
+                resp = conn.getresponse()
+                resp.read()
+                if resp.status == 503:
+                    self.busy += 1
+                elif resp.status != 200:
+                    self.errors += 1
+                else:
+                    self.durations.append((time.perf_counter() - start) * 1000.0)
+            except (OSError, http.client.HTTPException):
+                self.errors += 1
+            finally:
+                conn.close()
+            self.stop_event.wait(1.0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Web server latency load test")
+    parser.add_argument("--host", default="192.168.4.1", help="Main unit address")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--clients", type=int, default=5, help="Spectator connections")
+    parser.add_argument("--interval", type=float, default=0.5,
+                        help="Status poll interval per client (s), like the web UI")
+    parser.add_argument("--duration", type=float, default=30.0, help="Test duration (s)")
+    parser.add_argument("--scan", action="store_true", help="Run WiFi scans in parallel")
+    parser.add_argument("--upload", type=int, default=0, metavar="BYTES",
+                        help="Upload a file of this size in parallel")
+    args = parser.parse_args()
+
+    stop_event = threading.Event()
+    spectators = [Spectator(args.host, args.port, args.interval, stop_event)
+                  for _ in range(args.clients)]
+    slow = []
+    if args.scan:
+        slow.append(SlowRequester(args.host, args.port, "scan", 0, stop_event))
+    if args.upload > 0:
+        slow.append(SlowRequester(args.host, args.port, "upload", args.upload, stop_event))
+
+    print(f"Load test: {args.clients} spectators @ {args.interval}s, "
+          f"scan={'on' if args.scan else 'off'}, upload={args.upload} bytes, "
+          f"{args.duration}s against http://{args.host}:{args.port}")
+
+    for t in spectators + slow:
+        t.start()
+    time.sleep(args.duration)
+    stop_event.set()
+    for t in spectators + slow:
+        t.join(timeout=15)
+
+    latencies = sorted(l for s in spectators for l in s.latencies)
+    errors = sum(s.errors for s in spectators)
+    reconnects = sum(s.reconnects for s in spectators) - len(spectators)
+
+    print("")
+    print("/api/status")
+    print(f"  requests:   {len(latencies)}  errors: {errors}  reconnects: {reconnects}")
+    if latencies:
+        print(f"  mean:       {statistics.mean(latencies):8.1f} ms")
+        print(f"  p50:        {percentile(latencies, 50):8.1f} ms")
+        print(f"  p95:        {percentile(latencies, 95):8.1f} ms")
+        print(f"  p99:        {percentile(latencies, 99):8.1f} ms")
+        print(f"  max:        {latencies[-1]:8.1f} ms")
+
+    for s in slow:
+        print(f"{s.kind}")
+        print(f"  completed:  {len(s.durations)}  busy(503): {s.busy}  errors: {s.errors}")
+        if s.durations:
+            print(f"  mean:       {statistics.mean(s.durations):8.1f} ms")
+
+
+if __name__ == "__main__":
+    main()
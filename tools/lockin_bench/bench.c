@@ -0,0 +1,198 @@
+/**
+ * Lock-In Bench
+ *
+ * Host benchmark and sanity checks for the sensor lock-in demodulator.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#include "sensor_lockin.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define FS ((double)SENSOR_LOCKIN_SAMPLE_HZ)
+#define BLOCK SENSOR_LOCKIN_BLOCK_SAMPLES
+#define BENCH_SAMPLES (100L * 1000 * 1000)
+
+static uint16_t block[BLOCK * 2];
+static int failures = 0;
+
+/**
+ * Test signal
+ */
+typedef struct {
+    double carrier_hz;
+    double swing;           // Laser on minus laser off (counts)
+    double phase;           // Carrier phase at the first sample (periods)
+    double dc;              // Ambient level
+    double flicker;         // 100 Hz mains flicker amplitude
+    double harmonics;       // Amplitude of the 1200/1300 Hz flicker harmonics
+    double noise;           // Uniform noise +-noise
+} signal_t;
+
+static void check(int ok, const char *what)
+{
+    printf("  %-52s %s\n", what, ok ? "ok" : "FAILED");
+    if (!ok) {
+        failures++;
+    }
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Fill a block with a pulsed carrier over ambient light (12 bit, clipped)
+ */
+static void synth(const signal_t *sig, double t0, uint16_t *out, size_t count)
+{
+    for (size_t n = 0; n < count; n++) {
+        double t = t0 + n / FS;
+        double cycle = fmod(t * sig->carrier_hz + sig->phase, 1.0);
+        double v = sig->dc + (cycle < 0.5 ? sig->swing : 0.0);
+        v += sig->flicker * sin(2 * M_PI * 100 * t + 0.3);
+        v += sig->harmonics * (sin(2 * M_PI * 1200 * t + 1.1) + sin(2 * M_PI * 1300 * t + 2.2));
+        if (sig->noise > 0) {
+            v += sig->noise * (2.0 * rand() / RAND_MAX - 1.0);
+        }
+        v = v < 0 ? 0 : (v > 4095 ? 4095 : v);
+        out[n] = (uint16_t)lround(v);
+    }
+}
+
+static sensor_lockin_result_t run(const sensor_lockin_t *l, const signal_t *sig, double t0)
+{
+    sensor_lockin_result_t r;
+    synth(sig, t0, block, BLOCK);
+    sensor_lockin_process(l, block, BLOCK, &r);
+    return r;
+}
+
+/**
+ * Constant and mains-flicker light must not look like a carrier
+ */
+static void test_ambient(const sensor_lockin_t *l)
+{
+    signal_t dc = { .carrier_hz = SENSOR_LOCKIN_CARRIER_HZ, .dc = 2000 };
+    sensor_lockin_result_t r = run(l, &dc, 0);
+    check(r.amplitude <= 1, "DC ambient cancels");
+    check(abs(r.ambient - 2000) <= 1, "ambient level reported");
+
+    signal_t mains = dc;
+    mains.flicker = 1500;
+    mains.harmonics = 200;
+    int worst = 0;
+    for (int k = 0; k < 20; k++) {
+        r = run(l, &mains, k * 0.0037);
+        worst = r.amplitude > worst ? r.amplitude : worst;
+    }
+    printf("    worst amplitude from 100 Hz flicker: %d\n", worst);
+    check(worst <= 3, "100 Hz flicker and its harmonics cancel");
+}
+
+/**
+ * Amplitude of a square carrier, independent of its phase
+ */
+static void test_phase(const sensor_lockin_t *l)
+{
+    signal_t sig = { .carrier_hz = SENSOR_LOCKIN_CARRIER_HZ, .swing = 400, .dc = 500 };
+    double expected = 2.0 / M_PI * 400;
+    int lo = 65535, hi = 0;
+
+    for (int k = 0; k < 64; k++) {
+        sig.phase = k / 64.0;
+        sensor_lockin_result_t r = run(l, &sig, 0);
+        lo = r.amplitude < lo ? r.amplitude : lo;
+        hi = r.amplitude > hi ? r.amplitude : hi;
+    }
+    printf("    amplitude %d..%d, expected %.0f\n", lo, hi, expected);
+    check(lo > expected * 0.97 && hi < expected * 1.03, "carrier amplitude independent of phase");
+
+    // Laser and ADC clocks are not locked, a small frequency error must not matter
+    sig.phase = 0.2;
+    sig.carrier_hz = SENSOR_LOCKIN_CARRIER_HZ * 1.002;
+    sensor_lockin_result_t r = run(l, &sig, 0);
+    check(r.amplitude > expected * 0.95, "0.2 % carrier frequency error tolerated");
+}
+
+/**
+ * Weak beam under bright, flickering, noisy light stays separable
+ */
+static void test_separation(const sensor_lockin_t *l)
+{
+    signal_t on = {
+        .carrier_hz = SENSOR_LOCKIN_CARRIER_HZ, .swing = 100, .phase = 0.37,
+        .dc = 3000, .flicker = 800, .harmonics = 100, .noise = 60
+    };
+    signal_t off = on;
+    off.swing = 0;
+
+    int on_min = 65535, off_max = 0;
+    for (int k = 0; k < 50; k++) {
+        sensor_lockin_result_t r = run(l, &on, k * 0.02);
+        on_min = r.amplitude < on_min ? r.amplitude : on_min;
+        r = run(l, &off, k * 0.02);
+        off_max = r.amplitude > off_max ? r.amplitude : off_max;
+    }
+    printf("    beam on >= %d, beam off <= %d (raw threshold could not tell them apart)\n",
+           on_min, off_max);
+    check(on_min > 3 * off_max, "beam on/off separable under bright ambient");
+}
+
+/**
+ * Demodulate BENCH_SAMPLES with the given samples per period
+ */
+static void bench(uint16_t period)
+{
+    sensor_lockin_t l;
+    sensor_lockin_result_t r;
+    size_t count = (BLOCK / period) * period;
+    volatile uint32_t sink = 0;
+
+    sensor_lockin_init(&l, period);
+    double start = now_s();
+    for (long done = 0; done < BENCH_SAMPLES; done += count) {
+        sensor_lockin_process(&l, block, count, &r);
+        sink += r.amplitude;
+    }
+    double elapsed = now_s() - start;
+
+    double samples_per_s = BENCH_SAMPLES / elapsed;
+    printf("  %2u samples/period  %7.1f M samples/s  %7.0fx realtime\n",
+           period, samples_per_s / 1e6, samples_per_s / FS);
+    (void)sink;
+}
+
+int main(void)
+{
+    sensor_lockin_t l;
+    srand(1);
+    sensor_lockin_init(&l, SENSOR_LOCKIN_SAMPLES_PER_PERIOD);
+
+    printf("Checks (%d Hz carrier, %d samples per %d ms block):\n",
+           SENSOR_LOCKIN_CARRIER_HZ, BLOCK, (int)(BLOCK * 1000 / FS));
+    test_ambient(&l);
+    test_phase(&l);
+    test_separation(&l);
+
+    signal_t sig = {
+        .carrier_hz = SENSOR_LOCKIN_CARRIER_HZ, .swing = 300, .dc = 1500,
+        .flicker = 500, .noise = 40
+    };
+    synth(&sig, 0, block, BLOCK * 2);
+
+    printf("Demodulation throughput:\n");
+    static const uint16_t periods[] = {8, 16, 32};
+    for (size_t i = 0; i < sizeof(periods) / sizeof(periods[0]); i++) {
+        bench(periods[i]);
+    }
+
+    return failures ? 1 : 0;
+}
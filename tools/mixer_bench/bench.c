@@ -0,0 +1,172 @@
+/**
+ * Mixer Bench
+ *
+ * Host benchmark and sanity checks for the sound mixer core.
+ *
+ * @author ninharp
+ * @date 2026
+ */
+
+#include "sound_mixer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define SAMPLE_RATE 44100
+#define CLIP_FRAMES SAMPLE_RATE         // 1 s clips
+#define BENCH_FRAMES (SAMPLE_RATE * 60) // 1 min of output per run
+
+static int16_t clip[CLIP_FRAMES];
+static int16_t music[SOUND_MIXER_MAX_FRAMES * 2];
+static int16_t out[SOUND_MIXER_MAX_FRAMES * 2];
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    printf("  %-44s %s\n", what, ok ? "ok" : "FAILED");
+    if (!ok) {
+        failures++;
+    }
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Full-scale sums must clip, not wrap around
+ */
+static void test_saturation(void)
+{
+    static const int16_t loud[4] = {32767, 32767, -32768, -32768};
+    static const int16_t loud_music[8] = {32767, 32767, 32767, 32767, -32768, -32768, -32768, -32768};
+    sound_mixer_t m;
+
+    sound_mixer_init(&m, 4, 255, SOUND_MIXER_UNITY, 1);
+    sound_mixer_play(&m, loud, 4, SOUND_MIXER_UNITY, 1, false);
+    sound_mixer_play(&m, loud, 4, SOUND_MIXER_UNITY, 1, false);
+    sound_mixer_render(&m, loud_music, out, 4);
+    check(out[0] == 32767 && out[1] == 32767 && out[4] == -32768 && out[7] == -32768,
+          "saturates instead of wrapping");
+    check(sound_mixer_active(&m) == 0, "voices end with their clip");
+}
+
+/**
+ * Full voices: lower priority is stolen, higher priority is not
+ */
+static void test_priorities(void)
+{
+    sound_mixer_t m;
+
+    sound_mixer_init(&m, 2, 255, SOUND_MIXER_UNITY, 1);
+    int a = sound_mixer_play(&m, clip, CLIP_FRAMES, SOUND_MIXER_UNITY, 2, false);
+    int b = sound_mixer_play(&m, clip, CLIP_FRAMES, SOUND_MIXER_UNITY, 1, false);
+    int c = sound_mixer_play(&m, clip, CLIP_FRAMES, SOUND_MIXER_UNITY, 3, false);
+    int d = sound_mixer_play(&m, clip, CLIP_FRAMES, SOUND_MIXER_UNITY, 1, false);
+    check(a == 0 && b == 1 && c == b, "lowest priority voice is replaced");
+    check(d == -1, "no voice for a lower priority sound");
+}
+
+/**
+ * Music fades to the duck level while a ducking voice plays and back after
+ */
+static void test_ducking(void)
+{
+    static int16_t beep[SAMPLE_RATE / 10];
+    sound_mixer_t m;
+
+    for (int i = 0; i < SOUND_MIXER_MAX_FRAMES * 2; i++) {
+        music[i] = 10000;
+    }
+    sound_mixer_init(&m, 4, 2, SOUND_MIXER_UNITY / 4, SAMPLE_RATE / 20);
+    sound_mixer_play(&m, beep, sizeof(beep) / sizeof(beep[0]), SOUND_MIXER_UNITY, 2, false);
+    for (int i = 0; i < 12; i++) {
+        sound_mixer_render(&m, music, out, SOUND_MIXER_MAX_FRAMES);
+    }
+    check(out[0] > 2400 && out[0] < 2600, "music ducked to 25 %");
+    for (int i = 0; i < 24; i++) {
+        sound_mixer_render(&m, music, out, SOUND_MIXER_MAX_FRAMES);
+    }
+    check(out[0] > 9900, "music restored after the sound");
+}
+
+/**
+ * Looping voices wrap sample-exact, also several times per block
+ */
+static void test_loop(void)
+{
+    static int16_t tick[100];
+    sound_mixer_t m;
+    int ok = 1;
+
+    for (int i = 0; i < 100; i++) {
+        tick[i] = (int16_t)(i * 100);
+    }
+    sound_mixer_init(&m, 2, 255, SOUND_MIXER_UNITY, 1);
+    sound_mixer_play(&m, tick, 100, SOUND_MIXER_UNITY, 1, true);
+    for (int block = 0; block < 3; block++) {
+        sound_mixer_render(&m, NULL, out, SOUND_MIXER_MAX_FRAMES);
+        for (int k = 0; k < SOUND_MIXER_MAX_FRAMES; k++) {
+            int expected = ((block * SOUND_MIXER_MAX_FRAMES + k) % 100) * 100;
+            if (abs(out[k * 2] - expected) > 1) {
+                ok = 0;
+            }
+        }
+    }
+    check(ok, "looping voice wraps without a gap");
+    check(sound_mixer_active(&m) == 1, "looping voice keeps playing");
+}
+
+/**
+ * Render BENCH_FRAMES with the given number of voices
+ */
+static void bench(int voices)
+{
+    sound_mixer_t m;
+
+    sound_mixer_init(&m, voices ? voices : 1, 2, SOUND_MIXER_UNITY / 3, SAMPLE_RATE / 20);
+    sound_mixer_set_master(&m, SOUND_MIXER_UNITY * 7 / 10);
+
+    double start = now_s();
+    for (long done = 0; done < BENCH_FRAMES; done += SOUND_MIXER_MAX_FRAMES) {
+        for (int v = sound_mixer_active(&m); v < voices; v++) {
+            sound_mixer_play(&m, clip, CLIP_FRAMES, SOUND_MIXER_UNITY / 2, (uint8_t)(1 + v % 3), false);
+        }
+        sound_mixer_render(&m, music, out, SOUND_MIXER_MAX_FRAMES);
+    }
+    double elapsed = now_s() - start;
+
+    double frames_per_s = BENCH_FRAMES / elapsed;
+    printf("  %d voice%s  %7.1f M frames/s  %7.1f M voice samples/s  %6.0fx realtime\n",
+           voices, voices == 1 ? " " : "s", frames_per_s / 1e6,
+           voices ? frames_per_s * voices / 1e6 : 0.0, frames_per_s / SAMPLE_RATE);
+}
+
+int main(void)
+{
+    srand(1);
+    for (int i = 0; i < CLIP_FRAMES; i++) {
+        clip[i] = (int16_t)(rand() % 20000 - 10000);
+    }
+
+    printf("Checks:\n");
+    test_saturation();
+    test_priorities();
+    test_ducking();
+    test_loop();
+
+    for (int i = 0; i < SOUND_MIXER_MAX_FRAMES * 2; i++) {
+        music[i] = (int16_t)(rand() % 20000 - 10000);
+    }
+
+    printf("Render throughput (stereo output frames, music + N voices):\n");
+    static const int counts[] = {0, 1, 2, 4, 8};
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        bench(counts[i]);
+    }
+
+    return failures ? 1 : 0;
+}
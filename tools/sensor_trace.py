@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""
+Sensor Trace Reader
+
+Reads a raw sensor trace downloaded from the main unit (/api/trace, see
+components/sensor_manager/include/sensor_trace.h), prints a summary of
+the levels before and after the break and optionally writes a CSV for
+plotting or as input for detector regression tests.
+
+Usage:
+    curl -o trace.bin http://192.168.4.1/api/trace
+    tools/sensor_trace.py trace.bin
+    tools/sensor_trace.py trace.bin --csv trace.csv
+
+Author: ninharp
+Date: 2026-10-16
+"""
+
+import argparse
+import statistics
+import struct
+import sys
+
+HEADER = struct.Struct("<IBBBBHHHH")
+SAMPLE = struct.Struct("<iH")
+MAGIC = 0x5254504C
+DETECTORS = {0: "raw ADC", 1: "lock-in"}
+
+
+def read_trace(path):
+    """Return (header dict, list of (time_us, value))"""
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < HEADER.size:
+        raise ValueError("file too short")
+
+    magic, version, module_id, detector, trace_id, count, trigger, threshold, hysteresis = \
+        HEADER.unpack_from(data)
+    if magic != MAGIC:
+        raise ValueError("not a sensor trace (bad magic)")
+    if version != 1:
+        raise ValueError("unsupported trace version %d" % version)
+
+    expected = HEADER.size + count * SAMPLE.size
+    if len(data) < expected:
+        raise ValueError("truncated: %d of %d bytes" % (len(data), expected))
+
+    samples = [SAMPLE.unpack_from(data, HEADER.size + i * SAMPLE.size) for i in range(count)]
+    header = {
+        "module_id": module_id,
+        "detector": detector,
+        "trace_id": trace_id,
+        "count": count,
+        "trigger": trigger,
+        "threshold": threshold,
+        "hysteresis": hysteresis,
+    }
+    return header, samples
+
+
+def describe(name, samples):
+    """One line of level statistics"""
+    if not samples:
+        return "  %-7s no samples" % name
+    values = [v for _, v in samples]
+    span_ms = (samples[-1][0] - samples[0][0]) / 1000.0
+    return "  %-7s %5d samples over %8.1f ms  mean %7.1f  stddev %6.1f  min %4d  max %4d" % (
+        name, len(values), span_ms, statistics.fmean(values),
+        statistics.pstdev(values), min(values), max(values))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("trace", help="trace file from /api/trace")
+    parser.add_argument("--csv", help="write time_us,value rows to this file")
+    args = parser.parse_args()
+
+    try:
+        header, samples = read_trace(args.trace)
+    except (OSError, ValueError) as e:
+        print("%s: %s" % (args.trace, e), file=sys.stderr)
+        return 1
+
+    print("Trace %d from module %d, %s detector, threshold %d +- %d" % (
+        header["trace_id"], header["module_id"], DETECTORS.get(header["detector"], "unknown"),
+        header["threshold"], header["hysteresis"]))
+    if header["detector"] == 1:
+        print("  (lock-in: samples are the raw carrier, the threshold applies to its amplitude)")
+
+    # Unreceived samples are zero in both fields
+    missing = sum(1 for t, v in samples if t == 0 and v == 0)
+    if missing > 1:
+        print("  %d samples missing (frames lost on the way)" % missing)
+
+    trigger = header["trigger"]
+    print(describe("before", samples[:trigger]))
+    print(describe("after", samples[trigger:]))
+
+    gaps = [(a[0], b[0] - a[0]) for a, b in zip(samples, samples[1:]) if b[0] - a[0] > 50000]
+    for at, gap in gaps:
+        print("  gap of %.1f ms at %.1f ms" % (gap / 1000.0, at / 1000.0))
+
+    if args.csv:
+        with open(args.csv, "w") as f:
+            f.write("time_us,value\n")
+            for t, v in samples:
+                f.write("%d,%d\n" % (t, v))
+        print("Wrote %d rows to %s" % (len(samples), args.csv))
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())